@@ -102,6 +102,70 @@
 #define EFI_SIGNAL_EXECUTOR_ONE_TIMER TRUE
 #define EFI_SIGNAL_EXECUTOR_HW_TIMER FALSE
 
+/**
+ * Binary heap instead of sorted linked list for pending scheduler events, see event_heap.h
+ */
+#define EFI_EVENT_QUEUE_HEAP TRUE
+
+/**
+ * Per-callback lateness and duration histograms of scheduler events, see 'schedulerinfo' command
+ */
+#define EFI_SCHEDULER_HISTOGRAMS TRUE
+
+/**
+ * Fuel and spark angles are calculated by periodicFastCallback() and switched over at engine cycle boundary
+ */
+#define EFI_OUTPUT_SCHEDULE_BUFFER TRUE
+
+/**
+ * Capture interrupt only queues trigger edges, decoder and listeners are invoked by a high priority thread
+ *
+ * Optional: fuel and spark are scheduled from the time the edge is processed and not from capture
+ * timestamp, so queue latency becomes injection and ignition timing error.
+ */
+#define EFI_TRIGGER_EVENT_QUEUE FALSE
+
+/**
+ * Engine sniffer events are stored as fixed size binary records which TunerStudio reads, no text chart for rusEfi console
+ */
+#define EFI_ENGINE_SNIFFER_BINARY TRUE
+
+/**
+ * TunerStudio protocol command which makes ECU push delta-encoded output channel frames
+ */
+#define EFI_TS_OUTPUT_STREAM TRUE
+
+/**
+ * SD card log is written as binary records by a dedicated writer thread, see binary_log.h
+ */
+#define EFI_BINARY_FILE_LOGGING TRUE
+
+/**
+ * Each thread and interrupt context logs into a lock-free ring of its own, console merges them
+ */
+#define EFI_LOG_PRODUCER_RINGS TRUE
+
+/**
+ * PWM outputs on pins with a spare timer channel are generated by the timer
+ * instead of the event scheduler
+ */
+#define EFI_HARDWARE_PWM TRUE
+
+/**
+ * Slow ADC is free-running into a circular DMA buffer, each half is filtered while the other one is written
+ */
+#define EFI_SLOW_ADC_CIRCULAR TRUE
+
+/**
+ * Sequential speed density fuel is trimmed by MAP of each cylinder's own sampling window, for ITB engines
+ */
+#define EFI_MAP_PER_CYLINDER_FUEL FALSE
+
+/**
+ * Configuration burn only appends changed pages to a log in flash, so it does not have to wait for engine stop
+ */
+#define EFI_CONFIG_LOG_FLASH TRUE
+
 #define FUEL_MATH_EXTREME_LOGGING FALSE
 
 #define SPARK_EXTREME_LOGGING FALSE
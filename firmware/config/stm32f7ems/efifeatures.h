@@ -29,6 +29,10 @@
 #undef EFI_MCP_3208
 #define EFI_MCP_3208 FALSE
 
+// both copies of the tune are in the same 256K sector here, configuration log needs its two regions in different sectors
+#undef EFI_CONFIG_LOG_FLASH
+#define EFI_CONFIG_LOG_FLASH FALSE
+
 #undef EFI_MC33816
 #define EFI_MC33816 FALSE
 
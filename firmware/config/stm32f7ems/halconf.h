@@ -213,6 +213,14 @@
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
 
+/**
+ * @brief   Enforces the driver to use direct callbacks rather than OSAL events.
+ * @note    rusEfi CAN thread is woken by its own receive callback, see can_hw.cpp
+ */
+#if !defined(CAN_ENFORCE_USE_CALLBACKS) || defined(__DOXYGEN__)
+#define CAN_ENFORCE_USE_CALLBACKS   TRUE
+#endif
+
 /*===========================================================================*/
 /* I2C driver related settings.                                              */
 /*===========================================================================*/
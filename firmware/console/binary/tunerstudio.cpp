@@ -76,6 +76,8 @@
 #include "bluetooth.h"
 #include "tunerstudio_io.h"
 #include "tooth_logger.h"
+#include "engine_sniffer.h"
+#include "scheduler_histograms.h"
 
 #include <string.h>
 #include "engine_configuration.h"
@@ -121,8 +123,33 @@ static THD_WORKING_AREA(tunerstudioThreadStack, 3 * UTILITY_THREAD_STACK_SIZE);
 
 extern TunerStudioOutputChannels tsOutputChannels;
 
+#if EFI_TS_OUTPUT_STREAM
+#include "delta_frame_encoder.h"
+
+#define TS_OUTPUT_STREAM_MIN_PERIOD_MS 10
+
+typedef DeltaFrameEncoder<sizeof(TunerStudioOutputChannels)> output_stream_encoder_t;
+
+/**
+ * Instead of polling with 'O' the other side could ask us to push output channels at a fixed rate.
+ * Each frame only carries the words which have changed since previous frame.
+ */
+static output_stream_encoder_t outputStream;
+static uint8_t outputStreamFrame[output_stream_encoder_t::MAX_FRAME_SIZE];
+/**
+ * only one channel at a time is streaming
+ */
+static ts_channel_s *outputStreamChannel = NULL;
+static int outputStreamPeriodMs = 0;
+static efitimems_t outputStreamLastFrameMs = 0;
+#endif /* EFI_TS_OUTPUT_STREAM */
+
 extern tunerstudio_counters_s tsState;
 
+#if EFI_ENGINE_SNIFFER_BINARY
+extern WaveChart waveChart;
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+
 static void resetTs(void) {
 	memset(&tsState, 0, sizeof(tsState));
 }
@@ -133,6 +160,10 @@ static void printErrorCounters(void) {
 			tsState.outputChannelsCommandCounter, tsState.readPageCommandsCounter, tsState.burnCommandCounter);
 	scheduleMsg(&tsLogger, "TunerStudio W=%d / C=%d / P=%d / page=%d", tsState.writeValueCommandCounter,
 			tsState.writeChunkCommandCounter, tsState.pageCommandCounter, currentPageId);
+#if EFI_TS_OUTPUT_STREAM
+	scheduleMsg(&tsLogger, "TunerStudio stream period=%dms frames=%d key=%d sent=%d", outputStreamPeriodMs,
+			outputStream.frameCounter, outputStream.keyFrameCounter, tsState.outputStreamFrameCounter);
+#endif /* EFI_TS_OUTPUT_STREAM */
 //	scheduleMsg(&tsLogger, "page size=%d", getTunerStudioPageSize(currentPageId));
 }
 
@@ -260,6 +291,10 @@ static const void * getStructAddr(int structId) {
 		return static_cast<wall_fuel_state*>(&engine->wallFuel);
 	case LDS_TRIGGER_INDEX:
 		return static_cast<trigger_central_s*>(&engine->triggerCentral);
+#if EFI_SCHEDULER_HISTOGRAMS
+	case LDS_SCHEDULER_INDEX:
+		return &schedulerHistograms;
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
 	default:
 		return NULL;
 	}
@@ -461,11 +496,66 @@ static bool isKnownCommand(char command) {
 			|| command == TS_GET_FILE_RANGE
 			|| command == TS_SET_LOGGER_MODE
 			|| command == TS_GET_LOGGER_BUFFER
+#if EFI_ENGINE_SNIFFER_BINARY
+			|| command == TS_GET_ENGINE_SNIFFER
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+#if EFI_TS_OUTPUT_STREAM
+			|| command == TS_OUTPUT_STREAM_COMMAND
+#endif /* EFI_TS_OUTPUT_STREAM */
 			|| command == TS_GET_TEXT
 			|| command == TS_CRC_CHECK_COMMAND
 			|| command == TS_GET_FIRMWARE_VERSION;
 }
 
+#if EFI_TS_OUTPUT_STREAM
+static void handleOutputStreamCommand(ts_channel_s *tsChannel, uint16_t periodMs) {
+	if (periodMs == 0) {
+		outputStreamChannel = NULL;
+		outputStreamPeriodMs = 0;
+	} else {
+		outputStreamChannel = tsChannel;
+		outputStreamPeriodMs = maxI(periodMs, TS_OUTPUT_STREAM_MIN_PERIOD_MS);
+		// first frame goes out right after the response and has all the fields
+		outputStreamLastFrameMs = currentTimeMillis() - outputStreamPeriodMs;
+		outputStream.reset();
+	}
+	scheduleMsg(&tsLogger, "output stream period %dms", outputStreamPeriodMs);
+	sendOkResponse(tsChannel, TS_CRC);
+}
+
+/**
+ * Output channels are recalculated once per frame no matter how many gauges are displayed
+ */
+static void sendOutputStreamFrameIfDue(ts_channel_s *tsChannel) {
+	if (tsChannel != outputStreamChannel) {
+		return;
+	}
+	efitimems_t nowMs = currentTimeMillis();
+	if (nowMs - outputStreamLastFrameMs < outputStreamPeriodMs) {
+		return;
+	}
+	outputStreamLastFrameMs = nowMs;
+	prepareTunerStudioOutputs();
+	int size = outputStream.encode(&tsOutputChannels, outputStreamFrame);
+	sr5WriteCrcPacket(tsChannel, TS_RESPONSE_OUTPUT_FRAME, outputStreamFrame, size);
+	tsState.outputStreamFrameCounter++;
+}
+#endif /* EFI_TS_OUTPUT_STREAM */
+
+/**
+ * @return how long to wait for next command
+ */
+static int getCommandTimeout(ts_channel_s *tsChannel) {
+#if EFI_TS_OUTPUT_STREAM
+	if (tsChannel == outputStreamChannel) {
+		return TIME_MS2I(outputStreamPeriodMs);
+	}
+#else
+	UNUSED(tsChannel);
+#endif /* EFI_TS_OUTPUT_STREAM */
+	return SR5_READ_TIMEOUT;
+}
+
 // this function runs indefinitely
 void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 	int wasReady = false;
@@ -473,6 +563,12 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 	while (true) {
 		int isReady = sr5IsReady(tsChannel);
 		if (!isReady) {
+#if EFI_TS_OUTPUT_STREAM
+			if (tsChannel == outputStreamChannel) {
+				// nobody to stream to anymore
+				outputStreamChannel = NULL;
+			}
+#endif /* EFI_TS_OUTPUT_STREAM */
 			chThdSleepMilliseconds(10);
 			wasReady = false;
 			continue;
@@ -485,14 +581,25 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 
 		tsState.totalCounter++;
 
+#if EFI_TS_OUTPUT_STREAM
+		// frames are only sent between commands so that they never get in the middle of a response
+		sendOutputStreamFrameIfDue(tsChannel);
+#endif /* EFI_TS_OUTPUT_STREAM */
+
 		uint8_t firstByte;
-		int received = sr5ReadData(tsChannel, &firstByte, 1);
+		int received = sr5ReadDataTimeout(tsChannel, &firstByte, 1, getCommandTimeout(tsChannel));
 #if EFI_SIMULATOR
 			logMsg("received %d\r\n", received);
 #endif
 
 
 		if (received != 1) {
+#if EFI_TS_OUTPUT_STREAM
+			if (tsChannel == outputStreamChannel) {
+				// that's just time for next frame
+				continue;
+			}
+#endif /* EFI_TS_OUTPUT_STREAM */
 //			tunerStudioError("ERROR: no command");
 #if EFI_BLUETOOTH_SETUP
 			// assume there's connection loss and notify the bluetooth init code
@@ -543,8 +650,14 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 
 //		scheduleMsg(logger, "TunerStudio: reading %d+4 bytes(s)", incomingPacketSize);
 
-		received = sr5ReadData(tsChannel, (uint8_t * ) (tsChannel->crcReadBuffer + 1),
-				incomingPacketSize + CRC_VALUE_SIZE - 1);
+		// CRC is calculated as the packet arrives
+		uint32_t actualCrc = crc32(tsChannel->crcReadBuffer, 1);
+		received = sr5ReadDataCrc(tsChannel, (uint8_t * ) (tsChannel->crcReadBuffer + 1),
+				incomingPacketSize - 1, &actualCrc);
+		if (received == incomingPacketSize - 1) {
+			received += sr5ReadData(tsChannel, (uint8_t * ) (tsChannel->crcReadBuffer + incomingPacketSize),
+					CRC_VALUE_SIZE);
+		}
 		int expectedSize = incomingPacketSize + CRC_VALUE_SIZE - 1;
 		if (received != expectedSize) {
 			scheduleMsg(&tsLogger, "Got only %d bytes while expecting %d for command %c", received,
@@ -558,7 +671,6 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 
 		expectedCrc = SWAP_UINT32(expectedCrc);
 
-		uint32_t actualCrc = crc32(tsChannel->crcReadBuffer, incomingPacketSize);
 		if (actualCrc != expectedCrc) {
 			scheduleMsg(&tsLogger, "TunerStudio: CRC %x %x %x %x", tsChannel->crcReadBuffer[incomingPacketSize + 0],
 					tsChannel->crcReadBuffer[incomingPacketSize + 1], tsChannel->crcReadBuffer[incomingPacketSize + 2],
@@ -741,6 +853,11 @@ int tunerStudioHandleCrcCommand(ts_channel_s *tsChannel, char *data, int incomin
 	case TS_OUTPUT_COMMAND:
 		handleOutputChannelsCommand(tsChannel, TS_CRC, data16[0], data16[1]);
 		break;
+#if EFI_TS_OUTPUT_STREAM
+	case TS_OUTPUT_STREAM_COMMAND:
+		handleOutputStreamCommand(tsChannel, data16[0]);
+		break;
+#endif /* EFI_TS_OUTPUT_STREAM */
 	case TS_HELLO_COMMAND:
 		tunerStudioDebug("got Query command");
 		handleQueryCommand(tsChannel, TS_CRC);
@@ -825,10 +942,26 @@ int tunerStudioHandleCrcCommand(ts_channel_s *tsChannel, char *data, int incomin
 		{
 			auto toothBuffer = GetToothLoggerBuffer();
 			sr5SendResponse(tsChannel, TS_CRC, toothBuffer.Buffer, toothBuffer.Length);
+			ReleaseToothLoggerBuffer(toothBuffer);
 		}
 
 		break;
 #endif /* EFI_TOOTH_LOGGER */
+#if EFI_ENGINE_SNIFFER_BINARY
+	case TS_GET_ENGINE_SNIFFER:
+		{
+			const engine_sniffer_chart_s *chart = waveChart.beginBinaryRead();
+			if (chart == NULL) {
+				sr5SendResponse(tsChannel, TS_CRC, NULL, 0);
+			} else {
+				int size = sizeof(engine_sniffer_header_s) + chart->header.recordCount * sizeof(engine_sniffer_record_s);
+				sr5SendResponse(tsChannel, TS_CRC, (const uint8_t *) chart, size);
+			}
+			waveChart.endBinaryRead();
+		}
+
+		break;
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 	default:
 		tunerStudioError("ERROR: ignoring unexpected command");
 		return false;
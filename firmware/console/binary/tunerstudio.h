@@ -27,6 +27,7 @@ typedef struct {
 	int totalCounter;
 	int textCommandCounter;
 	int testCommandCounter;
+	int outputStreamFrameCounter;
 } tunerstudio_counters_s;
 
 /**
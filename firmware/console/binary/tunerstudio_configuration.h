@@ -176,7 +176,12 @@ typedef struct {
 	float etbTarget;		// 312
 	float etb1DutyCycle;	// 316
 	float etb1Error;		// 320
-	int unused3[8];
+	/**
+	 * p99 lateness and p99 execution time of scheduler callbacks, microseconds, one value per
+	 * scheduler_histograms_s slot
+	 */
+	uint16_t schedulerLatenessUs[8]; // 324
+	uint16_t schedulerDurationUs[8]; // 340
 	/* see also [OutputChannels] in rusefi.input */
 } TunerStudioOutputChannels;
 
@@ -64,9 +64,17 @@ static void tsRxIRQIdleHandler(UARTDriver *uartp) {
 	tsCopyDataFromDMA();
 }
 
+/* DMA has taken the whole response, the buffer could be reused. */
+static void tsTxIRQEndHandler(UARTDriver *uartp) {
+	UNUSED(uartp);
+	chSysLockFromISR();
+	chBSemSignalI(&tsUartDma.txSemaphore);
+	chSysUnlockFromISR();
+}
+
 /* Note: This structure is modified from the default ChibiOS layout! */
 static UARTConfig tsDmaUartConfig = { 
-	.txend1_cb = NULL, .txend2_cb = NULL, .rxend_cb = NULL, .rxchar_cb = NULL, .rxerr_cb = NULL, 
+	.txend1_cb = tsTxIRQEndHandler, .txend2_cb = NULL, .rxend_cb = NULL, .rxchar_cb = NULL, .rxerr_cb = NULL, 
 	.speed = 0, .cr1 = 0, .cr2 = 0/*USART_CR2_STOP1_BITS*/ | USART_CR2_LINEN, .cr3 = 0,
 	.timeout_cb = tsRxIRQIdleHandler, .rxhalf_cb = tsRxIRQHalfHandler
 };
@@ -109,6 +117,8 @@ void startTsPort(ts_channel_s *tsChannel) {
 					print("Using UART-DMA mode");
 					// init FIFO queue
 					iqObjectInit(&tsUartDma.fifoRxQueue, tsUartDma.buffer, sizeof(tsUartDma.buffer), NULL, NULL);
+					tsUartDma.txIndex = 0;
+					chBSemObjectInit(&tsUartDma.txSemaphore, false);
 
 					// start DMA driver
 					tsDmaUartConfig.speed = CONFIGB(tunerStudioSerialSpeed);
@@ -167,7 +177,14 @@ void sr5WriteData(ts_channel_s *tsChannel, const uint8_t * buffer, int size) {
 			logMsg("chSequentialStreamWrite [%d]\r\n", size);
 #endif
 
-#if (TS_UART_DMA_MODE || TS_UART_MODE) && EFI_PROD_CODE
+#if TS_UART_DMA_MODE && EFI_PROD_CODE
+	UNUSED(tsChannel);
+	int transferred = size;
+	// previous response could still be transmitting in background
+	chBSemWaitTimeout(&tsUartDma.txSemaphore, BINARY_IO_TIMEOUT);
+	uartSendTimeout(TS_UART_DEVICE, (size_t *)&transferred, buffer, BINARY_IO_TIMEOUT);
+	chBSemSignal(&tsUartDma.txSemaphore);
+#elif TS_UART_MODE && EFI_PROD_CODE
 	UNUSED(tsChannel);
 	int transferred = size;
 	uartSendTimeout(TS_UART_DEVICE, (size_t *)&transferred, buffer, BINARY_IO_TIMEOUT);
@@ -220,11 +237,71 @@ int sr5ReadData(ts_channel_s *tsChannel, uint8_t * buffer, int size) {
 	return sr5ReadDataTimeout(tsChannel, buffer, size, SR5_READ_TIMEOUT);
 }
 
+// small enough to keep up with the wire, large enough not to wake up for each byte
+#define TS_CRC_READ_CHUNK 16
+
+/**
+ * Reads packet body in small chunks and updates CRC while the rest of the packet is still arriving,
+ * so that there is nothing left to calculate once the last byte is here
+ */
+int sr5ReadDataCrc(ts_channel_s *tsChannel, uint8_t * buffer, int size, uint32_t *crc) {
+	int received = 0;
+	while (received < size) {
+		int chunkSize = minI(size - received, TS_CRC_READ_CHUNK);
+		int chunkReceived = sr5ReadData(tsChannel, buffer + received, chunkSize);
+		*crc = crc32inc(buffer + received, *crc, chunkReceived);
+		received += chunkReceived;
+		if (chunkReceived != chunkSize) {
+			break;
+		}
+	}
+	return received;
+}
+
+
+/**
+ * Size, response code, body and crc32 in one buffer of at least size + CRC_WRAPPING_SIZE bytes
+ * @return packet size
+ */
+int sr5AssembleCrcPacket(uint8_t *packet, const uint8_t responseCode, const void *buf, const uint16_t size) {
+	*(uint16_t *) packet = SWAP_UINT16(size + 1);
+	packet[2] = responseCode;
+	if (size > 0) {
+		memcpy(packet + 3, buf, size);
+	}
+	uint32_t crc = crc32inc(packet + 2, 0, size + 1);
+	*(uint32_t *) (packet + 3 + size) = SWAP_UINT32(crc);
+	return size + CRC_WRAPPING_SIZE;
+}
 
 /**
  * Adds size to the beginning of a packet and a crc32 at the end. Then send the packet.
  */
 void sr5WriteCrcPacket(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf, const uint16_t size) {
+#if TS_UART_DMA_MODE && EFI_PROD_CODE
+	if (size + CRC_WRAPPING_SIZE <= TS_TX_BUFFER_SIZE) {
+		/**
+		 * Whole packet is assembled in the spare buffer while previous response could still be
+		 * transmitting, DMA sends it in background and we are back to parsing next request
+		 */
+		uint8_t *packet = tsUartDma.txBuffer[tsUartDma.txIndex];
+		int packetSize = sr5AssembleCrcPacket(packet, responseCode, buf, size);
+
+		if (chBSemWaitTimeout(&tsUartDma.txSemaphore, BINARY_IO_TIMEOUT) != MSG_OK) {
+			scheduleMsg(&tsLogger, "TS transmission timeout");
+			uartStopSend(TS_UART_DEVICE);
+		}
+		uartStartSend(TS_UART_DEVICE, packetSize, packet);
+		tsUartDma.txIndex = 1 - tsUartDma.txIndex;
+		return;
+	}
+#elif EFI_SIMULATOR
+	if (size + CRC_WRAPPING_SIZE <= TS_TX_BUFFER_SIZE) {
+		// rusEfi console checks CRC of these, that covers packet assembly of TS_UART_DMA_MODE
+		sr5WriteData(tsChannel, tsChannel->txBuffer, sr5AssembleCrcPacket(tsChannel->txBuffer, responseCode, buf, size));
+		return;
+	}
+#endif /* TS_UART_DMA_MODE */
 	uint8_t *writeBuffer = tsChannel->writeBuffer;
 	uint8_t *crcBuffer = &tsChannel->writeBuffer[3];
 
@@ -19,6 +19,7 @@
 #define TS_RESPONSE_OK 0x00
 #define TS_RESPONSE_BURN_OK 0x04
 #define TS_RESPONSE_COMMAND_OK 0x07
+#define TS_RESPONSE_OUTPUT_FRAME 0x08 // unsolicited, see TS_OUTPUT_STREAM_COMMAND
 
 #define TS_RESPONSE_UNDERRUN 0x80
 #define TS_RESPONSE_CRC_FAILURE 0x82
@@ -28,6 +29,17 @@ typedef enum {
 	TS_CRC = 1
 } ts_response_format_e;
 
+#define CRC_VALUE_SIZE 4
+// todo: double-check this
+#define CRC_WRAPPING_SIZE (CRC_VALUE_SIZE + 3)
+
+// See uart_dma_s
+#define TS_FIFO_BUFFER_SIZE (BLOCKING_FACTOR + 30)
+// This must be a power of 2!
+#define TS_DMA_BUFFER_SIZE 32
+// Largest response which is sent as one assembled packet, see sr5WriteCrcPacket()
+#define TS_TX_BUFFER_SIZE (BLOCKING_FACTOR + CRC_WRAPPING_SIZE)
+
 typedef struct {
 	BaseChannel * channel;
 	uint8_t writeBuffer[7];	// size(2 bytes) + response(1 byte) + crc32 (4 bytes)
@@ -35,13 +47,12 @@ typedef struct {
 	 * See 'blockingFactor' in rusefi.ini
 	 */
 	char crcReadBuffer[BLOCKING_FACTOR + 30];
+#if EFI_SIMULATOR
+	// simulator sends whole packets same way as TS_UART_DMA_MODE does
+	uint8_t txBuffer[TS_TX_BUFFER_SIZE];
+#endif /* EFI_SIMULATOR */
 } ts_channel_s;
 
-// See uart_dma_s
-#define TS_FIFO_BUFFER_SIZE (BLOCKING_FACTOR + 30)
-// This must be a power of 2!
-#define TS_DMA_BUFFER_SIZE 32
-
 // struct needed for async DMA transfer mode (see TS_UART_DMA_MODE)
 typedef struct {
 	// circular DMA buffer
@@ -52,6 +63,11 @@ typedef struct {
 	uint8_t buffer[TS_FIFO_BUFFER_SIZE];
 	// input FIFO Rx queue
 	input_queue_t fifoRxQueue;
+	// next response is assembled in one buffer while the other one could still be transmitting
+	uint8_t txBuffer[2][TS_TX_BUFFER_SIZE];
+	int txIndex;
+	// taken while a transmission is in progress
+	binary_semaphore_t txSemaphore;
 } uart_dma_s;
 
 // These commands are used exclusively by the rusEfi console
@@ -72,6 +88,8 @@ typedef struct {
 // High speed logger commands
 #define TS_SET_LOGGER_MODE   'l'
 #define TS_GET_LOGGER_BUFFER 'L'
+#define TS_GET_ENGINE_SNIFFER 'N' // binary engine sniffer chart, see engine_sniffer_header_s
+#define TS_OUTPUT_STREAM_COMMAND 'D' // push delta-encoded output channels every N ms, zero to stop
 
 #define TS_SINGLE_WRITE_COMMAND 'W' // 0x57 pageValueWrite
 #define TS_CHUNK_WRITE_COMMAND 'C' // 0x43 pageChunkWrite
@@ -80,10 +98,6 @@ typedef struct {
 
 #define TS_CRC_CHECK_COMMAND 'k' // 0x6B
 
-#define CRC_VALUE_SIZE 4
-// todo: double-check this
-#define CRC_WRAPPING_SIZE (CRC_VALUE_SIZE + 3)
-
 #if HAL_USE_SERIAL_USB
 #define CONSOLE_USB_DEVICE SDU1
 #endif /* HAL_USE_SERIAL_USB */
@@ -99,9 +113,11 @@ bool stopTsPort(ts_channel_s *tsChannel);
 
 void sr5WriteData(ts_channel_s *tsChannel, const uint8_t * buffer, int size);
 void sr5WriteCrcPacket(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf, const uint16_t size);
+int sr5AssembleCrcPacket(uint8_t *packet, const uint8_t responseCode, const void *buf, const uint16_t size);
 void sr5SendResponse(ts_channel_s *tsChannel, ts_response_format_e mode, const uint8_t * buffer, int size);
 int sr5ReadData(ts_channel_s *tsChannel, uint8_t * buffer, int size);
 int sr5ReadDataTimeout(ts_channel_s *tsChannel, uint8_t * buffer, int size, int timeout);
+int sr5ReadDataCrc(ts_channel_s *tsChannel, uint8_t * buffer, int size, uint32_t *crc);
 bool sr5IsReady(ts_channel_s *tsChannel);
 
 #endif /* CONSOLE_TUNERSTUDIO_TUNERSTUDIO_IO_H_ */
@@ -97,6 +97,14 @@ extern int icuWidthPeriodCounter;
 extern WaveChart waveChart;
 #endif /* EFI_ENGINE_SNIFFER */
 
+#if EFI_BINARY_FILE_LOGGING
+#include "binary_log.h"
+#endif /* EFI_BINARY_FILE_LOGGING */
+
+#if EFI_SCHEDULER_HISTOGRAMS
+#include "scheduler_histograms.h"
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
+
 // this 'true' value is needed for simulator
 static volatile bool fullLog = true;
 int warningEnabled = true;
@@ -129,11 +137,26 @@ static char FILE_LOGGER[1000] MAIN_RAM;
 static Logging fileLogger("file logger", FILE_LOGGER, sizeof(FILE_LOGGER));
 #endif /* EFI_FILE_LOGGING */
 
+#if EFI_BINARY_FILE_LOGGING
+extern BinaryLogRing binaryLogRing;
+static BinaryLogEncoder binaryLogEncoder(&binaryLogRing);
+/**
+ * while this is set sensor values go into binary record instead of text line
+ */
+static bool isBinaryLogLine = false;
+#endif /* EFI_BINARY_FILE_LOGGING */
+
 static int logFileLineIndex = 0;
 #define TAB "\t"
 
 static void reportSensorF(Logging *log, const char *caption, const char *units, float value,
 		int precision) {
+#if EFI_BINARY_FILE_LOGGING
+	if (isBinaryLogLine) {
+		binaryLogEncoder.addFloat(caption, units, value);
+		return;
+	}
+#endif /* EFI_BINARY_FILE_LOGGING */
 	bool isLogFileFormatting = true;
 
 	if (!isLogFileFormatting) {
@@ -158,6 +181,12 @@ static void reportSensorF(Logging *log, const char *caption, const char *units,
 }
 
 static void reportSensorI(Logging *log, const char *caption, const char *units, int value) {
+#if EFI_BINARY_FILE_LOGGING
+	if (isBinaryLogLine) {
+		binaryLogEncoder.addInt(caption, units, value);
+		return;
+	}
+#endif /* EFI_BINARY_FILE_LOGGING */
 #if EFI_FILE_LOGGING
 		if (logFileLineIndex == 0) {
 			append(log, caption);
@@ -357,6 +386,21 @@ void writeLogLine(void) {
 #if EFI_FILE_LOGGING
 	if (!main_loop_started)
 		return;
+#if EFI_BINARY_FILE_LOGGING
+	/**
+	 * No formatting and no SD card access here: record goes into RAM ring, SD card writer thread
+	 * takes it from there
+	 */
+	if (!isSdCardAlive()) {
+		// nothing would ever consume these records
+		return;
+	}
+	isBinaryLogLine = true;
+	binaryLogEncoder.beginRecord();
+	printSensors(&fileLogger);
+	binaryLogEncoder.endRecord();
+	isBinaryLogLine = false;
+#else
 	resetLogging(&fileLogger);
 	printSensors(&fileLogger);
 
@@ -365,6 +409,7 @@ void writeLogLine(void) {
 		appendToLog(fileLogger.buffer);
 		logFileLineIndex++;
 	}
+#endif /* EFI_BINARY_FILE_LOGGING */
 #endif /* EFI_FILE_LOGGING */
 }
 
@@ -931,6 +976,11 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->recentErrorCodes[i] = engine->engineState.warnings.recentWarnings.get(i);
 	}
 
+#if EFI_SCHEDULER_HISTOGRAMS
+	static_assert(SCHEDULER_HISTOGRAM_SLOTS == 8, "see schedulerLatenessUs");
+	getSchedulerHistogramsSummary(&schedulerHistograms, tsOutputChannels->schedulerLatenessUs, tsOutputChannels->schedulerDurationUs);
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
+
 	tsOutputChannels->knockNowIndicator = engine->knockCount > 0;
 	tsOutputChannels->knockEverIndicator = engine->knockEver;
 
@@ -1,6 +1,13 @@
 /*
  * @file tooth_logger.cpp
  *
+ * Composite logger: every edge of primary, secondary and cam inputs with a full microsecond timestamp.
+ *
+ * Entries go into one of two buffer halves. Writers only reserve an entry with an atomic increment,
+ * so trigger and cam interrupts never wait for each other or for TS. Once a half is full it is
+ * handed over to TS and writers move to the other half. If TS has not picked up the previous half
+ * by then, entries are dropped and counted rather than silently overwritten.
+ *
  * @date Jul 7, 2019
  * @author Matthew Kennedy
  */
@@ -12,73 +19,187 @@
 #if EFI_TOOTH_LOGGER
 
 #include <cstddef>
+#include "os_access.h"
 #include "efitime.h"
 #include "efilib.h"
-#include "tunerstudio_configuration.h"
+#include "engine.h"
 
-extern TunerStudioOutputChannels tsOutputChannels;
+EXTERN_ENGINE;
 
-static uint16_t buffer[1000] CCM_OPTIONAL;
-static size_t NextIdx = 0;
+#if EFI_TUNER_STUDIO
+#include "tunerstudio_configuration.h"
+extern TunerStudioOutputChannels tsOutputChannels;
+#endif /* EFI_TUNER_STUDIO */
+
+struct ToothLoggerHalf
+{
+	composite_logger_s entries[COMPOSITE_LOGGER_SIZE];
+	// number of entries handed out to writers
+	volatile uint32_t reserved;
+	// number of entries completely written
+	volatile uint32_t committed;
+};
+
+static ToothLoggerHalf halves[2] CCM_OPTIONAL;
+static volatile int WriteHalf = 0;
+// half waiting for TS, -1 if none
+static volatile int ReadyHalf = -1;
 static volatile bool ToothLoggerEnabled = false;
+// levels of all channels as of the latest edge
+static volatile uint8_t CurrentLevels = 0;
+
+static volatile uint32_t DroppedCount = 0;
+static uint32_t BufferCount = 0;
+
+static void ResetHalf(ToothLoggerHalf* half) {
+	half->reserved = 0;
+	half->committed = 0;
+}
 
-static uint32_t lastEdgeTimestamp = 0;
+// Should be invoked with interrupts disabled
+static void SwitchHalves() {
+	// the other half is still waiting for TS
+	if (ReadyHalf != -1) return;
 
-void SetNextEntry(uint16_t entry) {
+	int fullHalf = WriteHalf;
+	ResetHalf(&halves[1 - fullHalf]);
+	WriteHalf = 1 - fullHalf;
+	ReadyHalf = fullHalf;
+	BufferCount++;
+
+#if EFI_TUNER_STUDIO
+	tsOutputChannels.toothLogReady = true;
+#endif /* EFI_TUNER_STUDIO */
+}
+
+static void LogEntry(uint8_t edgeFlags, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	uint8_t flags = CurrentLevels | edgeFlags;
+	if (ENGINE(triggerCentral.triggerState.shaft_is_synchronized)) {
+		flags |= COMPOSITE_SYNC;
+	}
+	uint32_t timestampUs = NT2US(timestamp);
+
+	ToothLoggerHalf* half = &halves[WriteHalf];
+	uint32_t index = __sync_fetch_and_add(&half->reserved, 1);
+	if (index >= COMPOSITE_LOGGER_SIZE) {
+		__sync_fetch_and_add(&DroppedCount, 1);
+		return;
+	}
+
+	composite_logger_s* entry = &half->entries[index];
+	entry->flags = flags;
 	// TS uses big endian, grumble
-	buffer[NextIdx] = SWAP_UINT16(entry);
-	NextIdx++;
+	entry->timestamp = SWAP_UINT32(timestampUs);
+	__sync_fetch_and_add(&half->committed, 1);
+
+	if (index + 1 == COMPOSITE_LOGGER_SIZE) {
+		bool alreadyLocked = lockAnyContext();
+		SwitchHalves();
+		if (!alreadyLocked) {
+			unlockAnyContext();
+		}
+	}
+}
 
-	// If we hit the end, loop
-	if (NextIdx >= sizeof(buffer) / sizeof(buffer[0])) {
-		NextIdx = 0;
+static void SetLevel(uint8_t levelFlag, bool isHigh) {
+	if (isHigh) {
+		CurrentLevels |= levelFlag;
+	} else {
+		CurrentLevels &= ~levelFlag;
 	}
 }
 
-void LogTriggerTooth(trigger_event_e tooth) {
+void LogTriggerTooth(trigger_event_e tooth, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	// bail if we aren't enabled
 	if (!ToothLoggerEnabled) return;
 
-	// We currently only support the primary trigger falling edge
-	// (this is the edge that VR sensors are accurate on)
-	// Since VR senors are the most useful case here, this is okay for now.
-	if (tooth != SHAFT_PRIMARY_FALLING) return;
+	switch (tooth) {
+	case SHAFT_PRIMARY_RISING:
+	case SHAFT_PRIMARY_FALLING:
+		SetLevel(COMPOSITE_PRIMARY_LEVEL, tooth == SHAFT_PRIMARY_RISING);
+		LogEntry(COMPOSITE_TRIGGER, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
+		break;
+	case SHAFT_SECONDARY_RISING:
+	case SHAFT_SECONDARY_FALLING:
+		SetLevel(COMPOSITE_SECONDARY_LEVEL, tooth == SHAFT_SECONDARY_RISING);
+		LogEntry(0, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
+		break;
+	default:
+		// third channel is not shown by TS
+		break;
+	}
+}
 
-	uint32_t nowUs = NT2US(getTimeNowNt());
-	// 10us per LSB - this gives plenty of accuracy, yet fits 655.35 ms in to a uint16
-	uint16_t delta = static_cast<uint16_t>((nowUs - lastEdgeTimestamp) / 10);
-	lastEdgeTimestamp = nowUs;
+void LogCamTooth(bool isRising, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!ToothLoggerEnabled) return;
 
-	SetNextEntry(delta);
+	SetLevel(COMPOSITE_CAM_LEVEL, isRising);
+	LogEntry(COMPOSITE_CAM, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
 }
 
 void EnableToothLogger() {
-	// Clear the buffer
-	memset(buffer, 0, sizeof(buffer));
+	bool alreadyLocked = lockAnyContext();
 
-	// Reset the last edge to now - this prevents the first edge logged from being bogus
-	lastEdgeTimestamp = NT2US(getTimeNowNt());
+	// Clear the buffer
+	memset(halves, 0, sizeof(halves));
 
-	// Reset write index
-	NextIdx = 0;
+	WriteHalf = 0;
+	ReadyHalf = -1;
+	CurrentLevels = 0;
+	DroppedCount = 0;
+	BufferCount = 0;
 
 	// Enable logging of edges as they come
 	ToothLoggerEnabled = true;
 
-	// Tell TS that we're ready for it to read out the log
-	// nb: this is a lie, as we may not have written anything
-	// yet.  However, we can let it continuously read out the buffer
-	// as we update it, which looks pretty nice.
-	tsOutputChannels.toothLogReady = true;
+#if EFI_TUNER_STUDIO
+	// TS is told that there is something to read once the first half is full
+	tsOutputChannels.toothLogReady = false;
+#endif /* EFI_TUNER_STUDIO */
+
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
 }
 
 void DisableToothLogger() {
 	ToothLoggerEnabled = false;
+#if EFI_TUNER_STUDIO
 	tsOutputChannels.toothLogReady = false;
+#endif /* EFI_TUNER_STUDIO */
 }
 
 ToothLoggerBuffer GetToothLoggerBuffer() {
-	return { reinterpret_cast<uint8_t*>(buffer), sizeof(buffer) };
+	int half = ReadyHalf;
+	// a writer could still be finishing an entry which it has reserved before the switch
+	if (half == -1 || halves[half].committed < COMPOSITE_LOGGER_SIZE) {
+		return { nullptr, 0, -1 };
+	}
+	return { reinterpret_cast<uint8_t*>(halves[half].entries), sizeof(halves[half].entries), half };
+}
+
+void ReleaseToothLoggerBuffer(const ToothLoggerBuffer& buffer) {
+	// a half which got ready after GetToothLoggerBuffer() has not been sent yet
+	if (buffer.Half == -1) return;
+
+	bool alreadyLocked = lockAnyContext();
+	if (ReadyHalf == buffer.Half) {
+		ReadyHalf = -1;
+#if EFI_TUNER_STUDIO
+		tsOutputChannels.toothLogReady = false;
+#endif /* EFI_TUNER_STUDIO */
+		// writers could have filled the other half while TS was busy
+		if (halves[WriteHalf].reserved >= COMPOSITE_LOGGER_SIZE) {
+			SwitchHalves();
+		}
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+ToothLoggerStats GetToothLoggerStats() {
+	return { ToothLoggerEnabled, DroppedCount, BufferCount };
 }
 
 #endif /* EFI_TOOTH_LOGGER */
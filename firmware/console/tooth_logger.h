@@ -9,7 +9,28 @@
 
 #include <cstdint>
 #include <cstddef>
-#include "rusefi_enums.h"
+#include "global.h"
+#include "globalaccess.h"
+
+// Bits of composite_logger_s.flags, see compositeLogger in rusefi.input
+#define COMPOSITE_PRIMARY_LEVEL 0x01
+#define COMPOSITE_SECONDARY_LEVEL 0x02
+// set for primary channel edges, clear for secondary and cam edges
+#define COMPOSITE_TRIGGER 0x04
+#define COMPOSITE_SYNC 0x08
+#define COMPOSITE_CAM_LEVEL 0x10
+#define COMPOSITE_CAM 0x20
+
+// Entries per buffer half. TS reads one half while the other one fills.
+#define COMPOSITE_LOGGER_SIZE 500
+
+struct __attribute__ ((packed)) composite_logger_s
+{
+	// levels of all channels right after this edge and which edge it was
+	uint8_t flags;
+	// microseconds, big endian as TS wants it. Wraps after ~71 minutes.
+	uint32_t timestamp;
+};
 
 // Enable the tooth logger - this clears the buffer starts logging
 void EnableToothLogger();
@@ -18,13 +39,35 @@ void EnableToothLogger();
 void DisableToothLogger();
 
 // A new tooth has arrived! Log to the buffer if enabled.
-void LogTriggerTooth(trigger_event_e tooth);
+// timestamp is the time the edge was captured at, processing could happen later
+void LogTriggerTooth(trigger_event_e tooth, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
+
+// VVT cam edge
+void LogCamTooth(bool isRising, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
 
 struct ToothLoggerBuffer
 {
 	const uint8_t* const Buffer;
 	const size_t Length;
+	// which half this is, -1 if empty
+	const int Half;
 };
 
-// Get a reference to the buffer
+// Get a reference to the completely filled buffer half, empty if there is none yet.
+// The half is not touched by the logger until ReleaseToothLoggerBuffer()
 ToothLoggerBuffer GetToothLoggerBuffer();
+
+// Buffer half returned by GetToothLoggerBuffer() has been sent, it could be filled again.
+// Nothing happens for an empty buffer, even if some half got ready in the meantime.
+void ReleaseToothLoggerBuffer(const ToothLoggerBuffer& buffer);
+
+struct ToothLoggerStats
+{
+	bool Enabled;
+	// entries which did not fit because TS has not read the previous half yet
+	uint32_t DroppedCount;
+	// number of completely filled halves
+	uint32_t BufferCount;
+};
+
+ToothLoggerStats GetToothLoggerStats();
@@ -126,6 +126,11 @@ public:
 			brain_pin_e pinDir2) {
 		dcMotor.SetType(useTwoWires ? TwoPinDcMotor::ControlType::PwmDirectionPins : TwoPinDcMotor::ControlType::PwmEnablePin);
 
+		// timer channels of previous start are given back before pins are initialized again
+		releaseHardwarePwm(&m_pwmEnable);
+		releaseHardwarePwm(&m_pwmDir1);
+		releaseHardwarePwm(&m_pwmDir2);
+
 		m_pinEnable.initPin("ETB Enable", pinEnable);
 		m_pinDir1.initPin("ETB Dir 1", pinDir1);
 		m_pinDir2.initPin("ETB Dir 2", pinDir2);
@@ -133,22 +138,26 @@ public:
 		// Clamp to >100hz
 		int freq = maxI(100, engineConfiguration->etbFreq);
 
-		startSimplePwm(&m_pwmEnable, "ETB Enable",
+		// pins with a spare timer channel get hardware PWM, see EFI_HARDWARE_PWM
+		startSimplePwmHard(&m_pwmEnable, "ETB Enable",
 				&engine->executor,
+				pinEnable,
 				&m_pinEnable,
 				freq,
 				0,
 				(pwm_gen_callback*)applyPinState);
 
-		startSimplePwm(&m_pwmDir1, "ETB Dir 1",
+		startSimplePwmHard(&m_pwmDir1, "ETB Dir 1",
 				&engine->executor,
+				pinDir1,
 				&m_pinDir1,
 				freq,
 				0,
 				(pwm_gen_callback*)applyPinState);
 
-		startSimplePwm(&m_pwmDir2, "ETB Dir 2",
+		startSimplePwmHard(&m_pwmDir2, "ETB Dir 2",
 				&engine->executor,
+				pinDir2,
 				&m_pinDir2,
 				freq,
 				0,
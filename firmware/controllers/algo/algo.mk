@@ -14,5 +14,6 @@ CONTROLLERS_ALGO_SRC_CPP = $(PROJECT_DIR)/controllers/algo/advance_map.cpp \
 	$(PROJECT_DIR)/controllers/algo/engine2.cpp \
 	$(PROJECT_DIR)/controllers/algo/lcd_menu_tree.cpp \
 	$(PROJECT_DIR)/controllers/algo/event_registry.cpp \
+	$(PROJECT_DIR)/controllers/algo/output_schedule.cpp \
 	$(PROJECT_DIR)/controllers/algo/algo.cpp \
 	
@@ -269,6 +269,7 @@ void Engine::watchdog() {
 	}
 	isSpinning = false;
 	ignitionEvents.isReady = false;
+	outputSchedule.invalidate();
 #if EFI_PROD_CODE || EFI_SIMULATOR
 	scheduleMsg(&engineLogger, "engine has STOPPED");
 	scheduleMsg(&engineLogger, "templog engine has STOPPED [%x][%x] [%x][%x] %d",
@@ -337,6 +338,10 @@ operation_mode_e Engine::getOperationMode(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
  * so that trigger event handler/IO scheduler tasks are faster.
  */
 void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	/**
+	 * all the tables evaluated below share axis lookups, see AxisIndexCache
+	 */
+	axisIndexCache.beginCycle();
 
 #if EFI_MAP_AVERAGING
 	refreshMapAveragingPreCalc(PASS_ENGINE_PARAMETER_SIGNATURE);
@@ -353,6 +358,11 @@ void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	ENGINE(injectionDuration) = getInjectionDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	engine->m.fuelCalcTime = getTimeNowLowerNt() - engine->m.beforeFuelCalc;
 
+#if EFI_OUTPUT_SCHEDULE_BUFFER
+	outputSchedule.update(PASS_ENGINE_PARAMETER_SIGNATURE);
+#endif /* EFI_OUTPUT_SCHEDULE_BUFFER */
+	axisIndexCache.endCycle();
+
 }
 
 void doScheduleStopEngine(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
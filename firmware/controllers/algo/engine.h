@@ -17,6 +17,7 @@
 #include "accel_enrichment.h"
 #include "trigger_central.h"
 #include "local_version_holder.h"
+#include "output_schedule.h"
 
 #if EFI_SIGNAL_EXECUTOR_ONE_TIMER
 // PROD real firmware uses this implementation
@@ -45,6 +46,10 @@ public:
 	bool addFuelEventsForCylinder(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX);
 
 	InjectionEvent elements[MAX_INJECTION_OUTPUT_COUNT];
+	/**
+	 * by injectionStart
+	 */
+	TriggerEventDispatchTable dispatch;
 	bool isReady;
 
 private:
@@ -112,6 +117,10 @@ public:
 #if EFI_ENGINE_CONTROL
 	FuelSchedule injectionEvents;
 #endif /* EFI_ENGINE_CONTROL */
+	/**
+	 * pre-calculated positions used by both injectionEvents and ignitionEvents
+	 */
+	OutputScheduleBuffer outputSchedule;
 
 	WallFuel wallFuel;
 	bool needToStopEngine(efitick_t nowNt) const;
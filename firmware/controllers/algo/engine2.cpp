@@ -108,6 +108,9 @@ TransmissionState::TransmissionState() {
 
 EngineState::EngineState() {
 	timeSinceLastTChargeK = getTimeNowNt();
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		mapPerCylinder[i] = NAN;
+	}
 }
 
 void EngineState::updateSlowSensors(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
@@ -12,6 +12,8 @@
 #include "engine_configuration_generated_structures.h"
 #include "cyclic_buffer.h"
 #include "thermistor.h"
+#include "sensor_curve.h"
+#include "local_version_holder.h"
 
 #define MOCK_ADC_SIZE 16
 
@@ -30,10 +32,22 @@ public:
 	void setConfig(thermistor_conf_s *config);
 	void prepareThermistorCurve(thermistor_conf_s *tc);
 	float getKelvinTemperatureByResistance(float resistance) const;
+	/**
+	 * Exact Steinhart-Hart conversion, see 'curve' for the fast one
+	 */
+	float getTemperatureByVoltage(float voltage) const;
 	float s_h_a = 0;
 	float s_h_b = 0;
 	float s_h_c = 0;
 	bool isLinear;
+	/**
+	 * Celsius by board voltage, rebuilt by setConfig() when thermistor settings change
+	 */
+	SensorCurve curve;
+	/**
+	 * settings are only compared when global configuration version changes
+	 */
+	LocalVersionHolder configVersion;
 private:
 	thermistor_conf_s currentConfig = {};
 };
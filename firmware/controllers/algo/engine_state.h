@@ -54,6 +54,11 @@ public:
 	 */
 	angle_t mapAveragingStart[INJECTION_PIN_COUNT];
 	angle_t mapAveragingDuration = 0;
+	/**
+	 * MAP averaged within the last sampling window of each cylinder, in kPa, NAN if unknown.
+	 * Indexed same as mapAveragingStart, that is by position in firing order.
+	 */
+	float mapPerCylinder[INJECTION_PIN_COUNT];
 
 	angle_t timingAdvance = 0;
 	// spark-related
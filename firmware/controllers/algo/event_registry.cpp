@@ -50,6 +50,31 @@ IgnitionOutputPin * IgnitionEvent::getOutputForLoggins() {
 	return outputs[0];
 }
 
+/**
+ * All events start at trigger index zero, same as event_trigger_position_s
+ */
+TriggerEventDispatchTable::TriggerEventDispatchTable() {
+	memset(eventsByTriggerIndex, 0, sizeof(eventsByTriggerIndex));
+	memset(triggerIndexByEvent, 0, sizeof(triggerIndexByEvent));
+	eventsByTriggerIndex[0] = (event_mask_t) -1;
+}
+
+void TriggerEventDispatchTable::setEventIndex(int eventId, uint32_t triggerEventIndex) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, eventId >= 0 && eventId < MAX_DISPATCH_EVENT_COUNT, "dispatch eventId");
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, triggerEventIndex < PWM_PHASE_MAX_COUNT, "dispatch triggerEventIndex");
+	event_mask_t bit = 1 << eventId;
+	eventsByTriggerIndex[triggerIndexByEvent[eventId]] &= ~bit;
+	eventsByTriggerIndex[triggerEventIndex] |= bit;
+	triggerIndexByEvent[eventId] = triggerEventIndex;
+}
+
+event_mask_t TriggerEventDispatchTable::getEvents(uint32_t triggerEventIndex) const {
+	if (triggerEventIndex >= PWM_PHASE_MAX_COUNT) {
+		return 0;
+	}
+	return eventsByTriggerIndex[triggerEventIndex];
+}
+
 
 //void registerActuatorEventWhat(InjectionEventList *list, int eventIndex, OutputSignal *actuator, float angleOffset) {
 //	ActuatorEvent *e = list->getNextActuatorEvent();
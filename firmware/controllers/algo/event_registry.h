@@ -63,10 +63,46 @@ public:
 
 #define MAX_IGNITION_EVENT_COUNT IGNITION_PIN_COUNT
 
+/**
+ * One bit per event, bit index is the index of the event within its list
+ */
+typedef uint16_t event_mask_t;
+
+#define MAX_DISPATCH_EVENT_COUNT 16
+
+/**
+ * mask of events which belong to currently configured cylinders
+ */
+#define CYLINDERS_MASK() ((event_mask_t) ((1 << CONFIG(specs.cylindersCount)) - 1))
+
+/**
+ * For each trigger event index within engine cycle this table knows which events are due on that tooth.
+ *
+ * Table mirrors event_trigger_position_s#eventIndex of all the events in a list and has to be updated each time
+ * findTriggerPosition() changes position of an event. This way per-tooth handlers do not need to iterate
+ * over all the events - most teeth of 60-2 or 36-1 wheel have nothing to do.
+ */
+class TriggerEventDispatchTable {
+public:
+	TriggerEventDispatchTable();
+	/**
+	 * O(1)
+	 */
+	void setEventIndex(int eventId, uint32_t triggerEventIndex);
+	event_mask_t getEvents(uint32_t triggerEventIndex) const;
+private:
+	event_mask_t eventsByTriggerIndex[PWM_PHASE_MAX_COUNT];
+	uint16_t triggerIndexByEvent[MAX_DISPATCH_EVENT_COUNT];
+};
+
 class IgnitionEventList {
 public:
 	IgnitionEventList();
 	IgnitionEvent elements[MAX_IGNITION_EVENT_COUNT];
+	/**
+	 * by dwellPosition
+	 */
+	TriggerEventDispatchTable dwellDispatch;
 	bool isReady;
 };
 
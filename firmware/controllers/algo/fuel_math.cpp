@@ -237,6 +237,10 @@ void initFuelMap(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 #endif /* (IGN_LOAD_COUNT == FUEL_LOAD_COUNT) && (IGN_RPM_COUNT == FUEL_RPM_COUNT) */
 }
 
+// protects against one bad MAP window
+#define CYLINDER_MAP_CORRECTION_MIN 0.7
+#define CYLINDER_MAP_CORRECTION_MAX 1.3
+
 /**
  * @brief Engine warm-up fuel correction.
  */
@@ -258,6 +262,30 @@ float getIatFuelCorrection(float iat DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	return interpolate2d("iatc", iat, config->iatFuelCorrBins, config->iatFuelCorr);
 }
 
+/**
+ * Speed density fuel is proportional to MAP, so each cylinder gets the ratio of its own
+ * windowed MAP to the average of all cylinders. Useful on ITB engines where runners do not share
+ * a plenum.
+ * @return 1 unless every cylinder has a MAP value of its own
+ */
+float getCylinderMapFuelCorrection(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (CONFIG(fuelAlgorithm) != LM_SPEED_DENSITY || CONFIG(injectionMode) != IM_SEQUENTIAL
+			|| CONFIGB(measureMapOnlyInOneCylinder)) {
+		return 1;
+	}
+	int cylindersCount = CONFIG(specs.cylindersCount);
+	float sum = 0;
+	for (int i = 0; i < cylindersCount; i++) {
+		float map = ENGINE(engineState.mapPerCylinder[i]);
+		if (cisnan(map) || map <= 0) {
+			return 1;
+		}
+		sum += map;
+	}
+	float correction = ENGINE(engineState.mapPerCylinder[cylinderIndex]) * cylindersCount / sum;
+	return maxF(minF(correction, CYLINDER_MAP_CORRECTION_MAX), CYLINDER_MAP_CORRECTION_MIN);
+}
+
 /**
  * @brief	Called from EngineState::periodicFastCallback to update the state.
  * @note The returned value is float, not boolean - to implement taper (smoothed correction).
@@ -32,6 +32,7 @@ float getIatFuelCorrection(float iat DECLARE_ENGINE_PARAMETER_SUFFIX);
 floatms_t getInjectorLag(float vBatt DECLARE_ENGINE_PARAMETER_SUFFIX);
 float getCltFuelCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 float getFuelCutOffCorrection(efitick_t nowNt, int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
+float getCylinderMapFuelCorrection(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX);
 angle_t getCltTimingCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 floatms_t getCrankingFuel(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 floatms_t getCrankingFuel3(float coolantTemperature, uint32_t revolutionCounterSinceStart DECLARE_ENGINE_PARAMETER_SUFFIX);
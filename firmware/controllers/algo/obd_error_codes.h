@@ -2074,6 +2074,7 @@ typedef enum {
 	CUSTOM_ERR_PIN_COUNT_TOO_LARGE = 6709,
 	CUSTOM_DUTY_INVALID = 6710,
 	CUSTOM_DUTY_TOO_HIGH = 6711,
+	CUSTOM_ERR_EVENT_QUEUE_OVERFLOW = 6712,
 
 
 	CUSTOM_ERR_TRIGGER_SYNC = 9000,
@@ -0,0 +1,170 @@
+/**
+ * @file output_schedule.cpp
+ * Double-buffered trigger positions of fuel and spark events
+ *
+ * FuelSchedule::addFuelEventsForCylinder() and prepareCylinderIgnitionSchedule() are invoked from trigger
+ * and scheduler interrupts, with a ready buffer these only copy pre-calculated positions.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "output_schedule.h"
+#include "engine_math.h"
+#include "spark_logic.h"
+
+EXTERN_ENGINE;
+
+output_schedule_s::output_schedule_s() {
+	isInjectionReady = false;
+	isIgnitionReady = false;
+	cylindersCount = 0;
+	injectionStartAngle = NAN;
+	timingAdvance = NAN;
+	dwellAngle = NAN;
+	memset(advance, 0, sizeof(advance));
+}
+
+OutputScheduleBuffer::OutputScheduleBuffer() {
+	activeIndex = 0;
+	isPending = false;
+	isUpdating = false;
+	invalidationCounter = 0;
+	injectionUpdateCounter = 0;
+	ignitionUpdateCounter = 0;
+	switchCounter = 0;
+}
+
+const output_schedule_s *OutputScheduleBuffer::getActive() const {
+	return &buffers[activeIndex];
+}
+
+void OutputScheduleBuffer::onEngineCycleStart() {
+	if (!isPending) {
+		return;
+	}
+	activeIndex = 1 - activeIndex;
+	isPending = false;
+	switchCounter++;
+}
+
+void OutputScheduleBuffer::invalidate() {
+	invalidationCounter++;
+	isPending = false;
+	buffers[activeIndex].isInjectionReady = false;
+	buffers[activeIndex].isIgnitionReady = false;
+}
+
+#if EFI_ENGINE_CONTROL
+
+void OutputScheduleBuffer::updateInjection(output_schedule_s *next DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	injectionUpdateCounter++;
+	next->isInjectionReady = false;
+	if (TRIGGER_SHAPE(getSize()) < 1) {
+		return;
+	}
+	for (int i = 0; i < next->cylindersCount; i++) {
+		angle_t angle = getInjectionStartAngle(i PASS_ENGINE_PARAMETER_SUFFIX);
+		if (cisnan(angle)) {
+			return;
+		}
+		assertAngleRange(angle, "findAngle#a33", CUSTOM_ERR_6544);
+		TRIGGER_SHAPE(findTriggerPosition(&next->injectionStart[i], angle PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	}
+	next->isInjectionReady = true;
+}
+
+void OutputScheduleBuffer::updateIgnition(output_schedule_s *next DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	ignitionUpdateCounter++;
+	next->isIgnitionReady = false;
+	if (TRIGGER_SHAPE(getSize()) < 1) {
+		return;
+	}
+	for (int i = 0; i < next->cylindersCount; i++) {
+		angle_t localAdvance = getCylinderIgnitionAdvance(i PASS_ENGINE_PARAMETER_SUFFIX);
+		if (cisnan(localAdvance)) {
+			return;
+		}
+		next->advance[i] = localAdvance;
+		angle_t a = localAdvance - next->dwellAngle;
+		assertAngleRange(a, "findAngle#a6", CUSTOM_ERR_6550);
+		TRIGGER_SHAPE(findTriggerPosition(&next->dwellPosition[i], a PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	}
+	next->isIgnitionReady = true;
+}
+
+static bool isAngleChanged(angle_t value, angle_t previous, angle_t tolerance) {
+	return absF(value - previous) >= tolerance;
+}
+
+#endif /* EFI_ENGINE_CONTROL */
+
+void OutputScheduleBuffer::update(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+#if EFI_ENGINE_CONTROL
+#if !EFI_UNIT_TEST
+	bool alreadyLocked = lockAnyContext();
+#endif /* EFI_UNIT_TEST */
+	/**
+	 * periodicFastCallback() is sometimes invoked from trigger callback, we do not want to touch the buffer
+	 * which is being written by the thread nor the buffer which is pending
+	 */
+	bool canUpdate = !isPending && !isUpdating;
+	if (canUpdate) {
+		isUpdating = true;
+	}
+	uint32_t invalidationCounterAtStart = invalidationCounter;
+#if !EFI_UNIT_TEST
+	if (!alreadyLocked)
+		unlockAnyContext();
+#endif /* EFI_UNIT_TEST */
+	if (!canUpdate) {
+		return;
+	}
+
+	output_schedule_s *next = &buffers[1 - activeIndex];
+	*next = buffers[activeIndex];
+
+	int cylindersCount = CONFIG(specs.cylindersCount);
+	bool isFullUpdate = configVersion.isOld(engine->getGlobalConfigurationVersion()) || next->cylindersCount != cylindersCount;
+	next->cylindersCount = cylindersCount;
+	bool isChanged = false;
+
+	// all cylinders share the same base angle so this is enough to know if anything has changed
+	angle_t injectionStartAngle = getInjectionStartAngle(0 PASS_ENGINE_PARAMETER_SUFFIX);
+	if (cisnan(injectionStartAngle)) {
+		isChanged |= next->isInjectionReady;
+		next->isInjectionReady = false;
+	} else if (isFullUpdate || !next->isInjectionReady || isAngleChanged(injectionStartAngle, next->injectionStartAngle, OUTPUT_SCHEDULE_INJECTION_TOLERANCE)) {
+		next->injectionStartAngle = injectionStartAngle;
+		updateInjection(next PASS_ENGINE_PARAMETER_SUFFIX);
+		isChanged = true;
+	}
+
+	angle_t timingAdvance = ENGINE(engineState.timingAdvance);
+	angle_t dwellAngle = ENGINE(engineState.dwellAngle);
+	if (cisnan(timingAdvance) || cisnan(dwellAngle)) {
+		isChanged |= next->isIgnitionReady;
+		next->isIgnitionReady = false;
+	} else if (isFullUpdate || !next->isIgnitionReady || isAngleChanged(timingAdvance, next->timingAdvance, OUTPUT_SCHEDULE_IGNITION_TOLERANCE)
+			|| isAngleChanged(dwellAngle, next->dwellAngle, OUTPUT_SCHEDULE_IGNITION_TOLERANCE)) {
+		next->timingAdvance = timingAdvance;
+		next->dwellAngle = dwellAngle;
+		updateIgnition(next PASS_ENGINE_PARAMETER_SUFFIX);
+		isChanged = true;
+	}
+
+#if !EFI_UNIT_TEST
+	alreadyLocked = lockAnyContext();
+#endif /* EFI_UNIT_TEST */
+	// invalidate() while we were busy means that we have used stale trigger shape or configuration
+	if (isChanged && invalidationCounterAtStart == invalidationCounter) {
+		isPending = true;
+	}
+	isUpdating = false;
+#if !EFI_UNIT_TEST
+	if (!alreadyLocked)
+		unlockAnyContext();
+#endif /* EFI_UNIT_TEST */
+#endif /* EFI_ENGINE_CONTROL */
+}
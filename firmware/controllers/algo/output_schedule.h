@@ -0,0 +1,98 @@
+/**
+ * @file output_schedule.h
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef OUTPUT_SCHEDULE_H_
+#define OUTPUT_SCHEDULE_H_
+
+#include "global.h"
+#include "trigger_structure.h"
+#include "local_version_holder.h"
+
+/**
+ * Input angle changes smaller than these do not cause a new version. Inputs are interpolated floats which
+ * are almost never exactly the same between two passes; the error is bounded by the tolerance since
+ * the comparison is against the inputs of the last calculated version.
+ */
+#ifndef OUTPUT_SCHEDULE_INJECTION_TOLERANCE
+#define OUTPUT_SCHEDULE_INJECTION_TOLERANCE 0.5
+#endif
+#ifndef OUTPUT_SCHEDULE_IGNITION_TOLERANCE
+#define OUTPUT_SCHEDULE_IGNITION_TOLERANCE 0.05
+#endif
+
+/**
+ * Trigger-relative positions of all fuel and spark events for one engine cycle, together with
+ * the inputs this version was calculated from
+ */
+class output_schedule_s {
+public:
+	output_schedule_s();
+	event_trigger_position_s injectionStart[INJECTION_PIN_COUNT];
+	event_trigger_position_s dwellPosition[IGNITION_PIN_COUNT];
+	angle_t advance[IGNITION_PIN_COUNT];
+	bool isInjectionReady;
+	bool isIgnitionReady;
+	int cylindersCount;
+	/**
+	 * injection inputs
+	 */
+	angle_t injectionStartAngle;
+	/**
+	 * ignition inputs
+	 */
+	angle_t timingAdvance;
+	angle_t dwellAngle;
+};
+
+/**
+ * Double-buffered output schedule.
+ *
+ * Heavy floating-point angle math and trigger position lookup are done by update() which is invoked from
+ * periodicFastCallback() thread. Trigger callback only switches to the new version at engine cycle boundary,
+ * see onEngineCycleStart(), so that trigger and scheduler interrupts never see a half-updated schedule.
+ *
+ * Only the part which depends on changed inputs is recalculated: injection phase change does not touch
+ * ignition positions and vice versa.
+ */
+class OutputScheduleBuffer {
+public:
+	OutputScheduleBuffer();
+	/**
+	 * Calculates next version if inputs have changed. Not re-entrant, invoked from one thread.
+	 */
+	void update(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+	/**
+	 * Invoked by trigger callback on trigger index zero, switches to new version if one is pending
+	 */
+	void onEngineCycleStart();
+	/**
+	 * Trigger shape change, engine stop or similar - current version should not be used anymore
+	 */
+	void invalidate();
+	const output_schedule_s *getActive() const;
+
+	uint32_t injectionUpdateCounter;
+	uint32_t ignitionUpdateCounter;
+	uint32_t switchCounter;
+private:
+	void updateInjection(output_schedule_s *next DECLARE_ENGINE_PARAMETER_SUFFIX);
+	void updateIgnition(output_schedule_s *next DECLARE_ENGINE_PARAMETER_SUFFIX);
+	output_schedule_s buffers[2];
+	volatile int activeIndex;
+	/**
+	 * true while the other buffer holds a complete version which trigger callback has not yet switched to
+	 */
+	volatile bool isPending;
+	volatile bool isUpdating;
+	/**
+	 * incremented by invalidate() so that update() which was interrupted by invalidate() would discard its result
+	 */
+	volatile uint32_t invalidationCounter;
+	LocalVersionHolder configVersion;
+};
+
+#endif /* OUTPUT_SCHEDULE_H_ */
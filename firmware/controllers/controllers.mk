@@ -16,12 +16,16 @@ CONTROLLERS_SRC_CPP = \
 	$(CONTROLLERS_DIR)/scheduling/single_timer_executor.cpp \
 	$(CONTROLLERS_DIR)/scheduling/pwm_generator_logic.cpp \
 	$(CONTROLLERS_DIR)/scheduling/event_queue.cpp \
+	$(CONTROLLERS_DIR)/scheduling/event_heap.cpp \
+	$(CONTROLLERS_DIR)/scheduling/scheduler_histograms.cpp \
 	$(PROJECT_DIR)/controllers/settings.cpp \
 	$(PROJECT_DIR)/controllers/core/error_handling.cpp \
 	$(PROJECT_DIR)/controllers/map_averaging.cpp \
 	$(PROJECT_DIR)/controllers/flash_main.cpp \
+	$(PROJECT_DIR)/controllers/flash_log.cpp \
 	$(PROJECT_DIR)/controllers/injector_central.cpp \
 	$(PROJECT_DIR)/controllers/obd2.cpp \
+	$(PROJECT_DIR)/controllers/obd2_server.cpp \
  	$(PROJECT_DIR)/controllers/engine_controller.cpp \
 	$(PROJECT_DIR)/controllers/persistent_store.cpp \
 	
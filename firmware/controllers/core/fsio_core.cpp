@@ -118,6 +118,42 @@ bool float2bool(float v) {
 	return v != 0;
 }
 
+static float getFsioSetting(float humanIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	int index = (int) humanIndex - 1;
+	if (index >= 0 && index < FSIO_COMMAND_COUNT) {
+		return CONFIGB(fsio_setting)[index];
+	}
+	return NAN;
+}
+
+static float getFsioTableValue(float i, float xValue, float yValue) {
+	int index = (int) i;
+	if (index < 1 || index > MAX_TABLE_INDEX) {
+		return NAN;
+	}
+	if (index == 1) {
+		return fsioTable1.getValue(xValue, yValue);
+	}
+	return fsio8t_tables[index]->getValue(xValue, yValue);
+}
+
+/**
+ * @return value of an action which does not take anything from the stack
+ */
+static float getInputValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	switch (action) {
+	case LE_METHOD_FSIO_DIGITAL_INPUT:
+		// todo: implement code for digital inout!!!
+	case LE_METHOD_FSIO_ANALOG_INPUT:
+		// todo: start taking index parameter!!!
+		return getVoltage("fsio", engineConfiguration->fsioAdc[0]);
+	case LE_METHOD_KNOCK:
+		return engine->knockCount;
+	default:
+		return getEngineValue(action PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+}
+
 float LECalculator::pop(le_action_e action) {
 	if (stack.size() == 0) {
 		warning(CUSTOM_EMPTY_FSIO_STACK, "empty stack for action=%d", action);
@@ -252,48 +288,21 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		break;
 	case LE_METHOD_FSIO_SETTING: {
 		float humanIndex = pop(LE_METHOD_FSIO_SETTING);
-		int index = (int) humanIndex - 1;
-		if (index >= 0 && index < FSIO_COMMAND_COUNT) {
-			push(element->action, CONFIGB(fsio_setting)[index]);
-		} else {
-			push(element->action, NAN);
-		}
+		push(element->action, getFsioSetting(humanIndex PASS_ENGINE_PARAMETER_SUFFIX));
 	}
 		break;
 	case LE_METHOD_FSIO_TABLE: {
 		float i = pop(LE_METHOD_FSIO_TABLE);
 		float yValue = pop(LE_METHOD_FSIO_TABLE);
 		float xValue = pop(LE_METHOD_FSIO_TABLE);
-		int index = (int) i;
-		if (index < 1 || index > MAX_TABLE_INDEX) {
-			push(element->action, NAN);
-		} else {
-			if (index == 1) {
-				fsio8_Map3D_f32t *t = &fsioTable1;
-
-				push(element->action, t->getValue(xValue, yValue));
-			} else {
-				fsio8_Map3D_u8t *t = fsio8t_tables[index];
-
-				push(element->action, t->getValue(xValue, yValue));
-			}
-		}
+		push(element->action, getFsioTableValue(i, xValue, yValue));
 	}
 		break;
-	case LE_METHOD_FSIO_DIGITAL_INPUT:
-		// todo: implement code for digital inout!!!
-	case LE_METHOD_FSIO_ANALOG_INPUT:
-		// todo: start taking index parameter!!!
-		push(element->action, getVoltage("fsio", engineConfiguration->fsioAdc[0]));
-		break;
-	case LE_METHOD_KNOCK:
-		push(element->action, engine->knockCount);
-		break;
 	case LE_UNDEFINED:
 		warning(CUSTOM_UNKNOWN_FSIO, "FSIO undefined action");
 		return true;
 	default:
-		push(element->action, getEngineValue(element->action PASS_ENGINE_PARAMETER_SUFFIX));
+		push(element->action, getInputValue(element->action PASS_ENGINE_PARAMETER_SUFFIX));
 	}
 	return false;
 }
@@ -339,6 +348,267 @@ float LECalculator::getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	return stack.pop();
 }
 
+FsioCodePool::FsioCodePool(fsio_instruction_s *pool, int size) {
+	this->pool = pool;
+	this->size = size;
+	reset();
+}
+
+void FsioCodePool::reset() {
+	index = 0;
+}
+
+int FsioCodePool::getSize() const {
+	return index;
+}
+
+/**
+ * @return number of stack values consumed by an operator, -1 if action only pushes a value
+ */
+static int getOperandCount(le_action_e action) {
+	switch (action) {
+	case LE_OPERATOR_NOT:
+	case LE_METHOD_FSIO_SETTING:
+		return 1;
+	case LE_OPERATOR_LESS:
+	case LE_OPERATOR_MORE:
+	case LE_OPERATOR_LESS_OR_EQUAL:
+	case LE_OPERATOR_MORE_OR_EQUAL:
+	case LE_OPERATOR_AND:
+	case LE_OPERATOR_OR:
+	case LE_OPERATOR_ADDITION:
+	case LE_OPERATOR_SUBTRACTION:
+	case LE_OPERATOR_MULTIPLICATION:
+	case LE_OPERATOR_DIVISION:
+	case LE_METHOD_MAX:
+	case LE_METHOD_MIN:
+		return 2;
+	case LE_METHOD_IF:
+	case LE_METHOD_FSIO_TABLE:
+		return 3;
+	default:
+		return -1;
+	}
+}
+
+/**
+ * Stack depth is verified by FsioProgram::compile() so there are no checks here.
+ * Same as in LECalculator, elements on stack are in reverse order.
+ */
+static float runCode(const fsio_instruction_s *code, int size, float selfValue, const float *inputs DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	float stack[MAX_STACK_DEPTH];
+	int sp = 0;
+	const fsio_instruction_s *end = code + size;
+	for (const fsio_instruction_s *i = code; i < end; i++) {
+		switch (i->action) {
+		case LE_NUMERIC_VALUE:
+			stack[sp++] = i->fValue;
+			break;
+		case LE_METHOD_SELF:
+			stack[sp++] = selfValue;
+			break;
+		case LE_OPERATOR_NOT:
+			stack[sp - 1] = !float2bool(stack[sp - 1]);
+			break;
+		case LE_OPERATOR_AND:
+			sp--;
+			stack[sp - 1] = float2bool(stack[sp]) && float2bool(stack[sp - 1]);
+			break;
+		case LE_OPERATOR_OR:
+			sp--;
+			stack[sp - 1] = float2bool(stack[sp]) || float2bool(stack[sp - 1]);
+			break;
+		case LE_OPERATOR_LESS:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] < stack[sp];
+			break;
+		case LE_OPERATOR_MORE:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] > stack[sp];
+			break;
+		case LE_OPERATOR_LESS_OR_EQUAL:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] <= stack[sp];
+			break;
+		case LE_OPERATOR_MORE_OR_EQUAL:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] >= stack[sp];
+			break;
+		case LE_OPERATOR_ADDITION:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] + stack[sp];
+			break;
+		case LE_OPERATOR_SUBTRACTION:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] - stack[sp];
+			break;
+		case LE_OPERATOR_MULTIPLICATION:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] * stack[sp];
+			break;
+		case LE_OPERATOR_DIVISION:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] / stack[sp];
+			break;
+		case LE_METHOD_MAX:
+			sp--;
+			stack[sp - 1] = maxF(stack[sp - 1], stack[sp]);
+			break;
+		case LE_METHOD_MIN:
+			sp--;
+			stack[sp - 1] = minF(stack[sp - 1], stack[sp]);
+			break;
+		case LE_METHOD_IF:
+			sp -= 2;
+			stack[sp - 1] = stack[sp - 1] != 0 ? stack[sp] : stack[sp + 1];
+			break;
+		case LE_METHOD_FSIO_SETTING:
+			stack[sp - 1] = getFsioSetting(stack[sp - 1] PASS_ENGINE_PARAMETER_SUFFIX);
+			break;
+		case LE_METHOD_FSIO_TABLE:
+			sp -= 2;
+			stack[sp - 1] = getFsioTableValue(stack[sp + 1], stack[sp - 1], stack[sp]);
+			break;
+		default:
+			stack[sp++] = inputs[i->iValue];
+		}
+	}
+	return stack[0];
+}
+
+FsioInputSnapshot::FsioInputSnapshot() {
+	readCounter = 0;
+	reset();
+}
+
+void FsioInputSnapshot::reset() {
+	validInputs = 0;
+}
+
+void FsioInputSnapshot::update(fsio_input_mask_t requiredInputs DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	fsio_input_mask_t missing = requiredInputs & ~validInputs;
+	while (missing != 0) {
+		int index = __builtin_ctz(missing);
+		missing &= missing - 1;
+		values[index] = getInputValue((le_action_e) (LE_METHOD_RPM + index) PASS_ENGINE_PARAMETER_SUFFIX);
+		readCounter++;
+	}
+	validInputs |= requiredInputs;
+}
+
+float FsioInputSnapshot::get(le_action_e action) const {
+	efiAssert(CUSTOM_ERR_ASSERT, IS_FSIO_INPUT(action), "fsio snapshot index", NAN);
+	return values[action - LE_METHOD_RPM];
+}
+
+FsioProgram::FsioProgram() {
+	reset();
+}
+
+void FsioProgram::reset() {
+	source = NULL;
+	code = NULL;
+	size = 0;
+	requiredInputs = 0;
+}
+
+bool FsioProgram::isCompiled() const {
+	return code != NULL;
+}
+
+int FsioProgram::getSize() const {
+	return size;
+}
+
+bool FsioProgram::compile(LEElement *element, FsioCodePool *pool DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	reset();
+	source = element;
+	fsio_instruction_s *start = &pool->pool[pool->index];
+	int capacity = pool->size - pool->index;
+	int count = 0;
+	int depth = 0;
+	/**
+	 * how many values on top of the stack are known at compile time
+	 */
+	int constantDepth = 0;
+
+	for (; element != NULL; element = element->next) {
+		le_action_e action = element->action;
+		if (action == LE_UNDEFINED) {
+			return false;
+		}
+		int operandCount = getOperandCount(action);
+		if (operandCount > depth) {
+			// LECalculator would report empty stack
+			return false;
+		}
+		fsio_instruction_s instruction;
+		instruction.action = action;
+		instruction.fValue = element->fValue;
+		instruction.iValue = 0;
+
+		if (operandCount == -1) {
+			if (action == LE_NUMERIC_VALUE) {
+				constantDepth++;
+			} else {
+				constantDepth = 0;
+				if (action != LE_METHOD_SELF) {
+					if (!IS_FSIO_INPUT(action)) {
+						// unknown action, LECalculator would report it
+						return false;
+					}
+					instruction.iValue = action - LE_METHOD_RPM;
+					requiredInputs |= FSIO_INPUT_BIT(action);
+				}
+			}
+			depth++;
+			if (depth > MAX_STACK_DEPTH) {
+				return false;
+			}
+		} else if (constantDepth >= operandCount && action != LE_METHOD_FSIO_SETTING && action != LE_METHOD_FSIO_TABLE) {
+			/**
+			 * all operands are constants which were just emitted, these are replaced with the result.
+			 * Settings and tables could be changed at runtime so only pure operators are folded.
+			 */
+			fsio_instruction_s folded[4];
+			count -= operandCount;
+			memcpy(folded, &start[count], operandCount * sizeof(fsio_instruction_s));
+			folded[operandCount] = instruction;
+			instruction.action = LE_NUMERIC_VALUE;
+			instruction.fValue = runCode(folded, operandCount + 1, NAN, NULL PASS_ENGINE_PARAMETER_SUFFIX);
+			depth -= operandCount - 1;
+			constantDepth -= operandCount - 1;
+		} else {
+			depth -= operandCount - 1;
+			constantDepth = 0;
+		}
+		if (count == capacity) {
+			return false;
+		}
+		start[count++] = instruction;
+	}
+	if (depth != 1) {
+		// LECalculator would report unexpected stack size
+		return false;
+	}
+	code = start;
+	size = count;
+	pool->index += count;
+	return true;
+}
+
+float FsioProgram::getValue(float selfValue, const FsioInputSnapshot *snapshot DECLARE_ENGINE_PARAMETER_SUFFIX) const {
+	efiAssert(CUSTOM_ERR_ASSERT, isCompiled(), "FSIO not compiled", NAN);
+	efiAssert(CUSTOM_ERR_ASSERT, (requiredInputs & ~snapshot->validInputs) == 0, "FSIO snapshot", NAN);
+	return runCode(code, size, selfValue, snapshot->values PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+float FsioProgram::getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX) const {
+	FsioInputSnapshot snapshot;
+	snapshot.update(requiredInputs PASS_ENGINE_PARAMETER_SUFFIX);
+	return getValue(selfValue, &snapshot PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
 LEElementPool::LEElementPool(LEElement *pool, int size) {
 	this->pool = pool;
 	this->size = size;
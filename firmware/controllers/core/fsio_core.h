@@ -117,6 +117,106 @@ private:
 	calc_stack_t stack;
 };
 
+/**
+ * All actions which do not take anything from the stack are between LE_METHOD_RPM and LE_METHOD_FSIO_DIGITAL_INPUT
+ */
+#define FSIO_INPUT_COUNT (LE_METHOD_FSIO_DIGITAL_INPUT - LE_METHOD_RPM + 1)
+#define FSIO_INPUT_BIT(action) (1 << ((action) - LE_METHOD_RPM))
+#define IS_FSIO_INPUT(action) ((action) >= LE_METHOD_RPM && (action) <= LE_METHOD_FSIO_DIGITAL_INPUT)
+
+typedef uint32_t fsio_input_mask_t;
+
+/**
+ * Engine values used by FSIO expressions, converted once per runFsio() pass so that
+ * all expressions evaluated in one pass agree on the same inputs.
+ */
+class FsioInputSnapshot {
+public:
+	FsioInputSnapshot();
+	/**
+	 * forgets all values, next update() would read everything again
+	 */
+	void reset();
+	/**
+	 * reads required values which were not read since last reset()
+	 */
+	void update(fsio_input_mask_t requiredInputs DECLARE_ENGINE_PARAMETER_SUFFIX);
+	float get(le_action_e action) const;
+	/**
+	 * bit for each value which has been read, see FSIO_INPUT_BIT
+	 */
+	fsio_input_mask_t validInputs;
+	uint32_t readCounter;
+private:
+	friend class FsioProgram;
+	float values[FSIO_INPUT_COUNT];
+};
+
+/**
+ * One step of a compiled FSIO expression, see FsioProgram
+ */
+typedef struct {
+	le_action_e action;
+	/**
+	 * constant value for LE_NUMERIC_VALUE
+	 */
+	float fValue;
+	/**
+	 * snapshot index for engine values
+	 */
+	int iValue;
+} fsio_instruction_s;
+
+class FsioCodePool {
+public:
+	FsioCodePool(fsio_instruction_s *pool, int size);
+	void reset();
+	int getSize() const;
+private:
+	friend class FsioProgram;
+	fsio_instruction_s *pool;
+	int index;
+	int size;
+};
+
+/**
+ * Parsed expression compiled into a contiguous array of instructions.
+ *
+ * Constant sub-expressions are folded at compile time and engine values are taken from
+ * FsioInputSnapshot, the compiler records which values are needed. Stack depth is verified by the
+ * compiler so the interpreter loop does not need any checks.
+ *
+ * Expressions which would fail at runtime (stack underflow, unknown action) are not compiled,
+ * these are evaluated by LECalculator same as before.
+ */
+class FsioProgram {
+public:
+	FsioProgram();
+	void reset();
+	/**
+	 * @return true if expression was compiled
+	 */
+	bool compile(LEElement *element, FsioCodePool *pool DECLARE_ENGINE_PARAMETER_SUFFIX);
+	bool isCompiled() const;
+	/**
+	 * @param snapshot should have all requiredInputs
+	 */
+	float getValue(float selfValue, const FsioInputSnapshot *snapshot DECLARE_ENGINE_PARAMETER_SUFFIX) const;
+	/**
+	 * reads engine values into a snapshot of its own
+	 */
+	float getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX) const;
+	int getSize() const;
+	/**
+	 * parsed expression this program was compiled from
+	 */
+	LEElement *source;
+	fsio_input_mask_t requiredInputs;
+private:
+	fsio_instruction_s *code;
+	int size;
+};
+
 class LENameOrdinalPair {
 public:
 	LENameOrdinalPair(le_action_e action, const char *name);
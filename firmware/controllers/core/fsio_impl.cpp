@@ -82,24 +82,29 @@ LEElementPool sysPool(sysElements, SYS_ELEMENT_POOL_SIZE);
 static LEElement userElements[UD_ELEMENT_POOL_SIZE] CCM_OPTIONAL;
 LEElementPool userPool(userElements, UD_ELEMENT_POOL_SIZE);
 
+/**
+ * compiled code is never longer than parsed expression
+ */
+static fsio_instruction_s sysCode[SYS_ELEMENT_POOL_SIZE] CCM_OPTIONAL;
+static FsioCodePool sysCodePool(sysCode, SYS_ELEMENT_POOL_SIZE);
+
+static fsio_instruction_s userCode[UD_ELEMENT_POOL_SIZE] CCM_OPTIONAL;
+static FsioCodePool userCodePool(userCode, UD_ELEMENT_POOL_SIZE);
+
 class FsioPointers {
 public:
-	FsioPointers();
-	LEElement * fsioLogics[FSIO_COMMAND_COUNT];
+	FsioProgram fsioLogics[FSIO_COMMAND_COUNT];
 };
 
-FsioPointers::FsioPointers() : fsioLogics() {
-}
-
 static FsioPointers state;
 
-static LEElement * acRelayLogic;
-static LEElement * fuelPumpLogic;
-static LEElement * radiatorFanLogic;
-static LEElement * alternatorLogic;
+static FsioProgram acRelayLogic;
+static FsioProgram fuelPumpLogic;
+static FsioProgram radiatorFanLogic;
+static FsioProgram alternatorLogic;
 
 #if EFI_MAIN_RELAY_CONTROL
-static LEElement * mainRelayLogic;
+static FsioProgram mainRelayLogic;
 #endif /* EFI_MAIN_RELAY_CONTROL */
 
 EXTERN_ENGINE
@@ -251,6 +256,7 @@ void setFsio(int index, brain_pin_e pin, const char * exp DECLARE_CONFIG_PARAMET
 
 void applyFsioConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	userPool.reset();
+	userCodePool.reset();
 	for (int i = 0; i < FSIO_COMMAND_COUNT; i++) {
 		brain_pin_e brainPin = CONFIGB(fsioOutputPins)[i];
 
@@ -261,7 +267,10 @@ void applyFsioConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 				warning(CUSTOM_FSIO_PARSING, "parsing [%s]", formula);
 			}
 
-			state.fsioLogics[i] = logic;
+			state.fsioLogics[i].compile(logic, &userCodePool PASS_ENGINE_PARAMETER_SUFFIX);
+		} else {
+			// pool has just been reset, previous expression is gone
+			state.fsioLogics[i].reset();
 		}
 	}
 }
@@ -274,6 +283,27 @@ void onConfigurationChangeFsioCallback(engine_configuration_s *previousConfigura
 
 static LECalculator calc;
 
+/**
+ * engine values for current runFsio() pass, only the values which are used by evaluated expressions are read
+ */
+static FsioInputSnapshot inputSnapshot;
+
+/**
+ * expressions which could not be compiled are still evaluated by the calculator
+ *
+ * @param snapshot NULL if invoked outside of runFsio()
+ */
+static float getProgramValue(FsioProgram *program, float selfValue, FsioInputSnapshot *snapshot DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (program->isCompiled()) {
+		if (snapshot == NULL) {
+			return program->getValue(selfValue PASS_ENGINE_PARAMETER_SUFFIX);
+		}
+		snapshot->update(program->requiredInputs PASS_ENGINE_PARAMETER_SUFFIX);
+		return program->getValue(selfValue, snapshot PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+	return calc.getValue2(selfValue, program->source PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
 static SimplePwm fsioPwm[FSIO_COMMAND_COUNT] CCM_OPTIONAL;
 
 // that's crazy, but what's an alternative? we need const char *, a shared buffer would not work for pin repository
@@ -315,15 +345,19 @@ static const char *getGpioPinName(int index) {
 	return NULL;
 }
 
-float getFsioOutputValue(int index DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	if (state.fsioLogics[index] == NULL) {
+static float getFsioOutputValue(int index, FsioInputSnapshot *snapshot DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (state.fsioLogics[index].source == NULL) {
 		warning(CUSTOM_NO_FSIO, "no FSIO for #%d %s", index + 1, hwPortname(CONFIGB(fsioOutputPins)[index]));
 		return NAN;
 	} else {
-		return calc.getValue2(engine->fsioState.fsioLastValue[index], state.fsioLogics[index] PASS_ENGINE_PARAMETER_SUFFIX);
+		return getProgramValue(&state.fsioLogics[index], engine->fsioState.fsioLastValue[index], snapshot PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 }
 
+float getFsioOutputValue(int index DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	return getFsioOutputValue(index, NULL PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
 /**
  * @param index from zero for (FSIO_COMMAND_COUNT - 1)
  */
@@ -335,7 +369,7 @@ static void handleFsio(int index DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
 	bool isPwmMode = CONFIGB(fsioFrequency)[index] != NO_PWM;
 
-	float fvalue = getFsioOutputValue(index PASS_ENGINE_PARAMETER_SUFFIX);
+	float fvalue = getFsioOutputValue(index, &inputSnapshot PASS_ENGINE_PARAMETER_SUFFIX);
 	engine->fsioState.fsioLastValue[index] = fvalue;
 
 	if (isPwmMode) {
@@ -378,21 +412,30 @@ static const char * action2String(le_action_e action) {
 	return buffer;
 }
 
-static void setPinState(const char * msg, OutputPin *pin, LEElement *element DECLARE_ENGINE_PARAMETER_SUFFIX) {
+static void setPinState(const char * msg, OutputPin *pin, FsioProgram *program DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_PROD_CODE
 	if (isRunningBenchTest()) {
 		return; // let's not mess with bench testing
 	}
 #endif /* EFI_PROD_CODE */
 
-	if (element == NULL) {
+	if (program->source == NULL) {
 		warning(CUSTOM_FSIO_INVALID_EXPRESSION, "invalid expression for %s", msg);
 	} else {
-		int value = (int)calc.getValue2(pin->getLogicValue(), element PASS_ENGINE_PARAMETER_SUFFIX);
+		int value = (int)getProgramValue(program, pin->getLogicValue(), &inputSnapshot PASS_ENGINE_PARAMETER_SUFFIX);
 		if (pin->isInitialized() && value != pin->getLogicValue()) {
 
-			for (int i = 0;i < calc.currentCalculationLogPosition;i++) {
-				scheduleMsg(logger, "calc %d: action %s value %.2f", i, action2String(calc.calcLogAction[i]), calc.calcLogValue[i]);
+			if (program->isCompiled()) {
+				fsio_input_mask_t inputs = program->requiredInputs;
+				while (inputs != 0) {
+					le_action_e action = (le_action_e) (LE_METHOD_RPM + __builtin_ctz(inputs));
+					inputs &= inputs - 1;
+					scheduleMsg(logger, "input: action %s value %.2f", action2String(action), inputSnapshot.get(action));
+				}
+			} else {
+				for (int i = 0;i < calc.currentCalculationLogPosition;i++) {
+					scheduleMsg(logger, "calc %d: action %s value %.2f", i, action2String(calc.calcLogAction[i]), calc.calcLogValue[i]);
+				}
 			}
 
 			scheduleMsg(logger, "setPin %s %s", msg, value ? "on" : "off");
@@ -423,13 +466,13 @@ static void setFsioFrequency(int index, int frequency) {
  * @return 'true' if value has changed
  */
 static bool updateValueOrWarning(int fsioIndex, const char *msg, float *value DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	LEElement * element = state.fsioLogics[fsioIndex];
-	if (element == NULL) {
+	FsioProgram *program = &state.fsioLogics[fsioIndex];
+	if (program->source == NULL) {
 		warning(CUSTOM_FSIO_INVALID_EXPRESSION, "invalid expression for %s", msg);
 		return false;
 	} else {
 		float beforeValue = *value;
-		*value = calc.getValue2(beforeValue, element PASS_ENGINE_PARAMETER_SUFFIX);
+		*value = getProgramValue(program, beforeValue, &inputSnapshot PASS_ENGINE_PARAMETER_SUFFIX);
 		// floating '==' comparison without EPS seems fine here
 		return (beforeValue != *value);
 	}
@@ -443,19 +486,21 @@ static void useFsioForServo(int servoIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
  * this method should be invoked periodically to calculate FSIO and toggle corresponding FSIO outputs
  */
 void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	inputSnapshot.reset();
+
 	for (int index = 0; index < FSIO_COMMAND_COUNT; index++) {
 		handleFsio(index PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
 #if EFI_FUEL_PUMP
 	if (CONFIGB(fuelPumpPin) != GPIO_UNASSIGNED) {
-		setPinState("pump", &enginePins.fuelPumpRelay, fuelPumpLogic PASS_ENGINE_PARAMETER_SUFFIX);
+		setPinState("pump", &enginePins.fuelPumpRelay, &fuelPumpLogic PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 #endif /* EFI_FUEL_PUMP */
 
 #if EFI_MAIN_RELAY_CONTROL
 	if (CONFIGB(mainRelayPin) != GPIO_UNASSIGNED)
-		setPinState("main_relay", &enginePins.mainRelay, mainRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
+		setPinState("main_relay", &enginePins.mainRelay, &mainRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
 #else /* EFI_MAIN_RELAY_CONTROL */
 	/**
 	 * main relay is always on if ECU is on, that's a good enough initial implementation
@@ -472,7 +517,7 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	enginePins.o2heater.setValue(engine->rpmCalculator.isRunning(PASS_ENGINE_PARAMETER_SIGNATURE));
 
 	if (CONFIGB(acRelayPin) != GPIO_UNASSIGNED) {
-		setPinState("A/C", &enginePins.acRelay, acRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
+		setPinState("A/C", &enginePins.acRelay, &acRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
 //	if (CONFIGB(alternatorControlPin) != GPIO_UNASSIGNED) {
@@ -480,7 +525,7 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 //	}
 
 	if (CONFIGB(fanPin) != GPIO_UNASSIGNED) {
-		setPinState("fan", &enginePins.fanRelay, radiatorFanLogic PASS_ENGINE_PARAMETER_SUFFIX);
+		setPinState("fan", &enginePins.fanRelay, &radiatorFanLogic PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
 #if EFI_ENABLE_ENGINE_WARNING
@@ -525,10 +570,14 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 
-static void showFsio(const char *msg, LEElement *element) {
+static void showFsio(const char *msg, FsioProgram *program) {
 #if EFI_PROD_CODE || EFI_SIMULATOR
 	if (msg != NULL)
 		scheduleMsg(logger, "%s:", msg);
+	LEElement *element = program->source;
+	if (program->isCompiled()) {
+		scheduleMsg(logger, "compiled: %d instruction(s) %d input(s)", program->getSize(), __builtin_popcount(program->requiredInputs));
+	}
 	while (element != NULL) {
 		scheduleMsg(logger, "action %d: fValue=%.2f iValue=%d", element->action, element->fValue, element->iValue);
 		element = element->next;
@@ -540,10 +589,12 @@ static void showFsio(const char *msg, LEElement *element) {
 static void showFsioInfo(void) {
 #if EFI_PROD_CODE || EFI_SIMULATOR
 	scheduleMsg(logger, "sys used %d/user used %d", sysPool.getSize(), userPool.getSize());
-	showFsio("a/c", acRelayLogic);
-	showFsio("fuel", fuelPumpLogic);
-	showFsio("fan", radiatorFanLogic);
-	showFsio("alt", alternatorLogic);
+	scheduleMsg(logger, "sys code %d/user code %d", sysCodePool.getSize(), userCodePool.getSize());
+	scheduleMsg(logger, "input reads %d", inputSnapshot.readCounter);
+	showFsio("a/c", &acRelayLogic);
+	showFsio("fuel", &fuelPumpLogic);
+	showFsio("fan", &radiatorFanLogic);
+	showFsio("alt", &alternatorLogic);
 
 	for (int i = 0; i < AUX_PID_COUNT ; i++) {
 		brain_pin_e pin = engineConfiguration->auxPidPins[i];
@@ -567,7 +618,7 @@ static void showFsioInfo(void) {
 					hwPortname(CONFIGB(fsioOutputPins)[i]), CONFIGB(fsioFrequency)[i],
 					engine->fsioState.fsioLastValue[i]);
 //			scheduleMsg(logger, "user-defined #%d value=%.2f", i, engine->engineConfigurationPtr2->fsioLastValue[i]);
-			showFsio(NULL, state.fsioLogics[i]);
+			showFsio(NULL, &state.fsioLogics[i]);
 		}
 	}
 	for (int i = 0; i < FSIO_COMMAND_COUNT; i++) {
@@ -655,20 +706,21 @@ void initFsioImpl(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #else
 	// only unit test needs this
 	sysPool.reset();
+	sysCodePool.reset();
 #endif
 
 #if EFI_FUEL_PUMP
-	fuelPumpLogic = sysPool.parseExpression(FUEL_PUMP_LOGIC);
+	fuelPumpLogic.compile(sysPool.parseExpression(FUEL_PUMP_LOGIC), &sysCodePool PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_FUEL_PUMP */
 
-	acRelayLogic = sysPool.parseExpression(AC_RELAY_LOGIC);
-	radiatorFanLogic = sysPool.parseExpression(FAN_CONTROL_LOGIC);
+	acRelayLogic.compile(sysPool.parseExpression(AC_RELAY_LOGIC), &sysCodePool PASS_ENGINE_PARAMETER_SUFFIX);
+	radiatorFanLogic.compile(sysPool.parseExpression(FAN_CONTROL_LOGIC), &sysCodePool PASS_ENGINE_PARAMETER_SUFFIX);
 
-	alternatorLogic = sysPool.parseExpression(ALTERNATOR_LOGIC);
+	alternatorLogic.compile(sysPool.parseExpression(ALTERNATOR_LOGIC), &sysCodePool PASS_ENGINE_PARAMETER_SUFFIX);
 	
 #if EFI_MAIN_RELAY_CONTROL
 	if (CONFIGB(mainRelayPin) != GPIO_UNASSIGNED)
-		mainRelayLogic = sysPool.parseExpression(MAIN_RELAY_LOGIC);
+		mainRelayLogic.compile(sysPool.parseExpression(MAIN_RELAY_LOGIC), &sysCodePool PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_MAIN_RELAY_CONTROL */
 
 #if EFI_PROD_CODE
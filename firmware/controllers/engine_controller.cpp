@@ -60,6 +60,7 @@
 #include "aux_pid.h"
 #include "accelerometer.h"
 #include "counter64.h"
+#include "scheduler_histograms.h"
 
 #if HAL_USE_ADC
 #include "AdcConfiguration.h"
@@ -176,60 +177,14 @@ efitimeus_t getTimeNowUs(void) {
 	return getTimeNowNt() / (CORE_CLOCK / 1000000);
 }
 
-//todo: macro to save method invocation
+/**
+ * Lock-free, see Overflow64Counter. Callers which only need a short duration should use
+ * getTimeNowLowerNt() which is a single register read.
+ */
 efitick_t getTimeNowNt(void) {
-#if EFI_PROD_CODE
-    /* Entering a reentrant critical zone.*/
-    syssts_t sts = chSysGetStatusAndLockX();
-	efitime_t localH = halTime.state.highBits;
-	uint32_t localLow = halTime.state.lowBits;
-
-	uint32_t value = getTimeNowLowerNt();
-
-	if (value < localLow) {
-		// new value less than previous value means there was an overflow in that 32 bit counter
-		localH += 0x100000000LL;
-	}
-
-	efitime_t result = localH + value;
-
-    /* Leaving the critical zone.*/
-    chSysRestoreStatusX(sts);
-	return result;
-#else /* EFI_PROD_CODE */
-// todo: why is this implementation not used?
-	/**
-	 * this method is lock-free and thread-safe, that's because the 'update' method
-	 * is atomic with a critical zone requirement.
-	 *
-	 * http://stackoverflow.com/questions/5162673/how-to-read-two-32bit-counters-as-a-64bit-integer-without-race-condition
-	 */
-	efitime_t localH;
-	efitime_t localH2;
-	uint32_t localLow;
-	int counter = 0;
-	do {
-		localH = halTime.state.highBits;
-		localLow = halTime.state.lowBits;
-		localH2 = halTime.state.highBits;
-#if EFI_PROD_CODE
-		if (counter++ == 10000)
-			chDbgPanic("lock-free frozen");
-#endif /* EFI_PROD_CODE */
-	} while (localH != localH2);
-	/**
-	 * We need to take current counter after making a local 64 bit snapshot
-	 */
-	uint32_t value = getTimeNowLowerNt();
-
-	if (value < localLow) {
-		// new value less than previous value means there was an overflow in that 32 bit counter
-		localH += 0x100000000LL;
-	}
-
-	return localH + value;
-#endif /* EFI_PROD_CODE */
-
+	// snapshot has to be taken before the hardware counter is sampled
+	State64 snapshot = halTime.getSnapshot();
+	return Overflow64Counter::toTime64(&snapshot, getTimeNowLowerNt());
 }
 
 /**
@@ -298,12 +253,9 @@ static void doPeriodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 #if EFI_PROD_CODE
 	/**
 	 * We need to push current value into the 64 bit counter often enough so that we do not miss an overflow
+	 * This is the only writer so no critical zone is needed.
 	 */
-    /* Entering a reentrant critical zone.*/
-    syssts_t sts = chSysGetStatusAndLockX();
-	updateAndSet(&halTime.state, getTimeNowLowerNt());
-    /* Leaving the critical zone.*/
-    chSysRestoreStatusX(sts);
+	halTime.update(getTimeNowLowerNt());
 	int timeSeconds = getTimeNowSeconds();
 	if (previousSecond != timeSeconds) {
 		previousSecond = timeSeconds;
@@ -319,10 +271,14 @@ static void doPeriodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		engine->rpmCalculator.setStopSpinning(PASS_ENGINE_PARAMETER_SIGNATURE);
 	}
 
-	if (engine->rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 #if EFI_INTERNAL_FLASH
-		writeToFlashIfPending();
+	/**
+	 * this one decides on its own what could be written while engine is running
+	 */
+	writeToFlashIfPending();
 #endif /* EFI_INTERNAL_FLASH */
+
+	if (engine->rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 		resetAccel();
 	} else {
 		updatePrimeInjectionPulseState(PASS_ENGINE_PARAMETER_SIGNATURE);
@@ -683,6 +639,10 @@ void initEngineContoller(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX)
 
 	initAlgo(sharedLogger);
 
+#if EFI_SCHEDULER_HISTOGRAMS
+	initSchedulerHistograms(sharedLogger);
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
+
 #if EFI_WAVE_ANALYZER
 	if (engineConfiguration->isWaveAnalyzerEnabled) {
 		initWaveAnalyzer(sharedLogger);
@@ -0,0 +1,344 @@
+/**
+ * @file flash_log.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "flash_log.h"
+#include "crc.h"
+#include <stddef.h>
+
+#define FLASH_LOG_ALIGN(size) (((size) + 3) & ~3)
+#define FLASH_LOG_CHANGED_MASK_SIZE ((FLASH_LOG_MAX_PAGES + 31) / 32)
+
+static uint32_t newerSequence(uint32_t a, uint32_t b) {
+	return a > b ? a : b;
+}
+
+FlashLog::FlashLog() {
+	flash = NULL;
+	regionAddress[0] = regionAddress[1] = 0;
+	regionSize = 0;
+	version = 0;
+	imageSize = 0;
+	pageCount = 0;
+	activeRegion = -1;
+	isAppendable = false;
+	writeOffset = 0;
+	regionSequence = 0;
+	burnSequence = 0;
+	burnCounter = 0;
+	compactionCounter = 0;
+	lastBurnPageCount = 0;
+	memset(pageAddress, 0xFF, sizeof(pageAddress));
+	memset(pendingAddress, 0xFF, sizeof(pendingAddress));
+}
+
+void FlashLog::init(FlashInterface *flash, uint32_t firstRegionAddress, uint32_t secondRegionAddress, uint32_t regionSize,
+		uint32_t version, int imageSize) {
+	this->flash = flash;
+	regionAddress[0] = firstRegionAddress;
+	regionAddress[1] = secondRegionAddress;
+	this->regionSize = regionSize;
+	this->version = version;
+	this->imageSize = imageSize;
+	pageCount = (imageSize + FLASH_LOG_PAGE_SIZE - 1) / FLASH_LOG_PAGE_SIZE;
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, pageCount <= FLASH_LOG_MAX_PAGES, "flash log pages");
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, getFullImageSize() <= (int) regionSize, "flash log region");
+	activeRegion = -1;
+	isAppendable = false;
+}
+
+int FlashLog::getPageSize(int pageIndex) const {
+	return minI(FLASH_LOG_PAGE_SIZE, imageSize - pageIndex * FLASH_LOG_PAGE_SIZE);
+}
+
+int FlashLog::getRecordSize(int pageIndex) const {
+	return sizeof(flash_log_record_header_s) + FLASH_LOG_ALIGN(getPageSize(pageIndex));
+}
+
+/**
+ * @return space taken by region header and one burn of every page
+ */
+int FlashLog::getFullImageSize() const {
+	int size = sizeof(flash_log_region_header_s) + sizeof(flash_log_record_header_s);
+	for (int i = 0; i < pageCount; i++) {
+		size += getRecordSize(i);
+	}
+	return size;
+}
+
+int FlashLog::getFreeSpace() const {
+	return activeRegion < 0 ? 0 : regionSize - writeOffset;
+}
+
+int FlashLog::getActiveRegion() const {
+	return activeRegion;
+}
+
+bool FlashLog::isCompactionDue() const {
+	return activeRegion < 0 || !isAppendable || getFreeSpace() < getFullImageSize();
+}
+
+uint32_t FlashLog::getCrc(const flash_log_record_header_s *header, const void *data, int size) const {
+	uint32_t crc = crc32(header, offsetof(flash_log_record_header_s, crc));
+	return crc32inc(data, crc, size);
+}
+
+bool FlashLog::readPage(uint32_t address, int pageIndex) {
+	return flash->read(address + sizeof(flash_log_record_header_s), pageBuffer, getPageSize(pageIndex)) == 0;
+}
+
+void FlashLog::clearPending() {
+	memset(pendingAddress, 0xFF, sizeof(pendingAddress));
+}
+
+void FlashLog::applyPending() {
+	for (int i = 0; i < pageCount; i++) {
+		if (pendingAddress[i] != FLASH_LOG_NO_ADDRESS) {
+			pageAddress[i] = pendingAddress[i];
+		}
+	}
+	clearPending();
+}
+
+/**
+ * Walks the records until erased space. Pages of a burn only become current once the commit record of
+ * the same burn is found, anything unreadable ends the scan.
+ */
+flash_log_result_e FlashLog::scanRegion(int region) {
+	uint32_t base = regionAddress[region];
+	memset(pageAddress, 0xFF, sizeof(pageAddress));
+	clearPending();
+	int pendingCount = 0;
+	uint32_t pendingSequence = 0;
+	uint32_t offset = sizeof(flash_log_region_header_s);
+	isAppendable = true;
+
+	while (offset + sizeof(flash_log_record_header_s) <= regionSize) {
+		flash_log_record_header_s header;
+		if (flash->read(base + offset, &header, sizeof(header)) != 0) {
+			isAppendable = false;
+			break;
+		}
+		if (header.tag == FLASH_LOG_ERASED_TAG) {
+			break;
+		}
+		if (header.tag == FLASH_LOG_COMMIT_TAG) {
+			if (getCrc(&header, NULL, 0) != header.crc) {
+				isAppendable = false;
+				break;
+			}
+			if (pendingCount > 0 && header.burnSequence == pendingSequence && header.pageIndex == pendingCount) {
+				applyPending();
+			} else {
+				clearPending();
+			}
+			pendingCount = 0;
+			burnSequence = newerSequence(burnSequence, header.burnSequence);
+			offset += sizeof(header);
+		} else if (header.tag == FLASH_LOG_PAGE_TAG && header.pageIndex < pageCount) {
+			int pageIndex = header.pageIndex;
+			if (offset + getRecordSize(pageIndex) > regionSize || !readPage(base + offset, pageIndex)
+					|| getCrc(&header, pageBuffer, getPageSize(pageIndex)) != header.crc) {
+				isAppendable = false;
+				break;
+			}
+			if (pendingCount == 0 || header.burnSequence != pendingSequence) {
+				// previous burn was never committed
+				clearPending();
+				pendingCount = 0;
+				pendingSequence = header.burnSequence;
+			}
+			if (pendingAddress[pageIndex] == FLASH_LOG_NO_ADDRESS) {
+				pendingCount++;
+			}
+			pendingAddress[pageIndex] = base + offset;
+			burnSequence = newerSequence(burnSequence, header.burnSequence);
+			offset += getRecordSize(pageIndex);
+		} else {
+			isAppendable = false;
+			break;
+		}
+	}
+	clearPending();
+	writeOffset = offset;
+
+	for (int i = 0; i < pageCount; i++) {
+		if (pageAddress[i] == FLASH_LOG_NO_ADDRESS) {
+			return FL_CORRUPTED;
+		}
+	}
+	return FL_OK;
+}
+
+flash_log_result_e FlashLog::recover(void *image) {
+	activeRegion = -1;
+	isAppendable = false;
+	regionSequence = 0;
+	burnSequence = 0;
+
+	flash_log_region_header_s headers[2];
+	bool isValid[2];
+	bool hasLog = false;
+	bool hasIncompatible = false;
+	for (int r = 0; r < 2; r++) {
+		isValid[r] = flash->read(regionAddress[r], &headers[r], sizeof(headers[r])) == 0
+				&& headers[r].magic == FLASH_LOG_REGION_MAGIC;
+		if (!isValid[r]) {
+			continue;
+		}
+		hasLog = true;
+		regionSequence = newerSequence(regionSequence, headers[r].sequence);
+		if (headers[r].version != version || headers[r].imageSize != (uint32_t) imageSize) {
+			hasIncompatible = true;
+			isValid[r] = false;
+		}
+	}
+
+	int newest = isValid[1] && (!isValid[0] || headers[1].sequence > headers[0].sequence) ? 1 : 0;
+	for (int i = 0; i < 2; i++) {
+		int region = i == 0 ? newest : 1 - newest;
+		if (!isValid[region] || scanRegion(region) != FL_OK) {
+			continue;
+		}
+		uint8_t *bytes = (uint8_t *) image;
+		for (int p = 0; p < pageCount; p++) {
+			if (flash->read(pageAddress[p] + sizeof(flash_log_record_header_s), bytes + p * FLASH_LOG_PAGE_SIZE,
+					getPageSize(p)) != 0) {
+				return FL_CORRUPTED;
+			}
+		}
+		activeRegion = region;
+		return FL_OK;
+	}
+	isAppendable = false;
+	if (hasIncompatible) {
+		return FL_INCOMPATIBLE_VERSION;
+	}
+	return hasLog ? FL_CORRUPTED : FL_EMPTY;
+}
+
+int FlashLog::writeRecord(uint32_t *address, uint16_t tag, uint16_t pageIndex, const void *data, int size) {
+	flash_log_record_header_s header;
+	header.tag = tag;
+	header.pageIndex = pageIndex;
+	header.burnSequence = burnSequence;
+	header.crc = getCrc(&header, data, size);
+	// header goes first: a torn write would then always fail CRC check
+	if (flash->write(*address, &header, sizeof(header)) != 0) {
+		return -1;
+	}
+	if (size > 0 && flash->write(*address + sizeof(header), data, size) != 0) {
+		return -1;
+	}
+	*address += sizeof(header) + FLASH_LOG_ALIGN(size);
+	return 0;
+}
+
+flash_log_result_e FlashLog::append(const void *image) {
+	if (activeRegion < 0 || !isAppendable) {
+		return FL_NO_SPACE;
+	}
+	const uint8_t *bytes = (const uint8_t *) image;
+	uint32_t changedMask[FLASH_LOG_CHANGED_MASK_SIZE];
+	memset(changedMask, 0, sizeof(changedMask));
+	int changedCount = 0;
+	uint32_t burnSize = sizeof(flash_log_record_header_s);
+	for (int i = 0; i < pageCount; i++) {
+		if (!readPage(pageAddress[i], i)) {
+			return FL_WRITE_FAILED;
+		}
+		if (memcmp(pageBuffer, bytes + i * FLASH_LOG_PAGE_SIZE, getPageSize(i)) != 0) {
+			changedMask[i / 32] |= 1 << (i % 32);
+			changedCount++;
+			burnSize += getRecordSize(i);
+		}
+	}
+	lastBurnPageCount = changedCount;
+	if (changedCount == 0) {
+		return FL_OK;
+	}
+	if (writeOffset + burnSize > regionSize) {
+		return FL_NO_SPACE;
+	}
+
+	burnSequence++;
+	uint32_t address = regionAddress[activeRegion] + writeOffset;
+	for (int i = 0; i < pageCount; i++) {
+		if ((changedMask[i / 32] & (1 << (i % 32))) == 0) {
+			continue;
+		}
+		memcpy(pageBuffer, bytes + i * FLASH_LOG_PAGE_SIZE, getPageSize(i));
+		pendingAddress[i] = address;
+		if (writeRecord(&address, FLASH_LOG_PAGE_TAG, i, pageBuffer, getPageSize(i)) != 0) {
+			clearPending();
+			isAppendable = false;
+			return FL_WRITE_FAILED;
+		}
+	}
+	if (writeRecord(&address, FLASH_LOG_COMMIT_TAG, changedCount, NULL, 0) != 0) {
+		clearPending();
+		isAppendable = false;
+		return FL_WRITE_FAILED;
+	}
+	applyPending();
+	writeOffset = address - regionAddress[activeRegion];
+	burnCounter++;
+	return FL_OK;
+}
+
+/**
+ * Current region is left untouched until the next compaction, so until the new region is committed
+ * the previous image is still there to recover.
+ */
+flash_log_result_e FlashLog::compact(const void *image) {
+	int target = activeRegion < 0 ? 0 : 1 - activeRegion;
+	uint32_t base = regionAddress[target];
+	if (flash->erase(base, regionSize) != 0) {
+		return FL_WRITE_FAILED;
+	}
+	flash_log_region_header_s header;
+	header.magic = FLASH_LOG_REGION_MAGIC;
+	header.sequence = regionSequence + 1;
+	header.version = version;
+	header.imageSize = imageSize;
+	if (flash->write(base, &header, sizeof(header)) != 0) {
+		return FL_WRITE_FAILED;
+	}
+	regionSequence++;
+
+	burnSequence++;
+	const uint8_t *bytes = (const uint8_t *) image;
+	uint32_t address = base + sizeof(header);
+	for (int i = 0; i < pageCount; i++) {
+		memcpy(pageBuffer, bytes + i * FLASH_LOG_PAGE_SIZE, getPageSize(i));
+		pendingAddress[i] = address;
+		if (writeRecord(&address, FLASH_LOG_PAGE_TAG, i, pageBuffer, getPageSize(i)) != 0) {
+			clearPending();
+			return FL_WRITE_FAILED;
+		}
+	}
+	if (writeRecord(&address, FLASH_LOG_COMMIT_TAG, pageCount, NULL, 0) != 0) {
+		clearPending();
+		return FL_WRITE_FAILED;
+	}
+	applyPending();
+	activeRegion = target;
+	isAppendable = true;
+	writeOffset = address - base;
+	burnCounter++;
+	compactionCounter++;
+	lastBurnPageCount = pageCount;
+	return FL_OK;
+}
+
+flash_log_result_e FlashLog::burn(const void *image, bool allowCompaction) {
+	flash_log_result_e result = append(image);
+	if (result == FL_OK || !allowCompaction) {
+		return result;
+	}
+	return compact(image);
+}
@@ -0,0 +1,169 @@
+/**
+ * @file flash_log.h
+ * @brief Log-structured configuration storage in internal flash
+ *
+ * Configuration image is split into pages. A burn only appends the pages which differ from what
+ * flash already has, followed by a commit record; no erase is needed until the region is full.
+ * Programming a few pages takes milliseconds so it is fine with engine running, while a sector erase
+ * stalls the chip for a second or more - compaction, which copies the whole image into the other
+ * region, is only done while engine is stopped.
+ *
+ * Two regions are used alternately, each region starts with a header carrying a sequence number.
+ * At boot the newest region which has a complete committed image wins; a burn interrupted by power
+ * loss has no commit record and is ignored, so the previous burn is what comes back.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef FLASH_LOG_H_
+#define FLASH_LOG_H_
+
+#include <stdint.h>
+
+#define FLASH_LOG_PAGE_SIZE 256
+#ifndef FLASH_LOG_MAX_PAGES
+#define FLASH_LOG_MAX_PAGES 96
+#endif /* FLASH_LOG_MAX_PAGES */
+
+#define FLASH_LOG_REGION_MAGIC 0x52464C47
+#define FLASH_LOG_PAGE_TAG 0x5047
+#define FLASH_LOG_COMMIT_TAG 0x4D43
+#define FLASH_LOG_ERASED_TAG 0xFFFF
+#define FLASH_LOG_NO_ADDRESS 0xFFFFFFFF
+
+/**
+ * Raw flash access, implemented by the chip flash driver and by the unit test simulator.
+ * Like real NOR flash, write can only clear bits and erase works on whole sectors.
+ * All methods return zero on success.
+ */
+class FlashInterface {
+public:
+	/**
+	 * Erases all sectors which overlap given range
+	 */
+	virtual int erase(uint32_t address, uint32_t size) = 0;
+	virtual int write(uint32_t address, const void *buffer, uint32_t size) = 0;
+	virtual int read(uint32_t address, void *buffer, uint32_t size) = 0;
+};
+
+typedef struct {
+	uint32_t magic;
+	/**
+	 * incremented by each compaction, region with higher value is newer
+	 */
+	uint32_t sequence;
+	uint32_t version;
+	uint32_t imageSize;
+} flash_log_region_header_s;
+
+/**
+ * Page record is followed by page data. For commit record pageIndex holds number of pages in the burn.
+ */
+typedef struct {
+	uint16_t tag;
+	uint16_t pageIndex;
+	uint32_t burnSequence;
+	/**
+	 * covers tag, pageIndex, burnSequence and page data
+	 */
+	uint32_t crc;
+} flash_log_record_header_s;
+
+typedef enum {
+	FL_OK = 0,
+	/**
+	 * there is no log in flash at all
+	 */
+	FL_EMPTY = 1,
+	FL_INCOMPATIBLE_VERSION = 2,
+	/**
+	 * there is a log but no complete image in it
+	 */
+	FL_CORRUPTED = 3,
+	/**
+	 * burn does not fit, compaction is needed
+	 */
+	FL_NO_SPACE = 4,
+	FL_WRITE_FAILED = 5
+} flash_log_result_e;
+
+class FlashLog {
+public:
+	FlashLog();
+	/**
+	 * Two regions of regionSize bytes each, they should not share flash sectors
+	 */
+	void init(FlashInterface *flash, uint32_t firstRegionAddress, uint32_t secondRegionAddress, uint32_t regionSize,
+			uint32_t version, int imageSize);
+	/**
+	 * Finds the newest complete image and copies it into image buffer
+	 */
+	flash_log_result_e recover(void *image);
+	/**
+	 * Appends pages which differ from flash content. Does not erase anything.
+	 */
+	flash_log_result_e append(const void *image);
+	/**
+	 * Erases the other region and writes complete image into it, takes a sector erase
+	 */
+	flash_log_result_e compact(const void *image);
+	/**
+	 * Appends if there is room, otherwise compacts if allowed
+	 * @param allowCompaction sector erase freezes the chip so this should only be true while engine is stopped
+	 * @return FL_NO_SPACE if the burn has to wait until compaction is allowed
+	 */
+	flash_log_result_e burn(const void *image, bool allowCompaction);
+	/**
+	 * @return true if there is no room left for a burn of the complete image, so next burn could fail
+	 */
+	bool isCompactionDue() const;
+	int getFreeSpace() const;
+	int getActiveRegion() const;
+
+	int burnCounter;
+	int compactionCounter;
+	int lastBurnPageCount;
+private:
+	int getPageSize(int pageIndex) const;
+	int getRecordSize(int pageIndex) const;
+	int getFullImageSize() const;
+	uint32_t getCrc(const flash_log_record_header_s *header, const void *data, int size) const;
+	bool readPage(uint32_t address, int pageIndex);
+	void clearPending();
+	void applyPending();
+	flash_log_result_e scanRegion(int region);
+	int writeRecord(uint32_t *address, uint16_t tag, uint16_t pageIndex, const void *data, int size);
+	FlashInterface *flash;
+	uint32_t regionAddress[2];
+	uint32_t regionSize;
+	uint32_t version;
+	int imageSize;
+	int pageCount;
+	/**
+	 * -1 until there is a usable region
+	 */
+	int activeRegion;
+	/**
+	 * false if there is garbage after the last record, only compaction could fix that
+	 */
+	bool isAppendable;
+	uint32_t writeOffset;
+	uint32_t regionSequence;
+	uint32_t burnSequence;
+	/**
+	 * flash address of the latest committed copy of each page
+	 */
+	uint32_t pageAddress[FLASH_LOG_MAX_PAGES];
+	/**
+	 * pages of the burn which is being written or scanned, not committed yet
+	 */
+	uint32_t pendingAddress[FLASH_LOG_MAX_PAGES];
+	/**
+	 * page is copied here before it is compared and written, so that tuner changing the
+	 * configuration in the middle of a burn could not break the CRC
+	 */
+	uint8_t pageBuffer[FLASH_LOG_PAGE_SIZE];
+};
+
+#endif /* FLASH_LOG_H_ */
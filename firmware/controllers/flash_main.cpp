@@ -14,6 +14,7 @@
 #include "eficonsole.h"
 
 #include "flash.h"
+#include "flash_log.h"
 #include "engine_math.h"
 
 // this message is part of console API, see FLASH_SUCCESS_MSG in java code
@@ -56,6 +57,13 @@ extern engine_configuration_s *engineConfiguration;
 #define FLASH_ADDR_SECOND_COPY 0x080C0000
 #endif
 
+/**
+ * Configuration log uses the sectors of both copies as its two regions
+ */
+#ifndef FLASH_LOG_REGION_SIZE
+#define FLASH_LOG_REGION_SIZE 0x20000
+#endif
+
 crc_t flashStateCrc(persistent_config_container_s *state) {
 	return calc_crc((const crc_t*) &state->persistentConfiguration, sizeof(persistent_config_s));
 }
@@ -69,17 +77,94 @@ bool getNeedToWriteConfiguration(void) {
 	return needToWriteConfiguration;
 }
 
+#if EFI_CONFIG_LOG_FLASH
+class InternalFlash : public FlashInterface {
+public:
+	int erase(uint32_t address, uint32_t size) {
+		return flashErase(address, size);
+	}
+	int write(uint32_t address, const void *buffer, uint32_t size) {
+		return flashWrite(address, (const char *) buffer, size);
+	}
+	int read(uint32_t address, void *buffer, uint32_t size) {
+		return flashRead(address, (char *) buffer, size);
+	}
+};
+
+static InternalFlash internalFlash;
+static FlashLog flashLog;
+
+/**
+ * compact() erases the region which is not active, so the two regions should not share a sector
+ */
+static bool isSeparateFlashLogRegions(void) {
+	return flashSectorAt(FLASH_ADDR_SECOND_COPY + FLASH_LOG_REGION_SIZE - 1) != flashSectorAt(FLASH_ADDR)
+			&& flashSectorAt(FLASH_ADDR + FLASH_LOG_REGION_SIZE - 1) != flashSectorAt(FLASH_ADDR_SECOND_COPY);
+}
+
+static void updateContainer(void) {
+	persistentState.size = PERSISTENT_SIZE;
+	persistentState.version = FLASH_DATA_VERSION;
+	persistentState.value = flashStateCrc(&persistentState);
+}
+
+/**
+ * @param allowCompaction sector erase freezes the chip so this should only be true while engine is stopped
+ * @return false if the burn has to wait for compaction
+ */
+static bool writeToFlashLog(bool allowCompaction) {
+	updateContainer();
+	efitimems_t nowMs = currentTimeMillis();
+	int compactionCounter = flashLog.compactionCounter;
+	flash_log_result_e result = flashLog.burn(&persistentState.persistentConfiguration, allowCompaction);
+	if (result != FL_OK && !allowCompaction) {
+		return false;
+	}
+	if (flashLog.compactionCounter != compactionCounter) {
+		scheduleMsg(logger, "Configuration log compacted");
+	}
+	scheduleMsg(logger, "Flash programmed in %dms: %d page(s), %d bytes free", currentTimeMillis() - nowMs,
+			flashLog.lastBurnPageCount, flashLog.getFreeSpace());
+	if (result == FL_OK) {
+		scheduleMsg(logger, FLASH_SUCCESS_MSG);
+	} else {
+		scheduleMsg(logger, "Flashing failed");
+	}
+	return true;
+}
+#endif /* EFI_CONFIG_LOG_FLASH */
+
 void writeToFlashIfPending() {
+	bool isStopped = engine->rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE);
+#if EFI_CONFIG_LOG_FLASH
 	if (!getNeedToWriteConfiguration()) {
+		if (isStopped && flashLog.isCompactionDue()) {
+			// so that burns while engine is running would have room
+			writeToFlashLog(true);
+		}
+		return;
+	}
+	// todo: technically we need a lock here, realistically we should be fine.
+	needToWriteConfiguration = false;
+	if (!writeToFlashLog(isStopped)) {
+		// no room for this burn, retry once engine is stopped
+		needToWriteConfiguration = true;
+	}
+#else
+	if (!isStopped || !getNeedToWriteConfiguration()) {
 		return;
 	}
 	// todo: technically we need a lock here, realistically we should be fine.
 	needToWriteConfiguration = false;
 	scheduleMsg(logger, "Writing pending configuration");
 	writeToFlashNow();
+#endif /* EFI_CONFIG_LOG_FLASH */
 }
 
 void writeToFlashNow(void) {
+#if EFI_CONFIG_LOG_FLASH
+	writeToFlashLog(true);
+#else
 	scheduleMsg(logger, " !!!!!!!!!!!!!!!!!!!! BE SURE NOT WRITE WITH IGNITION ON !!!!!!!!!!!!!!!!!!!!");
 	persistentState.size = PERSISTENT_SIZE;
 	persistentState.version = FLASH_DATA_VERSION;
@@ -100,6 +185,7 @@ void writeToFlashNow(void) {
 	} else {
 		scheduleMsg(logger, "Flashing failed");
 	}
+#endif /* EFI_CONFIG_LOG_FLASH */
 	assertEngineReference();
 	resetMaxValues();
 }
@@ -135,7 +221,25 @@ static persisted_configuration_state_e doReadConfiguration(flashaddr_t address,
  */
 persisted_configuration_state_e readConfiguration(Logging * logger) {
 	efiAssert(CUSTOM_ERR_ASSERT, getCurrentRemainingStack() > 256, "read f", PC_ERROR);
-	persisted_configuration_state_e result = doReadConfiguration(FLASH_ADDR, logger);
+	persisted_configuration_state_e result;
+#if EFI_CONFIG_LOG_FLASH
+	efiAssert(CUSTOM_ERR_ASSERT, isSeparateFlashLogRegions(), "flash log sectors", PC_ERROR);
+	// this runs before initFlash()
+	flashLog.init(&internalFlash, FLASH_ADDR_SECOND_COPY, FLASH_ADDR, FLASH_LOG_REGION_SIZE, FLASH_DATA_VERSION,
+			sizeof(persistent_config_s));
+	flash_log_result_e logResult = flashLog.recover(&persistentState.persistentConfiguration);
+	if (logResult == FL_OK) {
+		updateContainer();
+		result = PC_OK;
+	} else if (logResult == FL_INCOMPATIBLE_VERSION) {
+		result = INCOMPATIBLE_VERSION;
+	} else {
+		// no log yet, first compaction would go into the sector of second copy so primary copy survives it
+		result = doReadConfiguration(FLASH_ADDR, logger);
+	}
+#else
+	result = doReadConfiguration(FLASH_ADDR, logger);
+#endif /* EFI_CONFIG_LOG_FLASH */
 	if (result != PC_OK) {
 		printMsg(logger, "Reading second configuration copy");
 		result = doReadConfiguration(FLASH_ADDR_SECOND_COPY, logger);
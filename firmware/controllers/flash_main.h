@@ -30,6 +30,9 @@ void initFlash(Logging *sharedLogger);
  * frozen while we are writing to internal flash. Writing the configuration takes
  * about 1-2 seconds, we cannot afford to do that while the engine is
  * running so we postpone the write until the engine is stopped.
+ *
+ * With EFI_CONFIG_LOG_FLASH only changed pages are appended, that takes milliseconds and
+ * is done right away; only compaction, which erases a sector, waits for engine stop.
  */
 void writeToFlashNow(void);
 void setNeedToWriteConfiguration(void);
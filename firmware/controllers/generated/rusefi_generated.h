@@ -1332,6 +1332,7 @@
 #define LDS_ENGINE_STATE_INDEX 3
 #define LDS_FUEL_TRIM_INDEX 4
 #define LDS_IAT_INDEX 1
+#define LDS_SCHEDULER_INDEX 7
 #define LDS_SPEED_DENSITY_INDEX 2
 #define LDS_TPS_TPS_ENEICHMENT_INDEX 5
 #define LDS_TRIGGER_INDEX 6
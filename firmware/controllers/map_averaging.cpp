@@ -25,10 +25,72 @@
 #include "os_access.h"
 
 #include "map.h"
+#include "map_averaging.h"
+
+#define MAP_AVERAGING_MEMORY_BARRIER() __sync_synchronize()
+
+MapAverager::MapAverager() {
+	memset(sums, 0, sizeof(sums));
+	readIndex = 0;
+	memset(windowStart, 0, sizeof(windowStart));
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		isWindowOpen[i] = false;
+		cylinderAdc[i] = NAN;
+	}
+}
+
+void MapAverager::addSample(uint16_t adcValue) {
+	int readIndexLocal = readIndex;
+	int writeIndex = readIndexLocal ^ 1;
+	sums[writeIndex].sum = sums[readIndexLocal].sum + adcValue;
+	sums[writeIndex].count = sums[readIndexLocal].count + 1;
+	MAP_AVERAGING_MEMORY_BARRIER();
+	// this would commit the new pair of values
+	readIndex = writeIndex;
+}
+
+/**
+ * If the writer preempts us while we copy, index would change and we try again. Writer would
+ * need two samples within these few instructions to fool this check.
+ */
+map_running_sum_s MapAverager::getRunningSum() const {
+	map_running_sum_s result;
+	int index;
+	do {
+		index = readIndex;
+		MAP_AVERAGING_MEMORY_BARRIER();
+		result = sums[index];
+		MAP_AVERAGING_MEMORY_BARRIER();
+	} while (index != readIndex);
+	return result;
+}
+
+void MapAverager::startWindow(int cylinderIndex) {
+	windowStart[cylinderIndex] = getRunningSum();
+	isWindowOpen[cylinderIndex] = true;
+}
+
+int MapAverager::endWindow(int cylinderIndex) {
+	if (!isWindowOpen[cylinderIndex]) {
+		return 0;
+	}
+	isWindowOpen[cylinderIndex] = false;
+	map_running_sum_s end = getRunningSum();
+	// unsigned math handles counter wrap-around
+	uint32_t count = end.count - windowStart[cylinderIndex].count;
+	if (count == 0) {
+		return 0;
+	}
+	cylinderAdc[cylinderIndex] = (float) (end.sum - windowStart[cylinderIndex].sum) / count;
+	return count;
+}
+
+float MapAverager::getCylinderAdc(int cylinderIndex) const {
+	return cylinderAdc[cylinderIndex];
+}
 
 #if EFI_MAP_AVERAGING
 
-#include "map_averaging.h"
 #include "trigger_central.h"
 #include "adc_inputs.h"
 #include "allsensors.h"
@@ -59,20 +121,10 @@ static volatile int measurementsPerRevolutionCounter = 0;
  */
 static volatile int measurementsPerRevolution = 0;
 
-/**
- * In this lock-free implementation 'readIndex' is always pointing
- * to the consistent copy of accumulator and counter pair
- */
-static int readIndex = 0;
-static float accumulators[2];
-static int counters[2];
+static MapAverager mapAverager;
 
 /**
- * Running MAP accumulator - sum of all measurements within averaging window
- */
-static volatile float mapAdcAccumulator = 0;
-/**
- * Running counter of measurements to consider for averaging
+ * Number of measurements within last complete averaging window
  */
 static volatile int mapMeasurementsCounter = 0;
 
@@ -102,24 +154,9 @@ EXTERN_ENGINE
 static scheduling_s startTimer[INJECTION_PIN_COUNT][2];
 static scheduling_s endTimer[INJECTION_PIN_COUNT][2];
 
-/**
- * that's a performance optimization: let's not bother averaging
- * if we are outside of of the window
- */
-static bool isAveraging = false;
-
 static void startAveraging(void *arg) {
-	(void) arg;
 	efiAssertVoid(CUSTOM_ERR_6649, getCurrentRemainingStack() > 128, "lowstck#9");
-	bool wasLocked = lockAnyContext();
-	;
-	// with locking we would have a consistent state
-	mapAdcAccumulator = 0;
-	mapMeasurementsCounter = 0;
-	isAveraging = true;
-	if (!wasLocked)
-		unlockAnyContext();
-	;
+	mapAverager.startWindow((intptr_t) arg);
 	mapAveragingPin.setHigh();
 }
 
@@ -130,9 +167,8 @@ static void startAveraging(void *arg) {
  * as fast as possible
  */
 void mapAveragingAdcCallback(adcsample_t adcValue) {
-	if (!isAveraging && ENGINE(sensorChartMode) != SC_MAP) {
-		return;
-	}
+	// no window check here: running sum is cheaper than any locking and windows could overlap
+	mapAverager.addSample(adcValue);
 
 	/* Calculates the average values from the ADC samples.*/
 	measurementsPerRevolutionCounter++;
@@ -150,41 +186,22 @@ void mapAveragingAdcCallback(adcsample_t adcValue) {
 		}
 	}
 #endif /* EFI_SENSOR_CHART */
-
-	/**
-	 * Local copy is now safe, but it's an overkill: we only
-	 * have one writing thread anyway
-	 */
-	int readIndexLocal = readIndex;
-	int writeIndex = readIndexLocal ^ 1;
-	accumulators[writeIndex] = accumulators[readIndexLocal] + adcValue;
-	counters[writeIndex] = counters[readIndexLocal] + 1;
-	// this would commit the new pair of values
-	readIndex = writeIndex;
-
-	// todo: migrate to the lock-free implementation
-	bool alreadyLocked = lockAnyContext();
-	;
-	// with locking we would have a consistent state
-
-	mapAdcAccumulator += adcValue;
-	mapMeasurementsCounter++;
-	if (!alreadyLocked)
-		unlockAnyContext();
-	;
 }
 #endif
 
+/**
+ * Only scheduler callbacks write here so no locking is needed, readers see either old or new float
+ */
 static void endAveraging(void *arg) {
-	(void) arg;
-	bool wasLocked = lockAnyContext();
-	isAveraging = false;
-	// with locking we would have a consistent state
 #if HAL_USE_ADC
-	if (mapMeasurementsCounter > 0) {
-		v_averagedMapValue = adcToVoltsDivided(mapAdcAccumulator / mapMeasurementsCounter);
-		// todo: move out of locked context?
-		averagedMapRunningBuffer[averagedMapBufIdx] = getMapByVoltage(v_averagedMapValue);
+	int cylinderIndex = (intptr_t) arg;
+	int count = mapAverager.endWindow(cylinderIndex);
+	if (count > 0) {
+		mapMeasurementsCounter = count;
+		v_averagedMapValue = adcToVoltsDivided(mapAverager.getCylinderAdc(cylinderIndex));
+		float pressure = getMapByVoltage(v_averagedMapValue);
+		ENGINE(engineState.mapPerCylinder[cylinderIndex]) = pressure;
+		averagedMapRunningBuffer[averagedMapBufIdx] = pressure;
 		// increment circular running buffer index
 		averagedMapBufIdx = (averagedMapBufIdx + 1) % mapMinBufferLength;
 		// find min. value (only works for pressure values, not raw voltages!)
@@ -197,10 +214,9 @@ static void endAveraging(void *arg) {
 	} else {
 		warning(CUSTOM_UNEXPECTED_MAP_VALUE, "No MAP values");
 	}
+#else
+	UNUSED(arg);
 #endif
-	if (!wasLocked)
-		unlockAnyContext();
-	;
 	mapAveragingPin.setLow();
 }
 
@@ -245,6 +261,8 @@ void refreshMapAveragingPreCalc(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	} else {
 		for (int i = 0; i < engineConfiguration->specs.cylindersCount; i++) {
 			engine->engineState.mapAveragingStart[i] = NAN;
+			// stale values are no good for fuel math once engine has stopped
+			engine->engineState.mapPerCylinder[i] = NAN;
 		}
 		engine->engineState.mapAveragingDuration = NAN;
 	}
@@ -301,9 +319,9 @@ static void mapAveragingTriggerCallback(trigger_event_e ckpEventType,
 		int structIndex = engine->rpmCalculator.getRevolutionCounter() % 2;
 		// todo: schedule this based on closest trigger event, same as ignition works
 		scheduleByAngle(rpm, &startTimer[i][structIndex], samplingStart,
-				startAveraging, NULL, &engine->rpmCalculator);
+				startAveraging, (void *) (intptr_t) i, &engine->rpmCalculator);
 		scheduleByAngle(rpm, &endTimer[i][structIndex], samplingEnd,
-				endAveraging, NULL, &engine->rpmCalculator);
+				endAveraging, (void *) (intptr_t) i, &engine->rpmCalculator);
 		engine->m.mapAveragingCbTime = getTimeNowLowerNt()
 				- engine->m.beforeMapAveragingCb;
 	}
@@ -312,6 +330,9 @@ static void mapAveragingTriggerCallback(trigger_event_e ckpEventType,
 
 static void showMapStats(void) {
 	scheduleMsg(logger, "per revolution %d", measurementsPerRevolution);
+	for (int i = 0; i < engineConfiguration->specs.cylindersCount; i++) {
+		scheduleMsg(logger, "cylinder %d MAP %.2f", i, engine->engineState.mapPerCylinder[i]);
+	}
 }
 
 #if EFI_PROD_CODE
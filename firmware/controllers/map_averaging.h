@@ -10,6 +10,50 @@
 
 #include "engine.h"
 
+typedef struct {
+	uint32_t sum;
+	uint32_t count;
+} map_running_sum_s;
+
+/**
+ * Lock-free MAP window averaging.
+ *
+ * Fast ADC callback is the only writer and it only adds each sample to a running sum. Window
+ * start and end events take a consistent snapshot of that sum, so average over any window is
+ * the difference of two snapshots. Windows of different cylinders could overlap and nobody ever
+ * resets the accumulator from another context.
+ */
+class MapAverager {
+public:
+	MapAverager();
+	/**
+	 * fast ADC context
+	 */
+	void addSample(uint16_t adcValue);
+	/**
+	 * start and end are invoked from the same context, scheduler callbacks
+	 */
+	void startWindow(int cylinderIndex);
+	/**
+	 * @return number of samples in this window, result is not updated if there were none
+	 */
+	int endWindow(int cylinderIndex);
+	/**
+	 * @return average raw ADC value within last complete window of this cylinder, NAN if none yet
+	 */
+	float getCylinderAdc(int cylinderIndex) const;
+	map_running_sum_s getRunningSum() const;
+private:
+	/**
+	 * 'readIndex' is always pointing to the consistent copy, writer fills the other one
+	 */
+	map_running_sum_s sums[2];
+	volatile int readIndex;
+	map_running_sum_s windowStart[INJECTION_PIN_COUNT];
+	bool isWindowOpen[INJECTION_PIN_COUNT];
+	volatile float cylinderAdc[INJECTION_PIN_COUNT];
+};
+
 #if EFI_MAP_AVERAGING
 
 #if HAL_USE_ADC
@@ -108,16 +108,14 @@ void FuelSchedule::clear() {
 }
 
 /**
- * @returns false in case of error, true if success
+ * @return angle of injection start within engine cycle, NAN if we do not have enough data yet
  */
-bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	efiAssert(CUSTOM_ERR_ASSERT, engine!=NULL, "engine is NULL", false);
-
+angle_t getInjectionStartAngle(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	floatus_t oneDegreeUs = ENGINE(rpmCalculator.oneDegreeUs); // local copy
 	if (cisnan(oneDegreeUs)) {
 		// in order to have fuel schedule we need to have current RPM
 		// wonder if this line slows engine startup?
-		return false;
+		return NAN;
 	}
 
 	/**
@@ -128,19 +126,53 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 	 * engineState.injectionOffset is calculated from the same utility timer should we more that logic here?
 	 */
 	floatms_t fuelMs = ENGINE(injectionDuration);
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(fuelMs), "NaN fuelMs", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(fuelMs), "NaN fuelMs", NAN);
 	angle_t injectionDuration = MS2US(fuelMs) / oneDegreeUs;
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(injectionDuration), "NaN injectionDuration", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(injectionDuration), "NaN injectionDuration", NAN);
 	assertAngleRange(injectionDuration, "injectionDuration_r", CUSTOM_INJ_DURATION);
 	floatus_t injectionOffset = ENGINE(engineState.injectionOffset);
 	if (cisnan(injectionOffset)) {
 		// injection offset map not ready - we are not ready to schedule fuel events
-		return false;
+		return NAN;
 	}
 	angle_t baseAngle = injectionOffset - injectionDuration;
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(baseAngle), "NaN baseAngle", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(baseAngle), "NaN baseAngle", NAN);
 	assertAngleRange(baseAngle, "baseAngle_r", CUSTOM_ERR_6554);
 
+	assertAngleRange(baseAngle, "addFbaseAngle", CUSTOM_ADD_BASE);
+
+	int cylindersCount = CONFIG(specs.cylindersCount);
+	if (cylindersCount < 1) {
+		warning(CUSTOM_OBD_ZERO_CYLINDER_COUNT, "temp cylindersCount %d", cylindersCount);
+		return NAN;
+	}
+
+	float angle = baseAngle
+			+ cylinderIndex * ENGINE(engineCycle) / cylindersCount;
+	fixAngle(angle, "addFuel#1", CUSTOM_ERR_6554);
+	return angle;
+}
+
+/**
+ * @returns false in case of error, true if success
+ */
+bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	efiAssert(CUSTOM_ERR_ASSERT, engine!=NULL, "engine is NULL", false);
+
+	/**
+	 * if available, angles pre-calculated by OutputScheduleBuffer outside of trigger/scheduler interrupts are used
+	 */
+	const output_schedule_s *schedule = ENGINE(outputSchedule).getActive();
+	bool isBuffered = schedule->isInjectionReady && schedule->cylindersCount == CONFIG(specs.cylindersCount);
+
+	angle_t angle = 0;
+	if (!isBuffered) {
+		angle = getInjectionStartAngle(i PASS_ENGINE_PARAMETER_SUFFIX);
+		if (cisnan(angle)) {
+			return false;
+		}
+	}
+
 	int injectorIndex;
 
 	injection_mode_e mode = engine->getCurrentInjectionMode(PASS_ENGINE_PARAMETER_SIGNATURE);
@@ -159,17 +191,6 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 
 	bool isSimultanious = mode == IM_SIMULTANEOUS;
 
-	assertAngleRange(baseAngle, "addFbaseAngle", CUSTOM_ADD_BASE);
-
-	int cylindersCount = CONFIG(specs.cylindersCount);
-	if (cylindersCount < 1) {
-		warning(CUSTOM_OBD_ZERO_CYLINDER_COUNT, "temp cylindersCount %d", cylindersCount);
-		return false;
-	}
-
-	float angle = baseAngle
-			+ i * ENGINE(engineCycle) / cylindersCount;
-
 	InjectorOutputPin *secondOutput;
 	if (mode == IM_BATCH && CONFIG(twoWireBatchInjection)) {
 		/**
@@ -193,7 +214,6 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 #if EFI_UNIT_TEST
 	ev->engine = engine;
 #endif
-	fixAngle(angle, "addFuel#1", CUSTOM_ERR_6554);
 
 	ev->outputs[0] = output;
 	ev->outputs[1] = secondOutput;
@@ -205,9 +225,14 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 		return false;
 	}
 
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(angle), "findAngle#3", false);
-	assertAngleRange(angle, "findAngle#a33", CUSTOM_ERR_6544);
-	TRIGGER_SHAPE(findTriggerPosition(&ev->injectionStart, angle PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	if (isBuffered) {
+		ev->injectionStart = schedule->injectionStart[i];
+	} else {
+		efiAssert(CUSTOM_ERR_ASSERT, !cisnan(angle), "findAngle#3", false);
+		assertAngleRange(angle, "findAngle#a33", CUSTOM_ERR_6544);
+		TRIGGER_SHAPE(findTriggerPosition(&ev->injectionStart, angle PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	}
+	dispatch.setEventIndex(i, ev->injectionStart.eventIndex);
 #if EFI_UNIT_TEST
 	printf("registerInjectionEvent angle=%.2f trgIndex=%d inj %d\r\n", angle, ev->injectionStart.eventIndex, injectorIndex);
 #endif
@@ -38,180 +38,126 @@
 #include "engine_math.h"
 #include "fuel_math.h"
 
-extern CANTxFrame txmsg;
+#include "obd2_server.h"
+#include "error_handling.h"
 
 EXTERN_ENGINE
 ;
 
 static LoggingWithStorage logger("obd2");
 
-static const int16_t supportedPids0120[] = { 
-	PID_MONITOR_STATUS,
-	PID_FUEL_SYSTEM_STATUS,
-	PID_ENGINE_LOAD,
-	PID_COOLANT_TEMP,
-	PID_INTAKE_MAP,
-	PID_RPM,
-	PID_SPEED,
-	PID_TIMING_ADVANCE,
-	PID_INTAKE_TEMP,
-	PID_THROTTLE,
-	-1
-};
+static Obd2Server obd2Server;
 
-static const int16_t supportedPids2140[] = {
-	-1
-};
+static char calibrationId[OBD_CALIBRATION_ID_SIZE + 1];
+
+static float getMonitorStatus(void) {
+	// todo: add statuses
+	return 0;
+}
+
+static float getFuelSystemStatus(void) {
+	// 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
+	// todo: add statuses
+	return (2 << 8) | 0;
+}
+
+static float getEngineLoad(void) {
+	return getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float getCoolantTemperature(void) {
+	return engine->sensors.clt;
+}
+
+static float getIntakeMap(void) {
+	return getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float getRpm(void) {
+	return GET_RPM();
+}
+
+static float getTimingAdvance(void) {
+	float timing = engine->engineState.timingAdvance;
+	return (timing > 360.0f) ? (timing - 720.0f) : timing;
+}
+
+static float getIntakeTemperature(void) {
+	return engine->sensors.iat;
+}
+
+static float getMaf(void) {
+	return getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float getThrottle(void) {
+	return getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
 
-static const int16_t supportedPids4160[] = { 
-	PID_FUEL_RATE,
-	-1
+static float getFuelRate(void) {
+	return engine->engineState.fuelConsumption.perSecondConsumption;
+}
+
+/**
+ * Raw = (value + offset) * scale, see http://en.wikipedia.org/wiki/OBD-II_PIDs for formulas
+ */
+static const obd_pid_s obdPids[] = {
+	{ PID_MONITOR_STATUS, 4, 0, 1, getMonitorStatus },
+	{ PID_FUEL_SYSTEM_STATUS, 2, 0, 1, getFuelSystemStatus },
+	// (A*100/255)
+	{ PID_ENGINE_LOAD, 1, 0, 2.55f, getEngineLoad },
+	{ PID_COOLANT_TEMP, 1, 40, 1, getCoolantTemperature },
+	{ PID_INTAKE_MAP, 1, 0, 1, getIntakeMap },
+	// rotation/min.	(A*256+B)/4
+	{ PID_RPM, 2, 0, 4, getRpm },
+	{ PID_SPEED, 1, 0, 1, getVehicleSpeed },
+	// angle before TDC.	(A/2)-64
+	{ PID_TIMING_ADVANCE, 1, 64, 2, getTimingAdvance },
+	{ PID_INTAKE_TEMP, 1, 40, 1, getIntakeTemperature },
+	// grams/sec	(A*256+B)/100
+	{ PID_INTAKE_MAF, 2, 0, 100, getMaf },
+	// (A*100/255)
+	{ PID_THROTTLE, 1, 0, 2.55f, getThrottle },
+	// L/h.	(A*256+B)/20
+	{ PID_FUEL_RATE, 2, 0, 20, getFuelRate },
 };
 
-static void obdSendPacket(int mode, int PID, int numBytes, uint32_t iValue) {
-	commonTxInit(OBD_TEST_RESPONSE);
-
-	// write number of bytes
-	txmsg.data8[0] = (uint8_t)(2 + numBytes);
-	// write 2 bytes of header
-	txmsg.data8[1] = (uint8_t)(0x40 + mode);
-	txmsg.data8[2] = (uint8_t)PID;
-	// write N data bytes
-	for (int i = 8 * (numBytes - 1), j = 3; i >= 0; i -= 8, j++) {
-		txmsg.data8[j] = (uint8_t)((iValue >> i) & 0xff);
-	}
-	
-	sendCanMessage();
-}
-
-static void obdSendValue(int mode, int PID, int numBytes, float value) {
-	efiAssertVoid(CUSTOM_ERR_6662, numBytes <= 2, "invalid numBytes");
-	int iValue = (int)efiRound(value, 1.0f);
-	// clamp to uint8_t (0..255) or uint16_t (0..65535)
-	iValue = maxI(minI(iValue, (numBytes == 1) ? 255 : 65535), 0);
-	obdSendPacket(mode, PID, numBytes, iValue);
-}
-
-
-//#define MOCK_SUPPORTED_PIDS 0xffffffff
-
-static void obdWriteSupportedPids(int PID, int bitOffset, const int16_t *supportedPids) {
-	uint32_t value = 0;
-	// gather all 32 bit fields
-	for (int i = 0; i < 32 && supportedPids[i] > 0; i++)
-		value |= 1 << (31 + bitOffset - supportedPids[i]);
-
-#ifdef MOCK_SUPPORTED_PIDS
-	// for OBD debug
-	value = MOCK_SUPPORTED_PIDS;
-#endif
-
-	scheduleMsg(&logger, "Write bitfields 0x%08x", value);
-	obdSendPacket(1, PID, 4, value);
-}
-
-static void handleGetDataRequest(CANRxFrame *rx) {
-	int pid = rx->data8[2];
-	switch (pid) {
-	case PID_SUPPORTED_PIDS_REQUEST_01_20:
-		scheduleMsg(&logger, "Got lookup request 01-20");
-		obdWriteSupportedPids(pid, 1, supportedPids0120);
-		break;
-	case PID_SUPPORTED_PIDS_REQUEST_21_40:
-		scheduleMsg(&logger, "Got lookup request 21-40");
-		obdWriteSupportedPids(pid, 21, supportedPids2140);
-		break;
-	case PID_SUPPORTED_PIDS_REQUEST_41_60:
-		scheduleMsg(&logger, "Got lookup request 41-60");
-		obdWriteSupportedPids(pid, 41, supportedPids4160);
-		break;
-	case PID_MONITOR_STATUS:
-		scheduleMsg(&logger, "Got monitor status request");
-		obdSendPacket(1, pid, 4, 0);	// todo: add statuses
-		break;
-	case PID_FUEL_SYSTEM_STATUS:
-		scheduleMsg(&logger, "Got fuel system status request");
-		// todo: add statuses
-		obdSendValue(1, pid, 2, (2<<8)|(0));	// 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
-		break;
-	case PID_ENGINE_LOAD:
-		scheduleMsg(&logger, "Got engine load request");
-		obdSendValue(1, pid, 1, getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE) * 2.55f);
-		break;
-	case PID_COOLANT_TEMP:
-		scheduleMsg(&logger, "Got CLT request");
-		obdSendValue(1, pid, 1, engine->sensors.clt + 40.0f);
-		break;
-	case PID_INTAKE_MAP:
-		scheduleMsg(&logger, "Got MAP request");
-		obdSendValue(1, pid, 1, getMap(PASS_ENGINE_PARAMETER_SIGNATURE));
-		break;
-	case PID_RPM:
-		scheduleMsg(&logger, "Got RPM request");
-		obdSendValue(1, pid, 2, GET_RPM() * 4.0f);	//	rotation/min.	(A*256+B)/4
-		break;
-	case PID_SPEED:
-		scheduleMsg(&logger, "Got speed request");
-		obdSendValue(1, pid, 1, getVehicleSpeed());
-		break;
-	case PID_TIMING_ADVANCE: {
-		scheduleMsg(&logger, "Got timing request");
-		float timing = engine->engineState.timingAdvance;
-		timing = (timing > 360.0f) ? (timing - 720.0f) : timing;
-		obdSendValue(1, pid, 1, (timing + 64.0f) * 2.0f);		// angle before TDC.	(A/2)-64
-		break;
+/**
+ * Stored and pending DTCs are the same recent warnings for now
+ */
+static int getDtcs(uint16_t *codes, int capacity) {
+	WarningCodeState *warnings = &engine->engineState.warnings;
+	int count = 0;
+	int recentCount = minI(warnings->recentWarnings.getCount(), warnings->recentWarnings.getSize());
+	for (int i = 0; i < recentCount && count < capacity; i++) {
+		uint16_t dtc = obdCodeToDtc(warnings->recentWarnings.get(i));
+		if (dtc != 0) {
+			codes[count++] = dtc;
 		}
-	case PID_INTAKE_TEMP:
-		scheduleMsg(&logger, "Got IAT request");
-		obdSendValue(1, pid, 1, engine->sensors.iat + 40.0f);
-		break;
-	case PID_INTAKE_MAF:
-		scheduleMsg(&logger, "Got MAF request");
-		obdSendValue(1, pid, 2, getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE) * 100.0f);	// grams/sec	(A*256+B)/100
-		break;
-	case PID_THROTTLE:
-		scheduleMsg(&logger, "Got throttle request");
-		obdSendValue(1, pid, 1, getTPS(PASS_ENGINE_PARAMETER_SIGNATURE) * 2.55f);	// (A*100/255)
-		break;
-	case PID_FUEL_RATE:
-		scheduleMsg(&logger, "Got fuel rate request");
-		obdSendValue(1, pid, 2, engine->engineState.fuelConsumption.perSecondConsumption * 20.0f);	//	L/h.	(A*256+B)/20
-		break;
-	default:
-		scheduleMsg(&logger, "Got unhandled request (PID 0x%02x)", pid);
 	}
-	
+	return count;
 }
 
-static void handleDtcRequest(int numCodes, int *dtcCode) {
-	int numBytes = numCodes * 2;
-	// write CAN-TP Single Frame header?
-	txmsg.data8[0] = (uint8_t)((0 << 4) | numBytes);
-	for (int i = 0, j = 1; i < numCodes; i++) {
-		txmsg.data8[j++] = (uint8_t)((dtcCode[i] >> 8) & 0xff);
-		txmsg.data8[j++] = (uint8_t)(dtcCode[i] & 0xff);
-	}
+static void obdInfo(void) {
+	scheduleMsg(&logger, "OBD requests=%d unsupported=%d", obd2Server.requestCounter, obd2Server.unsupportedCounter);
+	scheduleMsg(&logger, "ISO-TP timeouts=%d aborted=%d", obd2Server.isoTp.timeoutCounter, obd2Server.isoTp.abortCounter);
 }
 
-#if HAL_USE_CAN
-void obdOnCanPacketRx(CANRxFrame *rx) {
-	if (rx->SID != OBD_TEST_REQUEST) {
-		return;
-	}
-	if (rx->data8[0] == 2 && rx->data8[1] == OBD_CURRENT_DATA) {
-		handleGetDataRequest(rx);
-	} else if (rx->data8[0] == 1 && rx->data8[1] == OBD_STORED_DIAGNOSTIC_TROUBLE_CODES) {
-		scheduleMsg(&logger, "Got stored DTC request");
-		// todo: implement stored/pending difference?
-		handleDtcRequest(1, &engine->engineState.warnings.lastErrorCode);
-	} else if (rx->data8[0] == 1 && rx->data8[1] == OBD_PENDING_DIAGNOSTIC_TROUBLE_CODES) {
-		scheduleMsg(&logger, "Got pending DTC request");
-		// todo: implement stored/pending difference?
-		handleDtcRequest(1, &engine->engineState.warnings.lastErrorCode);
-	} else {
-		scheduleMsg(&logger, "Got unhandled OBD message");
-	}
+void initObd2(CanBus *bus) {
+	chsnprintf(calibrationId, sizeof(calibrationId), "rusEFI %d", getRusEfiVersion());
+	obd2Server.init(bus, obdPids, sizeof(obdPids) / sizeof(obdPids[0]));
+	obd2Server.setVehicleInfo(NULL, calibrationId, "rusEFI");
+	obd2Server.setDtcGetter(getDtcs);
+	obd2Server.addRxHandlers(bus);
+	addConsoleAction("obdinfo", obdInfo);
+}
+
+void updateObd2(efitimems_t nowMs) {
+	obd2Server.update(nowMs);
+}
+
+int getObd2NextDelayMs(efitimems_t nowMs) {
+	return obd2Server.getNextDelayMs(nowMs);
 }
-#endif /* HAL_USE_CAN */
 
 #endif /* EFI_CAN_SUPPORT */
@@ -9,14 +9,7 @@
 #define CONTROLLERS_OBD2_H_
 
 #include "global.h"
-
-#define OBD_TEST_REQUEST 0x7DF
-
-#define OBD_TEST_RESPONSE 0x7E8
-
-#define OBD_CURRENT_DATA 1
-#define OBD_STORED_DIAGNOSTIC_TROUBLE_CODES 3
-#define OBD_PENDING_DIAGNOSTIC_TROUBLE_CODES 7
+#include "can_bus.h"
 
 #define PID_SUPPORTED_PIDS_REQUEST_01_20 0x00
 #define PID_MONITOR_STATUS 0x01
@@ -37,8 +30,14 @@
 #define PID_SUPPORTED_PIDS_REQUEST_41_60 0x40
 #define PID_FUEL_RATE 0x5E
 
-#if HAL_USE_CAN
-void obdOnCanPacketRx(CANRxFrame *rx);
-#endif /* HAL_USE_CAN */
+/**
+ * Registers OBD request handlers, has to be invoked before the bus is started
+ */
+void initObd2(CanBus *bus);
+/**
+ * invoked from CAN thread
+ */
+void updateObd2(efitimems_t nowMs);
+int getObd2NextDelayMs(efitimems_t nowMs);
 
 #endif /* CONTROLLERS_OBD2_H_ */
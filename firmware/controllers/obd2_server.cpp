@@ -0,0 +1,362 @@
+/**
+ * @file obd2_server.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "obd2_server.h"
+
+#define ISOTP_SINGLE_FRAME_MAX 7
+#define ISOTP_FIRST_FRAME_DATA 6
+#define ISOTP_CONSECUTIVE_FRAME_DATA 7
+
+IsoTpSender::IsoTpSender() {
+	bus = NULL;
+	txId = 0;
+	state = ISOTP_IDLE;
+	size = 0;
+	offset = 0;
+	sequence = 0;
+	blockSize = 0;
+	blockRemaining = 0;
+	separationMs = 0;
+	nextMs = 0;
+	timeoutCounter = 0;
+	abortCounter = 0;
+}
+
+void IsoTpSender::init(CanBus *bus, uint32_t txId) {
+	this->bus = bus;
+	this->txId = txId;
+}
+
+isotp_state_e IsoTpSender::getState() const {
+	return state;
+}
+
+void IsoTpSender::send(const uint8_t *data, int size, efitimems_t nowMs) {
+	if (state != ISOTP_IDLE) {
+		abortCounter++;
+	}
+	size = minI(size, ISOTP_MAX_SIZE);
+	can_frame_s frame;
+	initCanFrame(&frame, txId);
+	if (size <= ISOTP_SINGLE_FRAME_MAX) {
+		frame.data8[0] = (ISOTP_SINGLE_FRAME << 4) | size;
+		memcpy(frame.data8 + 1, data, size);
+		bus->transmit(&frame);
+		state = ISOTP_IDLE;
+		return;
+	}
+	memcpy(buffer, data, size);
+	this->size = size;
+	frame.data8[0] = (ISOTP_FIRST_FRAME << 4) | (size >> 8);
+	frame.data8[1] = size & 0xFF;
+	memcpy(frame.data8 + 2, data, ISOTP_FIRST_FRAME_DATA);
+	bus->transmit(&frame);
+	offset = ISOTP_FIRST_FRAME_DATA;
+	sequence = 1;
+	state = ISOTP_WAIT_FLOW_CONTROL;
+	nextMs = nowMs + ISOTP_FLOW_CONTROL_TIMEOUT_MS;
+}
+
+/**
+ * STmin of 0xF1-0xF9 is 100-900 microseconds, we could not pace that finely so it is one millisecond.
+ * Reserved values are treated as the longest separation, 0x7F, as ISO 15765-2 requires.
+ */
+static int getSeparationMs(uint8_t stMin) {
+	if (stMin <= 0x7F) {
+		return stMin;
+	}
+	if (stMin >= 0xF1 && stMin <= 0xF9) {
+		return 1;
+	}
+	return 0x7F;
+}
+
+void IsoTpSender::onFlowControl(const can_frame_s *frame, efitimems_t nowMs) {
+	if (state != ISOTP_WAIT_FLOW_CONTROL) {
+		return;
+	}
+	int flag = frame->data8[0] & 0xF;
+	if (flag == ISOTP_FLOW_CONTINUE) {
+		blockSize = frame->data8[1];
+		blockRemaining = blockSize;
+		separationMs = getSeparationMs(frame->data8[2]);
+		state = ISOTP_SENDING;
+		nextMs = nowMs;
+		update(nowMs);
+	} else if (flag == ISOTP_FLOW_WAIT) {
+		nextMs = nowMs + ISOTP_FLOW_CONTROL_TIMEOUT_MS;
+	} else {
+		abortCounter++;
+		state = ISOTP_IDLE;
+	}
+}
+
+void IsoTpSender::sendConsecutiveFrame() {
+	can_frame_s frame;
+	initCanFrame(&frame, txId);
+	frame.data8[0] = (ISOTP_CONSECUTIVE_FRAME << 4) | sequence;
+	int length = minI(ISOTP_CONSECUTIVE_FRAME_DATA, size - offset);
+	memcpy(frame.data8 + 1, buffer + offset, length);
+	bus->transmit(&frame);
+	offset += length;
+	sequence = (sequence + 1) & 0xF;
+}
+
+void IsoTpSender::update(efitimems_t nowMs) {
+	if (state == ISOTP_WAIT_FLOW_CONTROL) {
+		if ((int32_t) (nowMs - nextMs) >= 0) {
+			timeoutCounter++;
+			state = ISOTP_IDLE;
+		}
+		return;
+	}
+	while (state == ISOTP_SENDING && (int32_t) (nowMs - nextMs) >= 0) {
+		sendConsecutiveFrame();
+		if (offset >= size) {
+			state = ISOTP_IDLE;
+			return;
+		}
+		if (blockSize > 0 && --blockRemaining == 0) {
+			state = ISOTP_WAIT_FLOW_CONTROL;
+			nextMs = nowMs + ISOTP_FLOW_CONTROL_TIMEOUT_MS;
+			return;
+		}
+		nextMs = nowMs + separationMs;
+	}
+}
+
+int IsoTpSender::getNextDelayMs(efitimems_t nowMs) const {
+	if (state == ISOTP_IDLE) {
+		return ISOTP_FLOW_CONTROL_TIMEOUT_MS;
+	}
+	return maxI(0, (int32_t) (nextMs - nowMs));
+}
+
+uint16_t obdCodeToDtc(int code) {
+	if (code <= 0 || code > 3999) {
+		return 0;
+	}
+	return ((code / 1000) << 12) | ((code / 100 % 10) << 8) | ((code / 10 % 10) << 4) | (code % 10);
+}
+
+Obd2Server::Obd2Server() {
+	pids = NULL;
+	pidCount = 0;
+	vin = NULL;
+	calibrationId = NULL;
+	ecuName = NULL;
+	getDtcs = NULL;
+	nowMs = 0;
+	requestCounter = 0;
+	unsupportedCounter = 0;
+}
+
+void Obd2Server::init(CanBus *bus, const obd_pid_s *pids, int pidCount) {
+	this->pids = pids;
+	this->pidCount = pidCount;
+	isoTp.init(bus, OBD_ECU_RESPONSE);
+}
+
+static void onObdFrame(const can_frame_s *frame, void *arg) {
+	((Obd2Server *) arg)->onRxFrame(frame);
+}
+
+void Obd2Server::addRxHandlers(CanBus *bus) {
+	bus->addRxHandler(OBD_FUNCTIONAL_REQUEST, CAN_STD_ID_MASK, false, onObdFrame, this);
+	bus->addRxHandler(OBD_PHYSICAL_REQUEST, CAN_STD_ID_MASK, false, onObdFrame, this);
+}
+
+void Obd2Server::setVehicleInfo(const char *vin, const char *calibrationId, const char *ecuName) {
+	this->vin = vin;
+	this->calibrationId = calibrationId;
+	this->ecuName = ecuName;
+}
+
+void Obd2Server::setDtcGetter(obd_dtc_getter_f getDtcs) {
+	this->getDtcs = getDtcs;
+}
+
+void Obd2Server::update(efitimems_t nowMs) {
+	this->nowMs = nowMs;
+	isoTp.update(nowMs);
+}
+
+int Obd2Server::getNextDelayMs(efitimems_t nowMs) const {
+	return isoTp.getNextDelayMs(nowMs);
+}
+
+/**
+ * Only single frame requests are supported, nothing an OBD scan tool sends is longer than that
+ */
+void Obd2Server::onRxFrame(const can_frame_s *frame) {
+	int type = frame->data8[0] >> 4;
+	if (type == ISOTP_FLOW_CONTROL) {
+		isoTp.onFlowControl(frame, nowMs);
+		return;
+	}
+	int size = frame->data8[0] & 0xF;
+	if (type != ISOTP_SINGLE_FRAME || size == 0 || size > ISOTP_SINGLE_FRAME_MAX) {
+		unsupportedCounter++;
+		return;
+	}
+	requestCounter++;
+	handleRequest(frame->data8 + 1, size);
+}
+
+void Obd2Server::handleRequest(const uint8_t *data, int size) {
+	uint8_t response[ISOTP_MAX_SIZE];
+	int mode = data[0];
+	response[0] = OBD_POSITIVE_RESPONSE + mode;
+	int responseSize = 0;
+	if (mode == OBD_MODE_CURRENT_DATA) {
+		responseSize = handleCurrentData(data + 1, size - 1, response);
+	} else if (mode == OBD_MODE_STORED_DTC || mode == OBD_MODE_PENDING_DTC) {
+		responseSize = handleDtcRequest(mode, response);
+	} else if (mode == OBD_MODE_VEHICLE_INFO && size >= 2) {
+		responseSize = handleVehicleInfo(data[1], response);
+	}
+	// functional requests are answered only if there is something to say
+	if (responseSize == 0) {
+		unsupportedCounter++;
+		return;
+	}
+	isoTp.send(response, responseSize, nowMs);
+}
+
+const obd_pid_s *Obd2Server::findPid(int pid) const {
+	for (int i = 0; i < pidCount; i++) {
+		if (pids[i].pid == pid) {
+			return &pids[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Bit 31 is PID basePid+1, lowest bit says if next range has anything
+ */
+uint32_t Obd2Server::getSupportedMask(int basePid) const {
+	uint32_t mask = 0;
+	for (int i = 0; i < pidCount; i++) {
+		int pid = pids[i].pid;
+		if (pid > basePid && pid <= basePid + 0x20) {
+			mask |= 1U << (basePid + 0x20 - pid);
+		} else if (pid > basePid + 0x20) {
+			mask |= 1;
+		}
+	}
+	return mask;
+}
+
+static int writeMask(uint8_t *output, uint32_t mask) {
+	output[0] = mask >> 24;
+	output[1] = mask >> 16;
+	output[2] = mask >> 8;
+	output[3] = mask;
+	return 4;
+}
+
+int Obd2Server::encodeValue(const obd_pid_s *pid, uint8_t *output) const {
+	float raw = (pid->getValue() + pid->offset) * pid->scale;
+	float maxRaw = pid->size >= 4 ? 4294967295.0f : (float) ((1U << (8 * pid->size)) - 1);
+	uint32_t value = raw <= 0 || cisnan(raw) ? 0 : (raw >= maxRaw ? (uint32_t) maxRaw : (uint32_t) (raw + 0.5f));
+	for (int i = 0; i < pid->size; i++) {
+		output[i] = value >> (8 * (pid->size - 1 - i));
+	}
+	return pid->size;
+}
+
+/**
+ * Response is PID followed by its data, for each of requested PIDs which we support
+ */
+int Obd2Server::handleCurrentData(const uint8_t *data, int size, uint8_t *response) {
+	int responseSize = 1;
+	for (int i = 0; i < minI(size, OBD_MAX_PIDS_PER_REQUEST); i++) {
+		int pid = data[i];
+		if (pid % 0x20 == 0) {
+			uint32_t mask = getSupportedMask(pid);
+			if (mask == 0 && pid != 0) {
+				continue;
+			}
+			response[responseSize++] = pid;
+			responseSize += writeMask(response + responseSize, mask);
+			continue;
+		}
+		const obd_pid_s *entry = findPid(pid);
+		if (entry == NULL) {
+			continue;
+		}
+		response[responseSize++] = pid;
+		responseSize += encodeValue(entry, response + responseSize);
+	}
+	return responseSize == 1 ? 0 : responseSize;
+}
+
+/**
+ * Stored and pending are the same list for now
+ */
+int Obd2Server::handleDtcRequest(int mode, uint8_t *response) {
+	(void)mode;
+	uint16_t codes[OBD_MAX_DTC_COUNT];
+	int count = getDtcs == NULL ? 0 : getDtcs(codes, OBD_MAX_DTC_COUNT);
+	count = minI(count, (ISOTP_MAX_SIZE - 2) / 2);
+	response[1] = count;
+	for (int i = 0; i < count; i++) {
+		response[2 + 2 * i] = codes[i] >> 8;
+		response[3 + 2 * i] = codes[i] & 0xFF;
+	}
+	return 2 + 2 * count;
+}
+
+const char *Obd2Server::getVehicleInfoString(int pid, int *size) const {
+	switch (pid) {
+	case OBD_INFO_VIN:
+		*size = OBD_VIN_SIZE;
+		return vin;
+	case OBD_INFO_CALIBRATION_ID:
+		*size = OBD_CALIBRATION_ID_SIZE;
+		return calibrationId;
+	case OBD_INFO_ECU_NAME:
+		*size = OBD_ECU_NAME_SIZE;
+		return ecuName;
+	default:
+		*size = 0;
+		return NULL;
+	}
+}
+
+uint32_t Obd2Server::getVehicleInfoMask() const {
+	uint32_t mask = 0;
+	int size;
+	for (int pid = 1; pid <= 0x20; pid++) {
+		if (getVehicleInfoString(pid, &size) != NULL) {
+			mask |= 1U << (0x20 - pid);
+		}
+	}
+	return mask;
+}
+
+/**
+ * Strings are fixed size, shorter ones are padded with zeros
+ */
+int Obd2Server::handleVehicleInfo(int pid, uint8_t *response) {
+	response[1] = pid;
+	if (pid == OBD_INFO_SUPPORTED) {
+		return 2 + writeMask(response + 2, getVehicleInfoMask());
+	}
+	int size;
+	const char *value = getVehicleInfoString(pid, &size);
+	if (value == NULL) {
+		return 0;
+	}
+	// number of data items
+	response[2] = 1;
+	memset(response + 3, 0, size);
+	memcpy(response + 3, value, minI(size, strlen(value)));
+	return 3 + size;
+}
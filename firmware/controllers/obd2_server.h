@@ -0,0 +1,172 @@
+/**
+ * @file obd2_server.h
+ * @brief Table-driven OBD2 request handling on top of ISO 15765-2 transport
+ *
+ * Each mode 01 PID is a table entry: accessor returning the value in natural units plus
+ * offset/scale which turn it into the raw bytes, so supported PID bitmaps come from the same table.
+ * One mode 01 request could ask for up to six PIDs, all of them go into one response.
+ *
+ * Responses longer than a single frame (several PIDs, DTC list, mode 09 strings) are segmented:
+ * first frame, then consecutive frames paced by the flow control which tester sends back.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef OBD2_SERVER_H_
+#define OBD2_SERVER_H_
+
+#include "can_bus.h"
+
+#define OBD_FUNCTIONAL_REQUEST 0x7DF
+#define OBD_PHYSICAL_REQUEST 0x7E0
+#define OBD_ECU_RESPONSE 0x7E8
+
+#define OBD_MODE_CURRENT_DATA 0x01
+#define OBD_MODE_STORED_DTC 0x03
+#define OBD_MODE_PENDING_DTC 0x07
+#define OBD_MODE_VEHICLE_INFO 0x09
+#define OBD_POSITIVE_RESPONSE 0x40
+
+#define OBD_INFO_SUPPORTED 0x00
+#define OBD_INFO_VIN 0x02
+#define OBD_INFO_CALIBRATION_ID 0x04
+#define OBD_INFO_ECU_NAME 0x0A
+
+#define OBD_VIN_SIZE 17
+#define OBD_CALIBRATION_ID_SIZE 16
+#define OBD_ECU_NAME_SIZE 20
+
+/**
+ * Mode 01 allows up to six PIDs in one request
+ */
+#define OBD_MAX_PIDS_PER_REQUEST 6
+#define OBD_MAX_DTC_COUNT 16
+
+#define ISOTP_MAX_SIZE 64
+#define ISOTP_SINGLE_FRAME 0x0
+#define ISOTP_FIRST_FRAME 0x1
+#define ISOTP_CONSECUTIVE_FRAME 0x2
+#define ISOTP_FLOW_CONTROL 0x3
+#define ISOTP_FLOW_CONTINUE 0x0
+#define ISOTP_FLOW_WAIT 0x1
+#define ISOTP_FLOW_OVERFLOW 0x2
+/**
+ * N_Bs, how long we wait for flow control
+ */
+#define ISOTP_FLOW_CONTROL_TIMEOUT_MS 1000
+
+typedef float (*obd_pid_getter_f)(void);
+/**
+ * @return number of DTCs written into codes, in OBD two byte format
+ */
+typedef int (*obd_dtc_getter_f)(uint16_t *codes, int capacity);
+
+/**
+ * Raw value is (value + offset) * scale, rounded and clamped into 'size' bytes
+ */
+typedef struct {
+	uint8_t pid;
+	uint8_t size;
+	float offset;
+	float scale;
+	obd_pid_getter_f getValue;
+} obd_pid_s;
+
+typedef enum {
+	ISOTP_IDLE = 0,
+	ISOTP_WAIT_FLOW_CONTROL = 1,
+	ISOTP_SENDING = 2
+} isotp_state_e;
+
+/**
+ * Transmit side of ISO 15765-2
+ */
+class IsoTpSender {
+public:
+	IsoTpSender();
+	void init(CanBus *bus, uint32_t txId);
+	/**
+	 * Previous message is abandoned if it was still being sent
+	 */
+	void send(const uint8_t *data, int size, efitimems_t nowMs);
+	void onFlowControl(const can_frame_s *frame, efitimems_t nowMs);
+	/**
+	 * Sends consecutive frames which are due, handles flow control timeout
+	 */
+	void update(efitimems_t nowMs);
+	int getNextDelayMs(efitimems_t nowMs) const;
+	isotp_state_e getState() const;
+	int timeoutCounter;
+	int abortCounter;
+private:
+	void sendConsecutiveFrame();
+	CanBus *bus;
+	uint32_t txId;
+	isotp_state_e state;
+	uint8_t buffer[ISOTP_MAX_SIZE];
+	int size;
+	int offset;
+	uint8_t sequence;
+	/**
+	 * zero means tester wants no more flow control frames
+	 */
+	int blockSize;
+	int blockRemaining;
+	int separationMs;
+	efitimems_t nextMs;
+};
+
+/**
+ * OBD DTC of P type, rusEfi codes are the decimal digits of the P code. Codes which
+ * do not fit P0000-P3999 are not reported.
+ * @return zero if the code could not be represented
+ */
+uint16_t obdCodeToDtc(int code);
+
+class Obd2Server {
+public:
+	Obd2Server();
+	void init(CanBus *bus, const obd_pid_s *pids, int pidCount);
+	/**
+	 * Both request IDs, flow control from tester comes to physical one
+	 */
+	void addRxHandlers(CanBus *bus);
+	/**
+	 * @param vin NULL if not known, same for other strings
+	 */
+	void setVehicleInfo(const char *vin, const char *calibrationId, const char *ecuName);
+	void setDtcGetter(obd_dtc_getter_f getDtcs);
+	/**
+	 * CAN thread side
+	 */
+	void onRxFrame(const can_frame_s *frame);
+	void update(efitimems_t nowMs);
+	int getNextDelayMs(efitimems_t nowMs) const;
+
+	int requestCounter;
+	int unsupportedCounter;
+	IsoTpSender isoTp;
+private:
+	void handleRequest(const uint8_t *data, int size);
+	int handleCurrentData(const uint8_t *data, int size, uint8_t *response);
+	int handleDtcRequest(int mode, uint8_t *response);
+	int handleVehicleInfo(int pid, uint8_t *response);
+	int encodeValue(const obd_pid_s *pid, uint8_t *output) const;
+	const obd_pid_s *findPid(int pid) const;
+	uint32_t getSupportedMask(int basePid) const;
+	uint32_t getVehicleInfoMask() const;
+	const char *getVehicleInfoString(int pid, int *size) const;
+	const obd_pid_s *pids;
+	int pidCount;
+	const char *vin;
+	const char *calibrationId;
+	const char *ecuName;
+	obd_dtc_getter_f getDtcs;
+	/**
+	 * time of the latest update(), rx handlers do not get current time
+	 */
+	efitimems_t nowMs;
+};
+
+#endif /* OBD2_SERVER_H_ */
@@ -0,0 +1,226 @@
+/**
+ * @file event_heap.cpp
+ * Binary heap alternative to the sorted linked list from event_queue.cpp
+ *
+ * Heap is kept in a plain array of pointers to scheduling_s, so no memory allocation is needed and
+ * scheduling_s structure remains unchanged. 'next' field is only used to detach the list of
+ * events to be executed.
+ *
+ * this data structure is NOT thread safe
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "event_heap.h"
+#include "efitime.h"
+
+EventHeap::EventHeap() {
+	count = 0;
+	sequenceCounter = 0;
+	setLateDelay(100);
+	setCoalescingWindow(0);
+}
+
+/**
+ * Strict ordering by timestamp, then by tie-breaker sequence. Sequence difference is compared as signed so that
+ * counter overflow does not matter as long as an event does not stay pending for 2^31 insertions.
+ */
+static bool isEarlier(const event_heap_entry_s *a, const event_heap_entry_s *b) {
+	if (a->event->momentX != b->event->momentX) {
+		return a->event->momentX < b->event->momentX;
+	}
+	return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+void EventHeap::siftUp(int index) {
+	event_heap_entry_s element = heap[index];
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if (!isEarlier(&element, &heap[parent])) {
+			break;
+		}
+		heap[index] = heap[parent];
+		index = parent;
+	}
+	heap[index] = element;
+}
+
+void EventHeap::siftDown(int index) {
+	event_heap_entry_s element = heap[index];
+	while (true) {
+		int child = 2 * index + 1;
+		if (child >= count) {
+			break;
+		}
+		if (child + 1 < count && isEarlier(&heap[child + 1], &heap[child])) {
+			child++;
+		}
+		if (!isEarlier(&heap[child], &element)) {
+			break;
+		}
+		heap[index] = heap[child];
+		index = child;
+	}
+	heap[index] = element;
+}
+
+scheduling_s *EventHeap::pop() {
+	scheduling_s *result = heap[0].event;
+	count--;
+	if (count > 0) {
+		heap[0] = heap[count];
+		siftDown(0);
+	}
+	return result;
+}
+
+/**
+ * @return true if inserted into the head of the heap
+ */
+bool EventHeap::insertTask(scheduling_s *scheduling, efitime_t timeX, schfunc_t callback, void *param) {
+	efiAssert(CUSTOM_ERR_ASSERT, callback != NULL, "NULL callback", false);
+
+	if (scheduling->isScheduled) {
+#if EFI_UNIT_TEST
+		printf("Already scheduled was %d\r\n", (int)scheduling->momentX);
+		printf("Already scheduled now %d\r\n", (int)timeX);
+#endif /* EFI_UNIT_TEST */
+		return false;
+	}
+	if (count >= EVENT_HEAP_CAPACITY) {
+		firmwareError(CUSTOM_ERR_EVENT_QUEUE_OVERFLOW, "event heap is full %d", count);
+		return false;
+	}
+
+	scheduling->momentX = timeX;
+	scheduling->callback = callback;
+	scheduling->param = param;
+	scheduling->isScheduled = true;
+	scheduling->next = NULL;
+
+	/**
+	 * Same tie order as EventQueue: new event goes ahead of pending events with the same timestamp,
+	 * unless these are at the head of the queue - head stays in place and new event goes right after it.
+	 * Counter is decreasing so that newer means earlier.
+	 */
+	heap[count].event = scheduling;
+	heap[count].sequence = sequenceCounter--;
+	if (count > 0 && heap[0].event->momentX == timeX) {
+		// root only gets smaller, heap stays valid
+		heap[0].sequence = sequenceCounter--;
+	}
+	siftUp(count++);
+#if EFI_UNIT_TEST
+	assertHeapIsValid();
+#endif /* EFI_UNIT_TEST */
+	return heap[0].event == scheduling;
+}
+
+/**
+ * This method is always invoked under a lock
+ * @return Get the timestamp of the soonest pending action, skipping all the actions in the past
+ */
+efitime_t EventHeap::getNextEventTime(efitime_t nowX) const {
+	if (count == 0) {
+		return EMPTY_QUEUE;
+	}
+	if (heap[0].event->momentX <= nowX) {
+		// see comment in EventQueue::getNextEventTime
+		return nowX + lateDelay;
+	}
+	return heap[0].event->momentX;
+}
+
+/**
+ * Invoke all pending actions prior to specified timestamp
+ * @return number of executed actions
+ */
+int EventHeap::executeAll(efitime_t now) {
+	scheduling_s * executionList = NULL;
+	scheduling_s * lastInExecutionList = NULL;
+
+	int executionCounter = 0;
+	efitime_t executeUntil = now + coalescingWindow;
+	/**
+	 * All the due events are detached before any callback is invoked, same as EventQueue does,
+	 * so that an event re-inserted by its own callback would not be executed twice in one pass
+	 */
+	while (count > 0 && heap[0].event->momentX <= executeUntil) {
+		scheduling_s *current = pop();
+		efiAssert(CUSTOM_ERR_ASSERT, current->callback != NULL, "callback==null1", 0);
+		executionCounter++;
+		if (executionList == NULL) {
+			lastInExecutionList = executionList = current;
+		} else {
+			lastInExecutionList->next = current;
+			lastInExecutionList = current;
+		}
+		current->next = NULL;
+	}
+#if EFI_UNIT_TEST
+	assertHeapIsValid();
+#endif
+
+	executeEventList(executionList, now);
+	return executionCounter;
+}
+
+int EventHeap::size(void) const {
+	return count;
+}
+
+#if EFI_UNIT_TEST
+extern bool eventQueueDebugMode;
+
+void EventHeap::assertHeapIsValid() const {
+	if (!eventQueueDebugMode) {
+		return;
+	}
+	for (int i = 1; i < count; i++) {
+		efiAssertVoid(CUSTOM_ERR_6623, isEarlier(&heap[(i - 1) / 2], &heap[i]), "heap order");
+	}
+}
+#endif
+
+void EventHeap::setLateDelay(int value) {
+	lateDelay = value;
+}
+
+void EventHeap::setCoalescingWindow(int value) {
+	coalescingWindow = value;
+}
+
+scheduling_s * EventHeap::getHead() {
+	return count == 0 ? NULL : heap[0].event;
+}
+
+scheduling_s *EventHeap::getForUnitText(int index) {
+	if (index < 0 || index >= count) {
+#if EFI_UNIT_TEST
+		firmwareError(OBD_PCM_Processor_Fault, "getForUnitText: null");
+#endif /* EFI_UNIT_TEST */
+		return NULL;
+	}
+	// selection by repeated search of the smallest element later than previously found one
+	const event_heap_entry_s *previous = NULL;
+	for (int step = 0; step <= index; step++) {
+		const event_heap_entry_s *best = NULL;
+		for (int i = 0; i < count; i++) {
+			const event_heap_entry_s *candidate = &heap[i];
+			if (previous != NULL && !isEarlier(previous, candidate)) {
+				continue;
+			}
+			if (best == NULL || isEarlier(candidate, best)) {
+				best = candidate;
+			}
+		}
+		previous = best;
+	}
+	return previous->event;
+}
+
+void EventHeap::clear(void) {
+	count = 0;
+}
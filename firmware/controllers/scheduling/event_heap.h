@@ -0,0 +1,83 @@
+/**
+ * @file event_heap.h
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef EVENT_HEAP_H_
+#define EVENT_HEAP_H_
+
+#include "event_queue.h"
+
+/**
+ * Maximum number of simultaneously pending events. Each slot is one pointer of RAM.
+ */
+#ifndef EVENT_HEAP_CAPACITY
+#define EVENT_HEAP_CAPACITY 128
+#endif
+
+/**
+ * Heap slot: event and its tie-breaker sequence number
+ */
+typedef struct {
+	scheduling_s *event;
+	/**
+	 * tie-breaker so that events with the same timestamp are executed in the same order as EventQueue does
+	 */
+	uint32_t sequence;
+} event_heap_entry_s;
+
+/**
+ * Fixed-capacity binary min-heap of pending events
+ *
+ * Same contract as EventQueue but insertion is O(log(size)) instead of O(size) linear walk, which
+ * matters since insertion happens with interrupts disabled. Events with the exact same
+ * timestamp are executed in the same order as EventQueue executes them.
+ */
+class EventHeap {
+public:
+	EventHeap();
+
+	/**
+	 * O(log(size))
+	 */
+	bool insertTask(scheduling_s *scheduling, efitime_t timeX, schfunc_t callback, void *param);
+
+	int executeAll(efitime_t now);
+
+	efitime_t getNextEventTime(efitime_t nowUs) const;
+	void clear(void);
+	int size(void) const;
+	/**
+	 * O(size * index) - this is only meant for unit tests
+	 */
+	scheduling_s *getForUnitText(int index);
+	void setLateDelay(int value);
+	void setCoalescingWindow(int value);
+	scheduling_s * getHead();
+	void assertHeapIsValid() const;
+private:
+	scheduling_s *pop();
+	void siftUp(int index);
+	void siftDown(int index);
+	event_heap_entry_s heap[EVENT_HEAP_CAPACITY];
+	int count;
+	uint32_t sequenceCounter;
+	efitime_t lateDelay;
+	/**
+	 * events due within this window after 'now' are executed together with already due events
+	 */
+	efitime_t coalescingWindow;
+};
+
+/**
+ * Compile-time choice of the queue implementation used by executors
+ */
+#if EFI_EVENT_QUEUE_HEAP
+typedef EventHeap ExecutionQueue;
+#else
+typedef EventQueue ExecutionQueue;
+#endif /* EFI_EVENT_QUEUE_HEAP */
+
+#endif /* EVENT_HEAP_H_ */
@@ -3,7 +3,7 @@
  * This is a data structure which keeps track of all pending events
  * Implemented as a linked list, which is fine since the number of
  * pending events is pretty low
- * todo: MAYBE migrate to a better data structure, but that's low priority
+ * See event_heap.cpp for O(log(n)) alternative which is enabled by EFI_EVENT_QUEUE_HEAP
  *
  * this data structure is NOT thread safe
  *
@@ -16,9 +16,17 @@
 #include "event_queue.h"
 #include "efitime.h"
 #include "os_util.h"
+#include "scheduler_histograms.h"
 
 uint32_t maxSchedulingPrecisionLoss = 0;
 
+#if EFI_UNIT_TEST
+/**
+ * per-event console output and O(n) self-validation, scheduler benchmark needs to turn these off
+ */
+bool eventQueueDebugMode = true;
+#endif /* EFI_UNIT_TEST */
+
 scheduling_s::scheduling_s() {
 	callback = NULL;
 	next = NULL;
@@ -30,6 +38,7 @@ scheduling_s::scheduling_s() {
 EventQueue::EventQueue() {
 	head = NULL;
 	setLateDelay(100);
+	setCoalescingWindow(0);
 }
 
 bool EventQueue::checkIfPending(scheduling_s *scheduling) {
@@ -115,6 +124,45 @@ static scheduling_s * longScheduling;
 uint32_t maxEventCallbackDuration = 0;
 static uint32_t lastEventCallbackDuration;
 
+/**
+ * Invokes callbacks of a list of events which were already detached from the queue
+ * This part is shared by all queue implementations, see also event_heap.cpp
+ */
+void executeEventList(scheduling_s *executionList, efitime_t now) {
+	scheduling_s * current, *tmp;
+
+	/*
+	 * we need safe iteration here because 'callback' might change change 'current->next'
+	 * while re-inserting it into the queue from within the callback
+	 */
+	LL_FOREACH_SAFE(executionList, current, tmp)
+	{
+		efiAssertVoid(CUSTOM_ERR_ASSERT, current->callback != NULL, "callback==null2");
+		uint32_t before = getTimeNowLowerNt();
+		current->isScheduled = false;
+		// with coalescing window the event could be executed a bit early, that's a precision loss as well
+		uint32_t howFarOff = absI((int32_t)(now - current->momentX));
+		maxSchedulingPrecisionLoss = maxI(maxSchedulingPrecisionLoss, howFarOff);
+#if EFI_UNIT_TEST
+		if (eventQueueDebugMode) {
+			printf("QUEUE: execute current=%d param=%d\r\n", (long)current, (long)current->param);
+		}
+#endif
+		current->callback(current->param);
+		// even with overflow it's safe to subtract here
+		lastEventCallbackDuration = getTimeNowLowerNt() - before;
+		if (lastEventCallbackDuration > maxEventCallbackDuration)
+			maxEventCallbackDuration = lastEventCallbackDuration;
+#if EFI_SCHEDULER_HISTOGRAMS
+		recordSchedulerCallback(&schedulerHistograms, current->callback, howFarOff, lastEventCallbackDuration);
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
+		if (lastEventCallbackDuration > 2000) {
+			longScheduling = current;
+// what is this line about?			lastEventCallbackDuration++;
+		}
+	}
+}
+
 /**
  * Invoke all pending actions prior to specified timestamp
  * @return number of executed actions
@@ -127,6 +175,7 @@ int EventQueue::executeAll(efitime_t now) {
 
 	int listIterationCounter = 0;
 	int executionCounter = 0;
+	efitime_t executeUntil = now + coalescingWindow;
 	// we need safe iteration because we are removing elements inside the loop
 	LL_FOREACH_SAFE(head, current, tmp)
 	{
@@ -135,7 +184,7 @@ int EventQueue::executeAll(efitime_t now) {
 			firmwareError(CUSTOM_LIST_LOOP, "Is this list looped?");
 			return false;
 		}
-		if (current->momentX <= now) {
+		if (current->momentX <= executeUntil) {
 			executionCounter++;
 			efiAssert(CUSTOM_ERR_ASSERT, head == current, "removing from head", -1);
 			//LL_DELETE(head, current);
@@ -159,30 +208,7 @@ int EventQueue::executeAll(efitime_t now) {
 	assertListIsSorted();
 #endif
 
-	/*
-	 * we need safe iteration here because 'callback' might change change 'current->next'
-	 * while re-inserting it into the queue from within the callback
-	 */
-	LL_FOREACH_SAFE(executionList, current, tmp)
-	{
-		efiAssert(CUSTOM_ERR_ASSERT, current->callback != NULL, "callback==null2", 0);
-		uint32_t before = getTimeNowLowerNt();
-		current->isScheduled = false;
-		uint32_t howFarOff = now - current->momentX;
-		maxSchedulingPrecisionLoss = maxI(maxSchedulingPrecisionLoss, howFarOff);
-#if EFI_UNIT_TEST
-		printf("QUEUE: execute current=%d param=%d\r\n", (long)current, (long)current->param);
-#endif
-		current->callback(current->param);
-		// even with overflow it's safe to subtract here
-		lastEventCallbackDuration = getTimeNowLowerNt() - before;
-		if (lastEventCallbackDuration > maxEventCallbackDuration)
-			maxEventCallbackDuration = lastEventCallbackDuration;
-		if (lastEventCallbackDuration > 2000) {
-			longScheduling = current;
-// what is this line about?			lastEventCallbackDuration++;
-		}
-	}
+	executeEventList(executionList, now);
 	return executionCounter;
 }
 
@@ -195,6 +221,9 @@ int EventQueue::size(void) const {
 
 #if EFI_UNIT_TEST
 void EventQueue::assertListIsSorted() const {
+	if (!eventQueueDebugMode) {
+		return;
+	}
 	scheduling_s *current = head;
 	while (current != NULL && current->next != NULL) {
 		efiAssertVoid(CUSTOM_ERR_6623, current->momentX <= current->next->momentX, "list order");
@@ -207,6 +236,10 @@ void EventQueue::setLateDelay(int value) {
 	lateDelay = value;
 }
 
+void EventQueue::setCoalescingWindow(int value) {
+	coalescingWindow = value;
+}
+
 scheduling_s * EventQueue::getHead() {
 	return head;
 }
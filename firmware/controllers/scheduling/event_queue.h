@@ -42,6 +42,8 @@ bool assertNotInList(T *head, T*element) {
 	return false;
 }
 
+void executeEventList(scheduling_s *executionList, efitime_t now);
+
 /**
  * Execution sorted linked list
  */
@@ -61,6 +63,7 @@ public:
 	int size(void) const;
 	scheduling_s *getForUnitText(int index);
 	void setLateDelay(int value);
+	void setCoalescingWindow(int value);
 	scheduling_s * getHead();
 	void assertListIsSorted() const;
 private:
@@ -70,6 +73,10 @@ private:
 	 */
 	scheduling_s *head;
 	efitime_t lateDelay;
+	/**
+	 * events due within this window after 'now' are executed together with already due events
+	 */
+	efitime_t coalescingWindow;
 };
 
 #endif /* EVENT_SCHEDULER_H_ */
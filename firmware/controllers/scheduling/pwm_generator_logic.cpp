@@ -44,6 +44,7 @@ PwmConfig::PwmConfig() {
 	pwmCycleCallback = NULL;
 	stateChangeCallback = NULL;
 	executor = NULL;
+	hardPwm = NULL;
 	name = "[noname]";
 	arg = this;
 }
@@ -72,6 +73,10 @@ void SimplePwm::setSimplePwmDutyCycle(float dutyCycle) {
 		warning(CUSTOM_DUTY_TOO_HIGH, "spwd:dutyCycle %.2f", dutyCycle);
 		dutyCycle = 1;
 	}
+	if (hardPwm != NULL) {
+		hardPwm->setDuty(dutyCycle);
+		return;
+	}
 	if (dutyCycle == 0.0f && stateChangeCallback != NULL) {
 		/**
 		 * set the pin low just to be super sure
@@ -117,6 +122,9 @@ static efitimeus_t getNextSwitchTimeUs(PwmConfig *state) {
 }
 
 void PwmConfig::setFrequency(float frequency) {
+	if (hardPwm != NULL) {
+		hardPwm->setFrequency(frequency);
+	}
 	if (cisnan(frequency)) {
 		// explicit code just to be sure
 		periodNt = NAN;
@@ -225,6 +233,10 @@ efitimeus_t PwmConfig::togglePwmState() {
  * First invocation happens on application thread
  */
 static void timerCallback(PwmConfig *state) {
+	if (state->hardPwm != NULL) {
+		// restarted on a pin with timer channel, software loop ends here
+		return;
+	}
 	state->dbgNestingLevel++;
 	efiAssertVoid(CUSTOM_ERR_6581, state->dbgNestingLevel < 25, "PWM nesting issue");
 
@@ -330,6 +342,41 @@ void startSimplePwmExt(SimplePwm *state, const char *msg,
 	startSimplePwm(state, msg, executor, output, frequency, dutyCycle, stateChangeCallback);
 }
 
+void releaseHardwarePwm(SimplePwm *state) {
+	if (state->hardPwm != NULL) {
+		state->hardPwm->stop();
+		state->hardPwm = NULL;
+	}
+}
+
+void startSimplePwmHard(SimplePwm *state, const char *msg,
+		ExecutorInterface *executor,
+		brain_pin_e brainPin, OutputPin *output, float frequency,
+		float dutyCycle, pwm_gen_callback *stateChangeCallback) {
+	releaseHardwarePwm(state);
+
+#if EFI_HARDWARE_PWM
+	/**
+	 * Custom callbacks do more than just setting the pin on each edge, those have to stay in software
+	 */
+	if (stateChangeCallback == (pwm_gen_callback*) applyPinState && frequency >= 1) {
+		HardwarePwm *hardPwm = tryInitHardwarePwm(msg, brainPin, frequency, dutyCycle);
+		if (hardPwm != NULL) {
+			state->hardPwm = hardPwm;
+			state->outputPins[0] = output;
+			state->stateChangeCallback = stateChangeCallback;
+			state->setFrequency(frequency);
+			state->setSimplePwmDutyCycle(dutyCycle);
+			return;
+		}
+	}
+#else
+	UNUSED(brainPin);
+#endif /* EFI_HARDWARE_PWM */
+
+	startSimplePwm(state, msg, executor, output, frequency, dutyCycle, stateChangeCallback);
+}
+
 /**
  * This method controls the actual hardware pins
  *
@@ -39,6 +39,23 @@ typedef struct {
 
 class PwmConfig;
 
+/**
+ * Timer channel which produces the wave by itself, so PWM edges do not go through the scheduler
+ * and do not compete with spark and fuel events.
+ */
+class HardwarePwm {
+public:
+	virtual void setDuty(float duty) = 0;
+	/**
+	 * @param use NAN frequency to pause PWM, output is held low
+	 */
+	virtual void setFrequency(float frequency) = 0;
+	/**
+	 * Stops the timer and gives the pin back, see efiSetPadUnused
+	 */
+	virtual void stop() = 0;
+};
+
 typedef void (pwm_cycle_callback)(PwmConfig *state);
 typedef void (pwm_gen_callback)(int stateIndex, void *arg);
 
@@ -103,6 +120,11 @@ public:
 	 * this main callback is invoked when it's time to switch level on any of the output channels
 	 */
 	pwm_gen_callback *stateChangeCallback = NULL;
+	/**
+	 * Not NULL if the wave is generated by a hardware timer, in which case none of the software
+	 * scheduling state above is used
+	 */
+	HardwarePwm *hardPwm;
 private:
 	/**
 	 * float value of PWM period
@@ -145,6 +167,23 @@ void startSimplePwmExt(SimplePwm *state,
 		brain_pin_e brainPin, OutputPin *output,
 		float frequency, float dutyCycle, pwm_gen_callback *stateChangeCallback);
 
+/**
+ * Same as startSimplePwm but if the pin has a spare timer channel the wave is generated by the
+ * timer, see EFI_HARDWARE_PWM. GPIO pin should already be initialized by the caller.
+ *
+ * Could be invoked again with a different pin, timer channel of previous start is released first.
+ */
+void startSimplePwmHard(SimplePwm *state, const char *msg,
+		ExecutorInterface *executor,
+		brain_pin_e brainPin, OutputPin *output,
+		float frequency, float dutyCycle, pwm_gen_callback *stateChangeCallback);
+
+/**
+ * Gives back the timer channel taken by startSimplePwmHard, if any. Duty cycle changes go to the
+ * software PWM after that.
+ */
+void releaseHardwarePwm(SimplePwm *state);
+
 void copyPwmParameters(PwmConfig *state, int phaseCount, float const *switchTimes,
 		int waveCount, pin_state_t *const *pinStates);
 
@@ -0,0 +1,166 @@
+/**
+ * @file scheduler_histograms.cpp
+ * Per-callback lateness and execution time distribution of scheduler events
+ *
+ * maxSchedulingPrecisionLoss and maxEventCallbackDuration only tell us about the worst event,
+ * here we keep a small histogram for each distinct callback.
+ *
+ * Updated from executeEventList(), reset from console thread: slot claims and resets are done
+ * under lockAnyContext() so that the two never see a half-moved slot. Readers do not lock.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "scheduler_histograms.h"
+#include "cli_registry.h"
+
+#if EFI_SCHEDULER_HISTOGRAMS
+
+scheduler_histograms_s schedulerHistograms;
+
+static Logging *logger;
+
+/**
+ * Caller holds the lock
+ */
+static callback_histograms_s *findSlot(scheduler_histograms_s *histograms, schfunc_t callback) {
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		callback_histograms_s *slot = &histograms->slots[i];
+		if (slot->callback == callback) {
+			return slot;
+		}
+		if (slot->callback == NULL) {
+			// slots are claimed in order so first empty slot means there is no slot for this callback yet
+			slot->callback = callback;
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+void recordSchedulerCallback(scheduler_histograms_s *histograms, schfunc_t callback, uint32_t lateness, uint32_t duration) {
+	bool alreadyLocked = lockAnyContext();
+	callback_histograms_s *slot = findSlot(histograms, callback);
+	if (slot == NULL) {
+		histograms->untrackedCounter++;
+	} else {
+		compactHsAdd(&slot->lateness, lateness);
+		compactHsAdd(&slot->duration, duration);
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+static int getNamedSlotCount(scheduler_histograms_s *histograms) {
+	int count = 0;
+	while (count < SCHEDULER_HISTOGRAM_SLOTS && histograms->slots[count].name != NULL) {
+		count++;
+	}
+	return count;
+}
+
+/**
+ * Slot is swapped with the first slot without a name, so that named slots follow registration order
+ * no matter which callbacks were invoked before registration. Both slots are taken so this keeps
+ * 'no gaps' property findSlot() relies on.
+ */
+void registerSchedulerCallbackName(scheduler_histograms_s *histograms, schfunc_t callback, const char *name) {
+	bool alreadyLocked = lockAnyContext();
+	callback_histograms_s *slot = findSlot(histograms, callback);
+	if (slot != NULL && slot->name == NULL) {
+		callback_histograms_s *target = &histograms->slots[getNamedSlotCount(histograms)];
+		callback_histograms_s copy = *target;
+		*target = *slot;
+		*slot = copy;
+		slot = target;
+	}
+	if (slot != NULL) {
+		slot->name = name;
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+/**
+ * Named slots are moved to the front in the same order, this keeps 'no gaps' property findSlot() relies on.
+ */
+void resetSchedulerHistograms(scheduler_histograms_s *histograms) {
+	bool alreadyLocked = lockAnyContext();
+	int keptCount = 0;
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		callback_histograms_s *slot = &histograms->slots[i];
+		if (slot->callback != NULL && slot->name != NULL) {
+			if (keptCount != i) {
+				histograms->slots[keptCount].callback = slot->callback;
+				histograms->slots[keptCount].name = slot->name;
+			}
+			keptCount++;
+		}
+	}
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		callback_histograms_s *slot = &histograms->slots[i];
+		if (i >= keptCount) {
+			slot->callback = NULL;
+			slot->name = NULL;
+		}
+		resetCompactHistogram(&slot->lateness);
+		resetCompactHistogram(&slot->duration);
+	}
+	histograms->untrackedCounter = 0;
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+static uint16_t p99us(compact_histogram_s *h) {
+	uint32_t valueUs = NT2US(compactHsGetPercentile(h, 0.99));
+	return valueUs > 0xFFFF ? 0xFFFF : valueUs;
+}
+
+void getSchedulerHistogramsSummary(scheduler_histograms_s *histograms, uint16_t *latenessUs, uint16_t *durationUs) {
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		callback_histograms_s *slot = &histograms->slots[i];
+		latenessUs[i] = p99us(&slot->lateness);
+		durationUs[i] = p99us(&slot->duration);
+	}
+}
+
+static void printCompactHistogram(const char *title, compact_histogram_s *h) {
+	scheduleMsg(logger, "  %s: p50 %dus p90 %dus p99 %dus max %dus", title,
+			(int) NT2US(compactHsGetPercentile(h, 0.5)),
+			(int) NT2US(compactHsGetPercentile(h, 0.9)),
+			(int) NT2US(compactHsGetPercentile(h, 0.99)),
+			(int) NT2US(h->max));
+}
+
+static void showSchedulerHistograms(void) {
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		callback_histograms_s *slot = &schedulerHistograms.slots[i];
+		if (slot->callback == NULL) {
+			break;
+		}
+		const char *name = slot->name == NULL ? "unnamed" : slot->name;
+		// slot number is what TunerStudio 'sched' gauges and log columns are numbered by
+		scheduleMsg(logger, "slot %d callback %s %x: %d invocations", i + 1, name, (int) (uintptr_t) slot->callback,
+				slot->lateness.total_count);
+		printCompactHistogram("lateness", &slot->lateness);
+		printCompactHistogram("duration", &slot->duration);
+	}
+	scheduleMsg(logger, "untracked invocations: %d", schedulerHistograms.untrackedCounter);
+}
+
+static void resetSchedulerInfo(void) {
+	resetSchedulerHistograms(&schedulerHistograms);
+}
+
+void initSchedulerHistograms(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleAction("schedulerinfo", showSchedulerHistograms);
+	addConsoleAction("reset_scheduler_info", resetSchedulerInfo);
+}
+
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
@@ -0,0 +1,68 @@
+/**
+ * @file scheduler_histograms.h
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef SCHEDULER_HISTOGRAMS_H_
+#define SCHEDULER_HISTOGRAMS_H_
+
+#include "scheduler.h"
+#include "histogram.h"
+#include "datalogging.h"
+
+/**
+ * Number of distinct callbacks which get their own histograms
+ */
+#define SCHEDULER_HISTOGRAM_SLOTS 8
+
+typedef struct {
+	schfunc_t callback;
+	/**
+	 * human-readable name, slots with a name are kept by resetSchedulerHistograms()
+	 */
+	const char *name;
+	/**
+	 * how late the callback was invoked compared to requested time, in NT ticks
+	 */
+	compact_histogram_s lateness;
+	/**
+	 * callback execution time, in NT ticks
+	 */
+	compact_histogram_s duration;
+} callback_histograms_s;
+
+/**
+ * This structure is available to TunerStudio and rusEfi console as LDS_SCHEDULER_INDEX
+ */
+typedef struct {
+	callback_histograms_s slots[SCHEDULER_HISTOGRAM_SLOTS];
+	/**
+	 * number of invocations of callbacks which did not get a slot
+	 */
+	uint32_t untrackedCounter;
+} scheduler_histograms_s;
+
+/**
+ * instance updated by the scheduler
+ */
+extern scheduler_histograms_s schedulerHistograms;
+
+void recordSchedulerCallback(scheduler_histograms_s *histograms, schfunc_t callback, uint32_t lateness, uint32_t duration);
+/**
+ * Reserves a slot for given callback so that console report could show a human-readable name
+ */
+void registerSchedulerCallbackName(scheduler_histograms_s *histograms, schfunc_t callback, const char *name);
+/**
+ * Clears all the counters. Slots of callbacks without a name are released so that callbacks which are
+ * no longer in use do not hold them forever.
+ */
+void resetSchedulerHistograms(scheduler_histograms_s *histograms);
+/**
+ * p99 lateness and p99 duration of each slot in microseconds, this is what TunerStudio 'Scheduler' gauges show
+ */
+void getSchedulerHistogramsSummary(scheduler_histograms_s *histograms, uint16_t *latenessUs, uint16_t *durationUs);
+void initSchedulerHistograms(Logging *sharedLogger);
+
+#endif /* SCHEDULER_HISTOGRAMS_H_ */
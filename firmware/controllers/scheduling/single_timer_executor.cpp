@@ -25,12 +25,20 @@
 #include "single_timer_executor.h"
 #include "efitime.h"
 
+bool isImmediateTimerResetNeeded(efitick_t eventTimeNt, efitick_t nowNt, efitick_t marginNt) {
+	return eventTimeNt - nowNt < marginNt;
+}
+
+bool isEndOfBatchExecuteNeeded(bool isTimerResetPending, scheduling_s *head, efitick_t nowNt) {
+	return isTimerResetPending || (head != NULL && head->momentX <= nowNt);
+}
 
 #if EFI_SIGNAL_EXECUTOR_ONE_TIMER
 
 #include "microsecond_timer.h"
 #include "tunerstudio_configuration.h"
 #include "os_util.h"
+#include "cli_registry.h"
 
 #include "engine.h"
 EXTERN_ENGINE;
@@ -61,11 +69,21 @@ static void executorCallback(void *arg) {
 
 SingleTimerExecutor::SingleTimerExecutor() {
 	reentrantFlag = false;
-	doExecuteCounter = scheduleCounter = timerCallbackCounter = 0;
+	batchDepth = 0;
+	isTimerResetPending = false;
+	doExecuteCounter = scheduleCounter = timerCallbackCounter = deferredTimerResetCounter = immediateTimerResetCounter = 0;
 	/**
 	 * todo: a good comment
 	 */
 	queue.setLateDelay(US2NT(100));
+	queue.setCoalescingWindow(US2NT(SCHEDULER_COALESCING_WINDOW_US));
+}
+
+void SingleTimerExecutor::setCoalescingWindowUs(int value) {
+	bool alreadyLocked = lockAnyContext();
+	queue.setCoalescingWindow(US2NT(value));
+	if (!alreadyLocked)
+		unlockAnyContext();
 }
 
 void SingleTimerExecutor::scheduleForLater(scheduling_s *scheduling, int delayUs, schfunc_t callback, void *param) {
@@ -92,15 +110,52 @@ void SingleTimerExecutor::scheduleByTimestamp(scheduling_s *scheduling, efitimeu
 	}
 	bool needToResetTimer = queue.insertTask(scheduling, US2NT(timeUs), callback, param);
 	if (!reentrantFlag) {
-		doExecute();
-		if (needToResetTimer) {
-			scheduleTimerCallback();
+		if (batchDepth > 0) {
+			/**
+			 * we are inside of a batch, for instance a trigger event handler which schedules a number
+			 * of events in a row - endBatch() would take care of the hardware timer just once
+			 */
+			if (needToResetTimer) {
+				if (isImmediateTimerResetNeeded(US2NT(timeUs), getTimeNowNt(), US2NT(SCHEDULER_BATCH_REARM_MARGIN_US))) {
+					// this one could be due before the end of the batch, timer is armed for a later event
+					scheduleTimerCallback();
+					immediateTimerResetCounter++;
+				} else {
+					isTimerResetPending = true;
+					deferredTimerResetCounter++;
+				}
+			}
+		} else {
+			doExecute();
+			if (needToResetTimer) {
+				scheduleTimerCallback();
+			}
 		}
 		if (!alreadyLocked)
 			unlockAnyContext();
 	}
 }
 
+void SingleTimerExecutor::beginBatch() {
+	bool alreadyLocked = lockAnyContext();
+	batchDepth++;
+	if (!alreadyLocked)
+		unlockAnyContext();
+}
+
+void SingleTimerExecutor::endBatch() {
+	efiAssertVoid(CUSTOM_ERR_ASSERT, batchDepth > 0, "endBatch without beginBatch");
+	bool alreadyLocked = lockAnyContext();
+	batchDepth--;
+	if (batchDepth == 0 && !reentrantFlag && isEndOfBatchExecuteNeeded(isTimerResetPending, queue.getHead(), getTimeNowNt())) {
+		isTimerResetPending = false;
+		doExecute();
+		scheduleTimerCallback();
+	}
+	if (!alreadyLocked)
+		unlockAnyContext();
+}
+
 void SingleTimerExecutor::onTimerCallback() {
 	timerCallbackCounter++;
 	bool alreadyLocked = lockAnyContext();
@@ -162,9 +217,14 @@ void SingleTimerExecutor::scheduleTimerCallback() {
 	hwSetTimerDuration = getTimeNowLowerNt() - beforeHwSetTimer;
 }
 
+static void setSchedulerCoalescingWindow(int valueUs) {
+	___engine.executor.setCoalescingWindowUs(valueUs);
+}
+
 void initSingleTimerExecutorHardware(void) {
 	globalTimerCallback = executorCallback;
 	initMicrosecondTimer();
+	addConsoleActionI("set_scheduler_coalescing_us", setSchedulerCoalescingWindow);
 }
 
 #if EFI_TUNER_STUDIO
@@ -177,6 +237,8 @@ void executorStatistics() {
 		tsOutputChannels.debugIntField1 = ___engine.executor.timerCallbackCounter;
 		tsOutputChannels.debugIntField2 = ___engine.executor.doExecuteCounter;
 		tsOutputChannels.debugIntField3 = ___engine.executor.scheduleCounter;
+		tsOutputChannels.debugIntField4 = ___engine.executor.deferredTimerResetCounter;
+		tsOutputChannels.debugIntField5 = ___engine.executor.immediateTimerResetCounter;
 #endif /* EFI_TUNER_STUDIO */
 	}
 }
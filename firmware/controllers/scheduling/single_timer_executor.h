@@ -9,7 +9,34 @@
 #define SINGLETIMEREXECUTOR_H_
 
 #include "scheduler.h"
-#include "event_queue.h"
+#include "event_heap.h"
+
+/**
+ * Events due within this many microseconds are executed in the same timer interrupt
+ * Zero means no coalescing, see also 'set_scheduler_coalescing_us' console command
+ */
+#ifndef SCHEDULER_COALESCING_WINDOW_US
+#define SCHEDULER_COALESCING_WINDOW_US 0
+#endif
+
+/**
+ * Inside of a batch, a new head of the queue due sooner than this re-arms the hardware timer right away
+ * instead of waiting for endBatch(). Should be above the typical trigger handler duration.
+ */
+#ifndef SCHEDULER_BATCH_REARM_MARGIN_US
+#define SCHEDULER_BATCH_REARM_MARGIN_US 50
+#endif
+
+/**
+ * @return true if a new head of the queue scheduled inside of a batch could become due before the batch ends
+ */
+bool isImmediateTimerResetNeeded(efitick_t eventTimeNt, efitick_t nowNt, efitick_t marginNt);
+/**
+ * @param head head of the queue at the end of a batch, NULL if empty
+ * @return true if endBatch() has to execute the queue right away: timer re-arm was deferred, or the head
+ * has become due while the batch was running, same as an event scheduled outside of a batch would be executed
+ */
+bool isEndOfBatchExecuteNeeded(bool isTimerResetPending, scheduling_s *head, efitick_t nowNt);
 
 class SingleTimerExecutor : public ExecutorInterface {
 public:
@@ -17,12 +44,25 @@ public:
 	void scheduleByTimestamp(scheduling_s *scheduling, efitimeus_t timeUs, schfunc_t callback, void *param);
 	void scheduleForLater(scheduling_s *scheduling, int delayUs, schfunc_t callback, void *param);
 	void onTimerCallback();
+	/**
+	 * Between beginBatch() and endBatch() new events are only inserted into the queue, hardware timer
+	 * is re-armed once by endBatch(). Exception is a new head which is due within SCHEDULER_BATCH_REARM_MARGIN_US,
+	 * that one re-arms the timer right away so that it does not fire late. Events which are already due
+	 * by the end of the batch are executed by endBatch().
+	 */
+	void beginBatch();
+	void endBatch();
+	void setCoalescingWindowUs(int value);
 	int timerCallbackCounter;
 	int scheduleCounter;
 	int doExecuteCounter;
+	int deferredTimerResetCounter;
+	int immediateTimerResetCounter;
 private:
-	EventQueue queue;
+	ExecutionQueue queue;
 	bool reentrantFlag;
+	int batchDepth;
+	bool isTimerResetPending;
 	void doExecute();
 	void scheduleTimerCallback();
 };
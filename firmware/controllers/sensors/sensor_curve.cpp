@@ -0,0 +1,72 @@
+/**
+ * @file sensor_curve.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "sensor_curve.h"
+
+/**
+ * how many points within each segment are checked by getMaxError()
+ */
+#define SENSOR_CURVE_ERROR_SAMPLES 8
+
+SensorCurve::SensorCurve() {
+	minVoltage = 0;
+	// zero means not built
+	segmentsPerVolt = 0;
+	memset(values, 0, sizeof(values));
+}
+
+void SensorCurve::build(float minVoltage, float maxVoltage, sensor_curve_convert_f convert, const void *arg) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT, maxVoltage > minVoltage, "sensor curve range");
+	float step = (maxVoltage - minVoltage) / SENSOR_CURVE_SEGMENTS;
+	for (int i = 0; i <= SENSOR_CURVE_SEGMENTS; i++) {
+		values[i] = convert(minVoltage + i * step, arg);
+	}
+	this->minVoltage = minVoltage;
+	segmentsPerVolt = SENSOR_CURVE_SEGMENTS / (maxVoltage - minVoltage);
+}
+
+bool SensorCurve::isBuilt() const {
+	return segmentsPerVolt != 0;
+}
+
+float SensorCurve::getValue(float voltage) const {
+	if (!isBuilt() || cisnan(voltage)) {
+		return NAN;
+	}
+	float position = (voltage - minVoltage) * segmentsPerVolt;
+	if (position <= 0) {
+		return values[0];
+	}
+	if (position >= SENSOR_CURVE_SEGMENTS) {
+		return values[SENSOR_CURVE_SEGMENTS];
+	}
+	int index = (int) position;
+	float fraction = position - index;
+	return values[index] + (values[index + 1] - values[index]) * fraction;
+}
+
+float SensorCurve::getMaxError(sensor_curve_convert_f convert, const void *arg, float fromVoltage, float toVoltage,
+		float *worstVoltage) const {
+	*worstVoltage = fromVoltage;
+	if (!isBuilt()) {
+		return NAN;
+	}
+	float maxError = 0;
+	float step = 1 / (segmentsPerVolt * SENSOR_CURVE_ERROR_SAMPLES);
+	for (float voltage = fromVoltage; voltage <= toVoltage; voltage += step) {
+		float exact = convert(voltage, arg);
+		if (cisnan(exact)) {
+			continue;
+		}
+		float error = absF(getValue(voltage) - exact);
+		if (error > maxError) {
+			maxError = error;
+			*worstVoltage = voltage;
+		}
+	}
+	return maxError;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file sensor_curve.h
+ * @brief Voltage-indexed lookup table for nonlinear sensor transfer functions
+ *
+ * Exact conversion (logarithm for a thermistor, for example) is evaluated only when the table is built,
+ * that is when configuration changes. Each read is then an index computation and a linear interpolation
+ * between two neighbouring points, voltage step is uniform so no search is needed.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef CONTROLLERS_SENSORS_SENSOR_CURVE_H_
+#define CONTROLLERS_SENSORS_SENSOR_CURVE_H_
+
+#include "global.h"
+
+/**
+ * 128 segments over 5 volts keep thermistor error around 0.2C
+ */
+#ifndef SENSOR_CURVE_SEGMENTS
+#define SENSOR_CURVE_SEGMENTS 128
+#endif /* SENSOR_CURVE_SEGMENTS */
+
+/**
+ * Exact conversion of sensor voltage into sensor value
+ */
+typedef float (*sensor_curve_convert_f)(float voltage, const void *arg);
+
+class SensorCurve {
+public:
+	SensorCurve();
+	void build(float minVoltage, float maxVoltage, sensor_curve_convert_f convert, const void *arg);
+	/**
+	 * Voltages outside of the table get the value of the nearest end
+	 * @return NAN if the table was not built yet
+	 */
+	float getValue(float voltage) const;
+	/**
+	 * Compares interpolated values with exact conversion at several points within each segment,
+	 * points where exact value is NAN are skipped.
+	 * @return largest absolute difference between fromVoltage and toVoltage
+	 */
+	float getMaxError(sensor_curve_convert_f convert, const void *arg, float fromVoltage, float toVoltage,
+			float *worstVoltage) const;
+	bool isBuilt() const;
+private:
+	float minVoltage;
+	float segmentsPerVolt;
+	float values[SENSOR_CURVE_SEGMENTS + 1];
+};
+
+#endif /* CONTROLLERS_SENSORS_SENSOR_CURVE_H_ */
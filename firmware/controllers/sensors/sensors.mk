@@ -2,6 +2,7 @@
 CONTROLLERS_SENSORS_SRC = 
 																																				
 CONTROLLERS_SENSORS_SRC_CPP = 	$(PROJECT_DIR)/controllers/sensors/thermistors.cpp \
+	$(PROJECT_DIR)/controllers/sensors/sensor_curve.cpp \
 	$(PROJECT_DIR)/controllers/sensors/allsensors.cpp \
 	$(PROJECT_DIR)/controllers/sensors/map.cpp \
 	$(PROJECT_DIR)/controllers/sensors/voltage.cpp \
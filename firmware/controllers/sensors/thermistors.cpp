@@ -24,6 +24,12 @@
 #define LIMPING_MODE_CLT_TEMPERATURE 70.0f
 #define NO_CLT_SENSOR_TEMPERATURE 72.0f
 
+/**
+ * Readings closer to the rails than this are an open or shorted sensor, exact formula is meaningless there
+ */
+#define THERMISTOR_TABLE_ERROR_MIN_VOLTAGE 0.2f
+#define THERMISTOR_TABLE_ERROR_MAX_VOLTAGE (_5_VOLTS - 0.2f)
+
 EXTERN_ENGINE
 ;
 
@@ -56,6 +62,20 @@ float ThermistorMath::getKelvinTemperatureByResistance(float resistance) const {
 	return 1 / (s_h_a + s_h_b * logR + s_h_c * logR * logR * logR);
 }
 
+float ThermistorMath::getTemperatureByVoltage(float voltage) const {
+	float resistance = getR2InVoltageDividor(voltage, _5_VOLTS, currentConfig.bias_resistor);
+	return convertKelvinToCelcius(getKelvinTemperatureByResistance(resistance));
+}
+
+static float getThermistorTemperature(float voltage, const void *arg) {
+	return ((const ThermistorMath *) arg)->getTemperatureByVoltage(voltage);
+}
+
+float getThermistorTableError(ThermistorMath *tm, float *worstVoltage) {
+	return tm->curve.getMaxError(getThermistorTemperature, tm, THERMISTOR_TABLE_ERROR_MIN_VOLTAGE,
+			THERMISTOR_TABLE_ERROR_MAX_VOLTAGE, worstVoltage);
+}
+
 /*
 float convertCelsiustoF(temperature_t tempC) {
 	return tempC * 9 / 5 + 32;
@@ -80,7 +100,9 @@ float getResistance(ThermistorConf *config, float voltage) {
 }
 
 temperature_t getTemperatureC(ThermistorConf *cfg, ThermistorMath *tm, bool useLinear DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	tm->setConfig(&cfg->config); // implementation checks if configuration has changed or not
+	if (tm->configVersion.isOld(ENGINE(getGlobalConfigurationVersion()))) {
+		tm->setConfig(&cfg->config); // implementation checks if configuration has changed or not
+	}
 
 	DISPLAY_TEXT(Analog_MCU_reads);
 	tm->DISPLAY_FIELD(voltageMCU) = DISPLAY_TEXT(from_pin) getVoltage("term", cfg->DISPLAY_CONFIG(adcChannel));
@@ -110,8 +132,7 @@ temperature_t getTemperatureC(ThermistorConf *cfg, ThermistorMath *tm, bool useL
 	DISPLAY_TEXT(Measured_resistance);
 	tm->DISPLAY_FIELD(resistance) = getResistance(cfg, tm->voltageBoard);
 
-	float kelvinTemperature = tm->getKelvinTemperatureByResistance(tm->resistance);
-	return convertKelvinToCelcius(kelvinTemperature);
+	return tm->curve.getValue(tm->voltageBoard);
 }
 
 bool isValidCoolantTemperature(temperature_t temperature) {
@@ -260,6 +281,17 @@ static void testCltByR(float resistance) {
 	float kTemp = engine->engineState.cltCurve.getKelvinTemperatureByResistance(resistance);
 	scheduleMsg(logger, "for R=%.2f we have %.2f", resistance, (kTemp - KELV));
 }
+
+static void printThermistorTableError(const char *msg, ThermistorMath *tm) {
+	float worstVoltage;
+	float error = getThermistorTableError(tm, &worstVoltage);
+	scheduleMsg(logger, "%s table error %.3fC at %.3fv", msg, error, worstVoltage);
+}
+
+static void printThermistorTableErrors(void) {
+	printThermistorTableError("CLT", &engine->engineState.cltCurve);
+	printThermistorTableError("IAT", &engine->engineState.iatCurve);
+}
 #endif
 
 void initThermistors(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -268,6 +300,7 @@ void initThermistors(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
 #if EFI_PROD_CODE
 	addConsoleActionF("test_clt_by_r", testCltByR);
+	addConsoleAction("thermistor_table_error", printThermistorTableErrors);
 #endif
 }
 
@@ -278,4 +311,5 @@ void ThermistorMath::setConfig(thermistor_conf_s *config) {
 	}
 	memcpy(&currentConfig, config, sizeof(currentConfig));
 	prepareThermistorCurve(config);
+	curve.build(0, _5_VOLTS, getThermistorTemperature, this);
 }
@@ -32,6 +32,10 @@ float convertFtoCelcius(float tempF);
 
 float getKelvinTemperature(float resistance, ThermistorMath *tm);
 float getResistance(ThermistorConf *cfg, float voltage);
+/**
+ * @return worst difference between lookup table and exact formula, Celsius, over realistic sensor voltages
+ */
+float getThermistorTableError(ThermistorMath *tm, float *worstVoltage);
 temperature_t getTemperatureC(ThermistorConf *cfg, ThermistorMath *tm, bool useLinear DECLARE_ENGINE_PARAMETER_SUFFIX);
 temperature_t getCoolantTemperature(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 bool isValidCoolantTemperature(temperature_t temperature);
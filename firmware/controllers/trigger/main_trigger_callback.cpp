@@ -52,6 +52,7 @@
 #endif /* EFI_HISTOGRAMS */
 #include "local_version_holder.h"
 #include "event_queue.h"
+#include "scheduler_histograms.h"
 #include "engine.h"
 
 #include "aux_valves.h"
@@ -214,7 +215,12 @@ static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionE
 	 * wetting coefficient works the same way for any injection mode, or is something
 	 * x2 or /2?
 	 */
+#if EFI_MAP_PER_CYLINDER_FUEL
+	const floatms_t injectionDuration = ENGINE(wallFuel).adjust(0/*event->outputs[0]->injectorIndex*/,
+			ENGINE(injectionDuration) * getCylinderMapFuelCorrection(event->ownIndex PASS_ENGINE_PARAMETER_SUFFIX) PASS_ENGINE_PARAMETER_SUFFIX);
+#else
 	const floatms_t injectionDuration = ENGINE(wallFuel).adjust(0/*event->outputs[0]->injectorIndex*/, ENGINE(injectionDuration) PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_MAP_PER_CYLINDER_FUEL */
 #if EFI_PRINTF_FUEL_DETAILS
 	printf("fuel injectionDuration=%.2f adjusted=%.2f\t\n", ENGINE(injectionDuration), injectionDuration);
 #endif /*EFI_PRINTF_FUEL_DETAILS */
@@ -404,14 +410,15 @@ static ALWAYS_INLINE void handleFuel(const bool limitedFuel, uint32_t trgEventIn
 	 */
 	ENGINE(injectionDuration) = getInjectionDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 
-	for (int injEventIndex = 0; injEventIndex < CONFIG(specs.cylindersCount); injEventIndex++) {
-		InjectionEvent *event = &fs->elements[injEventIndex];
-		uint32_t eventIndex = event->injectionStart.eventIndex;
+	/**
+	 * only the events which are due on this tooth, see FuelSchedule#dispatch
+	 */
 // right after trigger change we are still using old & invalid fuel schedule. good news is we do not change trigger on the fly in real life
-//		efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, eventIndex < ENGINE(triggerShape.getLength()), "handleFuel/event sch index");
-		if (eventIndex != trgEventIndex) {
-			continue;
-		}
+	event_mask_t dueEvents = fs->dispatch.getEvents(trgEventIndex) & CYLINDERS_MASK();
+	while (dueEvents != 0) {
+		int injEventIndex = __builtin_ctz(dueEvents);
+		dueEvents &= dueEvents - 1;
+		InjectionEvent *event = &fs->elements[injEventIndex];
 		handleFuelInjectionEvent(injEventIndex, event, rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 }
@@ -504,6 +511,7 @@ void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEventIndex D
 		if (checkIfTriggerConfigChanged(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 			engine->ignitionEvents.isReady = false; // we need to rebuild ignition schedule
 			engine->injectionEvents.isReady = false;
+			engine->outputSchedule.invalidate();
 			// moved 'triggerIndexByAngle' into trigger initialization (why was it invoked from here if it's only about trigger shape & optimization?)
 			// see initializeTriggerShape() -> prepareOutputSignals(PASS_ENGINE_PARAMETER_SIGNATURE)
 
@@ -514,6 +522,9 @@ void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEventIndex D
 		if (CONFIG(fuelClosedLoopCorrectionEnabled)) {
 			fuelClosedLoopCorrection(PASS_ENGINE_PARAMETER_SIGNATURE);
 		}
+
+		// engine cycle boundary is the moment to switch to the most recent pre-calculated schedule
+		ENGINE(outputSchedule.onEngineCycleStart());
 	}
 
 	efiAssertVoid(CUSTOM_IGN_MATH_STATE, !CONFIG(useOnlyRisingEdgeForTrigger) || CONFIG(ignMathCalculateAtIndex) % 2 == 0, "invalid ignMathCalculateAtIndex");
@@ -641,6 +652,14 @@ void initMainEventListener(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX
 
 	initAuxValves(logger);
 
+#if EFI_SCHEDULER_HISTOGRAMS
+	// slot order, TunerStudio 'Scheduler' gauges in rusefi.input are labeled accordingly
+	registerSchedulerCallbackName(&schedulerHistograms, (schfunc_t) &seTurnPinHigh, "seTurnPinHigh");
+	registerSchedulerCallbackName(&schedulerHistograms, (schfunc_t) &seTurnPinLow, "seTurnPinLow");
+	registerSchedulerCallbackName(&schedulerHistograms, (schfunc_t) &turnSparkPinHigh, "turnSparkPinHigh");
+	registerSchedulerCallbackName(&schedulerHistograms, (schfunc_t) &fireSparkAndPrepareNextSchedule, "fireSpark");
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
+
 #if EFI_PROD_CODE
 	addConsoleAction("performanceinfo", showTriggerHistogram);
 	addConsoleActionP("maininfo", (VoidPtr) showMainInfo, engine);
@@ -229,7 +229,8 @@ void RpmCalculator::setSpinningUp(efitime_t nowNt DECLARE_ENGINE_PARAMETER_SUFFI
  */
 void rpmShaftPositionCallback(trigger_event_e ckpSignalType,
 		uint32_t index DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	efitick_t nowNt = getTimeNowNt();
+	// edge capture time, with EFI_TRIGGER_EVENT_QUEUE the edge is processed a bit later
+	efitick_t nowNt = engine->triggerCentral.nowNt;
 #if EFI_PROD_CODE
 	efiAssertVoid(CUSTOM_ERR_6632, getCurrentRemainingStack() > 256, "lowstckRCL");
 #endif
@@ -72,19 +72,32 @@ static void fireSparkBySettingPinLow(IgnitionEvent *event, IgnitionOutputPin *ou
 		} \
 }
 
+/**
+ * @return spark angle of given cylinder within engine cycle
+ */
+angle_t getCylinderIgnitionAdvance(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// change of sign here from 'before TDC' to 'after TDC'
+	angle_t ignitionPositionWithinEngineCycle = ENGINE(ignitionPositionWithinEngineCycle[cylinderIndex]);
+	assertAngleRange(ignitionPositionWithinEngineCycle, "aPWEC", CUSTOM_ERR_6566);
+	cfg_float_t_1f timing_offset_cylinder = CONFIG(timing_offset_cylinder[cylinderIndex]);
+	const angle_t localAdvance = -ENGINE(engineState.timingAdvance) + ignitionPositionWithinEngineCycle + timing_offset_cylinder;
+	efiAssert(CUSTOM_ERR_6689, !cisnan(localAdvance), "findAngle#9", NAN);
+	return localAdvance;
+}
+
 static void prepareCylinderIgnitionSchedule(angle_t dwellAngle, floatms_t sparkDwell, IgnitionEvent *event DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	// todo: clean up this implementation? does not look too nice as is.
 
 	// let's save planned duration so that we can later compare it with reality
 	event->sparkDwell = sparkDwell;
 
-	// change of sign here from 'before TDC' to 'after TDC'
-	angle_t ignitionPositionWithinEngineCycle = ENGINE(ignitionPositionWithinEngineCycle[event->cylinderIndex]);
-	assertAngleRange(ignitionPositionWithinEngineCycle, "aPWEC", CUSTOM_ERR_6566);
-	cfg_float_t_1f timing_offset_cylinder = CONFIG(timing_offset_cylinder[event->cylinderIndex]);
-	const angle_t localAdvance = -ENGINE(engineState.timingAdvance) + ignitionPositionWithinEngineCycle + timing_offset_cylinder;
-	efiAssertVoid(CUSTOM_ERR_6689, !cisnan(localAdvance), "findAngle#9");
+	/**
+	 * if available, angles pre-calculated by OutputScheduleBuffer outside of trigger/scheduler interrupts are used
+	 */
+	const output_schedule_s *schedule = ENGINE(outputSchedule).getActive();
+	bool isBuffered = schedule->isIgnitionReady && schedule->cylindersCount == CONFIG(specs.cylindersCount);
 
+	const angle_t localAdvance = isBuffered ? schedule->advance[event->cylinderIndex] : getCylinderIgnitionAdvance(event->cylinderIndex PASS_ENGINE_PARAMETER_SUFFIX);
 	efiAssertVoid(CUSTOM_ERR_6589, !cisnan(localAdvance), "localAdvance#1");
 	const int index = ENGINE(ignitionPin[event->cylinderIndex]);
 	const int coilIndex = ID2INDEX(getCylinderId(index PASS_ENGINE_PARAMETER_SUFFIX));
@@ -106,10 +119,15 @@ static void prepareCylinderIgnitionSchedule(angle_t dwellAngle, floatms_t sparkD
 	event->outputs[1] = secondOutput;
 	event->advance = localAdvance;
 
-	angle_t a = localAdvance - dwellAngle;
-	efiAssertVoid(CUSTOM_ERR_6590, !cisnan(a), "findAngle#5");
-	assertAngleRange(a, "findAngle#a6", CUSTOM_ERR_6550);
-	TRIGGER_SHAPE(findTriggerPosition(&event->dwellPosition, a PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	if (isBuffered) {
+		event->dwellPosition = schedule->dwellPosition[event->cylinderIndex];
+	} else {
+		angle_t a = localAdvance - dwellAngle;
+		efiAssertVoid(CUSTOM_ERR_6590, !cisnan(a), "findAngle#5");
+		assertAngleRange(a, "findAngle#a6", CUSTOM_ERR_6550);
+		TRIGGER_SHAPE(findTriggerPosition(&event->dwellPosition, a PASS_CONFIG_PARAM(engineConfiguration->globalTriggerAngleOffset)));
+	}
+	ENGINE(ignitionEvents.dwellDispatch.setEventIndex(event->cylinderIndex, event->dwellPosition.eventIndex));
 
 #if FUEL_MATH_EXTREME_LOGGING
 	printf("addIgnitionEvent %s ind=%d\n", output->name, event->dwellPosition.eventIndex);
@@ -415,10 +433,14 @@ void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm
 
 //	scheduleSimpleMsg(&logger, "eventId spark ", eventIndex);
 	if (ENGINE(ignitionEvents.isReady)) {
-		for (int i = 0; i < CONFIG(specs.cylindersCount); i++) {
+		/**
+		 * only cylinders which start dwell on this tooth, see initializeIgnitionActions()
+		 */
+		event_mask_t dueEvents = ENGINE(ignitionEvents.dwellDispatch.getEvents(trgEventIndex)) & CYLINDERS_MASK();
+		while (dueEvents != 0) {
+			int i = __builtin_ctz(dueEvents);
+			dueEvents &= dueEvents - 1;
 			IgnitionEvent *event = &ENGINE(ignitionEvents.elements[i]);
-			if (event->dwellPosition.eventIndex != trgEventIndex)
-				continue;
 			handleSparkEvent(limitedSpark, trgEventIndex, event, rpm PASS_ENGINE_PARAMETER_SUFFIX);
 		}
 	}
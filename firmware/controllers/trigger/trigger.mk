@@ -21,6 +21,7 @@ TRIGGER_SRC_CPP = \
 	$(PROJECT_DIR)/controllers/trigger/trigger_emulator_algo.cpp \
 	$(PROJECT_DIR)/controllers/trigger/rpm_calculator.cpp \
 	$(PROJECT_DIR)/controllers/trigger/trigger_central.cpp \
+	$(PROJECT_DIR)/controllers/trigger/trigger_event_queue.cpp \
 	$(PROJECT_DIR)/controllers/trigger/spark_logic.cpp \
 	$(PROJECT_DIR)/controllers/trigger/main_trigger_callback.cpp \
 	$(PROJECT_DIR)/controllers/trigger/aux_valves.cpp
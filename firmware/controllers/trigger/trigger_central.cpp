@@ -25,6 +25,9 @@
 #include "trigger_simulator.h"
 
 #include "rpm_calculator.h"
+#include "scheduler_histograms.h"
+#include "trigger_event_queue.h"
+#include "deferred_log.h"
 
 #if EFI_PROD_CODE
 #include "pin_repository.h"
@@ -89,6 +92,9 @@ void addTriggerEventListener(ShaftPositionListener listener, const char *name, E
 }
 
 void hwHandleVvtCamSignal(trigger_value_e front DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_TOOTH_LOGGER
+	LogCamTooth(front == TV_RISE, getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_TOOTH_LOGGER */
 	addEngineSnifferEvent(VVT_NAME, front == TV_RISE ? WC_UP : WC_DOWN);
 
 	if (CONFIGB(vvtCamSensorUseRise) ^ (front != TV_FALL)) {
@@ -116,13 +122,13 @@ void hwHandleVvtCamSignal(trigger_value_e front DECLARE_ENGINE_PARAMETER_SUFFIX)
 		tc->previousVvtCamTime = nowNt;
 
 		if (engineConfiguration->verboseTriggerSynchDetails) {
-			scheduleMsg(logger, "vvt ratio %.2f", ratio);
+			deferredMsg("vvt ratio %.2f", ratio);
 		}
 		if (ratio < CONFIGB(miataNb2VVTRatioFrom) || ratio > CONFIGB(miataNb2VVTRatioTo)) {
 			return;
 		}
 		if (engineConfiguration->verboseTriggerSynchDetails) {
-			scheduleMsg(logger, "looks good: vvt ratio %.2f", ratio);
+			deferredMsg("looks good: vvt ratio %.2f", ratio);
 		}
 		if (engineConfiguration->debugMode == DBG_VVT) {
 #if EFI_TUNER_STUDIO
@@ -189,13 +195,12 @@ uint32_t triggerMaxDuration = 0;
 
 static bool isInsideTriggerHandler = false;
 
-
-void hwHandleShaftSignal(trigger_event_e signal) {
+static void doProcessShaftSignal(trigger_event_e signal, efitick_t timestamp) {
 #if EFI_TOOTH_LOGGER
 	// Log to the Tunerstudio tooth logger
 	// We want to do this before anything else as we
 	// actually want to capture any noise/jitter that may be occurring
-	LogTriggerTooth(signal);
+	LogTriggerTooth(signal, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_TOOTH_LOGGER */
 
 	// for effective noise filtering, we need both signal edges, 
@@ -211,13 +216,105 @@ void hwHandleShaftSignal(trigger_event_e signal) {
 		maxTriggerReentraint = triggerReentraint;
 	triggerReentraint++;
 	efiAssertVoid(CUSTOM_ERR_6636, getCurrentRemainingStack() > 128, "lowstck#8");
-	engine->triggerCentral.handleShaftSignal(signal PASS_ENGINE_PARAMETER_SUFFIX);
+	engine->triggerCentral.handleShaftSignal(signal, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
 	triggerReentraint--;
 	triggerDuration = getTimeNowLowerNt() - triggerHandlerEntryTime;
 	isInsideTriggerHandler = false;
 	if (triggerDuration > triggerMaxDuration)
 		triggerMaxDuration = triggerDuration;
 }
+
+static void processShaftSignal(trigger_event_e signal, efitick_t timestamp) {
+#if EFI_SIGNAL_EXECUTOR_ONE_TIMER
+	/**
+	 * all the fuel and spark events scheduled while handling this edge share one hardware timer re-arm
+	 * on the way out, unless one of them is due too soon to wait for it
+	 */
+	engine->executor.beginBatch();
+#endif /* EFI_SIGNAL_EXECUTOR_ONE_TIMER */
+	doProcessShaftSignal(signal, timestamp);
+#if EFI_SIGNAL_EXECUTOR_ONE_TIMER
+	engine->executor.endBatch();
+#endif /* EFI_SIGNAL_EXECUTOR_ONE_TIMER */
+}
+
+#if EFI_TRIGGER_EVENT_QUEUE
+
+#define TRIGGER_EVENT_QUEUE_STACK_SIZE 1024
+
+static TriggerEventQueue triggerEventQueue;
+static binary_semaphore_t triggerEventQueueSemaphore;
+static THD_WORKING_AREA(triggerEventQueueStack, TRIGGER_EVENT_QUEUE_STACK_SIZE);
+/**
+ * longest time between edge capture and the beginning of its processing
+ */
+static uint32_t triggerEventQueueMaxLatency = 0;
+
+/**
+ * Edges are processed in the same order they were captured. Since fuel and spark events are scheduled relative
+ * to current time and not to the edge timestamp, queue latency adds to output timing error - see triggerinfo
+ */
+static msg_t triggerEventQueueThread(void *arg) {
+	(void) arg;
+	chRegSetThreadName("trigger queue");
+	while (true) {
+		chBSemWait(&triggerEventQueueSemaphore);
+		trigger_capture_s capture;
+		while (triggerEventQueue.pop(&capture)) {
+			// only a short delta is needed so lower 32 bits are enough
+			uint32_t latency = getTimeNowLowerNt() - (uint32_t) capture.timestamp;
+			if (latency > triggerEventQueueMaxLatency) {
+				triggerEventQueueMaxLatency = latency;
+			}
+			processShaftSignal(capture.signal, capture.timestamp);
+		}
+	}
+#if defined __GNUC__
+	return -1;
+#endif
+}
+
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
+
+#if EFI_TRIGGER_EVENT_QUEUE
+static void wakeUpTriggerEventQueue(void) {
+	// trigger emulator runs from a timer callback, input capture from ICU/EXTI interrupt
+	syssts_t sts = chSysGetStatusAndLockX();
+	chBSemSignalI(&triggerEventQueueSemaphore);
+	chSysRestoreStatusX(sts);
+}
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
+
+/**
+ * Invoked by input capture interrupt on each trigger edge
+ */
+void hwHandleShaftSignal(trigger_event_e signal) {
+	efitick_t timestamp = getTimeNowNt();
+#if EFI_TRIGGER_EVENT_QUEUE
+	/**
+	 * Capture interrupt only records the edge so that a slow listener would not delay the next edge capture,
+	 * all the processing happens in triggerEventQueueThread
+	 */
+	// overrun is counted by the queue, we still want to wake up the thread
+	triggerEventQueue.pushCaptured(signal, timestamp);
+	wakeUpTriggerEventQueue();
+#else
+	processShaftSignal(signal, timestamp);
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
+}
+
+/**
+ * Invoked by trigger emulator, which has its own ring since it could preempt input capture interrupt
+ */
+void hwHandleEmulatedShaftSignal(trigger_event_e signal) {
+	efitick_t timestamp = getTimeNowNt();
+#if EFI_TRIGGER_EVENT_QUEUE
+	triggerEventQueue.pushEmulated(signal, timestamp);
+	wakeUpTriggerEventQueue();
+#else
+	processShaftSignal(signal, timestamp);
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
+}
 #endif /* EFI_PROD_CODE */
 
 void TriggerCentral::resetCounters() {
@@ -310,6 +407,10 @@ bool TriggerCentral::noiseFilter(efitick_t nowNt, trigger_event_e signal DECLARE
 }
 
 void TriggerCentral::handleShaftSignal(trigger_event_e signal DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	handleShaftSignal(signal, getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+void TriggerCentral::handleShaftSignal(trigger_event_e signal, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	efiAssertVoid(CUSTOM_CONF_NULL, engine!=NULL, "configuration");
 
 	if (triggerShape.shapeDefinitionError) {
@@ -320,7 +421,7 @@ void TriggerCentral::handleShaftSignal(trigger_event_e signal DECLARE_ENGINE_PAR
 		return;
 	}
 
-	nowNt = getTimeNowNt();
+	nowNt = timestamp;
 
 	// This code gathers some statistics on signals and compares accumulated periods to filter interference
 	if (CONFIGB(useNoiselessTriggerDecoder)) {
@@ -517,9 +618,16 @@ extern int vvtEventFallCounter;
 void resetMaxValues() {
 #if EFI_PROD_CODE || EFI_SIMULATOR
 	maxEventCallbackDuration = triggerMaxDuration = 0;
+#if EFI_TRIGGER_EVENT_QUEUE
+	triggerEventQueue.resetCounters();
+	triggerEventQueueMaxLatency = 0;
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
 #endif /* EFI_PROD_CODE || EFI_SIMULATOR */
 
 	maxSchedulingPrecisionLoss = 0;
+#if EFI_SCHEDULER_HISTOGRAMS
+	resetSchedulerHistograms(&schedulerHistograms);
+#endif /* EFI_SCHEDULER_HISTOGRAMS */
 
 #if EFI_CLOCK_LOCKS
 	maxLockedDuration = 0;
@@ -586,6 +694,20 @@ void triggerInfo(void) {
 		scheduleMsg(logger, "gap from %.2f to %.2f", TRIGGER_SHAPE(syncronizationRatioFrom[0]), TRIGGER_SHAPE(syncronizationRatioTo[0]));
 	}
 
+#if EFI_TRIGGER_EVENT_QUEUE
+	scheduleMsg(logger, "trigger queue backlog=%d maxBacklog=%d overruns=%d maxLatency=%d",
+			triggerEventQueue.getBacklog(), triggerEventQueue.getMaxBacklog(), triggerEventQueue.getOverrunCounter(),
+			triggerEventQueueMaxLatency);
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
+
+#if EFI_TOOTH_LOGGER
+	ToothLoggerStats toothLoggerStats = GetToothLoggerStats();
+	scheduleMsg(logger, "tooth logger enabled=%s buffers=%d dropped=%d", boolToString(toothLoggerStats.Enabled),
+			toothLoggerStats.BufferCount, toothLoggerStats.DroppedCount);
+#endif /* EFI_TOOTH_LOGGER */
+	scheduleMsg(logger, "verbose trigger messages=%d dropped=%d", getDeferredMessageCounter(),
+			getDeferredDroppedCounter());
+
 #endif /* EFI_PROD_CODE || EFI_SIMULATOR */
 
 #if EFI_PROD_CODE
@@ -727,6 +849,10 @@ void initTriggerCentral(Logging *sharedLogger) {
 #endif /* EFI_ENGINE_SNIFFER */
 
 #if EFI_PROD_CODE || EFI_SIMULATOR
+#if EFI_TRIGGER_EVENT_QUEUE
+	chBSemObjectInit(&triggerEventQueueSemaphore, true);
+	chThdCreateStatic(triggerEventQueueStack, sizeof(triggerEventQueueStack), HIGHPRIO, (tfunc_t)(void*) triggerEventQueueThread, NULL);
+#endif /* EFI_TRIGGER_EVENT_QUEUE */
 	addConsoleAction(CMD_TRIGGERINFO, triggerInfo);
 	addConsoleAction("trigger_shape_info", triggerShapeInfo);
 	addConsoleAction("reset_trigger", resetRunningTriggerCounters);
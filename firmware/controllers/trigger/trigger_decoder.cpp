@@ -29,6 +29,7 @@
 #include "engine_math.h"
 #include "trigger_central.h"
 #include "trigger_simulator.h"
+#include "deferred_log.h"
 
 #if EFI_SENSOR_CHART
 #include "sensor_chart.h"
@@ -360,7 +361,7 @@ void TriggerState::handleTriggerError(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	totalTriggerErrorCounter++;
 	if (CONFIG(verboseTriggerSynchDetails) || someSortOfTriggerError) {
 #if EFI_PROD_CODE
-		scheduleMsg(logger, "error: synchronizationPoint @ index %d expected %d/%d/%d got %d/%d/%d",
+		deferredMsg("error: synchronizationPoint @ index %d expected %d/%d/%d got %d/%d/%d",
 				currentCycle.current_index, TRIGGER_SHAPE(expectedEventCount[0]),
 				TRIGGER_SHAPE(expectedEventCount[1]), TRIGGER_SHAPE(expectedEventCount[2]),
 				currentCycle.eventCount[0], currentCycle.eventCount[1], currentCycle.eventCount[2]);
@@ -527,10 +528,10 @@ void TriggerState::decodeTriggerEvent(trigger_event_e const signal, efitime_t no
 				for (int i = 0;i<GAP_TRACKING_LENGTH;i++) {
 					float gap = 1.0 * toothDurations[i] / toothDurations[i + 1];
 					if (cisnan(gap)) {
-						scheduleMsg(logger, "index=%d NaN gap, you have noise issues?",
+						deferredMsg("index=%d NaN gap, you have noise issues?",
 								i);
 					} else {
-						scheduleMsg(logger, "time=%d index=%d: gap=%.2f expected from %.2f to %.2f error=%s",
+						deferredMsg("time=%d index=%d: gap=%.2f expected from %.2f to %.2f error=%s",
 							getTimeNowSeconds(),
 							i,
 							gap,
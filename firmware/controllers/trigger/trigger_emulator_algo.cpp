@@ -49,17 +49,17 @@ void TriggerEmulatorHelper::handleEmulatorCallback(PwmConfig *state, int stateIn
 
 	if (needEvent(stateIndex, state->phaseCount, &state->multiWave, 0)) {
 		pin_state_t currentValue = multiWave->getChannelState(/*phaseIndex*/0, stateIndex);
-		hwHandleShaftSignal(currentValue ? SHAFT_PRIMARY_RISING : SHAFT_PRIMARY_FALLING);
+		hwHandleEmulatedShaftSignal(currentValue ? SHAFT_PRIMARY_RISING : SHAFT_PRIMARY_FALLING);
 	}
 
 	if (needEvent(stateIndex, state->phaseCount, &state->multiWave, 1)) {
 		pin_state_t currentValue = multiWave->getChannelState(/*phaseIndex*/1, stateIndex);
-		hwHandleShaftSignal(currentValue ? SHAFT_SECONDARY_RISING : SHAFT_SECONDARY_FALLING);
+		hwHandleEmulatedShaftSignal(currentValue ? SHAFT_SECONDARY_RISING : SHAFT_SECONDARY_FALLING);
 	}
 
 	if (needEvent(stateIndex, state->phaseCount, &state->multiWave, 2)) {
 		pin_state_t currentValue = multiWave->getChannelState(/*phaseIndex*/2, stateIndex);
-		hwHandleShaftSignal(currentValue ? SHAFT_3RD_RISING : SHAFT_3RD_FALLING);
+		hwHandleEmulatedShaftSignal(currentValue ? SHAFT_3RD_RISING : SHAFT_3RD_FALLING);
 	}
 
 	//	print("hello %d\r\n", chTimeNow());
@@ -0,0 +1,56 @@
+/**
+ * @file trigger_event_queue.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "trigger_event_queue.h"
+
+bool TriggerEventQueue::pushCaptured(trigger_event_e signal, efitick_t timestamp) {
+	trigger_capture_s capture = { timestamp, signal };
+	return captured.push(capture);
+}
+
+bool TriggerEventQueue::pushEmulated(trigger_event_e signal, efitick_t timestamp) {
+	trigger_capture_s capture = { timestamp, signal };
+	return emulated.push(capture);
+}
+
+bool TriggerEventQueue::pop(trigger_capture_s *capture) {
+	trigger_capture_s capturedHead;
+	trigger_capture_s emulatedHead;
+	bool hasCaptured = captured.peek(&capturedHead);
+	bool hasEmulated = emulated.peek(&emulatedHead);
+	if (hasCaptured && hasEmulated) {
+		// equal timestamps: real edge first
+		if (emulatedHead.timestamp < capturedHead.timestamp) {
+			return emulated.pop(capture);
+		}
+		return captured.pop(capture);
+	}
+	if (hasCaptured) {
+		return captured.pop(capture);
+	}
+	if (hasEmulated) {
+		return emulated.pop(capture);
+	}
+	return false;
+}
+
+int TriggerEventQueue::getBacklog() const {
+	return captured.getBacklog() + emulated.getBacklog();
+}
+
+int TriggerEventQueue::getMaxBacklog() const {
+	return maxI(captured.maxBacklog, emulated.maxBacklog);
+}
+
+uint32_t TriggerEventQueue::getOverrunCounter() const {
+	return captured.overrunCounter + emulated.overrunCounter;
+}
+
+void TriggerEventQueue::resetCounters() {
+	captured.resetCounters();
+	emulated.resetCounters();
+}
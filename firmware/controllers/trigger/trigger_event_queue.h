@@ -0,0 +1,53 @@
+/**
+ * @file trigger_event_queue.h
+ * @brief Trigger edges waiting to be decoded, see EFI_TRIGGER_EVENT_QUEUE
+ *
+ * Each producer has its own single-producer ring: input capture interrupt and trigger emulator
+ * could preempt each other so they cannot share one. Consumer merges both rings by edge timestamp.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef TRIGGER_EVENT_QUEUE_H_
+#define TRIGGER_EVENT_QUEUE_H_
+
+#include "global.h"
+#include "spsc_queue.h"
+
+#define TRIGGER_EVENT_QUEUE_SIZE 64
+
+typedef struct {
+	efitick_t timestamp;
+	trigger_event_e signal;
+} trigger_capture_s;
+
+typedef SpscQueue<trigger_capture_s, TRIGGER_EVENT_QUEUE_SIZE> trigger_capture_queue_t;
+
+class TriggerEventQueue {
+public:
+	/**
+	 * Input capture interrupt side
+	 * @return false if edge was dropped
+	 */
+	bool pushCaptured(trigger_event_e signal, efitick_t timestamp);
+	/**
+	 * Trigger emulator side
+	 * @return false if edge was dropped
+	 */
+	bool pushEmulated(trigger_event_e signal, efitick_t timestamp);
+	/**
+	 * Consumer side, oldest edge of both rings goes first
+	 * @return false if both rings are empty
+	 */
+	bool pop(trigger_capture_s *capture);
+	int getBacklog() const;
+	int getMaxBacklog() const;
+	uint32_t getOverrunCounter() const;
+	void resetCounters();
+
+	trigger_capture_queue_t captured;
+	trigger_capture_queue_t emulated;
+};
+
+#endif /* TRIGGER_EVENT_QUEUE_H_ */
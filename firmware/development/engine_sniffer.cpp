@@ -47,6 +47,7 @@ EXTERN_ENGINE
 ;
 extern uint32_t maxLockedDuration;
 
+#if EFI_ENGINE_SNIFFER_TEXT
 /**
  * This is the number of events in the digital chart which would be displayed
  * on the 'digital sniffer' pane
@@ -58,6 +59,22 @@ extern uint32_t maxLockedDuration;
 #endif
 
 static char WAVE_LOGGING_BUFFER[WAVE_LOGGING_SIZE] CCM_OPTIONAL;
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+
+#if EFI_ENGINE_SNIFFER_BINARY
+/**
+ * Writers only reserve a record with a compare-and-swap and fill it, there is no lock and no text
+ * formatting. Charts are switched by status loop thread.
+ */
+static engine_sniffer_chart_s charts[ENGINE_SNIFFER_CHART_COUNT] CCM_OPTIONAL;
+#if EFI_ENGINE_SNIFFER_TEXT
+static char valueBuffer[_MAX_FILLER];
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+/**
+ * ticks since chart start have to fit into uint32_t
+ */
+#define ENGINE_SNIFFER_MAX_DURATION_NT 0x7FFFFFFF
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 
 int waveChartUsedSize;
 
@@ -74,8 +91,9 @@ static LoggingWithStorage logger("wave info");
  */
 static uint32_t skipUntilEngineCycle = 0;
 
-#if ! EFI_UNIT_TEST
 extern WaveChart waveChart;
+
+#if ! EFI_UNIT_TEST
 static void resetNow(void) {
 	skipUntilEngineCycle = engine->rpmCalculator.getRevolutionCounter() + 3;
 	waveChart.reset();
@@ -86,7 +104,15 @@ WaveChart::WaveChart() {
 }
 
 void WaveChart::init() {
+#if EFI_ENGINE_SNIFFER_BINARY
+	for (int i = 0; i < ENGINE_SNIFFER_CHART_COUNT; i++) {
+		charts[i].committed = 0;
+		charts[i].startTimeNt = getTimeNowNt();
+	}
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+#if EFI_ENGINE_SNIFFER_TEXT
 	logging.initLoggingExt("wave chart", WAVE_LOGGING_BUFFER, sizeof(WAVE_LOGGING_BUFFER));
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
 	isInitialized = true;
 	reset();
 }
@@ -95,11 +121,18 @@ void WaveChart::reset() {
 #if DEBUG_WAVE
 	scheduleSimpleMsg(&debugLogging, "reset while at ", counter);
 #endif /* DEBUG_WAVE */
+#if EFI_ENGINE_SNIFFER_BINARY
+	/**
+	 * writers could be using the active chart right now, status loop would close and discard it
+	 */
+	isResetRequested = true;
+#else
 	resetLogging(&logging);
 	counter = 0;
 	startTimeNt = 0;
-	collectingData = false;
 	appendPrintf(&logging, "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+	collectingData = false;
 }
 
 void WaveChart::startDataCollection() {
@@ -113,17 +146,39 @@ bool WaveChart::isStartedTooLongAgo() const {
 	 * engineChartSize/20 is the longest meaningful chart.
 	 *
 	 */
+#if EFI_ENGINE_SNIFFER_BINARY
+	uint32_t slot = activeSlot;
+	const engine_sniffer_chart_s *chart = &charts[ENGINE_SNIFFER_SLOT_CHART(slot)];
+	efitime_t chartDurationNt = getTimeNowNt() - chart->startTimeNt;
+	return ENGINE_SNIFFER_SLOT_INDEX(slot) != 0 && (chartDurationNt > ENGINE_SNIFFER_MAX_DURATION_NT
+			|| NT2US(chartDurationNt) > engineConfiguration->engineChartSize * 1000000 / 20);
+#else
 	efitime_t chartDurationNt = getTimeNowNt() - startTimeNt;
 	return startTimeNt != 0 && NT2US(chartDurationNt) > engineConfiguration->engineChartSize * 1000000 / 20;
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 }
 
+#if EFI_ENGINE_SNIFFER_BINARY
+static int getChartLimit(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return minI(CONFIG(engineChartSize), ENGINE_SNIFFER_RECORD_COUNT);
+}
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+
 bool WaveChart::isFull() const {
+#if EFI_ENGINE_SNIFFER_BINARY
+	return ENGINE_SNIFFER_SLOT_INDEX(activeSlot) >= (uint32_t)getChartLimit(PASS_ENGINE_PARAMETER_SIGNATURE);
+#else
 	return counter >= CONFIG(engineChartSize);
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 }
 
 static void printStatus(void) {
 	scheduleMsg(&logger, "engine chart: %s", boolToString(engineConfiguration->isEngineChartEnabled));
 	scheduleMsg(&logger, "engine chart size=%d", engineConfiguration->engineChartSize);
+#if EFI_ENGINE_SNIFFER_BINARY
+	scheduleMsg(&logger, "binary engine chart: capacity=%d charts=%d dropped=%d", ENGINE_SNIFFER_RECORD_COUNT,
+			waveChart.chartCounter, waveChart.droppedCounter);
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 }
 
 static void setChartActive(int value) {
@@ -142,13 +197,167 @@ void setChartSize(int newSize) {
 	printStatus();
 }
 
+#if EFI_ENGINE_SNIFFER_BINARY
+
+/**
+ * Makes a spare chart active and closes the previous one, only invoked by status loop
+ */
+void WaveChart::switchChart() {
+	if (closingChart != -1) {
+		// previous chart is not published yet, writers would keep filling active one up to its capacity
+		return;
+	}
+	int active = ENGINE_SNIFFER_SLOT_CHART(activeSlot);
+	// TunerStudio thread could be picking a chart to read
+	bool alreadyLocked = lockAnyContext();
+	int next = -1;
+	for (int i = 0; i < ENGINE_SNIFFER_CHART_COUNT; i++) {
+		if (i == active || i == readingChart) {
+			continue;
+		}
+		// latest published chart is only reused if the spare one is being sent to TunerStudio
+		if (next == -1 || next == publishedChart) {
+			next = i;
+		}
+	}
+	if (next == publishedChart) {
+		publishedChart = -1;
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+	engine_sniffer_chart_s *chart = &charts[next];
+	chart->committed = 0;
+	chart->startTimeNt = getTimeNowNt();
+
+	/**
+	 * writer which has already reserved a record in previous chart is counted here, any later writer
+	 * gets a record in the new chart
+	 */
+	uint32_t previous = switchEngineSnifferChart(&activeSlot, next);
+	closingChart = ENGINE_SNIFFER_SLOT_CHART(previous);
+	charts[closingChart].header.recordCount = minI(ENGINE_SNIFFER_SLOT_INDEX(previous), ENGINE_SNIFFER_RECORD_COUNT);
+	isClosingDiscarded = isResetRequested;
+	isResetRequested = false;
+}
+
+void WaveChart::publishBinary(engine_sniffer_chart_s *chart) {
+	engine_sniffer_header_s *header = &chart->header;
+	int count = 0;
+	while (count < ENGINE_SNIFFER_CHANNEL_COUNT && channelNames[count] != NULL) {
+		count++;
+	}
+	header->version = ENGINE_SNIFFER_BINARY_VERSION;
+	header->channelCount = count;
+	header->ticksPerSecond = US2NT(1000000);
+	header->chartCounter = ++chartCounter;
+	header->droppedCounter = droppedCounter;
+	memset(header->names, 0, sizeof(header->names));
+	for (int i = 0; i < count; i++) {
+		strncpy(header->names[i], channelNames[i], ENGINE_SNIFFER_NAME_SIZE - 1);
+	}
+
+	/**
+	 * TunerStudio reads the records, see TS_GET_ENGINE_SNIFFER
+	 */
+	bool alreadyLocked = lockAnyContext();
+	publishedChart = chart - charts;
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+#if EFI_ENGINE_SNIFFER_TEXT
+	publishText(chart);
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+	waveChartUsedSize = sizeof(engine_sniffer_header_s) + header->recordCount * sizeof(engine_sniffer_record_s);
+}
+
+#if EFI_ENGINE_SNIFFER_TEXT
+/**
+ * Same text as addEvent3() produces without EFI_ENGINE_SNIFFER_BINARY. Records are not necessarily
+ * in time order if writers have interrupted each other.
+ */
+void WaveChart::publishText(const engine_sniffer_chart_s *chart) {
+	const engine_sniffer_header_s *header = &chart->header;
+	uint32_t firstTimeNt = 0xFFFFFFFF;
+	for (int i = 0; i < header->recordCount; i++) {
+		if (chart->records[i].timeNt < firstTimeNt) {
+			firstTimeNt = chart->records[i].timeNt;
+		}
+	}
+
+	resetLogging(&logging);
+	appendPrintf(&logging, "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
+	for (int i = 0; i < header->recordCount; i++) {
+		if (remainingSize(&logging) <= 35) {
+			break;
+		}
+		const engine_sniffer_record_s *record = &chart->records[i];
+		appendFast(&logging, channelNames[record->channel]);
+		appendChar(&logging, CHART_DELIMETER);
+		printEngineSnifferValue(valueBuffer, record);
+		appendFast(&logging, valueBuffer);
+		appendChar(&logging, CHART_DELIMETER);
+		uint32_t time100 = NT2US((record->timeNt - firstTimeNt) / 10);
+		itoa10(valueBuffer, time100);
+		appendFast(&logging, valueBuffer);
+		appendChar(&logging, CHART_DELIMETER);
+	}
+	logging.linePointer[0] = 0;
+	publish();
+}
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+
+const engine_sniffer_chart_s *WaveChart::beginBinaryRead() {
+	bool alreadyLocked = lockAnyContext();
+	readingChart = publishedChart;
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+	return readingChart == -1 ? NULL : &charts[readingChart];
+}
+
+void WaveChart::endBinaryRead() {
+	readingChart = -1;
+}
+
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+
 void WaveChart::publishIfFull() {
+#if EFI_ENGINE_SNIFFER_BINARY
+	if (closingChart == -1) {
+		if (isResetRequested || isFull() || isStartedTooLongAgo()) {
+			switchChart();
+		} else {
+			bool alreadyLocked = lockAnyContext();
+			uint32_t slot = activeSlot;
+			// while there are no events chart start follows current time so that record times stay small
+			if (ENGINE_SNIFFER_SLOT_INDEX(slot) == 0) {
+				charts[ENGINE_SNIFFER_SLOT_CHART(slot)].startTimeNt = getTimeNowNt();
+			}
+			if (!alreadyLocked) {
+				unlockAnyContext();
+			}
+			return;
+		}
+	}
+	engine_sniffer_chart_s *chart = &charts[closingChart];
+	if (chart->committed < chart->header.recordCount) {
+		// some writer was interrupted between reserving and filling the record, would try next time
+		return;
+	}
+	if (!isClosingDiscarded) {
+		publishBinary(chart);
+	}
+	closingChart = -1;
+#else
 	if (isFull() || isStartedTooLongAgo()) {
 		publish();
 		reset();
 	}
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 }
 
+#if EFI_ENGINE_SNIFFER_TEXT
 void WaveChart::publish() {
 	appendPrintf(&logging, DELIMETER);
 	waveChartUsedSize = loggingSize(&logging);
@@ -160,6 +369,28 @@ void WaveChart::publish() {
 		scheduleLogging(&logging);
 	}
 }
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+
+#if EFI_ENGINE_SNIFFER_BINARY
+
+void WaveChart::addBinaryEvent(const char *name, const char *msg) {
+	int channel = getEngineSnifferChannel(channelNames, name);
+	uint32_t slot;
+	if (channel == -1 || !reserveEngineSnifferRecord(&activeSlot, getChartLimit(PASS_ENGINE_PARAMETER_SIGNATURE), &slot)) {
+		// channel table or chart is full, status loop would switch to a spare chart
+		__sync_fetch_and_add(&droppedCounter, 1);
+		return;
+	}
+	engine_sniffer_chart_s *chart = &charts[ENGINE_SNIFFER_SLOT_CHART(slot)];
+	engine_sniffer_record_s *record = &chart->records[ENGINE_SNIFFER_SLOT_INDEX(slot)];
+	// after the reservation so that chart start is never later than the event
+	record->timeNt = getTimeNowNt() - chart->startTimeNt;
+	record->channel = channel;
+	encodeEngineSnifferValue(record, msg);
+	__sync_fetch_and_add(&chart->committed, 1);
+}
+
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 
 /**
  * @brief	Register an event for digital sniffer
@@ -188,14 +419,17 @@ void WaveChart::addEvent3(const char *name, const char * msg) {
 #if DEBUG_WAVE
 	scheduleSimpleMsg(&debugLogging, "current", chart->counter);
 #endif /* DEBUG_WAVE */
-	if (isFull()) {
-		return;
-	}
-
 #if EFI_HISTOGRAMS && EFI_PROD_CODE
 	int beforeCallback = hal_lld_get_counter_value();
 #endif
 
+#if EFI_ENGINE_SNIFFER_BINARY
+	addBinaryEvent(name, msg);
+#else
+	if (isFull()) {
+		return;
+	}
+
 	efitick_t nowNt = getTimeNowNt();
 
 	bool alreadyLocked = lockOutputBuffer(); // we have multiple threads writing to the same output buffer
@@ -235,6 +469,7 @@ void WaveChart::addEvent3(const char *name, const char * msg) {
 	if (!alreadyLocked) {
 		unlockOutputBuffer();
 	}
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 
 #if EFI_HISTOGRAMS && EFI_PROD_CODE
 	int64_t diff = hal_lld_get_counter_value() - beforeCallback;
@@ -14,6 +14,15 @@
 #if EFI_ENGINE_SNIFFER
 #include "datalogging.h"
 
+#if EFI_ENGINE_SNIFFER_BINARY
+#include "engine_sniffer_record.h"
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
+
+/**
+ * Simulator renders binary charts as text, rusEfi console and its functional tests read those
+ */
+#define EFI_ENGINE_SNIFFER_TEXT (! EFI_ENGINE_SNIFFER_BINARY || EFI_SIMULATOR)
+
 /**
  * @brief	rusEfi console sniffer data buffer
  */
@@ -25,10 +34,48 @@ public:
 	void reset();
 	void startDataCollection();
 	void publishIfFull();
+#if EFI_ENGINE_SNIFFER_TEXT
 	void publish();
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
 	bool isFull() const;
 	bool isStartedTooLongAgo() const;
+#if EFI_ENGINE_SNIFFER_BINARY
+	/**
+	 * @return latest published chart, which is not going to be reused until endBinaryRead()
+	 */
+	const engine_sniffer_chart_s *beginBinaryRead();
+	void endBinaryRead();
+	/**
+	 * events which did not fit into the chart or into channel table
+	 */
+	volatile uint32_t droppedCounter = 0;
+	uint32_t chartCounter = 0;
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 private:
+#if EFI_ENGINE_SNIFFER_BINARY
+	void addBinaryEvent(const char *name, const char *msg);
+	void switchChart();
+	void publishBinary(engine_sniffer_chart_s *chart);
+#if EFI_ENGINE_SNIFFER_TEXT
+	void publishText(const engine_sniffer_chart_s *chart);
+#endif /* EFI_ENGINE_SNIFFER_TEXT */
+	/**
+	 * entries are only ever added, by writers
+	 */
+	const char * volatile channelNames[ENGINE_SNIFFER_CHANNEL_COUNT] = {};
+	/**
+	 * see ENGINE_SNIFFER_SLOT
+	 */
+	volatile uint32_t activeSlot = ENGINE_SNIFFER_SLOT(0, 0);
+	/**
+	 * chart closed by switchChart(), waiting for all writers to commit
+	 */
+	int closingChart = -1;
+	int publishedChart = -1;
+	int readingChart = -1;
+	bool isResetRequested = false;
+	bool isClosingDiscarded = false;
+#endif /* EFI_ENGINE_SNIFFER_BINARY */
 	Logging logging;
 	char timeBuffer[10];
 	uint32_t counter = 0;
@@ -22,6 +22,38 @@
 
 static Logging* logger;
 
+/**
+ * 'before' is the same work inside of a critical zone, that is how getTimeNowNt used to be
+ */
+static void testTimeBase(const int count) {
+	efitick_t result = 0;
+
+	uint32_t start = getTimeNowLowerNt();
+	for (int i = 0; i < count; i++) {
+		syssts_t sts = chSysGetStatusAndLockX();
+		result += getTimeNowNt();
+		chSysRestoreStatusX(sts);
+	}
+	uint32_t lockedCycles = getTimeNowLowerNt() - start;
+
+	start = getTimeNowLowerNt();
+	for (int i = 0; i < count; i++) {
+		result += getTimeNowNt();
+	}
+	uint32_t lockFreeCycles = getTimeNowLowerNt() - start;
+
+	start = getTimeNowLowerNt();
+	for (int i = 0; i < count; i++) {
+		result += getTimeNowLowerNt();
+	}
+	uint32_t lowerCycles = getTimeNowLowerNt() - start;
+
+	if (result != 0) {
+		scheduleMsg(logger, "getTimeNowNt cycles per call: with lock %.2f lock-free %.2f lower %.2f",
+				(float) lockedCycles / count, (float) lockFreeCycles / count, (float) lowerCycles / count);
+	}
+}
+
 static void testSystemCalls(const int count) {
 	time_t start, time;
 	long result = 0;
@@ -65,6 +97,8 @@ static void testSystemCalls(const int count) {
 	time = currentTimeMillis() - start;
 	if (result != 0)
 		scheduleMsg(logger, "Finished %d iterations of 'currentTimeMillis' in %dms", count, time);
+
+	testTimeBase(count);
 }
 
 static Engine testEngine;
@@ -259,8 +293,6 @@ static void runTests(const int count) {
 	testMath(count);
 }
 
-extern Overflow64Counter halTime;
-
 #if EFI_RTC
 static int rtcStartTime;
 #endif
@@ -269,7 +301,7 @@ static int rtcStartTime;
 
 static void timeInfo(void) {
 	scheduleMsg(logger, "chTimeNow as seconds = %d", getTimeNowSeconds());
-	scheduleMsg(logger, "hal seconds = %d", halTime.get() / (long)CORE_CLOCK);
+	scheduleMsg(logger, "hal seconds = %d", (int) (getTimeNowNt() / CORE_CLOCK));
 
 #if EFI_RTC
 	int unix = rtcGetTimeUnixSec(&RTCD1) - rtcStartTime;
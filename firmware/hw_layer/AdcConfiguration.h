@@ -9,12 +9,9 @@
 
 #if HAL_USE_ADC
 
-#define ADC_MAX_CHANNELS_COUNT 16
+#include "adc_filter.h"
 
-// this structure contains one multi-channel ADC state snapshot
-typedef struct {
-	volatile adcsample_t adc_data[ADC_MAX_CHANNELS_COUNT];
-} adc_state;
+#define ADC_MAX_CHANNELS_COUNT 16
 
 class AdcDevice {
 public:
@@ -41,7 +38,10 @@ public:
 
 	int getAdcValueByHwChannel(int hwChannel) const;
 
-	adc_state values;
+	/**
+	 * filtered values by internal index, updated once per completed DMA buffer or half-buffer
+	 */
+	AdcFilterBank filter;
 	int channelCount;
 private:
 	ADCConversionGroup* hwConfig;
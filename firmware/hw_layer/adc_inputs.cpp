@@ -8,7 +8,9 @@
  * At the moment rusEfi does not allow to have more than 16 ADC channels combined. At the moment there is no flexibility to use
  * any ADC pins, only the hardcoded choice of 16 pins.
  *
- * Slow ADC group is used for IAT, CLT, AFR, VBATT etc - this one is currently sampled at 20Hz
+ * Slow ADC group is used for IAT, CLT, AFR, VBATT etc - with EFI_SLOW_ADC_CIRCULAR this one is free-running
+ * into a circular DMA buffer and each half of the buffer is decimated and filtered while DMA fills the other half,
+ * otherwise it is sampled at 20Hz
  *
  * Fast ADC group is used for TPS, MAP, MAF HIP - this one is currently sampled at 10KHz
  *  We need frequent MAP for map_averaging.cpp
@@ -36,12 +38,32 @@
 #include "maf.h"
 //#include "biquad.h"
 
-/* Depth of the conversion buffer, channels are sampled X times each.*/
-#define ADC_BUF_DEPTH_SLOW      8
-#define ADC_BUF_DEPTH_FAST      4
-
 //static Biquad biq[ADC_MAX_CHANNELS_COUNT];
 
+static_assert(sizeof(adcsample_t) == sizeof(uint16_t), "AdcFilterBank expects 16 bit samples");
+
+#if EFI_SLOW_ADC_CIRCULAR
+/**
+ * ADC clock with default ADCPRE divider, used to estimate how often each half-buffer completes
+ */
+#ifndef ADC_SLOW_CLOCK
+#define ADC_SLOW_CLOCK (STM32_PCLK2 / 4)
+#endif /* ADC_SLOW_CLOCK */
+// 480 cycles sampling plus 12 bit conversion
+#define ADC_SLOW_CONVERSION_CYCLES (480 + 12)
+/**
+ * Slow channels get a filter step this often no matter how many channels are sampled, this is
+ * the rate slowAdcAlpha was tuned for
+ */
+#define ADC_SLOW_FILTER_PERIOD_US 50000
+#endif /* EFI_SLOW_ADC_CIRCULAR */
+
+/**
+ * per-channel IIR alpha set by 'adcfilter' command, NAN means slowAdcAlpha
+ */
+static float adcFilterAlpha[HW_MAX_ADC_INDEX];
+static float appliedSlowAdcAlpha = NAN;
+
 static adc_channel_mode_e adcHwChannelEnabled[HW_MAX_ADC_INDEX];
 static const char * adcHwChannelUsage[HW_MAX_ADC_INDEX];
 
@@ -95,15 +117,6 @@ static int adcDebugReporting = false;
 
 EXTERN_ENGINE;
 
-static adcsample_t getAvgAdcValue(int index, adcsample_t *samples, int bufDepth, int numChannels) {
-	adcsample_t result = 0;
-	for (int i = 0; i < bufDepth; i++) {
-		result += samples[index];
-		index += numChannels;
-	}
-	return result / bufDepth;
-}
-
 static void adc_callback_slow(ADCDriver *adcp, adcsample_t *buffer, size_t n);
 
 #define ADC_SAMPLING_SLOW ADC_SAMPLE_480
@@ -111,7 +124,7 @@ static void adc_callback_slow(ADCDriver *adcp, adcsample_t *buffer, size_t n);
 /*
  * ADC conversion group.
  */
-static ADCConversionGroup adcgrpcfgSlow = { FALSE, 0, adc_callback_slow, NULL,
+static ADCConversionGroup adcgrpcfgSlow = { EFI_SLOW_ADC_CIRCULAR, 0, adc_callback_slow, NULL,
 /* HW dependent part.*/
 ADC_TwoSamplingDelay_20Cycles,   // cr1
 		ADC_CR2_SWSTART, // cr2
@@ -221,10 +234,12 @@ void doSlowAdc(void) {
 }
 
 #if HAL_USE_PWM
+#if !EFI_SLOW_ADC_CIRCULAR
 static void pwmpcb_slow(PWMDriver *pwmp) {
 	(void) pwmp;
 	doSlowAdc();
 }
+#endif /* EFI_SLOW_ADC_CIRCULAR */
 
 static void pwmpcb_fast(PWMDriver *pwmp) {
 	efiAssertVoid(CUSTOM_ERR_6659, getCurrentRemainingStack()> 32, "lwStAdcFast");
@@ -281,11 +296,7 @@ int getInternalAdcValue(const char *msg, adc_channel_e hwChannel) {
 
 
 	if (adcHwChannelEnabled[hwChannel] == ADC_FAST) {
-		int internalIndex = fastAdc.internalAdcIndexByHardwareIndex[hwChannel];
-// todo if ADC_BUF_DEPTH_FAST EQ 1
-//		return fastAdc.samples[internalIndex];
-		int value = getAvgAdcValue(internalIndex, fastAdc.samples, ADC_BUF_DEPTH_FAST, fastAdc.size());
-		return value;
+		return fastAdc.getAdcValueByHwChannel(hwChannel);
 	}
 	if (adcHwChannelEnabled[hwChannel] != ADC_SLOW) {
 		warning(CUSTOM_OBD_WRONG_ADC_MODE, "ADC is off [%s] index=%d", msg, hwChannel);
@@ -295,11 +306,13 @@ int getInternalAdcValue(const char *msg, adc_channel_e hwChannel) {
 }
 
 #if HAL_USE_PWM
+#if !EFI_SLOW_ADC_CIRCULAR
 static PWMConfig pwmcfg_slow = { PWM_FREQ_SLOW, PWM_PERIOD_SLOW, pwmpcb_slow, { {
 PWM_OUTPUT_DISABLED, NULL }, { PWM_OUTPUT_DISABLED, NULL }, {
 PWM_OUTPUT_DISABLED, NULL }, { PWM_OUTPUT_DISABLED, NULL } },
 /* HW dependent part.*/
 0, 0 };
+#endif /* EFI_SLOW_ADC_CIRCULAR */
 
 static PWMConfig pwmcfg_fast = { PWM_FREQ_FAST, PWM_PERIOD_FAST, pwmpcb_fast, { {
 PWM_OUTPUT_DISABLED, NULL }, { PWM_OUTPUT_DISABLED, NULL }, {
@@ -337,11 +350,11 @@ int AdcDevice::size() const {
 
 int AdcDevice::getAdcValueByHwChannel(int hwChannel) const {
 	int internalIndex = internalAdcIndexByHardwareIndex[hwChannel];
-	return values.adc_data[internalIndex];
+	return (int) filter.getValue(internalIndex);
 }
 
 int AdcDevice::getAdcValueByIndex(int internalIndex) const {
-	return values.adc_data[internalIndex];
+	return (int) filter.getValue(internalIndex);
 }
 
 void AdcDevice::invalidateSamplesCache() {
@@ -358,6 +371,7 @@ void AdcDevice::invalidateSamplesCache() {
 void AdcDevice::init(void) {
 	hwConfig->num_channels = size();
 	hwConfig->sqr1 += ADC_SQR1_NUM_CH(size());
+	filter.setChannelCount(size());
 }
 
 bool AdcDevice::isHwUsed(adc_channel_e hwChannelIndex) const {
@@ -442,31 +456,81 @@ int getSlowAdcCounter() {
 	return slowAdcCounter;
 }
 
-static void adc_callback_slow(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
-	(void) buffer;
-	(void) n;
+/**
+ * Filter strength could be changed at any time so it is applied from the ADC callback. Only
+ * alpha is changed so filter state is kept.
+ */
+static void applySlowAdcFilterAlpha(void) {
+	appliedSlowAdcAlpha = CONFIG(slowAdcAlpha);
+	for (int i = 0; i < slowAdc.size(); i++) {
+		adc_channel_e hwChannel = slowAdc.getAdcHardwareIndexByInternalIndex(i);
+		float alpha = hwChannel < HW_MAX_ADC_INDEX && !cisnan(adcFilterAlpha[hwChannel]) ?
+				adcFilterAlpha[hwChannel] : appliedSlowAdcAlpha;
+		slowAdc.filter.setAlpha(i, alpha);
+	}
+}
 
+static void adc_callback_slow(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
 	slowAdc.invalidateSamplesCache();
 
 	efiAssertVoid(CUSTOM_ERR_6671, getCurrentRemainingStack() > 128, "lowstck#9c");
+	if (CONFIG(slowAdcAlpha) != appliedSlowAdcAlpha) {
+		applySlowAdcFilterAlpha();
+	}
+#if EFI_SLOW_ADC_CIRCULAR
+	(void) adcp;
+	/**
+	 * In circular mode this is invoked for each half of the buffer, DMA keeps writing into the
+	 * other half while we are here.
+	 */
+	slowAdc.filter.processBlock(buffer, n);
+	// only count conversions which have produced new values, see waitForSlowAdc
+	slowAdcCounter = slowAdc.filter.getVersion();
+#else
+	(void) buffer;
+	(void) n;
 	/* Note, only in the ADC_COMPLETE state because the ADC driver fires
 	 * an intermediate callback when the buffer is half full. */
 	if (adcp->state == ADC_COMPLETE) {
-		/* Calculates the average values from the ADC samples.*/
-		for (int i = 0; i < slowAdc.size(); i++) {
-			int value = getAvgAdcValue(i, slowAdc.samples, ADC_BUF_DEPTH_SLOW, slowAdc.size());
-			adcsample_t prev = slowAdc.values.adc_data[i];
-			float result = (slowAdcCounter == 0) ? value :
-					CONFIG(slowAdcAlpha) * value + (1 - CONFIG(slowAdcAlpha)) * prev;
-//			if (slowAdcCounter == 0) {
-//				biq[i].initValue(value);
-//			}
-//			float result = biq[i].getValue(value);
-
-			slowAdc.values.adc_data[i] = (int)result;
-		}
+		slowAdc.filter.processBlock(slowAdc.samples, ADC_BUF_DEPTH_SLOW);
 		slowAdcCounter++;
 	}
+#endif /* EFI_SLOW_ADC_CIRCULAR */
+}
+
+#if EFI_SLOW_ADC_CIRCULAR
+/**
+ * Each half-buffer is one filter block
+ */
+static int getSlowAdcDecimation(void) {
+	int halfBufferUs = 1000000LL * ADC_SLOW_CONVERSION_CYCLES * slowAdc.size() * (ADC_BUF_DEPTH_SLOW / 2) / ADC_SLOW_CLOCK;
+	return getAdcFilterDecimation(halfBufferUs, ADC_SLOW_FILTER_PERIOD_US);
+}
+#endif /* EFI_SLOW_ADC_CIRCULAR */
+
+static void configureSlowAdcFilters(void) {
+#if EFI_SLOW_ADC_CIRCULAR
+	int decimation = getSlowAdcDecimation();
+#else
+	int decimation = 1;
+#endif /* EFI_SLOW_ADC_CIRCULAR */
+	for (int i = 0; i < slowAdc.size(); i++) {
+		slowAdc.filter.configure(i, CONFIG(slowAdcAlpha), decimation);
+	}
+	applySlowAdcFilterAlpha();
+}
+
+static void setAdcFilter(float hwChannel, float alpha) {
+	int index = (int) hwChannel;
+	if (index < 0 || index >= HW_MAX_ADC_INDEX) {
+		scheduleMsg(&logger, "invalid ADC channel %d", index);
+		return;
+	}
+	// zero goes back to slowAdcAlpha
+	adcFilterAlpha[index] = alpha > 0 ? alpha : NAN;
+	// applied by next ADC callback
+	appliedSlowAdcAlpha = NAN;
+	scheduleMsg(&logger, "ADC%d filter alpha %.3f", index, alpha);
 }
 
 static char errorMsgBuff[10];
@@ -540,9 +604,13 @@ void initAdcInputs() {
 		firmwareError(CUSTOM_ERR_ADC_DEPTH_SLOW, "ADC_BUF_DEPTH_SLOW too high");
 
 	configureInputs();
+	for (int i = 0; i < HW_MAX_ADC_INDEX; i++) {
+		adcFilterAlpha[i] = NAN;
+	}
 
 	// migrate to 'enable adcdebug'
 	addConsoleActionI("adcdebug", &setAdcDebugReporting);
+	addConsoleActionFF("adcfilter", setAdcFilter);
 
 #if EFI_INTERNAL_ADC
 	/*
@@ -571,10 +639,14 @@ void initAdcInputs() {
 #endif /* ADC_CHANNEL_SENSOR */
 
 	slowAdc.init();
-#if HAL_USE_PWM
+	configureSlowAdcFilters();
+#if EFI_SLOW_ADC_CIRCULAR
+	// started once, from now on DMA keeps refilling the buffer
+	adcStartConversion(&ADC_SLOW_DEVICE, &adcgrpcfgSlow, slowAdc.samples, ADC_BUF_DEPTH_SLOW);
+#elif HAL_USE_PWM
 	pwmStart(EFI_INTERNAL_SLOW_ADC_PWM, &pwmcfg_slow);
 	pwmEnablePeriodicNotification(EFI_INTERNAL_SLOW_ADC_PWM);
-#endif /* HAL_USE_PWM */
+#endif /* EFI_SLOW_ADC_CIRCULAR */
 
 	if (CONFIGB(isFastAdcEnabled)) {
 		fastAdc.init();
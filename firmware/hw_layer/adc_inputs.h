@@ -40,6 +40,10 @@ float getMCUInternalTemperature(void);
 void addChannel(const char *name, adc_channel_e setting, adc_channel_mode_e mode);
 void removeChannel(const char *name, adc_channel_e setting);
 
+/* Depth of the conversion buffer, channels are sampled X times each.*/
+#define ADC_BUF_DEPTH_SLOW      8
+#define ADC_BUF_DEPTH_FAST      4
+
 // max(ADC_BUF_DEPTH_SLOW, ADC_BUF_DEPTH_FAST)
 #define MAX_ADC_GRP_BUF_DEPTH 8
 
@@ -0,0 +1,192 @@
+/**
+ * @file can_bus.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "can_bus.h"
+
+/**
+ * Frame has to be completely copied before the other side sees the new index
+ */
+#define CAN_BUS_MEMORY_BARRIER() __sync_synchronize()
+
+/**
+ * CAN thread still wakes up once in a while if there are no periodic messages
+ */
+#define CAN_MAX_SLEEP_MS 100
+
+void initCanFrame(can_frame_s *frame, uint32_t id) {
+	memset(frame, 0, sizeof(can_frame_s));
+	frame->id = id;
+	frame->isExtended = id > CAN_STD_ID_MASK;
+	frame->dlc = 8;
+}
+
+bool isCanFilterMatch(const can_rx_filter_s *filter, const can_frame_s *frame) {
+	return filter->isExtended == frame->isExtended && (frame->id & filter->mask) == (filter->id & filter->mask);
+}
+
+CanBus::CanBus() {
+	driver = NULL;
+	rxFilterCount = 0;
+	periodicCount = 0;
+	defaultPeriodMs = 50;
+	rxWriteIndex = 0;
+	rxReadIndex = 0;
+	txWriteIndex = 0;
+	txReadIndex = 0;
+	rxCounter = 0;
+	rxOverrunCounter = 0;
+	rxUnhandledCounter = 0;
+	txCounter = 0;
+	txOverrunCounter = 0;
+}
+
+void CanBus::setDriver(CanDriverInterface *driver) {
+	this->driver = driver;
+}
+
+bool CanBus::addRxHandler(uint32_t id, uint32_t mask, bool isExtended, can_rx_handler_f handler, void *arg) {
+	if (rxFilterCount >= CAN_MAX_RX_HANDLERS) {
+		return false;
+	}
+	can_rx_filter_s *filter = &rxFilters[rxFilterCount++];
+	filter->id = id;
+	filter->mask = mask;
+	filter->isExtended = isExtended;
+	filter->handler = handler;
+	filter->arg = arg;
+	return true;
+}
+
+void CanBus::applyFilters() {
+	if (driver != NULL) {
+		driver->setFilters(rxFilters, rxFilterCount);
+	}
+}
+
+bool CanBus::addPeriodic(uint32_t id, int periodMs, can_tx_fill_f fill, void *arg) {
+	if (periodicCount >= CAN_MAX_PERIODIC_MESSAGES) {
+		return false;
+	}
+	can_periodic_message_s *message = &periodic[periodicCount++];
+	message->id = id;
+	message->periodMs = periodMs;
+	message->nextMs = 0;
+	message->isScheduled = false;
+	message->fill = fill;
+	message->arg = arg;
+	return true;
+}
+
+void CanBus::setDefaultPeriod(int periodMs) {
+	defaultPeriodMs = periodMs;
+}
+
+void CanBus::onRxInterrupt(const can_frame_s *frame) {
+	uint32_t index = rxWriteIndex;
+	if (index - rxReadIndex >= CAN_RX_RING_SIZE) {
+		rxOverrunCounter++;
+		return;
+	}
+	rxRing[index & (CAN_RX_RING_SIZE - 1)] = *frame;
+	CAN_BUS_MEMORY_BARRIER();
+	rxWriteIndex = index + 1;
+	rxCounter++;
+}
+
+int CanBus::processRx() {
+	int count = 0;
+	while (rxReadIndex != rxWriteIndex) {
+		CAN_BUS_MEMORY_BARRIER();
+		can_frame_s frame = rxRing[rxReadIndex & (CAN_RX_RING_SIZE - 1)];
+		CAN_BUS_MEMORY_BARRIER();
+		rxReadIndex++;
+		bool isHandled = false;
+		for (int i = 0; i < rxFilterCount; i++) {
+			if (isCanFilterMatch(&rxFilters[i], &frame)) {
+				rxFilters[i].handler(&frame, rxFilters[i].arg);
+				isHandled = true;
+			}
+		}
+		if (!isHandled) {
+			rxUnhandledCounter++;
+		}
+		count++;
+	}
+	return count;
+}
+
+void CanBus::flushRx() {
+	CAN_BUS_MEMORY_BARRIER();
+	rxReadIndex = rxWriteIndex;
+}
+
+bool CanBus::transmit(const can_frame_s *frame) {
+	uint32_t index = txWriteIndex;
+	if (index - txReadIndex >= CAN_TX_QUEUE_SIZE) {
+		txOverrunCounter++;
+		return false;
+	}
+	txQueue[index & (CAN_TX_QUEUE_SIZE - 1)] = *frame;
+	CAN_BUS_MEMORY_BARRIER();
+	txWriteIndex = index + 1;
+	return true;
+}
+
+void CanBus::pumpTx() {
+	if (driver == NULL) {
+		return;
+	}
+	while (txReadIndex != txWriteIndex) {
+		CAN_BUS_MEMORY_BARRIER();
+		if (!driver->transmit(&txQueue[txReadIndex & (CAN_TX_QUEUE_SIZE - 1)])) {
+			// all mailboxes are busy, transmit-complete interrupt would get back here
+			return;
+		}
+		CAN_BUS_MEMORY_BARRIER();
+		txReadIndex++;
+		txCounter++;
+	}
+}
+
+/**
+ * A message which fell behind by more than a period is not sent repeatedly to catch up
+ */
+void CanBus::processPeriodic(efitimems_t nowMs) {
+	for (int i = 0; i < periodicCount; i++) {
+		can_periodic_message_s *message = &periodic[i];
+		if (!message->isScheduled) {
+			// first one goes out right away
+			message->nextMs = nowMs;
+			message->isScheduled = true;
+		}
+		if ((int32_t) (nowMs - message->nextMs) < 0) {
+			continue;
+		}
+		int periodMs = message->periodMs == 0 ? defaultPeriodMs : message->periodMs;
+		message->nextMs += periodMs;
+		if ((int32_t) (nowMs - message->nextMs) >= 0) {
+			message->nextMs = nowMs + periodMs;
+		}
+		can_frame_s frame;
+		initCanFrame(&frame, message->id);
+		if (message->fill(&frame, message->arg)) {
+			transmit(&frame);
+		}
+	}
+}
+
+int CanBus::getNextPeriodicDelayMs(efitimems_t nowMs) const {
+	int delayMs = CAN_MAX_SLEEP_MS;
+	for (int i = 0; i < periodicCount; i++) {
+		if (!periodic[i].isScheduled) {
+			return 0;
+		}
+		delayMs = minI(delayMs, maxI(0, (int32_t) (periodic[i].nextMs - nowMs)));
+	}
+	return delayMs;
+}
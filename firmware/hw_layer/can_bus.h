@@ -0,0 +1,165 @@
+/**
+ * @file can_bus.h
+ * @brief CAN receive dispatch, transmit queue and periodic transmit scheduling
+ *
+ * Receive interrupt only copies the frame into a ring, handlers registered by ID and mask run later
+ * in CAN thread. The same ID/mask pairs are programmed into hardware acceptance filters so that
+ * unrelated bus traffic does not even cause an interrupt.
+ *
+ * Frames to send go through a queue which is drained into hardware mailboxes by CAN thread and by
+ * the transmit-complete interrupt. Periodic messages each have their own ID and period, a message
+ * is filled right before it is queued.
+ *
+ * Transport is behind CanDriverInterface: bxCAN on the chip, loopback in unit tests.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef CAN_BUS_H_
+#define CAN_BUS_H_
+
+#include "global.h"
+
+#define CAN_STD_ID_MASK 0x7FF
+#define CAN_EXT_ID_MASK 0x1FFFFFFF
+
+/**
+ * queue sizes should be power of two
+ */
+#ifndef CAN_RX_RING_SIZE
+#define CAN_RX_RING_SIZE 32
+#endif /* CAN_RX_RING_SIZE */
+#ifndef CAN_TX_QUEUE_SIZE
+#define CAN_TX_QUEUE_SIZE 16
+#endif /* CAN_TX_QUEUE_SIZE */
+#define CAN_MAX_RX_HANDLERS 8
+#define CAN_MAX_PERIODIC_MESSAGES 16
+
+typedef struct {
+	uint32_t id;
+	bool isExtended;
+	uint8_t dlc;
+	uint8_t data8[8];
+} can_frame_s;
+
+typedef void (*can_rx_handler_f)(const can_frame_s *frame, void *arg);
+/**
+ * @return false to skip this period, for example if the message is disabled in configuration
+ */
+typedef bool (*can_tx_fill_f)(can_frame_s *frame, void *arg);
+
+typedef struct {
+	uint32_t id;
+	uint32_t mask;
+	bool isExtended;
+	can_rx_handler_f handler;
+	void *arg;
+} can_rx_filter_s;
+
+typedef struct {
+	uint32_t id;
+	/**
+	 * zero for bus default period
+	 */
+	int periodMs;
+	efitimems_t nextMs;
+	bool isScheduled;
+	can_tx_fill_f fill;
+	void *arg;
+} can_periodic_message_s;
+
+class CanDriverInterface {
+public:
+	/**
+	 * Invoked with interrupts locked
+	 * @return false if all transmit mailboxes are busy
+	 */
+	virtual bool transmit(const can_frame_s *frame) = 0;
+	/**
+	 * Programs hardware acceptance filters, invoked before the bus is started
+	 */
+	virtual void setFilters(const can_rx_filter_s *filters, int count) = 0;
+};
+
+void initCanFrame(can_frame_s *frame, uint32_t id);
+bool isCanFilterMatch(const can_rx_filter_s *filter, const can_frame_s *frame);
+
+class CanBus {
+public:
+	CanBus();
+	void setDriver(CanDriverInterface *driver);
+	/**
+	 * Handlers are registered before the bus is started, see applyFilters()
+	 * @return false if there is no room for another handler
+	 */
+	bool addRxHandler(uint32_t id, uint32_t mask, bool isExtended, can_rx_handler_f handler, void *arg);
+	void applyFilters();
+	/**
+	 * @param periodMs zero to use default period
+	 */
+	bool addPeriodic(uint32_t id, int periodMs, can_tx_fill_f fill, void *arg);
+	void setDefaultPeriod(int periodMs);
+
+	/**
+	 * Receive interrupt side, the only producer of the receive ring
+	 */
+	void onRxInterrupt(const can_frame_s *frame);
+	/**
+	 * CAN thread side, runs handlers for all received frames
+	 * @return number of frames dispatched
+	 */
+	int processRx();
+	/**
+	 * CAN thread side, drops received frames without dispatching them
+	 */
+	void flushRx();
+
+	/**
+	 * CAN thread side, the only producer of the transmit queue. Frame goes out on next pumpTx().
+	 * @return false if the queue is full, frame is dropped and counted
+	 */
+	bool transmit(const can_frame_s *frame);
+	/**
+	 * Moves queued frames into free mailboxes. Has to be invoked with interrupts locked since
+	 * both CAN thread and transmit-complete interrupt do that.
+	 */
+	void pumpTx();
+	/**
+	 * CAN thread side, queues periodic messages which are due
+	 */
+	void processPeriodic(efitimems_t nowMs);
+	/**
+	 * @return how long CAN thread could sleep before next periodic message is due
+	 */
+	int getNextPeriodicDelayMs(efitimems_t nowMs) const;
+
+	volatile uint32_t rxCounter;
+	volatile uint32_t rxOverrunCounter;
+	/**
+	 * frames which passed hardware filter but no handler wanted them
+	 */
+	uint32_t rxUnhandledCounter;
+	uint32_t txCounter;
+	uint32_t txOverrunCounter;
+private:
+	CanDriverInterface *driver;
+	can_rx_filter_s rxFilters[CAN_MAX_RX_HANDLERS];
+	int rxFilterCount;
+	can_periodic_message_s periodic[CAN_MAX_PERIODIC_MESSAGES];
+	int periodicCount;
+	int defaultPeriodMs;
+
+	can_frame_s rxRing[CAN_RX_RING_SIZE];
+	/**
+	 * free-running counters, only lower bits are used as index
+	 */
+	volatile uint32_t rxWriteIndex;
+	volatile uint32_t rxReadIndex;
+
+	can_frame_s txQueue[CAN_TX_QUEUE_SIZE];
+	volatile uint32_t txWriteIndex;
+	volatile uint32_t txReadIndex;
+};
+
+#endif /* CAN_BUS_H_ */
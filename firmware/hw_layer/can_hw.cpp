@@ -16,6 +16,7 @@
 #include "engine_configuration.h"
 #include "pin_repository.h"
 #include "can_hw.h"
+#include "can_bus.h"
 #include "string.h"
 #include "obd2.h"
 #include "mpu_util.h"
@@ -25,13 +26,16 @@
 EXTERN_ENGINE
 ;
 
-static int canReadCounter = 0;
-static int canWriteOk = 0;
-static int canWriteNotOk = 0;
 static bool isCanEnabled = false;
 static LoggingWithStorage logger("CAN driver");
 static THD_WORKING_AREA(canTreadStack, UTILITY_THREAD_STACK_SIZE);
 
+static CanBus canBus;
+/**
+ * receive interrupt wakes CAN thread up right away
+ */
+static binary_semaphore_t canWakeup;
+
 // Values below calculated with http://www.bittiming.can-wiki.info/
 // Pick ST micro bxCAN
 // Clock rate of 42mhz for f4, 54mhz for f7
@@ -59,6 +63,13 @@ static THD_WORKING_AREA(canTreadStack, UTILITY_THREAD_STACK_SIZE);
  * CAN_TI0R_STID "Standard Identifier or Extended Identifier"? not mentioned as well
  */
 
+/**
+ * bxCAN filter banks are shared, CAN2 gets the upper half
+ */
+#define CAN2_FIRST_FILTER_BANK 14
+#define CAN_FILTER_IDE 0x4
+#define CAN_FILTER_RTR 0x2
+
 static const CANConfig canConfig250 = {
 CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP,
 CAN_BTR_250 };
@@ -72,16 +83,16 @@ CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP,
 CAN_BTR_1k0 };
 
 
-static CANRxFrame rxBuffer;
-CANTxFrame txmsg;
+/**
+ * legacy single frame buffer, see commonTxInit()
+ */
+can_frame_s txmsg;
 
-static void printPacket(CANRxFrame *rx) {
-//	scheduleMsg(&logger, "CAN FMI %x", rx->FMI);
-//	scheduleMsg(&logger, "TIME %x", rx->TIME);
-	scheduleMsg(&logger, "Got CAN message: SID %x/%x %x %x %x %x %x %x %x %x", rx->SID, rx->DLC, rx->data8[0], rx->data8[1],
+static void printPacket(const can_frame_s *rx) {
+	scheduleMsg(&logger, "Got CAN message: SID %x/%x %x %x %x %x %x %x %x %x", rx->id, rx->dlc, rx->data8[0], rx->data8[1],
 			rx->data8[2], rx->data8[3], rx->data8[4], rx->data8[5], rx->data8[6], rx->data8[7]);
 
-	if (rx->SID == CAN_BMW_E46_CLUSTER_STATUS) {
+	if (rx->id == CAN_BMW_E46_CLUSTER_STATUS) {
 		int odometerKm = 10 * (rx->data8[1] << 8) + rx->data8[0];
 		int odometerMi = (int) (odometerKm * 0.621371);
 		scheduleMsg(&logger, "GOT odometerKm %d", odometerKm);
@@ -91,41 +102,29 @@ static void printPacket(CANRxFrame *rx) {
 	}
 }
 
-static void setShortValue(CANTxFrame *txmsg, int value, int offset) {
-	txmsg->data8[offset] = value;
-	txmsg->data8[offset + 1] = value >> 8;
+static void setShortValue(can_frame_s *frame, int value, int offset) {
+	frame->data8[offset] = value;
+	frame->data8[offset + 1] = value >> 8;
+}
+
+static void setFrameBit(can_frame_s *frame, int offset, int index) {
+	frame->data8[offset] = frame->data8[offset] | (1 << index);
 }
 
 void setTxBit(int offset, int index) {
-	txmsg.data8[offset] = txmsg.data8[offset] | (1 << index);
+	setFrameBit(&txmsg, offset, index);
 }
 
 void commonTxInit(int eid) {
-	memset(&txmsg, 0, sizeof(txmsg));
-	txmsg.IDE = CAN_IDE_STD;
-	txmsg.EID = eid;
-	txmsg.RTR = CAN_RTR_DATA;
-	txmsg.DLC = 8;
+	initCanFrame(&txmsg, eid);
 }
 
 /**
- * send CAN message from txmsg buffer
+ * queue CAN message from txmsg buffer, should be invoked from CAN thread
  */
 static void sendCanMessage2(int size) {
-	CANDriver *device = detectCanDevice(CONFIGB(canRxPin),
-			CONFIGB(canTxPin));
-	if (device == NULL) {
-		warning(CUSTOM_ERR_CAN_CONFIGURATION, "CAN configuration issue");
-		return;
-	}
-	txmsg.DLC = size;
-	// 1 second timeout
-	msg_t result = canTransmit(device, CAN_ANY_MAILBOX, &txmsg, TIME_MS2I(1000));
-	if (result == MSG_OK) {
-		canWriteOk++;
-	} else {
-		canWriteNotOk++;
-	}
+	txmsg.dlc = size;
+	canBus.transmit(&txmsg);
 }
 
 /**
@@ -135,150 +134,277 @@ void sendCanMessage() {
 	sendCanMessage2(8);
 }
 
-static void canDashboardBMW(void) {
-	//BMW Dashboard
-	commonTxInit(CAN_BMW_E46_SPEED);
-	setShortValue(&txmsg, 10 * 8, 1);
-	sendCanMessage();
+/**
+ * Each dashboard frame is a periodic message of its own, all of them are registered and
+ * those not matching current dashboard type are skipped.
+ */
+static bool isDashboard(can_nbc_e type) {
+	return engineConfiguration->canWriteEnabled && engineConfiguration->canNbcType == type;
+}
 
-	commonTxInit(CAN_BMW_E46_RPM);
-	setShortValue(&txmsg, (int) (GET_RPM() * 6.4), 2);
-	sendCanMessage();
+static bool fillBmwSpeed(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_BMW)) {
+		return false;
+	}
+	setShortValue(frame, 10 * 8, 1);
+	return true;
+}
 
-	commonTxInit(CAN_BMW_E46_DME2);
-	setShortValue(&txmsg, (int) ((engine->sensors.clt + 48.373) / 0.75), 1);
-	sendCanMessage();
+static bool fillBmwRpm(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_BMW)) {
+		return false;
+	}
+	setShortValue(frame, (int) (GET_RPM() * 6.4), 2);
+	return true;
 }
 
-static void canMazdaRX8(void) {
-	commonTxInit(CAN_MAZDA_RX_STEERING_WARNING);
-	// todo: something needs to be set here? see http://rusefi.com/wiki/index.php?title=Vehicle:Mazda_Rx8_2004
-	sendCanMessage();
+static bool fillBmwDme2(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_BMW)) {
+		return false;
+	}
+	setShortValue(frame, (int) ((engine->sensors.clt + 48.373) / 0.75), 1);
+	return true;
+}
 
-	commonTxInit(CAN_MAZDA_RX_RPM_SPEED);
+static bool fillMazdaRx8SteeringWarning(can_frame_s *frame, void *arg) {
+	(void)frame;
+	(void)arg;
+	// todo: something needs to be set here? see http://rusefi.com/wiki/index.php?title=Vehicle:Mazda_Rx8_2004
+	return isDashboard(CAN_BUS_MAZDA_RX8);
+}
 
+static bool fillMazdaRx8RpmSpeed(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_MAZDA_RX8)) {
+		return false;
+	}
 	float kph = getVehicleSpeed();
 
-	setShortValue(&txmsg, SWAP_UINT16(GET_RPM() * 4), 0);
-	setShortValue(&txmsg, 0xFFFF, 2);
-	setShortValue(&txmsg, SWAP_UINT16((int )(100 * kph + 10000)), 4);
-	setShortValue(&txmsg, 0, 6);
-	sendCanMessage();
-
-	commonTxInit(CAN_MAZDA_RX_STATUS_1);
-	txmsg.data8[0] = 0xFE; //Unknown
-	txmsg.data8[1] = 0xFE; //Unknown
-	txmsg.data8[2] = 0xFE; //Unknown
-	txmsg.data8[3] = 0x34; //DSC OFF in combo with byte 5 Live data only seen 0x34
-	txmsg.data8[4] = 0x00; // B01000000; // Brake warning B00001000;  //ABS warning
-	txmsg.data8[5] = 0x40; // TCS in combo with byte 3
-	txmsg.data8[6] = 0x00; // Unknown
-	txmsg.data8[7] = 0x00; // Unused
-	sendCanMessage();
-
-	commonTxInit(CAN_MAZDA_RX_STATUS_2);
-	txmsg.data8[0] = (uint8_t)(engine->sensors.clt + 69); //temp gauge //~170 is red, ~165 last bar, 152 centre, 90 first bar, 92 second bar
-	txmsg.data8[1] = ((int16_t)(engine->engineState.vssEventCounter*(engineConfiguration->vehicleSpeedCoef*0.277*2.58))) & 0xff;
-	txmsg.data8[2] = 0x00; // unknown
-	txmsg.data8[3] = 0x00; //unknown
-	txmsg.data8[4] = 0x01; //Oil Pressure (not really a gauge)
-	txmsg.data8[5] = 0x00; //check engine light
-	txmsg.data8[6] = 0x00; //Coolant, oil and battery
+	setShortValue(frame, SWAP_UINT16(GET_RPM() * 4), 0);
+	setShortValue(frame, 0xFFFF, 2);
+	setShortValue(frame, SWAP_UINT16((int )(100 * kph + 10000)), 4);
+	setShortValue(frame, 0, 6);
+	return true;
+}
+
+static bool fillMazdaRx8Status1(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_MAZDA_RX8)) {
+		return false;
+	}
+	frame->data8[0] = 0xFE; //Unknown
+	frame->data8[1] = 0xFE; //Unknown
+	frame->data8[2] = 0xFE; //Unknown
+	frame->data8[3] = 0x34; //DSC OFF in combo with byte 5 Live data only seen 0x34
+	frame->data8[4] = 0x00; // B01000000; // Brake warning B00001000;  //ABS warning
+	frame->data8[5] = 0x40; // TCS in combo with byte 3
+	frame->data8[6] = 0x00; // Unknown
+	frame->data8[7] = 0x00; // Unused
+	return true;
+}
+
+static bool fillMazdaRx8Status2(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_MAZDA_RX8)) {
+		return false;
+	}
+	frame->data8[0] = (uint8_t)(engine->sensors.clt + 69); //temp gauge //~170 is red, ~165 last bar, 152 centre, 90 first bar, 92 second bar
+	frame->data8[1] = ((int16_t)(engine->engineState.vssEventCounter*(engineConfiguration->vehicleSpeedCoef*0.277*2.58))) & 0xff;
+	frame->data8[2] = 0x00; // unknown
+	frame->data8[3] = 0x00; //unknown
+	frame->data8[4] = 0x01; //Oil Pressure (not really a gauge)
+	frame->data8[5] = 0x00; //check engine light
+	frame->data8[6] = 0x00; //Coolant, oil and battery
 	if ((GET_RPM()>0) && (engine->sensors.vBatt<13)) {
-		setTxBit(6, 6); // battery light
+		setFrameBit(frame, 6, 6); // battery light
 	}
 	if (engine->sensors.clt > 105) {
-		setTxBit(6, 1); // coolant light, 101 - red zone, light means its get too hot
+		setFrameBit(frame, 6, 1); // coolant light, 101 - red zone, light means its get too hot
 	}
 	//oil pressure warning lamp bit is 7
-	txmsg.data8[7] = 0x00; //unused
-	sendCanMessage();
+	frame->data8[7] = 0x00; //unused
+	return true;
 }
 
-static void canDashboardFiat(void) {
-	//Fiat Dashboard
-	commonTxInit(CAN_FIAT_MOTOR_INFO);
-	setShortValue(&txmsg, (int) (engine->sensors.clt - 40), 3); //Coolant Temp
-	setShortValue(&txmsg, GET_RPM() / 32, 6); //RPM
-	sendCanMessage();
+static bool fillFiatMotorInfo(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_FIAT)) {
+		return false;
+	}
+	setShortValue(frame, (int) (engine->sensors.clt - 40), 3); //Coolant Temp
+	setShortValue(frame, GET_RPM() / 32, 6); //RPM
+	return true;
 }
 
-static void canDashboardVAG(void) {
-	//VAG Dashboard
-	commonTxInit(CAN_VAG_RPM);
-	setShortValue(&txmsg, GET_RPM() * 4, 2); //RPM
-	sendCanMessage();
-
-	commonTxInit(CAN_VAG_CLT);
-	setShortValue(&txmsg, (int) ((engine->sensors.clt + 48.373) / 0.75), 1); //Coolant Temp
-	sendCanMessage();
-
-	commonTxInit(CAN_VAG_CLT_V2);
-		setShortValue(&txmsg, (int) ((engine->sensors.clt + 48.373) / 0.75), 4); //Coolant Temp
-		sendCanMessage();
-
-	commonTxInit(CAN_VAG_IMMO);
-		setShortValue(&txmsg, 0x80, 1);
-		sendCanMessage();
-}
-
-static void canInfoNBCBroadcast(can_nbc_e typeOfNBC) {
-	switch (typeOfNBC) {
-	case CAN_BUS_NBC_BMW:
-		canDashboardBMW();
-		break;
-	case CAN_BUS_NBC_FIAT:
-		canDashboardFiat();
-		break;
-	case CAN_BUS_NBC_VAG:
-		canDashboardVAG();
-		break;
-	case CAN_BUS_MAZDA_RX8:
-		canMazdaRX8();
-		break;
-	default:
-		break;
+static bool fillVagRpm(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_VAG)) {
+		return false;
 	}
+	setShortValue(frame, GET_RPM() * 4, 2); //RPM
+	return true;
 }
 
-static void canRead(void) {
-	CANDriver *device = detectCanDevice(CONFIGB(canRxPin),
-			CONFIGB(canTxPin));
-	if (device == NULL) {
-		warning(CUSTOM_ERR_CAN_CONFIGURATION, "CAN configuration issue");
-		return;
+/**
+ * @param arg offset of coolant temperature, differs between VAG cluster generations
+ */
+static bool fillVagClt(can_frame_s *frame, void *arg) {
+	if (!isDashboard(CAN_BUS_NBC_VAG)) {
+		return false;
 	}
-//	scheduleMsg(&logger, "Waiting for CAN");
-	msg_t result = canReceive(device, CAN_ANY_MAILBOX, &rxBuffer, TIME_MS2I(1000));
-	if (result == MSG_TIMEOUT) {
-		return;
+	setShortValue(frame, (int) ((engine->sensors.clt + 48.373) / 0.75), (int) (intptr_t) arg); //Coolant Temp
+	return true;
+}
+
+static bool fillVagImmo(can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (!isDashboard(CAN_BUS_NBC_VAG)) {
+		return false;
 	}
+	setShortValue(frame, 0x80, 1);
+	return true;
+}
+
+/**
+ * Zero period follows canSleepPeriodMs
+ */
+static void addDashboardMessages(void) {
+	//BMW Dashboard
+	canBus.addPeriodic(CAN_BMW_E46_SPEED, 0, fillBmwSpeed, NULL);
+	canBus.addPeriodic(CAN_BMW_E46_RPM, 0, fillBmwRpm, NULL);
+	canBus.addPeriodic(CAN_BMW_E46_DME2, 0, fillBmwDme2, NULL);
+
+	canBus.addPeriodic(CAN_MAZDA_RX_STEERING_WARNING, 0, fillMazdaRx8SteeringWarning, NULL);
+	canBus.addPeriodic(CAN_MAZDA_RX_RPM_SPEED, 0, fillMazdaRx8RpmSpeed, NULL);
+	canBus.addPeriodic(CAN_MAZDA_RX_STATUS_1, 0, fillMazdaRx8Status1, NULL);
+	canBus.addPeriodic(CAN_MAZDA_RX_STATUS_2, 0, fillMazdaRx8Status2, NULL);
+
+	//Fiat Dashboard
+	canBus.addPeriodic(CAN_FIAT_MOTOR_INFO, 0, fillFiatMotorInfo, NULL);
 
-	canReadCounter++;
-	printPacket(&rxBuffer);
-	obdOnCanPacketRx(&rxBuffer);
+	//VAG Dashboard
+	canBus.addPeriodic(CAN_VAG_RPM, 0, fillVagRpm, NULL);
+	canBus.addPeriodic(CAN_VAG_CLT, 0, fillVagClt, (void *) 1);
+	canBus.addPeriodic(CAN_VAG_CLT_V2, 0, fillVagClt, (void *) 4);
+	canBus.addPeriodic(CAN_VAG_IMMO, 0, fillVagImmo, NULL);
 }
 
-static void writeStateToCan(void) {
-	canInfoNBCBroadcast(engineConfiguration->canNbcType);
+static void onClusterStatus(const can_frame_s *frame, void *arg) {
+	(void)arg;
+	printPacket(frame);
+}
+
+class BxCanDriver : public CanDriverInterface {
+public:
+	CANDriver *device;
+
+	bool transmit(const can_frame_s *frame) {
+		CANTxFrame tx;
+		tx.IDE = frame->isExtended ? CAN_IDE_EXT : CAN_IDE_STD;
+		if (frame->isExtended) {
+			tx.EID = frame->id;
+		} else {
+			tx.SID = frame->id;
+		}
+		tx.RTR = CAN_RTR_DATA;
+		tx.DLC = frame->dlc;
+		memcpy(tx.data8, frame->data8, sizeof(tx.data8));
+		// false means the frame got a mailbox
+		return !canTryTransmitI(device, CAN_ANY_MAILBOX, &tx);
+	}
+
+	/**
+	 * One 32 bit mask mode bank per handler, see "Identifier filtering" in the reference manual
+	 */
+	void setFilters(const can_rx_filter_s *filters, int count) {
+		CANFilter banks[CAN_MAX_RX_HANDLERS];
+#if STM32_CAN_USE_CAN2
+		int firstBank = device == &CAND2 ? CAN2_FIRST_FILTER_BANK : 0;
+#else
+		int firstBank = 0;
+#endif /* STM32_CAN_USE_CAN2 */
+		for (int i = 0; i < count; i++) {
+			const can_rx_filter_s *filter = &filters[i];
+			CANFilter *bank = &banks[i];
+			bank->filter = firstBank + i;
+			bank->mode = 0;
+			bank->scale = 1;
+			bank->assignment = 0;
+			// IDE and RTR bits have to match as well, only data frames are accepted
+			if (filter->isExtended) {
+				bank->register1 = (filter->id << 3) | CAN_FILTER_IDE;
+				bank->register2 = (filter->mask << 3) | CAN_FILTER_IDE | CAN_FILTER_RTR;
+			} else {
+				bank->register1 = filter->id << 21;
+				bank->register2 = (filter->mask << 21) | CAN_FILTER_IDE | CAN_FILTER_RTR;
+			}
+		}
+		canSTM32SetFilters(device, CAN2_FIRST_FILTER_BANK, count, banks);
+	}
+};
+
+static BxCanDriver bxCanDriver;
+
+static void convertRxFrame(const CANRxFrame *rx, can_frame_s *frame) {
+	frame->isExtended = rx->IDE == CAN_IDE_EXT;
+	frame->id = frame->isExtended ? rx->EID : rx->SID;
+	frame->dlc = rx->DLC;
+	memcpy(frame->data8, rx->data8, sizeof(frame->data8));
+}
+
+/**
+ * Invoked from receive interrupt, which stays disabled until the FIFO has been drained
+ */
+static void onCanRxFull(CANDriver *device, uint32_t flags) {
+	(void)flags;
+	CANRxFrame rx;
+	can_frame_s frame;
+	chSysLockFromISR();
+	// false means a frame was fetched
+	while (!canTryReceiveI(device, CAN_ANY_MAILBOX, &rx)) {
+		convertRxFrame(&rx, &frame);
+		canBus.onRxInterrupt(&frame);
+	}
+	chBSemSignalI(&canWakeup);
+	chSysUnlockFromISR();
+}
+
+static void onCanTxEmpty(CANDriver *device, uint32_t flags) {
+	(void)device;
+	(void)flags;
+	chSysLockFromISR();
+	canBus.pumpTx();
+	chSysUnlockFromISR();
 }
 
 static msg_t canThread(void *arg) {
 	(void)arg;
 	chRegSetThreadName("CAN");
 	while (true) {
-		if (engineConfiguration->canWriteEnabled)
-			writeStateToCan();
-
-		if (engineConfiguration->canReadEnabled)
-			canRead(); // todo: since this is a blocking operation, do we need a separate thread for 'write'?
-
 		if (engineConfiguration->canSleepPeriodMs < 10) {
 			warning(CUSTOM_OBD_LOW_CAN_PERIOD, "%d too low CAN", engineConfiguration->canSleepPeriodMs);
 			engineConfiguration->canSleepPeriodMs = 50;
 		}
+		canBus.setDefaultPeriod(engineConfiguration->canSleepPeriodMs);
+
+		if (engineConfiguration->canReadEnabled) {
+			canBus.processRx();
+		} else {
+			canBus.flushRx();
+		}
+		canBus.processPeriodic(currentTimeMillis());
+		updateObd2(currentTimeMillis());
+
+		chSysLock();
+		canBus.pumpTx();
+		chSysUnlock();
 
-		chThdSleepMilliseconds(engineConfiguration->canSleepPeriodMs);
+		efitimems_t nowMs = currentTimeMillis();
+		int delayMs = minI(canBus.getNextPeriodicDelayMs(nowMs), getObd2NextDelayMs(nowMs));
+		chBSemWaitTimeout(&canWakeup, TIME_MS2I(delayMs));
 	}
 #if defined __GNUC__
 	return -1;
@@ -297,7 +423,8 @@ static void canInfo(void) {
 			boolToString(engineConfiguration->canReadEnabled), boolToString(engineConfiguration->canWriteEnabled),
 			engineConfiguration->canSleepPeriodMs);
 
-	scheduleMsg(&logger, "CAN rx_cnt=%d/tx_ok=%d/tx_not_ok=%d", canReadCounter, canWriteOk, canWriteNotOk);
+	scheduleMsg(&logger, "CAN rx_cnt=%d/tx_ok=%d/tx_not_ok=%d", canBus.rxCounter, canBus.txCounter, canBus.txOverrunCounter);
+	scheduleMsg(&logger, "CAN rx_overrun=%d/rx_unhandled=%d", canBus.rxOverrunCounter, canBus.rxUnhandledCounter);
 }
 
 void setCanType(int type) {
@@ -306,9 +433,9 @@ void setCanType(int type) {
 }
 
 void postCanState(TunerStudioOutputChannels *tsOutputChannels) {
-	tsOutputChannels->debugIntField1 = isCanEnabled ? canReadCounter : -1;
-	tsOutputChannels->debugIntField2 = isCanEnabled ? canWriteOk : -1;
-	tsOutputChannels->debugIntField3 = isCanEnabled ? canWriteNotOk : -1;
+	tsOutputChannels->debugIntField1 = isCanEnabled ? canBus.rxCounter : -1;
+	tsOutputChannels->debugIntField2 = isCanEnabled ? canBus.txCounter : -1;
+	tsOutputChannels->debugIntField3 = isCanEnabled ? canBus.txOverrunCounter : -1;
 }
 
 void enableFrankensoCan(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
@@ -340,6 +467,24 @@ void initCan(void) {
 	if (!isCanEnabled)
 		return;
 
+	CANDriver *device = detectCanDevice(CONFIGB(canRxPin), CONFIGB(canTxPin));
+	if (device == NULL) {
+		warning(CUSTOM_ERR_CAN_CONFIGURATION, "CAN configuration issue");
+		return;
+	}
+	bxCanDriver.device = device;
+	canBus.setDriver(&bxCanDriver);
+	chBSemObjectInit(&canWakeup, true);
+
+	initObd2(&canBus);
+	canBus.addRxHandler(CAN_BMW_E46_CLUSTER_STATUS, CAN_STD_ID_MASK, false, onClusterStatus, NULL);
+	addDashboardMessages();
+	// filters have to be in place before the bus is started
+	canBus.applyFilters();
+
+	device->rxfull_cb = onCanRxFull;
+	device->txempty_cb = onCanTxEmpty;
+
 #if STM32_CAN_USE_CAN2
 	// CAN1 is required for CAN2
 	canStart(&CAND1, &canConfig500);
@@ -39,6 +39,10 @@
 #define CAN_VAG_IMMO 0x3D0
 
 void initCan(void);
+/**
+ * Single frame buffer API, only to be used from CAN thread: frame is queued and goes out
+ * as soon as a transmit mailbox is free
+ */
 void commonTxInit(int eid);
 void sendCanMessage();
 void setCanType(int type);
@@ -209,6 +209,9 @@ void adc_callback_fast(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
 		 */
 		efiAssertVoid(CUSTOM_ERR_6676, getCurrentRemainingStack() > 128, "lowstck#9b");
 
+		// averaged once here instead of on every getAdcValue call
+		fastAdc.filter.processBlock(fastAdc.samples, ADC_BUF_DEPTH_FAST);
+
 #if EFI_MAP_AVERAGING
 		mapAveragingAdcCallback(fastAdc.samples[fastMapSampleIndex]);
 #endif /* EFI_MAP_AVERAGING */
@@ -4,6 +4,7 @@ HW_LAYER_EGT = $(PROJECT_DIR)/hw_layer/serial_over_usb/usbcfg.c \
 HW_INC = hw_layer/$(CPU_HWLAYER)
 
 HW_LAYER_EGT_CPP = $(PROJECT_DIR)/hw_layer/can_hw.cpp \
+	$(PROJECT_DIR)/hw_layer/can_bus.cpp \
 	$(PROJECT_DIR)/hw_layer/max31855.cpp
 
 HW_LAYER_EMS = $(HW_LAYER_EGT) \
@@ -28,6 +28,10 @@
 
 #include "rtc_helper.h"
 
+#if EFI_BINARY_FILE_LOGGING
+#include "binary_log.h"
+#endif /* EFI_BINARY_FILE_LOGGING */
+
 #define SD_STATE_INIT "init"
 #define SD_STATE_MOUNTED "MOUNTED"
 #define SD_STATE_MOUNT_FAILED "MOUNT_FAILED"
@@ -92,6 +96,37 @@ static MMCConfig mmccfg = { NULL, &ls_spicfg, &hs_spicfg };
 
 #define FILE_LOG_DELAY 200
 
+#if EFI_BINARY_FILE_LOGGING
+/**
+ * Log records are accumulated in RAM and written in large sector-aligned chunks, FatFS transfers
+ * whole sectors straight from our buffer without going through its own sector cache.
+ */
+#define BINARY_LOG_RING_SIZE 8192
+#define SD_WRITE_CHUNK_SIZE 4096
+#define SD_WRITER_PERIOD_MS 50
+/**
+ * f_sync updates FAT and directory entry which costs a few extra sector writes, so it is only done
+ * periodically. Power loss would cost us at most this much of the log.
+ */
+#define SD_SYNC_PERIOD_MS 1000
+#define SD_SYNC_SIZE (32 * 1024)
+
+// this one needs to be in main ram so that SD card SPI DMA works fine
+static uint8_t binaryLogBuffer[BINARY_LOG_RING_SIZE] MAIN_RAM;
+BinaryLogRing binaryLogRing(binaryLogBuffer, sizeof(binaryLogBuffer));
+
+static THD_WORKING_AREA(sdWriterThreadStack, UTILITY_THREAD_STACK_SIZE);
+
+static efitimems_t lastSyncTimeMs = 0;
+static uint32_t unsyncedBytes = 0;
+/**
+ * current log file size, writes are aligned against this and not against ring offset
+ */
+static uint32_t logFileOffset = 0;
+static uint32_t sdWriteCounter = 0;
+static uint32_t sdSyncCounter = 0;
+#endif /* EFI_BINARY_FILE_LOGGING */
+
 /**
  * fatfs MMC/SPI
  */
@@ -131,6 +166,10 @@ static void sdStatistics(void) {
 	if (fs_ready) {
 		scheduleMsg(&logger, "filename=%s size=%d", logName, engine->engineState.totalLoggedBytes);
 	}
+#if EFI_BINARY_FILE_LOGGING
+	scheduleMsg(&logger, "binary log: backlog=%d overruns=%d writes=%d syncs=%d", binaryLogRing.getBacklog(),
+			binaryLogRing.overrunCounter, sdWriteCounter, sdSyncCounter);
+#endif /* EFI_BINARY_FILE_LOGGING */
 }
 
 static void incLogFileName(void) {
@@ -178,7 +217,11 @@ static void prepareLogFileName(void) {
 	} else {
 		ptr = itoa10(&logName[PREFIX_LEN], logFileIndex);
 	}
+#if EFI_BINARY_FILE_LOGGING
+	strcat(ptr, BINARY_LOG_FILE_EXTENSION);
+#else
 	strcat(ptr, ".msl");
+#endif /* EFI_BINARY_FILE_LOGGING */
 
 }
 
@@ -211,6 +254,12 @@ static void createLogFile(void) {
 		return;
 	}
 	f_sync(&FDLogFile);
+#if EFI_BINARY_FILE_LOGGING
+	// whatever was logged before does not belong to this file, and new file needs a schema
+	binaryLogRing.startFile();
+	logFileOffset = f_size(&FDLogFile);
+	unsyncedBytes = 0;
+#endif /* EFI_BINARY_FILE_LOGGING */
 	fs_ready = true;						// everything Ok
 	unlockSpi();
 }
@@ -318,6 +367,65 @@ void appendToLog(const char *line) {
 	unlockSpi();
 }
 
+#if EFI_BINARY_FILE_LOGGING
+class SdBinaryLogFile : public BinaryLogFile {
+public:
+	int write(const void *data, int size) {
+		UINT bytesWritten = 0;
+		FRESULT err = f_write(&FDLogFile, data, size, &bytesWritten);
+		sdWriteCounter++;
+		if (bytesWritten < (UINT) size) {
+			printError("write error or disk full", err);
+		}
+		return bytesWritten;
+	}
+};
+
+static SdBinaryLogFile sdBinaryLogFile;
+
+/**
+ * Caller holds SPI lock and has checked that the file is open.
+ * @param isFlush write everything and sync
+ */
+static void writeBinaryLogLocked(bool isFlush, efitimems_t nowMs, bool isSyncDue) {
+	int bytesWritten = binaryLogRing.writeTo(&sdBinaryLogFile, logFileOffset, isFlush, SD_WRITE_CHUNK_SIZE);
+	logFileOffset += bytesWritten;
+	unsyncedBytes += bytesWritten;
+	engine->engineState.totalLoggedBytes += bytesWritten;
+	if (unsyncedBytes > 0 && (isFlush || isSyncDue || unsyncedBytes >= SD_SYNC_SIZE)) {
+		f_sync(&FDLogFile);
+		sdSyncCounter++;
+		unsyncedBytes = 0;
+	}
+	if (isSyncDue) {
+		lastSyncTimeMs = nowMs;
+	}
+}
+
+static void writeBinaryLog(void) {
+	efitimems_t nowMs = currentTimeMillis();
+	bool isSyncDue = nowMs - lastSyncTimeMs >= SD_SYNC_PERIOD_MS;
+	if (!isSyncDue && binaryLogRing.getBacklog() < SD_WRITE_CHUNK_SIZE) {
+		return;
+	}
+	lockSpi(SPI_NONE);
+	if (fs_ready) {
+		writeBinaryLogLocked(false, nowMs, isSyncDue);
+	}
+	unlockSpi();
+}
+
+static THD_FUNCTION(sdWriterThread, arg) {
+	(void)arg;
+	chRegSetThreadName("SD_Writer");
+
+	while (true) {
+		writeBinaryLog();
+		chThdSleepMilliseconds(SD_WRITER_PERIOD_MS);
+	}
+}
+#endif /* EFI_BINARY_FILE_LOGGING */
+
 /*
  * MMC card umount.
  */
@@ -326,13 +434,19 @@ static void MMCumount(void) {
 		scheduleMsg(&logger, "Error: No File system is mounted. \"mountsd\" first");
 		return;
 	}
+	// writer thread and appendToLog check fs_ready under this same lock
+	lockSpi(SPI_NONE);
+	fs_ready = false;							// status = false
+#if EFI_BINARY_FILE_LOGGING
+	writeBinaryLogLocked(true, currentTimeMillis(), true);
+#endif /* EFI_BINARY_FILE_LOGGING */
 	f_close(&FDLogFile);						// close file
 	f_sync(&FDLogFile);							// sync ALL
 	mmcDisconnect(&MMCD1);						// Brings the driver in a state safe for card removal.
 	mmcStop(&MMCD1);							// Disables the MMC peripheral.
 	f_mount(NULL, 0, 0);						// FATFS: Unregister work area prior to discard it
 	memset(&FDLogFile, 0, sizeof(FIL));			// clear FDLogFile
-	fs_ready = false;							// status = false
+	unlockSpi();
 	scheduleMsg(&logger, "MMC/SD card removed");
 }
 
@@ -454,9 +568,15 @@ void initMmcCard(void) {
 	mmcStart(&MMCD1, &mmccfg);
 
 	chThdCreateStatic(mmcThreadStack, sizeof(mmcThreadStack), LOWPRIO, (tfunc_t)(void*) MMCmonThread, NULL);
+#if EFI_BINARY_FILE_LOGGING
+	chThdCreateStatic(sdWriterThreadStack, sizeof(sdWriterThreadStack), LOWPRIO, (tfunc_t)(void*) sdWriterThread, NULL);
+#endif /* EFI_BINARY_FILE_LOGGING */
 
 	addConsoleAction("mountsd", MMCmount);
+#if !EFI_BINARY_FILE_LOGGING
+	// text line would not make sense in the middle of binary log
 	addConsoleActionS("appendtolog", appendToLog);
+#endif /* EFI_BINARY_FILE_LOGGING */
 	addConsoleAction("umountsd", MMCumount);
 	addConsoleActionS("ls", listDirectory);
 	addConsoleActionS("del", removeFile);
@@ -145,3 +145,113 @@ void jump_to_bootloader() {
 	NVIC_SystemReset();
 }
 #endif /* EFI_PROD_CODE */
+
+#if EFI_HARDWARE_PWM
+#include "pwm_generator.h"
+
+/**
+ * Timers which nothing else is using. Only channel 1 is used so that each output could have a
+ * frequency of its own.
+ */
+typedef struct {
+	TIM_TypeDef *timer;
+	uint32_t clock;
+	volatile uint32_t *rccEnableRegister;
+	uint32_t rccEnableBit;
+	uint8_t alternateFunction;
+	brain_pin_e pins[2];
+} hardware_pwm_timer_s;
+
+static const hardware_pwm_timer_s hardwarePwmTimers[] = {
+	{ TIM10, STM32_TIMCLK2, &RCC->APB2ENR, RCC_APB2ENR_TIM10EN, 3, { GPIOB_8, GPIOF_6 } },
+	{ TIM11, STM32_TIMCLK2, &RCC->APB2ENR, RCC_APB2ENR_TIM11EN, 3, { GPIOB_9, GPIOF_7 } },
+	{ TIM12, STM32_TIMCLK1, &RCC->APB1ENR, RCC_APB1ENR_TIM12EN, 9, { GPIOB_14, GPIOH_6 } },
+	{ TIM13, STM32_TIMCLK1, &RCC->APB1ENR, RCC_APB1ENR_TIM13EN, 9, { GPIOA_6, GPIOF_8 } },
+	{ TIM14, STM32_TIMCLK1, &RCC->APB1ENR, RCC_APB1ENR_TIM14EN, 9, { GPIOA_7, GPIOF_9 } },
+};
+
+#define HARDWARE_PWM_TIMER_COUNT (sizeof(hardwarePwmTimers) / sizeof(hardwarePwmTimers[0]))
+/**
+ * below this many timer ticks per period duty cycle resolution is not good enough
+ */
+#define HARDWARE_PWM_MIN_RESOLUTION 100
+
+class Stm32HardwarePwm : public HardwarePwm {
+public:
+	void start(const hardware_pwm_timer_s *config, brain_pin_e brainPin, float frequency, float dutyCycle);
+	void setDuty(float duty) override;
+	void setFrequency(float frequency) override;
+	void stop() override;
+	bool isStarted() const {
+		return config != NULL;
+	}
+private:
+	const hardware_pwm_timer_s *config = NULL;
+	brain_pin_e brainPin = GPIO_UNASSIGNED;
+	float duty = 0;
+	bool isPaused = false;
+};
+
+static Stm32HardwarePwm hardwarePwms[HARDWARE_PWM_TIMER_COUNT];
+
+void Stm32HardwarePwm::start(const hardware_pwm_timer_s *config, brain_pin_e brainPin, float frequency, float dutyCycle) {
+	this->config = config;
+	this->brainPin = brainPin;
+	*config->rccEnableRegister |= config->rccEnableBit;
+	TIM_TypeDef *timer = config->timer;
+	timer->CR1 = 0;
+	// PWM mode 1 with preload so that new duty cycle is applied at the start of next period
+	timer->CCMR1 = TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE;
+	timer->CCER = TIM_CCER_CC1E;
+	timer->CR1 = TIM_CR1_ARPE;
+	duty = dutyCycle;
+	setFrequency(frequency);
+	timer->CR1 |= TIM_CR1_CEN;
+}
+
+void Stm32HardwarePwm::setDuty(float duty) {
+	this->duty = duty;
+	TIM_TypeDef *timer = config->timer;
+	// compare value above auto-reload value means output is always high
+	timer->CCR1 = isPaused ? 0 : (uint32_t) (duty * (timer->ARR + 1));
+}
+
+void Stm32HardwarePwm::setFrequency(float frequency) {
+	isPaused = cisnan(frequency);
+	if (!isPaused) {
+		uint32_t ticks = config->clock / frequency;
+		uint32_t prescaler = ticks >> 16;
+		TIM_TypeDef *timer = config->timer;
+		timer->PSC = prescaler;
+		timer->ARR = ticks / (prescaler + 1) - 1;
+		timer->EGR = TIM_EGR_UG;
+	}
+	setDuty(duty);
+}
+
+void Stm32HardwarePwm::stop() {
+	TIM_TypeDef *timer = config->timer;
+	timer->CR1 = 0;
+	timer->CCER = 0;
+	// pin could be taken by something else next, it should not stay connected to the timer
+	efiSetPadUnused(brainPin);
+	config = NULL;
+}
+
+HardwarePwm *tryInitHardwarePwm(const char *msg, brain_pin_e brainPin, float frequency, float dutyCycle) {
+	for (unsigned int i = 0; i < HARDWARE_PWM_TIMER_COUNT; i++) {
+		const hardware_pwm_timer_s *config = &hardwarePwmTimers[i];
+		if (config->pins[0] != brainPin && config->pins[1] != brainPin) {
+			continue;
+		}
+		if (hardwarePwms[i].isStarted() || config->clock / frequency < HARDWARE_PWM_MIN_RESOLUTION) {
+			return NULL;
+		}
+		// pin is already registered as GPIO output by the caller, only its mode is changed here
+		palSetPadMode(getHwPort(msg, brainPin), getHwPin(msg, brainPin), PAL_MODE_ALTERNATE(config->alternateFunction));
+		hardwarePwms[i].start(config, brainPin, frequency, dutyCycle);
+		return &hardwarePwms[i];
+	}
+	return NULL;
+}
+#endif /* EFI_HARDWARE_PWM */
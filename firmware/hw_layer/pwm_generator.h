@@ -23,4 +23,12 @@ void initPwmGenerator(void);
  */
 void applyPinState(int stateIndex, PwmConfig* state) /* pwm_gen_callback */;
 
+#if EFI_HARDWARE_PWM
+/**
+ * Switches already initialized GPIO output to timer alternate function
+ * @return NULL if there is no spare timer channel on this pin
+ */
+HardwarePwm *tryInitHardwarePwm(const char *msg, brain_pin_e brainPin, float frequency, float dutyCycle);
+#endif /* EFI_HARDWARE_PWM */
+
 #endif /* PWM_GENERATOR_H_ */
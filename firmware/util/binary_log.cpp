@@ -0,0 +1,232 @@
+/**
+ * @file binary_log.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "binary_log.h"
+
+/**
+ * Block has to be completely written before the other side sees the new index
+ */
+#define BINARY_LOG_MEMORY_BARRIER() __sync_synchronize()
+
+BinaryLogRing::BinaryLogRing(uint8_t *buffer, int size) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, (size & (size - 1)) == 0 && size % BINARY_LOG_SECTOR_SIZE == 0, "log ring size");
+	this->buffer = buffer;
+	this->size = size;
+	writeIndex = 0;
+	readIndex = 0;
+	fileCounter = 0;
+	fileStartIndex = 0;
+	fileStartCounter = 0;
+	skippedFileCounter = 0;
+	overrunCounter = 0;
+	totalBytes = 0;
+}
+
+int BinaryLogRing::getBacklog() const {
+	return writeIndex - readIndex;
+}
+
+bool BinaryLogRing::write(const void *data, int length) {
+	uint32_t index = writeIndex;
+	if ((int) (index - readIndex) + length > size) {
+		overrunCounter++;
+		return false;
+	}
+	int offset = index & (size - 1);
+	int firstPart = minI(length, size - offset);
+	memcpy(buffer + offset, data, firstPart);
+	memcpy(buffer, (const uint8_t *) data + firstPart, length - firstPart);
+	BINARY_LOG_MEMORY_BARRIER();
+	writeIndex = index + length;
+	totalBytes += length;
+	return true;
+}
+
+int BinaryLogRing::getFreeSpace() const {
+	return size - getBacklog();
+}
+
+int BinaryLogRing::getContiguousSize() const {
+	int offset = readIndex & (size - 1);
+	return minI(getBacklog(), size - offset);
+}
+
+const uint8_t *BinaryLogRing::getReadPointer() const {
+	BINARY_LOG_MEMORY_BARRIER();
+	return buffer + (readIndex & (size - 1));
+}
+
+void BinaryLogRing::consume(int length) {
+	BINARY_LOG_MEMORY_BARRIER();
+	readIndex += length;
+}
+
+void BinaryLogRing::discard() {
+	consume(getBacklog());
+}
+
+void BinaryLogRing::startFile() {
+	BINARY_LOG_MEMORY_BARRIER();
+	fileCounter++;
+}
+
+/**
+ * Producer could still be writing a record for the previous file right after startFile(), so
+ * instead of dropping the backlog at that point consumer waits for producer to mark where the
+ * new file begins.
+ */
+bool BinaryLogRing::skipPreviousFile() {
+	uint32_t counter = fileCounter;
+	if (skippedFileCounter == counter) {
+		return true;
+	}
+	uint32_t index = writeIndex;
+	BINARY_LOG_MEMORY_BARRIER();
+	if (fileStartCounter != counter) {
+		// new file not started yet so everything up to 'index' belongs to previous one
+		consume(index - readIndex);
+		return false;
+	}
+	uint32_t startIndex = fileStartIndex;
+	if ((int) (startIndex - readIndex) > 0) {
+		consume(startIndex - readIndex);
+	}
+	skippedFileCounter = counter;
+	return true;
+}
+
+void BinaryLogRing::markFileStart(uint32_t fileCounter) {
+	fileStartIndex = writeIndex;
+	BINARY_LOG_MEMORY_BARRIER();
+	fileStartCounter = fileCounter;
+}
+
+int BinaryLogRing::getSectorAlignedBacklog(uint32_t fileOffset) const {
+	int backlog = getBacklog();
+	return maxI(0, backlog - (int) ((fileOffset + backlog) % BINARY_LOG_SECTOR_SIZE));
+}
+
+int BinaryLogRing::writeTo(BinaryLogFile *file, uint32_t fileOffset, bool isFlush, int maxChunkSize) {
+	if (!skipPreviousFile()) {
+		return 0;
+	}
+	// file offset and not ring offset matters: file could have been appended to and flush leaves
+	// a partial sector
+	int remaining = isFlush ? getBacklog() : getSectorAlignedBacklog(fileOffset);
+	int total = 0;
+	while (remaining > 0) {
+		// at the end of the ring this is a short write, the next one ends at sector boundary
+		int chunk = minI(minI(remaining, getContiguousSize()), maxChunkSize);
+		int written = file->write(getReadPointer(), chunk);
+		consume(chunk);
+		remaining -= chunk;
+		total += written;
+		if (written < chunk) {
+			break;
+		}
+	}
+	return total;
+}
+
+BinaryLogEncoder::BinaryLogEncoder(BinaryLogRing *ring) {
+	this->ring = ring;
+	fieldCount = 0;
+	schemaFieldCount = 0;
+	schemaFileCounter = 0;
+	schemaCounter = 0;
+	recordCounter = 0;
+	record[0] = BINARY_LOG_RECORD_TAG;
+}
+
+void BinaryLogEncoder::beginRecord() {
+	fieldCount = 0;
+}
+
+void BinaryLogEncoder::addField(const char *name, const char *units, log_field_type_e type, const void *value) {
+	if (fieldCount >= BINARY_LOG_MAX_FIELDS) {
+		return;
+	}
+	log_field_s *field = &fields[fieldCount];
+	field->name = name;
+	field->units = units;
+	field->type = type;
+	memcpy(&record[1 + 4 * fieldCount], value, 4);
+	fieldCount++;
+}
+
+void BinaryLogEncoder::addFloat(const char *name, const char *units, float value) {
+	addField(name, units, LOG_FIELD_FLOAT, &value);
+}
+
+void BinaryLogEncoder::addInt(const char *name, const char *units, int value) {
+	int32_t v = value;
+	addField(name, units, LOG_FIELD_INT, &v);
+}
+
+/**
+ * Field names are string literals so comparing pointers is enough
+ */
+bool BinaryLogEncoder::isSameSchema() const {
+	if (fieldCount != schemaFieldCount || ring->fileCounter != schemaFileCounter) {
+		return false;
+	}
+	for (int i = 0; i < fieldCount; i++) {
+		if (fields[i].name != schema[i].name || fields[i].type != schema[i].type) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Schema is written in pieces to keep it off the stack. Free space is checked once in advance,
+ * consumer could only make it larger so every piece would fit.
+ */
+bool BinaryLogEncoder::writeSchema() {
+	int blockSize = BINARY_LOG_SCHEMA_HEADER_SIZE;
+	for (int i = 0; i < fieldCount; i++) {
+		blockSize += 1 + strlen(fields[i].name) + 1 + strlen(fields[i].units) + 1;
+	}
+	if (blockSize > ring->getFreeSpace()) {
+		ring->overrunCounter++;
+		return false;
+	}
+	uint8_t header[BINARY_LOG_SCHEMA_HEADER_SIZE];
+	header[0] = BINARY_LOG_SCHEMA_TAG;
+	memcpy(header + 1, BINARY_LOG_MAGIC, 4);
+	header[5] = BINARY_LOG_VERSION;
+	header[6] = fieldCount & 0xFF;
+	header[7] = fieldCount >> 8;
+	uint32_t fileCounter = ring->fileCounter;
+	if (fileCounter != schemaFileCounter) {
+		ring->markFileStart(fileCounter);
+	}
+	ring->write(header, sizeof(header));
+	for (int i = 0; i < fieldCount; i++) {
+		uint8_t type = fields[i].type;
+		ring->write(&type, 1);
+		ring->write(fields[i].name, strlen(fields[i].name) + 1);
+		ring->write(fields[i].units, strlen(fields[i].units) + 1);
+	}
+	memcpy(schema, fields, fieldCount * sizeof(log_field_s));
+	schemaFieldCount = fieldCount;
+	schemaFileCounter = fileCounter;
+	schemaCounter++;
+	return true;
+}
+
+bool BinaryLogEncoder::endRecord() {
+	if (!isSameSchema() && !writeSchema()) {
+		return false;
+	}
+	if (!ring->write(record, 1 + 4 * fieldCount)) {
+		return false;
+	}
+	recordCounter++;
+	return true;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file binary_log.h
+ * @brief Binary data log format for SD card
+ *
+ * Log file is a sequence of blocks, each block starts with a one byte tag.
+ *
+ * Schema block, written at the beginning of each file and whenever the set of logged fields changes:
+ *   'H', "RLOG", version byte, uint16 field count,
+ *   for each field: type byte (see log_field_type_e), zero-terminated name, zero-terminated units
+ *
+ * Record block, one per log line:
+ *   'R', four bytes per field in schema order, float or int32
+ *
+ * All numbers are little-endian. See misc/binary_log_decoder.py for host side decoder.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef BINARY_LOG_H_
+#define BINARY_LOG_H_
+
+#include <stdint.h>
+
+#define BINARY_LOG_SCHEMA_TAG 'H'
+#define BINARY_LOG_RECORD_TAG 'R'
+#define BINARY_LOG_MAGIC "RLOG"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_MAX_FIELDS 64
+#define BINARY_LOG_FILE_EXTENSION ".rlb"
+/**
+ * tag, magic, version and field count
+ */
+#define BINARY_LOG_SCHEMA_HEADER_SIZE 8
+
+/**
+ * SD card is written in multiples of this size so that every write is sector-aligned
+ */
+#define BINARY_LOG_SECTOR_SIZE 512
+
+typedef enum {
+	LOG_FIELD_FLOAT = 0,
+	LOG_FIELD_INT = 1,
+} log_field_type_e;
+
+typedef struct {
+	const char *name;
+	const char *units;
+	log_field_type_e type;
+} log_field_s;
+
+/**
+ * Log file as seen by BinaryLogRing::writeTo, FatFS file on SD card
+ */
+class BinaryLogFile {
+public:
+	/**
+	 * @return number of bytes written, less than size on error or full disk
+	 */
+	virtual int write(const void *data, int size) = 0;
+};
+
+/**
+ * Byte ring between log line producer and SD card writer thread. Single producer, single consumer,
+ * neither side locks.
+ */
+class BinaryLogRing {
+public:
+	/**
+	 * @param size power of two, multiple of BINARY_LOG_SECTOR_SIZE
+	 */
+	BinaryLogRing(uint8_t *buffer, int size);
+	/**
+	 * Producer side, either the whole block fits or nothing is written
+	 */
+	bool write(const void *data, int size);
+	/**
+	 * Consumer side
+	 * @return number of bytes which could be read at getReadPointer() in one go
+	 */
+	int getContiguousSize() const;
+	const uint8_t *getReadPointer() const;
+	void consume(int size);
+	/**
+	 * Consumer side, forget everything which was not written yet
+	 */
+	void discard();
+	/**
+	 * Consumer side, new file is opened. Producer repeats schema after that.
+	 */
+	void startFile();
+	/**
+	 * Consumer side, skips whatever was logged before startFile()
+	 * @return false while producer has not started the new file yet, nothing should be written meanwhile
+	 */
+	bool skipPreviousFile();
+	/**
+	 * Consumer side
+	 * @param fileOffset current size of the file
+	 * @return number of bytes to write so that the file ends at sector boundary, could be more
+	 * than getContiguousSize() at the end of the ring
+	 */
+	int getSectorAlignedBacklog(uint32_t fileOffset) const;
+	/**
+	 * Consumer side. Writes end at file sector boundary unless this is the final flush, remainder
+	 * waits for the next records. Nothing is written before skipPreviousFile() allows it.
+	 * @param fileOffset current size of the file
+	 * @param isFlush write everything, file would be closed next
+	 * @param maxChunkSize largest single file write
+	 * @return number of bytes written, stops at the first short write
+	 */
+	int writeTo(BinaryLogFile *file, uint32_t fileOffset, bool isFlush, int maxChunkSize);
+	/**
+	 * Producer side, called before the first schema of a new file
+	 */
+	void markFileStart(uint32_t fileCounter);
+	/**
+	 * number of bytes written but not yet consumed
+	 */
+	int getBacklog() const;
+	int getFreeSpace() const;
+	/**
+	 * incremented by consumer each time a new file is started, producer repeats schema after that
+	 */
+	volatile uint32_t fileCounter;
+	/**
+	 * write index of the first schema of file 'fileStartCounter'
+	 */
+	volatile uint32_t fileStartIndex;
+	volatile uint32_t fileStartCounter;
+	volatile uint32_t overrunCounter;
+	uint32_t totalBytes;
+private:
+	uint8_t *buffer;
+	int size;
+	volatile uint32_t writeIndex;
+	volatile uint32_t readIndex;
+	/**
+	 * consumer only, file which skipPreviousFile() is already done for
+	 */
+	uint32_t skippedFileCounter;
+};
+
+/**
+ * Packs one log line at a time into fixed size binary records
+ */
+class BinaryLogEncoder {
+public:
+	BinaryLogEncoder(BinaryLogRing *ring);
+	void beginRecord();
+	void addFloat(const char *name, const char *units, float value);
+	void addInt(const char *name, const char *units, int value);
+	/**
+	 * Writes schema if needed and the record
+	 * @return false if there was no room in the ring
+	 */
+	bool endRecord();
+	uint32_t schemaCounter;
+	uint32_t recordCounter;
+private:
+	void addField(const char *name, const char *units, log_field_type_e type, const void *value);
+	bool isSameSchema() const;
+	bool writeSchema();
+	BinaryLogRing *ring;
+	log_field_s fields[BINARY_LOG_MAX_FIELDS];
+	int fieldCount;
+	log_field_s schema[BINARY_LOG_MAX_FIELDS];
+	int schemaFieldCount;
+	uint32_t schemaFileCounter;
+	uint8_t record[1 + 4 * BINARY_LOG_MAX_FIELDS];
+};
+
+#endif /* BINARY_LOG_H_ */
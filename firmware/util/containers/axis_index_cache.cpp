@@ -0,0 +1,44 @@
+/**
+ * @file axis_index_cache.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "axis_index_cache.h"
+
+AxisIndexCache axisIndexCache;
+
+AxisIndexCache::AxisIndexCache() {
+	memset(entries, 0, sizeof(entries));
+	memset(owners, 0, sizeof(owners));
+	ownersCount = 0;
+	generation = 0;
+	cycleDepth = 0;
+	hitCounter = 0;
+	missCounter = 0;
+}
+
+int AxisIndexCache::registerAxis(const void *bins) {
+	for (int i = 0; i < ownersCount; i++) {
+		if (owners[i] == bins) {
+			return i;
+		}
+	}
+	if (ownersCount == AXIS_INDEX_CACHE_SIZE) {
+		return AXIS_INDEX_NO_SLOT;
+	}
+	owners[ownersCount] = bins;
+	return ownersCount++;
+}
+
+void AxisIndexCache::beginCycle() {
+	generation++;
+	cycleDepth++;
+}
+
+void AxisIndexCache::endCycle() {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, cycleDepth > 0, "endCycle without beginCycle");
+	cycleDepth--;
+}
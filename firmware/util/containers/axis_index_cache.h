@@ -0,0 +1,109 @@
+/**
+ * @file axis_index_cache.h
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef AXIS_INDEX_CACHE_H_
+#define AXIS_INDEX_CACHE_H_
+
+#include "interpolation.h"
+
+/**
+ * Maximum number of distinct axis arrays with a dedicated entry, axes registered after that are not cached
+ */
+#ifndef AXIS_INDEX_CACHE_SIZE
+#define AXIS_INDEX_CACHE_SIZE 32
+#endif
+
+#define AXIS_INDEX_NO_SLOT -1
+
+typedef struct {
+	/**
+	 * odd while the entry is being written
+	 */
+	volatile uint32_t sequence;
+	const void * volatile bins;
+	volatile uint32_t generation;
+	volatile float value;
+	volatile int index;
+	volatile float fraction;
+} axis_index_cache_entry_s;
+
+/**
+ * Remembers last findAxisIndex() result for each axis array during one calculation cycle.
+ *
+ * Fuel, timing, VE, AFR and other tables are evaluated a number of times per cycle for the same
+ * RPM and load, with this cache each axis is only searched once per distinct value.
+ *
+ * Each axis array gets its own entry by registerAxis() at table initialization, so two axes
+ * never compete for the same entry. Tables which share an axis array share its entry.
+ *
+ * Outside of beginCycle()/endCycle() the cache is bypassed - axis bins could be changed by
+ * TunerStudio at any moment and there is nothing to invalidate the cache in that case.
+ *
+ * Lookups are allowed from any context: an entry being written by an interrupted thread is
+ * recognized by its odd sequence number and treated as a miss.
+ */
+class AxisIndexCache {
+public:
+	AxisIndexCache();
+	/**
+	 * invalidates all the entries
+	 */
+	void beginCycle();
+	void endCycle();
+
+	/**
+	 * Not thread-safe, invoked on initialization
+	 * @return entry index for given axis array, same index for the same array, AXIS_INDEX_NO_SLOT if there is no room
+	 */
+	int registerAxis(const void *bins);
+
+	template<int TSize, typename kType>
+	axis_index_s get(int slot, const kType bins[], float value) {
+		if (cycleDepth == 0 || slot == AXIS_INDEX_NO_SLOT) {
+			return findAxisIndex<TSize, kType>(bins, value);
+		}
+		axis_index_cache_entry_s *entry = &entries[slot];
+		uint32_t sequence = entry->sequence;
+		if ((sequence & 1) == 0 && entry->bins == bins && entry->generation == generation && entry->value == value) {
+			axis_index_s result;
+			result.index = entry->index;
+			result.fraction = entry->fraction;
+			if (entry->sequence == sequence) {
+				hitCounter++;
+				return result;
+			}
+		}
+		missCounter++;
+		axis_index_s result = findAxisIndex<TSize, kType>(bins, value);
+		if ((entry->sequence & 1) == 0) {
+			entry->sequence++;
+			entry->bins = bins;
+			entry->generation = generation;
+			entry->value = value;
+			entry->index = result.index;
+			entry->fraction = result.fraction;
+			entry->sequence++;
+		}
+		return result;
+	}
+
+	uint32_t hitCounter;
+	uint32_t missCounter;
+private:
+	axis_index_cache_entry_s entries[AXIS_INDEX_CACHE_SIZE];
+	/**
+	 * axis array which owns each entry
+	 */
+	const void *owners[AXIS_INDEX_CACHE_SIZE];
+	int ownersCount;
+	volatile uint32_t generation;
+	volatile int cycleDepth;
+};
+
+extern AxisIndexCache axisIndexCache;
+
+#endif /* AXIS_INDEX_CACHE_H_ */
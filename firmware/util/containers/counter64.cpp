@@ -7,6 +7,8 @@
 
 #include "counter64.h"
 
+#define COUNTER64_MEMORY_BARRIER() __sync_synchronize()
+
 /**
  * The main use-case of this class is to keep track of a 64-bit global number of CPU ticks from reset.
  *
@@ -15,28 +17,40 @@
  * keep track of the current CYCCNT value, detect these overflows, and provide a nice,
  * clean 64 bit global cycle counter.
  *
- * In order for this to function, it's your responsibility to invoke offer() method at least once a second.
+ * In order for this to function, it's your responsibility to invoke update() method at least once a second.
+ *
+ * Readers never lock and never retry: writer only touches the copy which is not published, so a
+ * reader which preempts the writer, or is preempted by it, still sees a consistent pair. Writer
+ * would have to update twice within one read to break that.
  */
 Overflow64Counter::Overflow64Counter() {
-	state.highBits = 0;
-	state.lowBits = 0;
+	memset(states, 0, sizeof(states));
+	readIndex = 0;
 }
 
-/**
- * in order to have atomic writes this should be invoked within a critical section
- */
-void updateAndSet(State64 *state, uint32_t value) {
-	if (value < state->lowBits) {
+State64 Overflow64Counter::getSnapshot() const {
+	State64 result = states[readIndex];
+	COUNTER64_MEMORY_BARRIER();
+	return result;
+}
+
+efitime_t Overflow64Counter::toTime64(const State64 *snapshot, uint32_t value) {
+	uint32_t highBits = snapshot->highBits;
+	if (value < snapshot->lowBits) {
 		// new value less than previous value means there was an overflow in that 32 bit counter
-		state->highBits += 0x100000000LL;
+		highBits++;
 	}
-	state->lowBits = value;
+	return ((efitime_t) highBits << 32) + value;
 }
 
-#if EFI_UNIT_TEST
 efitime_t Overflow64Counter::update(uint32_t value) {
-	updateAndSet(&state, value);
-	return state.highBits + state.lowBits;
+	int readIndexLocal = readIndex;
+	int writeIndex = readIndexLocal ^ 1;
+	efitime_t result = toTime64(&states[readIndexLocal], value);
+	states[writeIndex].highBits = result >> 32;
+	states[writeIndex].lowBits = value;
+	COUNTER64_MEMORY_BARRIER();
+	// this would commit the new pair of values
+	readIndex = writeIndex;
+	return result;
 }
-#endif
-
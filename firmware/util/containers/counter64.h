@@ -11,24 +11,36 @@
 #include "global.h"
 
 typedef struct {
-	// todo: would probably be better to keep the high bits as 32 bit field to be sure
-	volatile efitime_t highBits;
-	volatile uint32_t lowBits;
+	/**
+	 * number of 32 bit counter overflows
+	 */
+	uint32_t highBits;
+	uint32_t lowBits;
 } State64;
 
-void updateAndSet(State64 *state, uint32_t value);
-
 class Overflow64Counter
 {
   public:
 	Overflow64Counter();
 
-	efitime_t get();
-#if EFI_UNIT_TEST
+	/**
+	 * Wait-free, could be invoked from any context. Has to be taken BEFORE the 32 bit counter
+	 * value which is going to be extended is sampled.
+	 */
+	State64 getSnapshot() const;
+	static efitime_t toTime64(const State64 *snapshot, uint32_t value);
+	/**
+	 * Only one context should invoke this, at least once per 32 bit counter period
+	 * @return 64 bit value of 'value'
+	 */
 	efitime_t update(uint32_t value);
-#endif
 
-	State64 state;
+  private:
+	/**
+	 * 'readIndex' is always pointing to the consistent copy, writer fills the other one
+	 */
+	State64 states[2];
+	volatile int readIndex;
 };
 
 #endif /* UTIL_CONTAINERS_COUNTER64_H_ */
@@ -0,0 +1,145 @@
+/**
+ * @file delta_frame_encoder.h
+ * @brief Encodes a structure as a sequence of frames which only carry changed 32 bit words
+ *
+ * Frame layout:
+ *   sequence number, one byte, incremented for each frame so that receiver can see lost frames
+ *   flags, one byte, see DELTA_FRAME_KEY
+ *   bitmap, one bit per 32 bit word of the structure, lowest bit of first byte is the first word
+ *   values of the words which have their bit set, in native byte order
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef DELTA_FRAME_ENCODER_H_
+#define DELTA_FRAME_ENCODER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define DELTA_FRAME_HEADER_SIZE 2
+/**
+ * all the words are present, receiver could start from here or recover after lost frame
+ */
+#define DELTA_FRAME_KEY 1
+#define DELTA_FRAME_KEY_INTERVAL 50
+
+template<int TSize>
+class DeltaFrameEncoder {
+public:
+	static constexpr int WORD_COUNT = (TSize + 3) / 4;
+	static constexpr int BITMAP_SIZE = (WORD_COUNT + 7) / 8;
+	static constexpr int MAX_FRAME_SIZE = DELTA_FRAME_HEADER_SIZE + BITMAP_SIZE + WORD_COUNT * 4;
+
+	DeltaFrameEncoder();
+	/**
+	 * next frame would be a key frame
+	 */
+	void reset();
+	/**
+	 * Takes a snapshot of current state and encodes the difference with previous snapshot
+	 * @param frame at least MAX_FRAME_SIZE bytes
+	 * @return frame size in bytes
+	 */
+	int encode(const void *state, uint8_t *frame);
+	/**
+	 * Applies a frame on top of previous state
+	 * @return false if frame is malformed or a frame was lost since last key frame
+	 */
+	static bool decode(const uint8_t *frame, int size, void *state, uint8_t *expectedSequence);
+
+	uint32_t frameCounter;
+	uint32_t keyFrameCounter;
+private:
+	/**
+	 * Snapshot pair, current state is copied into one while the other one holds the state as of the
+	 * previous frame. Roles are switched after each frame, so there is no copy back.
+	 */
+	uint32_t snapshots[2][WORD_COUNT];
+	int previousIndex;
+	int framesSinceKeyFrame;
+	uint8_t sequence;
+	bool needKeyFrame;
+};
+
+template<int TSize>
+DeltaFrameEncoder<TSize>::DeltaFrameEncoder() {
+	memset(snapshots, 0, sizeof(snapshots));
+	previousIndex = 0;
+	sequence = 0;
+	frameCounter = 0;
+	keyFrameCounter = 0;
+	reset();
+}
+
+template<int TSize>
+void DeltaFrameEncoder<TSize>::reset() {
+	needKeyFrame = true;
+	framesSinceKeyFrame = 0;
+}
+
+template<int TSize>
+int DeltaFrameEncoder<TSize>::encode(const void *state, uint8_t *frame) {
+	uint32_t *current = snapshots[1 - previousIndex];
+	const uint32_t *previous = snapshots[previousIndex];
+	// last word could be partial
+	current[WORD_COUNT - 1] = 0;
+	memcpy(current, state, TSize);
+
+	bool isKeyFrame = needKeyFrame || framesSinceKeyFrame >= DELTA_FRAME_KEY_INTERVAL;
+	frame[0] = sequence++;
+	frame[1] = isKeyFrame ? DELTA_FRAME_KEY : 0;
+	uint8_t *bitmap = frame + DELTA_FRAME_HEADER_SIZE;
+	memset(bitmap, 0, BITMAP_SIZE);
+	uint8_t *values = bitmap + BITMAP_SIZE;
+	for (int i = 0; i < WORD_COUNT; i++) {
+		if (isKeyFrame || current[i] != previous[i]) {
+			bitmap[i / 8] |= 1 << (i % 8);
+			memcpy(values, &current[i], 4);
+			values += 4;
+		}
+	}
+
+	previousIndex = 1 - previousIndex;
+	frameCounter++;
+	if (isKeyFrame) {
+		keyFrameCounter++;
+		needKeyFrame = false;
+		framesSinceKeyFrame = 0;
+	} else {
+		framesSinceKeyFrame++;
+	}
+	return values - frame;
+}
+
+template<int TSize>
+bool DeltaFrameEncoder<TSize>::decode(const uint8_t *frame, int size, void *state, uint8_t *expectedSequence) {
+	if (size < DELTA_FRAME_HEADER_SIZE + BITMAP_SIZE) {
+		return false;
+	}
+	bool isKeyFrame = frame[1] & DELTA_FRAME_KEY;
+	if (!isKeyFrame && frame[0] != *expectedSequence) {
+		return false;
+	}
+	*expectedSequence = frame[0] + 1;
+	const uint8_t *bitmap = frame + DELTA_FRAME_HEADER_SIZE;
+	const uint8_t *values = bitmap + BITMAP_SIZE;
+	const uint8_t *end = frame + size;
+	uint8_t *bytes = (uint8_t *) state;
+	for (int i = 0; i < WORD_COUNT; i++) {
+		if ((bitmap[i / 8] & (1 << (i % 8))) == 0) {
+			continue;
+		}
+		if (values + 4 > end) {
+			return false;
+		}
+		int offset = i * 4;
+		int length = offset + 4 > TSize ? TSize - offset : 4;
+		memcpy(bytes + offset, values, length);
+		values += 4;
+	}
+	return values == end;
+}
+
+#endif /* DELTA_FRAME_ENCODER_H_ */
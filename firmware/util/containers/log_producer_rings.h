@@ -0,0 +1,109 @@
+/**
+ * @file log_producer_rings.h
+ * @brief Console output of all log producers, see EFI_LOG_PRODUCER_RINGS
+ *
+ * Each producer has a lock-free ring of its own. Engine sniffer, sensor chart and status loop
+ * lines are larger than a ring could ever take, those go into one shared buffer under lock same
+ * way all the messages did before producer rings. There are two such buffers so that consumer
+ * only swaps them under lock and copies without it.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef LOG_PRODUCER_RINGS_H_
+#define LOG_PRODUCER_RINGS_H_
+
+#include "global.h"
+#include "message_ring.h"
+
+/**
+ * @param TLargeSize should not be larger than consumer output buffer
+ */
+template<int TRingSize, int TProducerCount, int TLargeSize>
+class LogProducerRings {
+public:
+	LogProducerRings();
+	/**
+	 * Could be invoked from any context
+	 * @return false if there was no room, in which case the message is dropped and counted
+	 */
+	bool write(int producer, const char *text, int length);
+	/**
+	 * Consumer side, large messages first and then producer rings starting with a different one
+	 * each time so that a busy one could not starve the others
+	 * @return number of bytes written into output
+	 */
+	int read(char *output, int capacity);
+	/**
+	 * @return true if message goes into shared buffer under lock
+	 */
+	static bool isLarge(int length) {
+		return MESSAGE_RING_HEADER_SIZE + length > TRingSize / 2;
+	}
+	MessageRing<TRingSize> rings[TProducerCount];
+	uint32_t largeMessageCounter;
+	uint32_t largeDroppedCounter;
+private:
+	char largeBuffers[2][TLargeSize];
+	int largeSizes[2];
+	/**
+	 * buffer which writers append to, the other one belongs to consumer
+	 */
+	int activeLarge;
+	int firstProducerIndex;
+};
+
+template<int TRingSize, int TProducerCount, int TLargeSize>
+LogProducerRings<TRingSize, TProducerCount, TLargeSize>::LogProducerRings() {
+	largeMessageCounter = 0;
+	largeDroppedCounter = 0;
+	largeSizes[0] = 0;
+	largeSizes[1] = 0;
+	activeLarge = 0;
+	firstProducerIndex = 0;
+}
+
+template<int TRingSize, int TProducerCount, int TLargeSize>
+bool LogProducerRings<TRingSize, TProducerCount, TLargeSize>::write(int producer, const char *text, int length) {
+	if (!isLarge(length)) {
+		return rings[producer].write(text, length);
+	}
+	bool alreadyLocked = lockAnyContext();
+	int index = activeLarge;
+	bool isWritten = largeSizes[index] + length <= TLargeSize;
+	if (isWritten) {
+		memcpy(largeBuffers[index] + largeSizes[index], text, length);
+		largeSizes[index] += length;
+		largeMessageCounter++;
+	} else {
+		// if no one is consuming the data we have to drop it
+		largeDroppedCounter++;
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+	return isWritten;
+}
+
+template<int TRingSize, int TProducerCount, int TLargeSize>
+int LogProducerRings<TRingSize, TProducerCount, TLargeSize>::read(char *output, int capacity) {
+	bool alreadyLocked = lockAnyContext();
+	int index = activeLarge;
+	activeLarge = 1 - index;
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+	// no writer touches this buffer until next swap
+	int size = minI(largeSizes[index], capacity);
+	memcpy(output, largeBuffers[index], size);
+	largeSizes[index] = 0;
+	for (int i = 0; i < TProducerCount; i++) {
+		MessageRing<TRingSize> *ring = &rings[(firstProducerIndex + i) % TProducerCount];
+		size += ring->read(output + size, capacity - size);
+	}
+	firstProducerIndex = (firstProducerIndex + 1) % TProducerCount;
+	return size;
+}
+
+#endif /* LOG_PRODUCER_RINGS_H_ */
@@ -0,0 +1,173 @@
+/**
+ * @file message_ring.h
+ * @brief Lock-free ring of variable length text messages
+ *
+ * Any number of producers, including interrupt handlers which preempt each other, and one consumer.
+ * Producer reserves space with compare-and-swap, copies the message and then publishes it by adding
+ * its size to the commit counter. Consumer only reads while every reservation is committed, that
+ * is always the case once nested writers have returned.
+ *
+ * Each message is stored as two byte length followed by the text, without zero terminator.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef MESSAGE_RING_H_
+#define MESSAGE_RING_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define MESSAGE_RING_MEMORY_BARRIER() __sync_synchronize()
+#define MESSAGE_RING_HEADER_SIZE 2
+
+template<int TSize>
+class MessageRing {
+	static_assert((TSize & (TSize - 1)) == 0, "size should be power of two");
+public:
+	MessageRing();
+	/**
+	 * Producer side, could be invoked from any context
+	 * @return false if there was no room, in which case the message is dropped and counted
+	 */
+	bool write(const char *text, int length);
+	/**
+	 * Consumer side, copies whole messages while they fit. Output should be at least TSize bytes
+	 * so that any message would fit into an empty output.
+	 * @return number of bytes written into output
+	 */
+	int read(char *output, int capacity);
+	/**
+	 * Consumer side, takes exactly one message
+	 * @return message length, or -1 if there is nothing to read or message does not fit
+	 */
+	int readMessage(void *output, int capacity);
+	/**
+	 * @return number of bytes reserved but not yet consumed
+	 */
+	int getBacklog() const;
+	volatile uint32_t messageCounter;
+	volatile uint32_t droppedCounter;
+	volatile uint32_t droppedBytes;
+private:
+	void copyIn(uint32_t index, const void *data, int length);
+	void copyOut(uint32_t index, void *data, int length) const;
+	bool isComplete(uint32_t *committed) const;
+	char buffer[TSize];
+	/**
+	 * free-running counters, only lower bits are used as index
+	 */
+	volatile uint32_t reserveIndex;
+	volatile uint32_t commitIndex;
+	volatile uint32_t readIndex;
+};
+
+template<int TSize>
+MessageRing<TSize>::MessageRing() {
+	reserveIndex = 0;
+	commitIndex = 0;
+	readIndex = 0;
+	messageCounter = 0;
+	droppedCounter = 0;
+	droppedBytes = 0;
+}
+
+template<int TSize>
+int MessageRing<TSize>::getBacklog() const {
+	return reserveIndex - readIndex;
+}
+
+template<int TSize>
+void MessageRing<TSize>::copyIn(uint32_t index, const void *data, int length) {
+	int offset = index & (TSize - 1);
+	int firstPart = length < TSize - offset ? length : TSize - offset;
+	memcpy(buffer + offset, data, firstPart);
+	memcpy(buffer, (const char *) data + firstPart, length - firstPart);
+}
+
+template<int TSize>
+void MessageRing<TSize>::copyOut(uint32_t index, void *data, int length) const {
+	int offset = index & (TSize - 1);
+	int firstPart = length < TSize - offset ? length : TSize - offset;
+	memcpy(data, buffer + offset, firstPart);
+	memcpy((char *) data + firstPart, buffer, length - firstPart);
+}
+
+template<int TSize>
+bool MessageRing<TSize>::write(const char *text, int length) {
+	int total = MESSAGE_RING_HEADER_SIZE + length;
+	uint32_t index;
+	do {
+		index = reserveIndex;
+		if ((int) (index - readIndex) + total > TSize) {
+			__sync_fetch_and_add(&droppedCounter, 1);
+			__sync_fetch_and_add(&droppedBytes, length);
+			return false;
+		}
+	} while (!__sync_bool_compare_and_swap(&reserveIndex, index, index + total));
+
+	uint8_t header[MESSAGE_RING_HEADER_SIZE] = { (uint8_t) (length & 0xFF), (uint8_t) (length >> 8) };
+	copyIn(index, header, MESSAGE_RING_HEADER_SIZE);
+	copyIn(index + MESSAGE_RING_HEADER_SIZE, text, length);
+	MESSAGE_RING_MEMORY_BARRIER();
+	__sync_fetch_and_add(&commitIndex, total);
+	__sync_fetch_and_add(&messageCounter, 1);
+	return true;
+}
+
+/**
+ * Commit counter has to be read first: if reservation counter still has the same value after
+ * that, no writer was in the middle of a message.
+ */
+template<int TSize>
+bool MessageRing<TSize>::isComplete(uint32_t *committed) const {
+	*committed = commitIndex;
+	MESSAGE_RING_MEMORY_BARRIER();
+	return *committed == reserveIndex;
+}
+
+template<int TSize>
+int MessageRing<TSize>::read(char *output, int capacity) {
+	uint32_t committed;
+	if (!isComplete(&committed)) {
+		return 0;
+	}
+	uint32_t index = readIndex;
+	int size = 0;
+	while (index != committed) {
+		uint8_t header[MESSAGE_RING_HEADER_SIZE];
+		copyOut(index, header, MESSAGE_RING_HEADER_SIZE);
+		int length = header[0] | (header[1] << 8);
+		if (size + length > capacity) {
+			break;
+		}
+		copyOut(index + MESSAGE_RING_HEADER_SIZE, output + size, length);
+		size += length;
+		index += MESSAGE_RING_HEADER_SIZE + length;
+	}
+	MESSAGE_RING_MEMORY_BARRIER();
+	readIndex = index;
+	return size;
+}
+
+template<int TSize>
+int MessageRing<TSize>::readMessage(void *output, int capacity) {
+	uint32_t committed;
+	uint32_t index = readIndex;
+	if (!isComplete(&committed) || index == committed) {
+		return -1;
+	}
+	uint8_t header[MESSAGE_RING_HEADER_SIZE];
+	copyOut(index, header, MESSAGE_RING_HEADER_SIZE);
+	int length = header[0] | (header[1] << 8);
+	if (length > capacity) {
+		return -1;
+	}
+	copyOut(index + MESSAGE_RING_HEADER_SIZE, output, length);
+	MESSAGE_RING_MEMORY_BARRIER();
+	readIndex = index + MESSAGE_RING_HEADER_SIZE + length;
+	return length;
+}
+
+#endif /* MESSAGE_RING_H_ */
@@ -0,0 +1,123 @@
+/**
+ * @file spsc_queue.h
+ * @brief Lock-free single-producer single-consumer queue
+ *
+ * Producer is usually an interrupt handler and consumer is a thread, neither side ever waits
+ * or masks interrupts. Each index is only written by one side.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stdint.h>
+
+/**
+ * Element has to be completely written before the other side sees the new index
+ */
+#define SPSC_MEMORY_BARRIER() __sync_synchronize()
+
+template<typename T, int TSize>
+class SpscQueue {
+	static_assert((TSize & (TSize - 1)) == 0, "size should be power of two");
+public:
+	SpscQueue();
+	/**
+	 * Producer side
+	 * @return false if queue is full, in which case the value is dropped and counted as overrun
+	 */
+	bool push(const T &value);
+	/**
+	 * Consumer side
+	 * @return false if queue is empty
+	 */
+	bool pop(T *value);
+	/**
+	 * Consumer side, same as pop() but the value stays in the queue
+	 * @return false if queue is empty
+	 */
+	bool peek(T *value) const;
+	/**
+	 * @return number of elements pushed but not yet popped
+	 */
+	int getBacklog() const;
+	void resetCounters();
+	/**
+	 * number of values dropped because queue was full
+	 */
+	volatile uint32_t overrunCounter;
+	/**
+	 * largest backlog seen by producer
+	 */
+	volatile int maxBacklog;
+private:
+	T values[TSize];
+	/**
+	 * free-running counters, only lower bits are used as index
+	 */
+	volatile uint32_t writeIndex;
+	volatile uint32_t readIndex;
+};
+
+template<typename T, int TSize>
+SpscQueue<T, TSize>::SpscQueue() {
+	writeIndex = 0;
+	readIndex = 0;
+	resetCounters();
+}
+
+template<typename T, int TSize>
+void SpscQueue<T, TSize>::resetCounters() {
+	overrunCounter = 0;
+	maxBacklog = 0;
+}
+
+template<typename T, int TSize>
+int SpscQueue<T, TSize>::getBacklog() const {
+	return writeIndex - readIndex;
+}
+
+template<typename T, int TSize>
+bool SpscQueue<T, TSize>::push(const T &value) {
+	uint32_t index = writeIndex;
+	int backlog = index - readIndex;
+	if (backlog >= TSize) {
+		overrunCounter++;
+		return false;
+	}
+	values[index & (TSize - 1)] = value;
+	SPSC_MEMORY_BARRIER();
+	writeIndex = index + 1;
+	if (backlog + 1 > maxBacklog) {
+		maxBacklog = backlog + 1;
+	}
+	return true;
+}
+
+template<typename T, int TSize>
+bool SpscQueue<T, TSize>::pop(T *value) {
+	uint32_t index = readIndex;
+	if (index == writeIndex) {
+		return false;
+	}
+	SPSC_MEMORY_BARRIER();
+	*value = values[index & (TSize - 1)];
+	SPSC_MEMORY_BARRIER();
+	readIndex = index + 1;
+	return true;
+}
+
+template<typename T, int TSize>
+bool SpscQueue<T, TSize>::peek(T *value) const {
+	uint32_t index = readIndex;
+	if (index == writeIndex) {
+		return false;
+	}
+	SPSC_MEMORY_BARRIER();
+	*value = values[index & (TSize - 1)];
+	return true;
+}
+
+#endif /* SPSC_QUEUE_H_ */
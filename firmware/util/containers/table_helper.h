@@ -10,6 +10,7 @@
 #include <math.h>
 #include "error_handling.h"
 #include "interpolation.h"
+#include "axis_index_cache.h"
 #include "efilib.h"
 
 // popular left edge of CLT-based correction curves
@@ -31,12 +32,24 @@ public:
 	Map3D(const char*name, float multiplier);
 	void init(vType table[RPM_BIN_SIZE][LOAD_BIN_SIZE], const kType loadBins[LOAD_BIN_SIZE], const kType rpmBins[RPM_BIN_SIZE]);
 	float getValue(float xRpm, float y);
+	/**
+	 * Same as getValue(float, float) with axis positions resolved by the caller, for example once
+	 * for all the tables which share the same axes
+	 */
+	float getValue(const axis_index_s &rpmIndex, const axis_index_s &loadIndex) const;
+	axis_index_s getRpmIndex(float rpm) const;
+	axis_index_s getLoadIndex(float load) const;
 	void setAll(vType value);
 	vType *pointers[LOAD_BIN_SIZE];
 private:
 	void create(const char*name, float multiplier);
 	const kType *loadBins = NULL;
 	const kType *rpmBins = NULL;
+	/**
+	 * see AxisIndexCache::registerAxis
+	 */
+	int loadSlot = AXIS_INDEX_NO_SLOT;
+	int rpmSlot = AXIS_INDEX_NO_SLOT;
 	bool initialized =  false;
 	const char *name;
 	float multiplier;
@@ -94,6 +107,8 @@ void Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::init(vType table[RPM_BIN_
 	initialized = true;
 	this->loadBins = loadBins;
 	this->rpmBins = rpmBins;
+	loadSlot = axisIndexCache.registerAxis(loadBins);
+	rpmSlot = axisIndexCache.registerAxis(rpmBins);
 }
 
 template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
@@ -103,8 +118,27 @@ float Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getValue(float xRpm, flo
 		warning(CUSTOM_PARAM_RANGE, "%s: y is NaN", name);
 		return NAN;
 	}
+	if (cisnan(xRpm)) {
+		warning(CUSTOM_INTEPOLATE_ERROR_2, "%s: x is NaN", name);
+		return NAN;
+	}
+	return getValue(getRpmIndex(xRpm), getLoadIndex(y));
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+float Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getValue(const axis_index_s &rpmIndex, const axis_index_s &loadIndex) const {
 	// todo: we have a bit of a mess: in TunerStudio, RPM is X-axis
-	return multiplier * interpolate3d<vType, kType>(y, loadBins, LOAD_BIN_SIZE, xRpm, rpmBins, RPM_BIN_SIZE, pointers);
+	return multiplier * interpolate3dCell<vType>(pointers, loadIndex, rpmIndex);
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+axis_index_s Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getRpmIndex(float rpm) const {
+	return axisIndexCache.get<RPM_BIN_SIZE, kType>(rpmSlot, rpmBins, rpm);
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+axis_index_s Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getLoadIndex(float load) const {
+	return axisIndexCache.get<LOAD_BIN_SIZE, kType>(loadSlot, loadBins, load);
 }
 
 template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
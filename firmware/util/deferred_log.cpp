@@ -0,0 +1,171 @@
+/**
+ * @file deferred_log.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "deferred_log.h"
+#include "message_ring.h"
+
+#if EFI_UNIT_TEST
+#define deferredSnprintf snprintf
+#else
+#include "os_access.h"
+#define deferredSnprintf chsnprintf
+#endif /* EFI_UNIT_TEST */
+
+#ifndef DEFERRED_LOG_RING_SIZE
+#define DEFERRED_LOG_RING_SIZE 2048
+#endif /* DEFERRED_LOG_RING_SIZE */
+
+/**
+ * longest formatted message, longer ones are truncated
+ */
+#define DEFERRED_LOG_LINE_SIZE 200
+#define DEFERRED_LOG_SPEC_SIZE 16
+#define DEFERRED_LOG_PREFIX "msg" DELIMETER
+
+static MessageRing<DEFERRED_LOG_RING_SIZE> deferredLogRing CCM_OPTIONAL;
+
+/**
+ * Formatted message which did not fit into output last time
+ */
+static char pendingLine[DEFERRED_LOG_LINE_SIZE];
+static int pendingLineLength = 0;
+
+/**
+ * @return pointer right after the conversion character, conversion is zero at the end of format
+ */
+static const char *nextConversion(const char *p, char *conversion) {
+	while (*p != 0 && *p != '%') {
+		p++;
+	}
+	if (*p == 0) {
+		*conversion = 0;
+		return p;
+	}
+	p++;
+	while (*p != 0 && strchr("-+ #0123456789.lhz", *p) != NULL) {
+		p++;
+	}
+	*conversion = *p;
+	return *p == 0 ? p : p + 1;
+}
+
+static bool isFloatConversion(char conversion) {
+	return strchr("fFeEgGaA", conversion) != NULL;
+}
+
+static bool isPointerConversion(char conversion) {
+	return conversion == 's' || conversion == 'p';
+}
+
+void deferredMsg(const char *fmt, ...) {
+	deferred_log_record_s record;
+	record.fmt = fmt;
+	int argCount = 0;
+
+	va_list ap;
+	va_start(ap, fmt);
+	const char *p = fmt;
+	while (argCount < DEFERRED_LOG_MAX_ARGS) {
+		char conversion;
+		p = nextConversion(p, &conversion);
+		if (conversion == 0) {
+			break;
+		} else if (conversion == '%') {
+			continue;
+		} else if (isFloatConversion(conversion)) {
+			record.args[argCount++].f = va_arg(ap, double);
+		} else if (isPointerConversion(conversion)) {
+			record.args[argCount++].s = va_arg(ap, const char *);
+		} else {
+			record.args[argCount++].i = va_arg(ap, int);
+		}
+	}
+	va_end(ap);
+
+	int size = sizeof(record.fmt) + argCount * sizeof(deferred_log_arg_u);
+	deferredLogRing.write((const char *) &record, size);
+}
+
+static int formatRecord(const deferred_log_record_s *record, int argCount, char *output, int capacity) {
+	int size = sizeof(DEFERRED_LOG_PREFIX) - 1;
+	memcpy(output, DEFERRED_LOG_PREFIX, size);
+	// leave room for closing delimiter and terminator
+	int limit = capacity - 2;
+	int argIndex = 0;
+	const char *p = record->fmt;
+	while (*p != 0 && size < limit) {
+		if (*p != '%') {
+			output[size++] = *p++;
+			continue;
+		}
+		char conversion;
+		const char *end = nextConversion(p, &conversion);
+		if (conversion == 0) {
+			break;
+		}
+		if (conversion == '%') {
+			output[size++] = '%';
+			p = end;
+			continue;
+		}
+		char specBuffer[DEFERRED_LOG_SPEC_SIZE];
+		int specLength = minI(end - p, DEFERRED_LOG_SPEC_SIZE - 1);
+		memcpy(specBuffer, p, specLength);
+		specBuffer[specLength] = 0;
+		p = end;
+		if (argIndex >= argCount) {
+			break;
+		}
+		const deferred_log_arg_u *arg = &record->args[argIndex++];
+		int written;
+		if (isFloatConversion(conversion)) {
+			written = deferredSnprintf(output + size, limit + 1 - size, specBuffer, (double) arg->f);
+		} else if (isPointerConversion(conversion)) {
+			written = deferredSnprintf(output + size, limit + 1 - size, specBuffer, arg->s);
+		} else {
+			written = deferredSnprintf(output + size, limit + 1 - size, specBuffer, arg->i);
+		}
+		size += maxI(0, minI(written, limit - size));
+	}
+	output[size++] = DELIMETER[0];
+	output[size] = 0;
+	return size;
+}
+
+int formatDeferredMessages(char *output, int capacity) {
+	int size = 0;
+	while (true) {
+		if (pendingLineLength == 0) {
+			deferred_log_record_s record;
+			int recordSize = deferredLogRing.readMessage(&record, sizeof(record));
+			if (recordSize < 0) {
+				break;
+			}
+			int argCount = (recordSize - sizeof(record.fmt)) / sizeof(deferred_log_arg_u);
+			pendingLineLength = formatRecord(&record, argCount, pendingLine, sizeof(pendingLine));
+		}
+		if (size + pendingLineLength >= capacity) {
+			break;
+		}
+		memcpy(output + size, pendingLine, pendingLineLength);
+		size += pendingLineLength;
+		pendingLineLength = 0;
+	}
+	if (capacity > 0) {
+		output[size] = 0;
+	}
+	return size;
+}
+
+uint32_t getDeferredMessageCounter(void) {
+	return deferredLogRing.messageCounter;
+}
+
+uint32_t getDeferredDroppedCounter(void) {
+	return deferredLogRing.droppedCounter;
+}
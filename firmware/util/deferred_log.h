@@ -0,0 +1,47 @@
+/**
+ * @file deferred_log.h
+ * @brief Logging which only records format string pointer and raw argument values
+ *
+ * Call site does not format anything, so this is cheap enough for trigger and scheduler
+ * interrupt handlers. Text is produced by the console thread when it collects pending output.
+ *
+ * Format string and any %s arguments have to be string literals or otherwise live forever.
+ * Supported conversions are the usual int ones, %s and floating point ones; 64 bit values are not.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef DEFERRED_LOG_H_
+#define DEFERRED_LOG_H_
+
+#include <stdint.h>
+
+#define DEFERRED_LOG_MAX_ARGS 10
+
+typedef union {
+	int32_t i;
+	float f;
+	const char *s;
+} deferred_log_arg_u;
+
+typedef struct {
+	const char *fmt;
+	deferred_log_arg_u args[DEFERRED_LOG_MAX_ARGS];
+} deferred_log_record_s;
+
+/**
+ * Could be invoked from any context, message is dropped and counted if the ring is full
+ */
+void deferredMsg(const char *fmt, ...);
+
+/**
+ * Consumer side, appends pending messages as 'msg,<text>,' into output
+ * @return number of characters written, output is zero-terminated
+ */
+int formatDeferredMessages(char *output, int capacity);
+
+uint32_t getDeferredMessageCounter(void);
+uint32_t getDeferredDroppedCounter(void);
+
+#endif /* DEFERRED_LOG_H_ */
@@ -62,6 +62,10 @@ efitimesec_t getTimeNowSeconds(void);
 }
 #endif /* __cplusplus */
 
+/**
+ * Lower 32 bits of getTimeNowNt, a single register read. Good for durations shorter than
+ * one counter period, compute those as unsigned difference.
+ */
 #if EFI_PROD_CODE || EFI_SIMULATOR
  #define getTimeNowLowerNt() port_rt_get_counter_value()
 #else
@@ -0,0 +1,88 @@
+/**
+ * @file engine_sniffer_record.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "engine_sniffer_record.h"
+
+bool reserveEngineSnifferRecord(volatile uint32_t *slot, uint32_t limit, uint32_t *reserved) {
+	while (true) {
+		uint32_t current = *slot;
+		if (ENGINE_SNIFFER_SLOT_INDEX(current) >= limit) {
+			return false;
+		}
+		if (__sync_bool_compare_and_swap(slot, current, current + 1)) {
+			*reserved = current;
+			return true;
+		}
+		// interrupted by another writer or by chart switch, try again
+	}
+}
+
+uint32_t switchEngineSnifferChart(volatile uint32_t *slot, int chart) {
+	while (true) {
+		uint32_t current = *slot;
+		if (__sync_bool_compare_and_swap(slot, current, ENGINE_SNIFFER_SLOT(chart, 0))) {
+			return current;
+		}
+	}
+}
+
+int getEngineSnifferChannel(const char * volatile *names, const char *name) {
+	for (int i = 0; i < ENGINE_SNIFFER_CHANNEL_COUNT; i++) {
+		// names are string constants so pointer comparison is enough
+		const char *current = names[i];
+		if (current == name) {
+			return i;
+		}
+		if (current == NULL) {
+			// only happens once per channel
+			if (__sync_bool_compare_and_swap(&names[i], (const char *) NULL, name) || names[i] == name) {
+				return i;
+			}
+			// another writer has just taken this entry for a different channel
+		}
+	}
+	return -1;
+}
+
+void encodeEngineSnifferValue(engine_sniffer_record_s *record, const char *msg) {
+	record->edge = 0;
+	// see WC_UP and WC_DOWN
+	if (msg[0] == 'u' || msg[0] == 'd') {
+		record->edge = msg[0];
+		msg++;
+		if (msg[0] == '_') {
+			msg++;
+		}
+	}
+	if (msg[0] < '0' || msg[0] > '9') {
+		record->value = ENGINE_SNIFFER_NO_VALUE;
+		return;
+	}
+	uint32_t value = 0;
+	while (msg[0] >= '0' && msg[0] <= '9' && value < ENGINE_SNIFFER_NO_VALUE) {
+		value = value * 10 + msg[0] - '0';
+		msg++;
+	}
+	record->value = minI(value, ENGINE_SNIFFER_NO_VALUE - 1);
+}
+
+char *printEngineSnifferValue(char *buffer, const engine_sniffer_record_s *record) {
+	if (record->edge != 0) {
+		*buffer++ = record->edge;
+		if (record->value == ENGINE_SNIFFER_NO_VALUE) {
+			*buffer = 0;
+			return buffer;
+		}
+		*buffer++ = '_';
+	}
+	if (record->value == ENGINE_SNIFFER_NO_VALUE) {
+		*buffer = 0;
+		return buffer;
+	}
+	return itoa10(buffer, record->value);
+}
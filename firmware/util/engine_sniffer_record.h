@@ -0,0 +1,115 @@
+/**
+ * @file engine_sniffer_record.h
+ * @brief Fixed size engine sniffer records, see EFI_ENGINE_SNIFFER_BINARY
+ *
+ * Writers are trigger and scheduler interrupt handlers so nothing here takes a lock.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef ENGINE_SNIFFER_RECORD_H_
+#define ENGINE_SNIFFER_RECORD_H_
+
+#include "global.h"
+
+#define ENGINE_SNIFFER_BINARY_VERSION 1
+#define ENGINE_SNIFFER_CHANNEL_COUNT 32
+#define ENGINE_SNIFFER_NAME_SIZE 12
+/**
+ * largest default engineChartSize, see mazda_626.cpp. Text chart buffer is not used in binary mode
+ * so its RAM goes here.
+ */
+#if EFI_PROD_CODE
+#define ENGINE_SNIFFER_RECORD_COUNT 600
+#else
+#define ENGINE_SNIFFER_RECORD_COUNT 2048
+#endif
+/**
+ * active chart, one chart being published and one spare which could still be read by TunerStudio
+ */
+#define ENGINE_SNIFFER_CHART_COUNT 3
+#define ENGINE_SNIFFER_NO_VALUE 0xFFFF
+/**
+ * "u_65534" and zero terminator
+ */
+#define ENGINE_SNIFFER_VALUE_SIZE 8
+
+/**
+ * Active chart index and number of records handed out from it share one word, so a writer picks
+ * the chart and its record in one compare-and-swap and a chart switch cannot get in between
+ */
+#define ENGINE_SNIFFER_SLOT(chart, index) (((uint32_t)(chart) << 24) | (index))
+#define ENGINE_SNIFFER_SLOT_CHART(slot) ((int)((slot) >> 24))
+#define ENGINE_SNIFFER_SLOT_INDEX(slot) ((slot) & 0xFFFFFF)
+
+/**
+ * One digital event. "t1!u_12!" becomes {channel of "t1", 'u', 12}
+ */
+typedef struct {
+	/**
+	 * ticks since chart start, no conversion to microseconds on the hot path
+	 */
+	uint32_t timeNt;
+	uint8_t channel;
+	/**
+	 * 'u', 'd' or zero
+	 */
+	uint8_t edge;
+	/**
+	 * tooth index or RPM, ENGINE_SNIFFER_NO_VALUE if none
+	 */
+	uint16_t value;
+} engine_sniffer_record_s;
+
+/**
+ * TunerStudio TS_GET_ENGINE_SNIFFER response is this header followed by recordCount records, all
+ * little-endian. Channel names are only sent once per chart.
+ */
+typedef struct {
+	uint8_t version;
+	uint8_t channelCount;
+	uint16_t recordCount;
+	uint32_t ticksPerSecond;
+	uint32_t chartCounter;
+	uint32_t droppedCounter;
+	char names[ENGINE_SNIFFER_CHANNEL_COUNT][ENGINE_SNIFFER_NAME_SIZE];
+} engine_sniffer_header_s;
+
+typedef struct {
+	engine_sniffer_header_s header;
+	engine_sniffer_record_s records[ENGINE_SNIFFER_RECORD_COUNT];
+	/**
+	 * number of records completely written
+	 */
+	volatile uint32_t committed;
+	efitick_t startTimeNt;
+} engine_sniffer_chart_s;
+
+/**
+ * Writer side
+ * @param slot see ENGINE_SNIFFER_SLOT
+ * @param reserved chart and record index to be filled by the writer
+ * @return false if active chart already has 'limit' records
+ */
+bool reserveEngineSnifferRecord(volatile uint32_t *slot, uint32_t limit, uint32_t *reserved);
+/**
+ * Makes 'chart' active, writers which have reserved a record before this point would still fill it
+ * @return previous slot value, index part is the number of records handed out from previous chart
+ */
+uint32_t switchEngineSnifferChart(volatile uint32_t *slot, int chart);
+/**
+ * @return index of 'name' in 'names', new names take the first free entry, -1 if table is full
+ */
+int getEngineSnifferChannel(const char * volatile *names, const char *name);
+/**
+ * "u_12" becomes 'u' and 12, "1500" becomes 1500
+ */
+void encodeEngineSnifferValue(engine_sniffer_record_s *record, const char *msg);
+/**
+ * Reverse of encodeEngineSnifferValue(), 'buffer' should fit ENGINE_SNIFFER_VALUE_SIZE characters
+ * @return pointer at the end zero symbol
+ */
+char *printEngineSnifferValue(char *buffer, const engine_sniffer_record_s *record);
+
+#endif /* ENGINE_SNIFFER_RECORD_H_ */
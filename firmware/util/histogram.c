@@ -17,6 +17,39 @@
 #error "Unexpected OS ACCESS HERE"
 #endif
 
+int compactHistogramGetIndex(uint32_t value) {
+	int index = value == 0 ? 0 : 32 - __builtin_clz(value);
+	return index < COMPACT_HISTOGRAM_SIZE ? index : COMPACT_HISTOGRAM_SIZE - 1;
+}
+
+void resetCompactHistogram(compact_histogram_s *h) {
+	memset(h, 0, sizeof(compact_histogram_s));
+}
+
+void compactHsAdd(compact_histogram_s *h, uint32_t value) {
+	h->values[compactHistogramGetIndex(value)]++;
+	h->total_count++;
+	if (value > h->max) {
+		h->max = value;
+	}
+}
+
+/**
+ * @return upper bound of the bucket which contains requested percentile, or zero for empty histogram
+ */
+uint32_t compactHsGetPercentile(compact_histogram_s *h, float percentile) {
+	uint32_t target = (uint32_t) (percentile * h->total_count);
+	uint32_t acc = 0;
+	for (int i = 0; i < COMPACT_HISTOGRAM_SIZE - 1; i++) {
+		acc += h->values[i];
+		if (acc > target) {
+			uint32_t bucketUpperBound = i == 0 ? 0 : (1 << i) - 1;
+			return bucketUpperBound < h->max ? bucketUpperBound : h->max;
+		}
+	}
+	return h->max;
+}
+
 #if EFI_HISTOGRAMS || EFI_UNIT_TEST
 
 #define H_ACCURACY 0.05
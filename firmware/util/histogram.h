@@ -38,6 +38,27 @@ void initHistogram(histogram_s *h, const char *name);
 void hsAdd(histogram_s *h, int64_t value);
 int hsReport(histogram_s *h, int* report);
 
+/**
+ * Bucket 0 is for zero, bucket N is for values in [2^(N-1), 2^N) range, last bucket takes everything above
+ */
+#define COMPACT_HISTOGRAM_SIZE 24
+
+/**
+ * Small power-of-two histogram which is cheap enough to be updated from ISR for every event.
+ * Updates are plain increments without any locking, readers are expected to tolerate
+ * a slightly inconsistent snapshot.
+ */
+typedef struct {
+	uint32_t total_count;
+	uint32_t max;
+	uint32_t values[COMPACT_HISTOGRAM_SIZE];
+} compact_histogram_s;
+
+int compactHistogramGetIndex(uint32_t value);
+void resetCompactHistogram(compact_histogram_s *h);
+void compactHsAdd(compact_histogram_s *h, uint32_t value);
+uint32_t compactHsGetPercentile(compact_histogram_s *h, float percentile);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -11,6 +11,7 @@
 
 #include "global.h"
 #include "efilib.h"
+#include "deferred_log.h"
 
 #if ! EFI_UNIT_TEST
 
@@ -22,6 +23,187 @@ typedef char log_buf_t[DL_OUTPUT_BUFFER];
  */
 #define MAX_DL_CAPACITY (DL_OUTPUT_BUFFER - 5)
 
+#if EFI_LOG_PRODUCER_RINGS
+#include "os_access.h"
+#include "os_util.h"
+#include "cli_registry.h"
+#include "log_producer_rings.h"
+
+/**
+ * Slot 0 is shared by all interrupt handlers, last slot is shared by threads which came after
+ * all the other slots were taken. Any other slot belongs to one thread.
+ */
+#ifndef LOG_PRODUCER_COUNT
+#define LOG_PRODUCER_COUNT 6
+#endif /* LOG_PRODUCER_COUNT */
+
+#ifndef LOG_PRODUCER_RING_SIZE
+#define LOG_PRODUCER_RING_SIZE 1024
+#endif /* LOG_PRODUCER_RING_SIZE */
+
+#define LOG_PRODUCER_SCRATCH_SIZE 200
+#define LOG_PRODUCER_ISR 0
+#define LOG_PRODUCER_SHARED (LOG_PRODUCER_COUNT - 1)
+
+typedef struct {
+	thread_t * volatile owner;
+	/**
+	 * scheduleMsg formats into scratch, nested interrupt handler or a thread sharing the slot would
+	 * find it busy and drop the message
+	 */
+	volatile uint32_t isBusy;
+	char scratch[LOG_PRODUCER_SCRATCH_SIZE];
+} log_producer_s;
+
+static log_producer_s logProducers[LOG_PRODUCER_COUNT] CCM_OPTIONAL;
+
+static LogProducerRings<LOG_PRODUCER_RING_SIZE, LOG_PRODUCER_COUNT, MAX_DL_CAPACITY> logRings CCM_OPTIONAL;
+
+static log_buf_t outputBuffer;
+
+static LoggingWithStorage logger("logging central");
+
+/**
+ * Each thread takes a slot of its own the first time it logs anything
+ */
+static log_producer_s *getLogProducer(void) {
+	if (isIsrContext()) {
+		return &logProducers[LOG_PRODUCER_ISR];
+	}
+	thread_t *self = chThdGetSelfX();
+	for (int i = LOG_PRODUCER_ISR + 1; i < LOG_PRODUCER_SHARED; i++) {
+		thread_t *owner = logProducers[i].owner;
+		if (owner == self) {
+			return &logProducers[i];
+		}
+		if (owner == NULL && __sync_bool_compare_and_swap(&logProducers[i].owner, (thread_t *) NULL, self)) {
+			return &logProducers[i];
+		}
+	}
+	return &logProducers[LOG_PRODUCER_SHARED];
+}
+
+static void writeToLogProducer(log_producer_s *producer, const char *text, int length) {
+#ifdef EFI_PRINT_MESSAGES_TO_TERMINAL
+	print(text);
+	print("\r\n");
+#endif /* EFI_PRINT_MESSAGES_TO_TERMINAL */
+	logRings.write(producer - logProducers, text, length);
+}
+
+static const char *getLogProducerName(int index) {
+	if (index == LOG_PRODUCER_ISR) {
+		return "ISR";
+	} else if (index == LOG_PRODUCER_SHARED) {
+		return "shared";
+	}
+	thread_t *owner = logProducers[index].owner;
+	return owner == NULL ? "free" : chRegGetThreadNameX(owner);
+}
+
+static void printLogProducers(void) {
+	for (int i = 0; i < LOG_PRODUCER_COUNT; i++) {
+		MessageRing<LOG_PRODUCER_RING_SIZE> *ring = &logRings.rings[i];
+		scheduleMsg(&logger, "log producer %d %s: messages=%d dropped=%d/%d bytes backlog=%d", i,
+				getLogProducerName(i), ring->messageCounter, ring->droppedCounter,
+				ring->droppedBytes, ring->getBacklog());
+	}
+	scheduleMsg(&logger, "large messages=%d dropped=%d", logRings.largeMessageCounter, logRings.largeDroppedCounter);
+}
+
+/**
+ * Appends the content of specified logger into the ring of current thread or interrupt context,
+ * no lock is taken unless the message is too large for a ring. If there is no room the message
+ * is dropped and counted.
+ */
+void scheduleLogging(Logging *logging) {
+#if EFI_TEXT_LOGGING
+	writeToLogProducer(getLogProducer(), logging->buffer, efiStrlen(logging->buffer));
+	resetLogging(logging);
+#endif /* EFI_TEXT_LOGGING */
+}
+
+/**
+ * Merges producer rings into the output buffer. Only whole messages are taken, whatever does not
+ * fit would go out next time.
+ *
+ * this method should always be invoked from the same thread!
+ * @return pointer to the buffer which should be print to console
+ */
+char * swapOutputBuffers(int *actualOutputBufferSize) {
+	int size = logRings.read(outputBuffer, MAX_DL_CAPACITY);
+	size += formatDeferredMessages(outputBuffer + size, MAX_DL_CAPACITY - size);
+	outputBuffer[size] = 0;
+	*actualOutputBufferSize = size;
+	return outputBuffer;
+}
+
+void initLoggingCentral(void) {
+	outputBuffer[0] = 0;
+	addConsoleAction("logproducers", printLogProducers);
+}
+
+/**
+ * rusEfi business logic invokes this method in order to eventually print stuff to rusEfi console
+ *
+ * Message is formatted right into the scratch buffer of current producer, so there is no shared
+ * state and no lock unless the message is longer than the scratch buffer.
+ */
+void scheduleMsg(Logging *logging, const char *fmt, ...) {
+	for (unsigned int i = 0;i<strlen(fmt);i++) {
+		// todo: open question which layer would not handle CR/LF properly?
+		efiAssertVoid(OBD_PCM_Processor_Fault, fmt[i] != '\n', "No CRLF please");
+	}
+#if EFI_TEXT_LOGGING
+	if (logging == NULL) {
+		warning(CUSTOM_ERR_LOGGING_NULL, "logging NULL");
+		return;
+	}
+	log_producer_s *producer = getLogProducer();
+	if (__sync_lock_test_and_set(&producer->isBusy, 1)) {
+		__sync_fetch_and_add(&logRings.rings[producer - logProducers].droppedCounter, 1);
+		return;
+	}
+	char *buffer = producer->scratch;
+	static const char prefix[] = "msg" DELIMETER;
+	int length = sizeof(prefix) - 1;
+	memcpy(buffer, prefix, length);
+
+	va_list ap;
+	va_start(ap, fmt);
+	// return value is the length which the whole message would have, it could be larger than what was written
+	length += chvsnprintf(buffer + length, LOG_PRODUCER_SCRATCH_SIZE - length - 1, fmt, ap);
+	va_end(ap);
+
+	if (length < LOG_PRODUCER_SCRATCH_SIZE - 2) {
+		buffer[length++] = DELIMETER[0];
+		buffer[length] = 0;
+		writeToLogProducer(producer, buffer, length);
+		__sync_lock_release(&producer->isBusy);
+		return;
+	}
+	__sync_lock_release(&producer->isBusy);
+	/**
+	 * Does not fit scratch: same as before producer rings, format into the buffer of this logger
+	 * under lock. Such message most likely goes into shared buffer of large messages.
+	 */
+	int wasLocked = lockAnyContext();
+	resetLogging(logging);
+	appendMsgPrefix(logging);
+	va_start(ap, fmt);
+	logging->vappendPrintf(fmt, ap);
+	va_end(ap);
+	appendMsgPostfix(logging);
+	writeToLogProducer(producer, logging->buffer, efiStrlen(logging->buffer));
+	resetLogging(logging);
+	if (!wasLocked) {
+		unlockAnyContext();
+	}
+#endif /* EFI_TEXT_LOGGING */
+}
+
+#else
+
 /**
  * This is the buffer into which all the data providers write
  */
@@ -116,6 +298,8 @@ char * swapOutputBuffers(int *actualOutputBufferSize) {
 		return NULL;
 	}
 #endif /* EFI_ENABLE_ASSERTS */
+	*actualOutputBufferSize += formatDeferredMessages(outputBuffer + *actualOutputBufferSize,
+			MAX_DL_CAPACITY - *actualOutputBufferSize);
 	return outputBuffer;
 }
 
@@ -162,5 +346,6 @@ void scheduleMsg(Logging *logging, const char *fmt, ...) {
 #endif /* EFI_TEXT_LOGGING */
 }
 
+#endif /* EFI_LOG_PRODUCER_RINGS */
 
 #endif /* EFI_UNIT_TEST */
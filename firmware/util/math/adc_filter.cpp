@@ -0,0 +1,116 @@
+/**
+ * @file adc_filter.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "adc_filter.h"
+
+#define ADC_FILTER_MEMORY_BARRIER() __sync_synchronize()
+#define ADC_FILTER_MIN_ALPHA 0.001
+
+AdcFilterBank::AdcFilterBank() {
+	channelCount = 0;
+	publishedIndex = 0;
+	version = 0;
+	memset(published, 0, sizeof(published));
+	for (int i = 0; i < ADC_FILTER_MAX_CHANNELS; i++) {
+		configure(i, 1, 1);
+	}
+}
+
+void AdcFilterBank::setChannelCount(int channelCount) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, channelCount >= 0 && channelCount <= ADC_FILTER_MAX_CHANNELS, "adc filter channels");
+	this->channelCount = channelCount;
+}
+
+int AdcFilterBank::getChannelCount() const {
+	return channelCount;
+}
+
+void AdcFilterBank::configure(int channel, float alpha, int decimation) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, channel >= 0 && channel < ADC_FILTER_MAX_CHANNELS, "adc filter channel");
+	setAlpha(channel, alpha);
+	this->decimation[channel] = maxI(minI(decimation, ADC_FILTER_MAX_DECIMATION), 1);
+	accumulator[channel] = 0;
+	sampleCount[channel] = 0;
+	blockCount[channel] = 0;
+	isInitialized[channel] = false;
+}
+
+void AdcFilterBank::setAlpha(int channel, float alpha) {
+	this->alpha[channel] = maxF(minF(alpha, 1), ADC_FILTER_MIN_ALPHA);
+}
+
+float AdcFilterBank::getAlpha(int channel) const {
+	return alpha[channel];
+}
+
+void AdcFilterBank::processBlock(const uint16_t *samples, int depth) {
+	for (int row = 0; row < depth; row++) {
+		for (int i = 0; i < channelCount; i++) {
+			accumulator[i] += samples[i];
+		}
+		samples += channelCount;
+	}
+
+	int writeIndex = publishedIndex ^ 1;
+	float *output = published[writeIndex];
+	bool hasNewValue = false;
+	for (int i = 0; i < channelCount; i++) {
+		sampleCount[i] += depth;
+		if (++blockCount[i] < decimation[i]) {
+			output[i] = published[publishedIndex][i];
+			continue;
+		}
+		float value = (float) accumulator[i] / sampleCount[i];
+		accumulator[i] = 0;
+		sampleCount[i] = 0;
+		blockCount[i] = 0;
+		if (isInitialized[i]) {
+			state[i] += alpha[i] * (value - state[i]);
+		} else {
+			state[i] = value;
+			isInitialized[i] = true;
+		}
+		output[i] = state[i];
+		hasNewValue = true;
+	}
+	if (!hasNewValue) {
+		return;
+	}
+	ADC_FILTER_MEMORY_BARRIER();
+	version++;
+	publishedIndex = writeIndex;
+}
+
+float AdcFilterBank::getValue(int channel) const {
+	return published[publishedIndex][channel];
+}
+
+uint32_t AdcFilterBank::getSnapshot(float *output) const {
+	while (true) {
+		uint32_t before = version;
+		ADC_FILTER_MEMORY_BARRIER();
+		memcpy(output, published[publishedIndex], channelCount * sizeof(float));
+		ADC_FILTER_MEMORY_BARRIER();
+		/**
+		 * if this reader has preempted the writer nothing could change until we are done, so
+		 * this only retries when the writer has preempted the reader
+		 */
+		if (version == before) {
+			return before;
+		}
+	}
+}
+
+uint32_t AdcFilterBank::getVersion() const {
+	return version;
+}
+
+int getAdcFilterDecimation(int blockUs, int filterPeriodUs) {
+	int decimation = filterPeriodUs / maxI(1, blockUs);
+	return maxI(1, minI(decimation, ADC_FILTER_MAX_DECIMATION));
+}
@@ -0,0 +1,83 @@
+/**
+ * @file adc_filter.h
+ * @brief Per-channel decimation and first order IIR filters over a block of ADC samples
+ *
+ * Writer is the ADC DMA callback, it processes a whole block of interleaved samples at once.
+ * Results are double-buffered: writer always fills the copy which is not published and then
+ * flips the index, so readers in any context never take a lock. A reader which needs several
+ * channels from the same update compares versions before and after copying.
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef ADC_FILTER_H_
+#define ADC_FILTER_H_
+
+#include <stdint.h>
+
+#define ADC_FILTER_MAX_CHANNELS 16
+/**
+ * keeps sum of 12 bit samples within 32 bits and sample count within 16 bits
+ */
+#define ADC_FILTER_MAX_DECIMATION 1024
+
+class AdcFilterBank {
+public:
+	AdcFilterBank();
+	void setChannelCount(int channelCount);
+	int getChannelCount() const;
+	/**
+	 * @param alpha weight of new value, 1 means no IIR filtering
+	 * @param decimation number of blocks averaged together before each filter step
+	 */
+	void configure(int channel, float alpha, int decimation);
+	/**
+	 * Changes filter strength without resetting filter state
+	 */
+	void setAlpha(int channel, float alpha);
+	float getAlpha(int channel) const;
+	/**
+	 * Writer side, samples are interleaved: depth rows of channelCount values each
+	 */
+	void processBlock(const uint16_t *samples, int depth);
+	/**
+	 * Any context
+	 */
+	float getValue(int channel) const;
+	/**
+	 * Any context, copies all channels from the same update
+	 * @return version of the copied values
+	 */
+	uint32_t getSnapshot(float *output) const;
+	/**
+	 * Incremented each time any channel has a new value
+	 */
+	uint32_t getVersion() const;
+private:
+	int channelCount;
+	/**
+	 * everything below is indexed by channel so that the block loop walks plain arrays
+	 */
+	uint32_t accumulator[ADC_FILTER_MAX_CHANNELS];
+	uint16_t sampleCount[ADC_FILTER_MAX_CHANNELS];
+	uint16_t blockCount[ADC_FILTER_MAX_CHANNELS];
+	uint16_t decimation[ADC_FILTER_MAX_CHANNELS];
+	float alpha[ADC_FILTER_MAX_CHANNELS];
+	bool isInitialized[ADC_FILTER_MAX_CHANNELS];
+	float state[ADC_FILTER_MAX_CHANNELS];
+
+	float published[2][ADC_FILTER_MAX_CHANNELS];
+	volatile int publishedIndex;
+	volatile uint32_t version;
+};
+
+/**
+ * Number of blocks averaged together so that filter step rate does not depend on how long
+ * one block takes, for instance on number of channels in a free-running conversion
+ * @param blockUs time it takes to convert one block
+ * @param filterPeriodUs desired time between filter steps
+ */
+int getAdcFilterDecimation(int blockUs, int filterPeriodUs);
+
+#endif /* ADC_FILTER_H_ */
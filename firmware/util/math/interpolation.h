@@ -230,6 +230,58 @@ float interpolate3d(float x, const kType xBin[], int xBinSize, float y, const kT
 	float result = interpolateMsg("3d", keyMin, keyMinValue, keyMax, keyMaxValue, y);
 	return result;
 }
+/**
+ * Position of a value on a table axis: index of the cell and position within that cell.
+ * Both are clamped to the axis range so that a value outside of the axis gets the edge value,
+ * same as interpolate3d does.
+ */
+typedef struct {
+	int index;
+	float fraction;
+} axis_index_s;
+
+/**
+ * Binary search over an axis of compile-time size without data-dependent branches, so that it is
+ * unrolled into a fixed sequence of compare-and-select instructions.
+ *
+ * @note 'value' is expected to be checked for NaN by the caller, once per value and not once per table
+ */
+template<int TSize, typename kType>
+axis_index_s findAxisIndex(const kType bins[], float value) {
+	static_assert(TSize > 1, "axis needs at least two bins");
+	int base = 0;
+	int cellsCount = TSize - 1;
+	while (cellsCount > 1) {
+		int half = cellsCount / 2;
+		base = value >= bins[base + half] ? base + half : base;
+		cellsCount -= half;
+	}
+	float x1 = bins[base];
+	float x2 = bins[base + 1];
+	// same bins (for example while bins are being re-configured) would give us the left value
+	float fraction = x2 > x1 ? (value - x1) / (x2 - x1) : 0;
+	axis_index_s result;
+	result.index = base;
+	result.fraction = fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+	return result;
+}
+
+/**
+ * @brief	Bilinear interpolation within a cell found by findAxisIndex()
+ */
+template<typename vType>
+float interpolate3dCell(vType * const map[], const axis_index_s &x, const axis_index_s &y) {
+	const vType *row0 = map[x.index];
+	const vType *row1 = map[x.index + 1];
+	float v00 = row0[y.index];
+	float v01 = row0[y.index + 1];
+	float v10 = row1[y.index];
+	float v11 = row1[y.index + 1];
+	float low = v00 + (v01 - v00) * y.fraction;
+	float high = v10 + (v11 - v10) * y.fraction;
+	return low + (high - low) * x.fraction;
+}
+
 void setCurveValue(float bins[], float values[], int size, float key, float value);
 void initInterpolation(Logging *sharedLogger);
 
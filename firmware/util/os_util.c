@@ -81,6 +81,16 @@ void unlockAnyContext(void) {
 #endif /* #if USE_PORT_LOCK */
 }
 
+#else
+/**
+ * unit tests are single threaded, we always pretend to be in locked context
+ */
+bool lockAnyContext(void) {
+	return true;
+}
+
+void unlockAnyContext(void) {
+}
 #endif /* EFI_UNIT_TEST */
 
 
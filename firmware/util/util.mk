@@ -12,11 +12,16 @@ UTILSRC_CPP = \
 	$(UTIL_DIR)/containers/counter64.cpp \
 	$(UTIL_DIR)/containers/local_version_holder.cpp \
 	$(UTIL_DIR)/containers/table_helper.cpp \
+	$(UTIL_DIR)/containers/axis_index_cache.cpp \
 	$(UTIL_DIR)/math/pid.cpp \
 	$(UTIL_DIR)/math/avg_values.cpp \
 	$(UTIL_DIR)/math/interpolation.cpp \
 	$(UTIL_DIR)/math/biquad.cpp \
+	$(UTIL_DIR)/math/adc_filter.cpp \
 	$(PROJECT_DIR)/util/datalogging.cpp \
+	$(PROJECT_DIR)/util/binary_log.cpp \
+	$(PROJECT_DIR)/util/deferred_log.cpp \
+	$(PROJECT_DIR)/util/engine_sniffer_record.cpp \
 	$(PROJECT_DIR)/util/loggingcentral.cpp \
 	$(PROJECT_DIR)/util/cli_registry.cpp \
 	$(PROJECT_DIR)/util/efilib.cpp \
@@ -875,6 +875,7 @@ public class Fields {
 	public static final int LDS_ENGINE_STATE_INDEX = 3;
 	public static final int LDS_FUEL_TRIM_INDEX = 4;
 	public static final int LDS_IAT_INDEX = 1;
+	public static final int LDS_SCHEDULER_INDEX = 7;
 	public static final int LDS_SPEED_DENSITY_INDEX = 2;
 	public static final int LDS_TPS_TPS_ENEICHMENT_INDEX = 5;
 	public static final int LDS_TRIGGER_INDEX = 6;
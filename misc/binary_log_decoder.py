@@ -0,0 +1,75 @@
+#!/usr/bin/python3
+
+# this script converts rusEfi binary SD card log (.rlb) into tab-separated .msl text log
+# see firmware/util/binary_log.h for file format
+#
+# usage: binary_log_decoder.py rus1.rlb [rus1.msl]
+
+import struct
+import sys
+
+SCHEMA_TAG = ord('H')
+RECORD_TAG = ord('R')
+MAGIC = b'RLOG'
+LOG_FIELD_FLOAT = 0
+LOG_FIELD_INT = 1
+
+
+def read_string(data, offset):
+    end = data.index(b'\0', offset)
+    return data[offset:end].decode('ascii', 'replace'), end + 1
+
+
+def decode(data, out):
+    offset = 0
+    fields = None
+    records = 0
+    skipped = 0
+    while offset < len(data):
+        tag = data[offset]
+        if tag == SCHEMA_TAG:
+            if data[offset + 1:offset + 5] != MAGIC:
+                raise ValueError('bad schema block at %d' % offset)
+            count = struct.unpack_from('<H', data, offset + 6)[0]
+            offset += 8
+            fields = []
+            for i in range(count):
+                type = data[offset]
+                name, offset = read_string(data, offset + 1)
+                units, offset = read_string(data, offset)
+                fields.append((name, units, type))
+            out.write('\t'.join(f[0] for f in fields) + '\t\r\n')
+            out.write('\t'.join(f[1] for f in fields) + '\t\r\n')
+        elif tag == RECORD_TAG:
+            if fields is None:
+                raise ValueError('record without schema at %d' % offset)
+            if offset + 1 + 4 * len(fields) > len(data):
+                # last record was cut short by power loss
+                skipped += 1
+                break
+            values = []
+            for i, field in enumerate(fields):
+                position = offset + 1 + 4 * i
+                if field[2] == LOG_FIELD_INT:
+                    values.append('%d' % struct.unpack_from('<i', data, position)[0])
+                else:
+                    values.append('%.3f' % struct.unpack_from('<f', data, position)[0])
+            out.write('\t'.join(values) + '\t\r\n')
+            offset += 1 + 4 * len(fields)
+            records += 1
+        else:
+            raise ValueError('unexpected tag %d at %d' % (tag, offset))
+    return records, skipped
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('usage: binary_log_decoder.py input.rlb [output.msl]')
+        sys.exit(1)
+    input_name = sys.argv[1]
+    output_name = sys.argv[2] if len(sys.argv) > 2 else input_name.rsplit('.', 1)[0] + '.msl'
+    with open(input_name, 'rb') as f:
+        data = f.read()
+    with open(output_name, 'w', newline='') as out:
+        records, skipped = decode(data, out)
+    print('%s: %d records, %d incomplete' % (output_name, records, skipped))
@@ -120,6 +120,18 @@
 #define SPARK_EXTREME_LOGGING FALSE
 #define DEBUG_PWM FALSE
 #define EFI_SIGNAL_EXECUTOR_ONE_TIMER FALSE
+#define EFI_EVENT_QUEUE_HEAP FALSE
+#define EFI_SCHEDULER_HISTOGRAMS FALSE
+#define EFI_OUTPUT_SCHEDULE_BUFFER FALSE
+#define EFI_TRIGGER_EVENT_QUEUE TRUE
+#define EFI_ENGINE_SNIFFER_BINARY TRUE
+#define EFI_TS_OUTPUT_STREAM TRUE
+#define EFI_BINARY_FILE_LOGGING FALSE
+#define EFI_LOG_PRODUCER_RINGS TRUE
+#define EFI_HARDWARE_PWM FALSE
+#define EFI_SLOW_ADC_CIRCULAR FALSE
+#define EFI_MAP_PER_CYLINDER_FUEL FALSE
+#define EFI_CONFIG_LOG_FLASH FALSE
 #define EFI_TUNER_STUDIO_VERBOSE FALSE
 #define EFI_FILE_LOGGING FALSE
 #define EFI_WARNING_LED FALSE
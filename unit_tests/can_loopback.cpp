@@ -0,0 +1,66 @@
+/**
+ * @file can_loopback.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "can_loopback.h"
+
+LoopbackCanDriver::LoopbackCanDriver(CanBus *bus) {
+	this->bus = bus;
+	peer = NULL;
+	filterCount = 0;
+	mailboxCount = 0;
+	filteredCounter = 0;
+	sentCounter = 0;
+	bus->setDriver(this);
+}
+
+void LoopbackCanDriver::connect(LoopbackCanDriver *peer) {
+	this->peer = peer;
+	peer->peer = this;
+}
+
+bool LoopbackCanDriver::transmit(const can_frame_s *frame) {
+	if (mailboxCount >= CAN_LOOPBACK_MAILBOXES) {
+		return false;
+	}
+	mailboxes[mailboxCount++] = *frame;
+	return true;
+}
+
+void LoopbackCanDriver::setFilters(const can_rx_filter_s *filters, int count) {
+	memcpy(this->filters, filters, count * sizeof(can_rx_filter_s));
+	filterCount = count;
+}
+
+int LoopbackCanDriver::getPendingMailboxes() const {
+	return mailboxCount;
+}
+
+/**
+ * Like bxCAN with no active filter bank, nothing is received until filters are set
+ */
+void LoopbackCanDriver::receive(const can_frame_s *frame) {
+	for (int i = 0; i < filterCount; i++) {
+		if (isCanFilterMatch(&filters[i], frame)) {
+			bus->onRxInterrupt(frame);
+			return;
+		}
+	}
+	filteredCounter++;
+}
+
+int LoopbackCanDriver::completeTransmission() {
+	int count = mailboxCount;
+	for (int i = 0; i < count; i++) {
+		if (peer != NULL) {
+			peer->receive(&mailboxes[i]);
+		}
+	}
+	mailboxCount = 0;
+	sentCounter += count;
+	bus->pumpTx();
+	return count;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file can_loopback.h
+ * @brief Virtual CAN transport for unit tests, two nodes connected by a wire
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef CAN_LOOPBACK_H_
+#define CAN_LOOPBACK_H_
+
+#include "can_bus.h"
+
+/**
+ * same as bxCAN
+ */
+#define CAN_LOOPBACK_MAILBOXES 3
+
+class LoopbackCanDriver : public CanDriverInterface {
+public:
+	explicit LoopbackCanDriver(CanBus *bus);
+	void connect(LoopbackCanDriver *peer);
+	bool transmit(const can_frame_s *frame);
+	void setFilters(const can_rx_filter_s *filters, int count);
+	/**
+	 * Puts frames from mailboxes on the wire and then fires transmit-complete interrupt
+	 * @return number of frames sent
+	 */
+	int completeTransmission();
+	int getPendingMailboxes() const;
+
+	/**
+	 * frames which did not pass acceptance filters
+	 */
+	int filteredCounter;
+	int sentCounter;
+private:
+	void receive(const can_frame_s *frame);
+	CanBus *bus;
+	LoopbackCanDriver *peer;
+	can_rx_filter_s filters[CAN_MAX_RX_HANDLERS];
+	int filterCount;
+	can_frame_s mailboxes[CAN_LOOPBACK_MAILBOXES];
+	int mailboxCount;
+};
+
+#endif /* CAN_LOOPBACK_H_ */
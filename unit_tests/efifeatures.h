@@ -47,6 +47,19 @@
 
 #define EFI_SIGNAL_EXECUTOR_ONE_TIMER FALSE
 #define EFI_SIGNAL_EXECUTOR_SLEEP FALSE
+#define EFI_EVENT_QUEUE_HEAP FALSE
+#define EFI_SCHEDULER_HISTOGRAMS TRUE
+#define EFI_OUTPUT_SCHEDULE_BUFFER FALSE
+#define EFI_TRIGGER_EVENT_QUEUE FALSE
+#define EFI_TOOTH_LOGGER TRUE
+#define EFI_ENGINE_SNIFFER_BINARY FALSE
+#define EFI_TS_OUTPUT_STREAM FALSE
+#define EFI_BINARY_FILE_LOGGING FALSE
+#define EFI_LOG_PRODUCER_RINGS FALSE
+#define EFI_HARDWARE_PWM TRUE
+#define EFI_SLOW_ADC_CIRCULAR FALSE
+#define EFI_MAP_PER_CYLINDER_FUEL FALSE
+#define EFI_CONFIG_LOG_FLASH FALSE
 
 #define EFI_SHAFT_POSITION_INPUT TRUE
 #define EFI_ENGINE_CONTROL TRUE
@@ -0,0 +1,81 @@
+/**
+ * @file flash_simulator.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "flash_simulator.h"
+
+FlashSimulator::FlashSimulator(uint32_t baseAddress, uint32_t sectorSize, uint32_t size) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, size <= FLASH_SIMULATOR_CAPACITY && size % sectorSize == 0, "flash simulator size");
+	this->baseAddress = baseAddress;
+	this->sectorSize = sectorSize;
+	this->size = size;
+	eraseCounter = 0;
+	bytesWritten = 0;
+	writeViolationCounter = 0;
+	powerBudget = -1;
+	memset(memory, 0xFF, sizeof(memory));
+}
+
+bool FlashSimulator::isInRange(uint32_t address, uint32_t size) const {
+	return address >= baseAddress && address + size <= baseAddress + this->size;
+}
+
+uint8_t *FlashSimulator::getMemory(uint32_t address) {
+	return &memory[address - baseAddress];
+}
+
+void FlashSimulator::losePowerAfter(int bytes) {
+	powerBudget = bytes;
+}
+
+void FlashSimulator::powerUp() {
+	powerBudget = -1;
+}
+
+int FlashSimulator::erase(uint32_t address, uint32_t size) {
+	if (!isInRange(address, size) || powerBudget == 0) {
+		return -1;
+	}
+	uint32_t first = (address - baseAddress) / sectorSize;
+	uint32_t last = (address - baseAddress + size - 1) / sectorSize;
+	for (uint32_t sector = first; sector <= last; sector++) {
+		memset(&memory[sector * sectorSize], 0xFF, sectorSize);
+		eraseCounter++;
+	}
+	return 0;
+}
+
+int FlashSimulator::write(uint32_t address, const void *buffer, uint32_t size) {
+	if (!isInRange(address, size)) {
+		return -1;
+	}
+	const uint8_t *bytes = (const uint8_t *) buffer;
+	uint8_t *target = getMemory(address);
+	for (uint32_t i = 0; i < size; i++) {
+		if (powerBudget == 0) {
+			return -1;
+		}
+		if (powerBudget > 0) {
+			powerBudget--;
+		}
+		if ((target[i] & bytes[i]) != bytes[i]) {
+			writeViolationCounter++;
+		}
+		// programming could only clear bits
+		target[i] &= bytes[i];
+		bytesWritten++;
+	}
+	return 0;
+}
+
+int FlashSimulator::read(uint32_t address, void *buffer, uint32_t size) {
+	if (!isInRange(address, size)) {
+		return -1;
+	}
+	memcpy(buffer, getMemory(address), size);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file flash_simulator.h
+ * @brief In-memory NOR flash for unit tests
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#ifndef FLASH_SIMULATOR_H_
+#define FLASH_SIMULATOR_H_
+
+#include "flash_log.h"
+
+#define FLASH_SIMULATOR_CAPACITY 65536
+
+class FlashSimulator : public FlashInterface {
+public:
+	FlashSimulator(uint32_t baseAddress, uint32_t sectorSize, uint32_t size);
+	int erase(uint32_t address, uint32_t size);
+	int write(uint32_t address, const void *buffer, uint32_t size);
+	int read(uint32_t address, void *buffer, uint32_t size);
+	/**
+	 * Power goes away once given number of bytes has been programmed, everything after that fails
+	 * until powerUp()
+	 */
+	void losePowerAfter(int bytes);
+	void powerUp();
+	uint8_t *getMemory(uint32_t address);
+
+	int eraseCounter;
+	int bytesWritten;
+	/**
+	 * attempts to turn a zero bit back into one without an erase
+	 */
+	int writeViolationCounter;
+private:
+	bool isInRange(uint32_t address, uint32_t size) const;
+	uint32_t baseAddress;
+	uint32_t sectorSize;
+	uint32_t size;
+	/**
+	 * -1 if power is not going to be lost
+	 */
+	int powerBudget;
+	uint8_t memory[FLASH_SIMULATOR_CAPACITY];
+};
+
+#endif /* FLASH_SIMULATOR_H_ */
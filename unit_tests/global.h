@@ -45,6 +45,9 @@ void chDbgAssert(int c, char *msg, void *arg);
 
 void print(const char *fmt, ...);
 
+bool lockAnyContext(void);
+void unlockAnyContext(void);
+
 #define TICKS_IN_MS 100
 
 #define chDbgCheck(x, y) chDbgAssert(x, y, NULL)
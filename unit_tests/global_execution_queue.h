@@ -9,7 +9,7 @@
 #define GLOBAL_EXECUTION_QUEUE_H_
 
 #include "scheduler.h"
-#include "event_queue.h"
+#include "event_heap.h"
 
 class TestExecutor : public ExecutorInterface {
 public:
@@ -20,7 +20,7 @@ public:
 	int size();
 	scheduling_s* getForUnitTest(int index);
 private:
-	EventQueue schedulingQueue;
+	ExecutionQueue schedulingQueue;
 };
 
 #endif /* GLOBAL_EXECUTION_QUEUE_H_ */
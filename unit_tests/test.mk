@@ -2,6 +2,8 @@ FRAMEWORK_SRC_CPP = unit_test_framework.cpp \
 	engine_test_helper.cpp \
 	boards.cpp \
 	global_execution_queue.cpp \
+	flash_simulator.cpp \
+	can_loopback.cpp \
 	test_basic_math/test_find_index.cpp \
 	test_basic_math/test_interpolation_3d.cpp \
 	test_basic_math/test_efilib.cpp \
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "interpolation.h"
+#include "axis_index_cache.h"
 #include "global.h"
 #include "unit_test_framework.h"
 
@@ -113,3 +114,126 @@ TEST(misc, testInterpolate3d) {
 	newTestToComfirmInterpolation();
 
 }
+
+static float getCellValue(float rpm, float maf) {
+	axis_index_s rpmIndex = findAxisIndex<5, float>(rpmBins, rpm);
+	axis_index_s mafIndex = findAxisIndex<4, float>(mafBins, maf);
+	return interpolate3dCell<float>(map, rpmIndex, mafIndex);
+}
+
+TEST(misc, testAxisIndex) {
+	axis_index_s index = findAxisIndex<5, float>(rpmBins, 250);
+	ASSERT_EQ(1, index.index);
+	ASSERT_FLOAT_EQ(0.5, index.fraction);
+
+	index = findAxisIndex<5, float>(rpmBins, 500);
+	ASSERT_EQ(3, index.index);
+	ASSERT_FLOAT_EQ(1, index.fraction);
+
+	// outside of the axis we are clamped to the edge cell
+	index = findAxisIndex<5, float>(rpmBins, -100);
+	ASSERT_EQ(0, index.index);
+	ASSERT_FLOAT_EQ(0, index.fraction);
+	index = findAxisIndex<5, float>(rpmBins, 100000);
+	ASSERT_EQ(3, index.index);
+	ASSERT_FLOAT_EQ(1, index.fraction);
+
+	// same results as interpolate3d, including outside of the table
+	srand(12345);
+	for (int i = 0; i < 1000; i++) {
+		float rpm = rand() % 800 - 100;
+		float maf = (rand() % 600 - 100) / 100.0;
+		ASSERT_NEAR(getValue(rpm, maf), getCellValue(rpm, maf), EPS4D) << rpm << "/" << maf;
+	}
+}
+
+TEST(misc, testAxisIndexCache) {
+	AxisIndexCache cache;
+	int rpmSlot = cache.registerAxis(rpmBins);
+	int mafSlot = cache.registerAxis(mafBins);
+	ASSERT_NE(rpmSlot, mafSlot);
+	// second table on the same axis shares the entry
+	ASSERT_EQ(rpmSlot, cache.registerAxis(rpmBins));
+
+	// outside of a cycle cache is not used
+	cache.get<5, float>(rpmSlot, rpmBins, 250);
+	cache.get<5, float>(rpmSlot, rpmBins, 250);
+	ASSERT_EQ(0U, cache.hitCounter);
+	ASSERT_EQ(0U, cache.missCounter);
+
+	cache.beginCycle();
+	axis_index_s index = cache.get<5, float>(rpmSlot, rpmBins, 250);
+	ASSERT_EQ(1U, cache.missCounter);
+	axis_index_s second = cache.get<5, float>(rpmSlot, rpmBins, 250);
+	ASSERT_EQ(1U, cache.hitCounter);
+	ASSERT_EQ(index.index, second.index);
+	ASSERT_FLOAT_EQ(index.fraction, second.fraction);
+
+	// other axis does not evict the first one
+	cache.get<4, float>(mafSlot, mafBins, 2.5);
+	ASSERT_EQ(2U, cache.missCounter);
+	cache.get<5, float>(rpmSlot, rpmBins, 250);
+	cache.get<4, float>(mafSlot, mafBins, 2.5);
+	ASSERT_EQ(3U, cache.hitCounter);
+
+	// other value is a miss
+	index = cache.get<5, float>(rpmSlot, rpmBins, 350);
+	ASSERT_EQ(3U, cache.missCounter);
+	ASSERT_EQ(2, index.index);
+	ASSERT_FLOAT_EQ(0.5, index.fraction);
+	cache.get<5, float>(rpmSlot, rpmBins, 350);
+	ASSERT_EQ(4U, cache.hitCounter);
+	cache.endCycle();
+
+	// new cycle forgets previous results since bins could have been changed in between
+	cache.beginCycle();
+	cache.get<5, float>(rpmSlot, rpmBins, 350);
+	ASSERT_EQ(4U, cache.missCounter);
+	cache.endCycle();
+}
+
+TEST(misc, testAxisIndexCacheFull) {
+	AxisIndexCache cache;
+	float bins[AXIS_INDEX_CACHE_SIZE + 1][5];
+	for (int i = 0; i < AXIS_INDEX_CACHE_SIZE; i++) {
+		ASSERT_EQ(i, cache.registerAxis(bins[i]));
+	}
+	ASSERT_EQ(AXIS_INDEX_NO_SLOT, cache.registerAxis(bins[AXIS_INDEX_CACHE_SIZE]));
+
+	// axis without an entry is searched every time
+	cache.beginCycle();
+	axis_index_s index = cache.get<5, float>(AXIS_INDEX_NO_SLOT, rpmBins, 350);
+	cache.get<5, float>(AXIS_INDEX_NO_SLOT, rpmBins, 350);
+	ASSERT_EQ(2, index.index);
+	ASSERT_EQ(0U, cache.hitCounter);
+	cache.endCycle();
+}
+
+#define RANDOM_TABLE_SIZE 16
+
+/**
+ * split lookup should give the same result as interpolate3d, including keys outside of the bins
+ */
+TEST(misc, testInterpolate3dCellSameAsInterpolate3d) {
+	float bins[RANDOM_TABLE_SIZE];
+	float table[RANDOM_TABLE_SIZE][RANDOM_TABLE_SIZE];
+	float *pointers[RANDOM_TABLE_SIZE];
+	srand(12345);
+	for (int i = 0; i < RANDOM_TABLE_SIZE; i++) {
+		bins[i] = 100 * i;
+		pointers[i] = table[i];
+		for (int j = 0; j < RANDOM_TABLE_SIZE; j++) {
+			table[i][j] = rand() % 1000;
+		}
+	}
+
+	for (int i = 0; i < 1000; i++) {
+		float xKey = rand() % (100 * RANDOM_TABLE_SIZE + 200) - 100;
+		float yKey = rand() % (100 * RANDOM_TABLE_SIZE + 200) - 100;
+		float expected = interpolate3d<float, float>(xKey, bins, RANDOM_TABLE_SIZE, yKey, bins, RANDOM_TABLE_SIZE, pointers);
+		axis_index_s x = findAxisIndex<RANDOM_TABLE_SIZE, float>(bins, xKey);
+		axis_index_s y = findAxisIndex<RANDOM_TABLE_SIZE, float>(bins, yKey);
+		// table values are up to 1000, so this is float rounding
+		ASSERT_NEAR(expected, interpolate3dCell<float>(pointers, x, y), EPS2D) << xKey << "/" << yKey;
+	}
+}
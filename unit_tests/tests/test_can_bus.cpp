@@ -0,0 +1,157 @@
+/**
+ * @file test_can_bus.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "unit_test_framework.h"
+#include "can_loopback.h"
+
+static int receivedCounter;
+static uint32_t lastReceivedId;
+
+static void onTestFrame(const can_frame_s *frame, void *arg) {
+	receivedCounter++;
+	lastReceivedId = frame->id;
+	(*(int *) arg)++;
+}
+
+static void sendFrame(CanBus *bus, uint32_t id) {
+	can_frame_s frame;
+	initCanFrame(&frame, id);
+	frame.data8[0] = id & 0xFF;
+	bus->transmit(&frame);
+}
+
+TEST(can, rxFilters) {
+	CanBus ecu;
+	CanBus tester;
+	LoopbackCanDriver ecuDriver(&ecu);
+	LoopbackCanDriver testerDriver(&tester);
+	ecuDriver.connect(&testerDriver);
+
+	receivedCounter = 0;
+	int obdCounter = 0;
+	int dashCounter = 0;
+	ASSERT_TRUE(ecu.addRxHandler(0x7DF, CAN_STD_ID_MASK, false, onTestFrame, &obdCounter));
+	// whole 0x610-0x617 range
+	ASSERT_TRUE(ecu.addRxHandler(0x610, 0x7F8, false, onTestFrame, &dashCounter));
+	ecu.applyFilters();
+
+	sendFrame(&tester, 0x7DF);
+	sendFrame(&tester, 0x123);
+	sendFrame(&tester, 0x613);
+	// extended ID with the same lower bits is not a match
+	sendFrame(&tester, 0x180007DF);
+	tester.pumpTx();
+	ASSERT_EQ(3, testerDriver.getPendingMailboxes());
+	ASSERT_EQ(3, testerDriver.completeTransmission());
+	ASSERT_EQ(1, testerDriver.completeTransmission());
+
+	ASSERT_EQ(2, ecuDriver.filteredCounter);
+	ASSERT_EQ(0, receivedCounter) << "handlers run in thread, not in interrupt";
+	ASSERT_EQ(2, ecu.processRx());
+	ASSERT_EQ(1, obdCounter);
+	ASSERT_EQ(1, dashCounter);
+	ASSERT_EQ(0x613U, lastReceivedId);
+	ASSERT_EQ(0, ecu.processRx());
+}
+
+TEST(can, rxOverrun) {
+	CanBus bus;
+	int counter = 0;
+	bus.addRxHandler(0x100, CAN_STD_ID_MASK, false, onTestFrame, &counter);
+	can_frame_s frame;
+	initCanFrame(&frame, 0x100);
+	for (int i = 0; i < CAN_RX_RING_SIZE + 5; i++) {
+		bus.onRxInterrupt(&frame);
+	}
+	ASSERT_EQ(5U, bus.rxOverrunCounter);
+	ASSERT_EQ(CAN_RX_RING_SIZE, bus.processRx());
+	ASSERT_EQ(CAN_RX_RING_SIZE, counter);
+
+	bus.onRxInterrupt(&frame);
+	bus.flushRx();
+	ASSERT_EQ(0, bus.processRx());
+}
+
+TEST(can, txQueue) {
+	CanBus ecu;
+	CanBus tester;
+	LoopbackCanDriver ecuDriver(&ecu);
+	LoopbackCanDriver testerDriver(&tester);
+	ecuDriver.connect(&testerDriver);
+	int counter = 0;
+	tester.addRxHandler(0, 0, false, onTestFrame, &counter);
+	tester.applyFilters();
+
+	for (int i = 0; i < CAN_TX_QUEUE_SIZE + 2; i++) {
+		sendFrame(&ecu, 0x200 + i);
+	}
+	ASSERT_EQ(2U, ecu.txOverrunCounter);
+	ecu.pumpTx();
+	ASSERT_EQ((uint32_t) CAN_LOOPBACK_MAILBOXES, ecu.txCounter);
+
+	// transmit-complete interrupt refills mailboxes until queue is empty
+	while (ecuDriver.completeTransmission() > 0) {
+	}
+	ASSERT_EQ((uint32_t) CAN_TX_QUEUE_SIZE, ecu.txCounter);
+	ASSERT_EQ(CAN_TX_QUEUE_SIZE, tester.processRx());
+	ASSERT_EQ(CAN_TX_QUEUE_SIZE, counter);
+	ASSERT_EQ((uint32_t) (0x200 + CAN_TX_QUEUE_SIZE - 1), lastReceivedId);
+}
+
+static bool isSecondEnabled;
+
+static bool fillTestFrame(can_frame_s *frame, void *arg) {
+	frame->data8[0] = 0x55;
+	return arg == NULL || isSecondEnabled;
+}
+
+TEST(can, periodic) {
+	CanBus ecu;
+	CanBus tester;
+	LoopbackCanDriver ecuDriver(&ecu);
+	LoopbackCanDriver testerDriver(&tester);
+	ecuDriver.connect(&testerDriver);
+	int fastCounter = 0;
+	int slowCounter = 0;
+	tester.addRxHandler(0x300, CAN_STD_ID_MASK, false, onTestFrame, &fastCounter);
+	tester.addRxHandler(0x301, CAN_STD_ID_MASK, false, onTestFrame, &slowCounter);
+	tester.applyFilters();
+
+	ecu.setDefaultPeriod(25);
+	ecu.addPeriodic(0x300, 10, fillTestFrame, NULL);
+	ecu.addPeriodic(0x301, 0, fillTestFrame, &isSecondEnabled);
+	ASSERT_EQ(0, ecu.getNextPeriodicDelayMs(1000));
+
+	isSecondEnabled = true;
+	for (efitimems_t nowMs = 1000; nowMs < 1100; nowMs++) {
+		ecu.processPeriodic(nowMs);
+		ecu.pumpTx();
+		ecuDriver.completeTransmission();
+	}
+	tester.processRx();
+	ASSERT_EQ(10, fastCounter);
+	ASSERT_EQ(4, slowCounter);
+	ASSERT_EQ(0, ecu.getNextPeriodicDelayMs(1100));
+
+	// disabled message keeps its schedule but is not sent
+	isSecondEnabled = false;
+	for (efitimems_t nowMs = 1100; nowMs < 1200; nowMs++) {
+		ecu.processPeriodic(nowMs);
+		ecu.pumpTx();
+		ecuDriver.completeTransmission();
+	}
+	tester.processRx();
+	ASSERT_EQ(20, fastCounter);
+	ASSERT_EQ(4, slowCounter);
+
+	// long stall does not cause a burst
+	ecu.processPeriodic(1500);
+	ecu.pumpTx();
+	ecuDriver.completeTransmission();
+	ASSERT_EQ(1, tester.processRx());
+	ASSERT_EQ(10, ecu.getNextPeriodicDelayMs(1500));
+}
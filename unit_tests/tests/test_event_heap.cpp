@@ -0,0 +1,205 @@
+/**
+ * @file	test_event_heap.cpp
+ *
+ * EventHeap is expected to behave exactly like EventQueue sorted list, see also test_signal_executor.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+
+#include "event_heap.h"
+#include "unit_test_framework.h"
+
+extern bool eventQueueDebugMode;
+
+static int callbackCounter = 0;
+
+static void callback(void *a) {
+	UNUSED(a);
+	callbackCounter++;
+}
+
+TEST(EventHeap, basic) {
+	EventHeap eq;
+	ASSERT_EQ(EMPTY_QUEUE, eq.getNextEventTime(0));
+	scheduling_s s1;
+	scheduling_s s2;
+	scheduling_s s3;
+	scheduling_s s4;
+
+	ASSERT_TRUE(eq.insertTask(&s1, 10, callback, NULL));
+	ASSERT_FALSE(eq.insertTask(&s4, 10, callback, NULL));
+	ASSERT_FALSE(eq.insertTask(&s3, 12, callback, NULL));
+	ASSERT_FALSE(eq.insertTask(&s2, 11, callback, NULL));
+
+	ASSERT_EQ(4, eq.size());
+	ASSERT_EQ(10, eq.getForUnitText(0)->momentX);
+	ASSERT_EQ(10, eq.getForUnitText(1)->momentX);
+	ASSERT_EQ(11, eq.getForUnitText(2)->momentX);
+	ASSERT_EQ(12, eq.getForUnitText(3)->momentX);
+
+	callbackCounter = 0;
+	eq.executeAll(10);
+	ASSERT_EQ( 2,  callbackCounter) << "callbackCounter/2";
+	callbackCounter = 0;
+	eq.executeAll(11);
+	ASSERT_EQ( 1,  callbackCounter) << "callbackCounter/1#1";
+	eq.executeAll(100);
+	ASSERT_EQ(0, eq.size());
+
+	ASSERT_TRUE(eq.insertTask(&s1, 12, callback, NULL));
+	ASSERT_TRUE(eq.insertTask(&s2, 11, callback, NULL));
+	ASSERT_TRUE(eq.insertTask(&s3, 10, callback, NULL));
+	callbackCounter = 0;
+	eq.executeAll(10);
+	ASSERT_EQ( 1,  callbackCounter) << "callbackCounter/1#2";
+	callbackCounter = 0;
+	eq.executeAll(11);
+	ASSERT_EQ(1, callbackCounter);
+	eq.executeAll(100);
+	ASSERT_EQ(0, eq.size());
+
+	callbackCounter = 0;
+	eq.insertTask(&s1, 10, callback, NULL);
+	ASSERT_EQ(10, eq.getNextEventTime(0));
+	// late event
+	ASSERT_EQ(20 + 100, eq.getNextEventTime(20));
+
+	eq.executeAll(1);
+	ASSERT_EQ( 0,  callbackCounter) << "callbacks not expected";
+
+	eq.executeAll(11);
+	ASSERT_EQ(1, callbackCounter);
+
+	ASSERT_EQ(EMPTY_QUEUE, eq.getNextEventTime(0));
+}
+
+TEST(EventHeap, alreadyScheduled) {
+	EventHeap eq;
+	scheduling_s s1;
+
+	ASSERT_TRUE(eq.insertTask(&s1, 10, callback, NULL));
+	// same as EventQueue, second insert of pending element is ignored
+	ASSERT_FALSE(eq.insertTask(&s1, 5, callback, NULL));
+	ASSERT_EQ(1, eq.size());
+	ASSERT_EQ(10, eq.getNextEventTime(0));
+
+	eq.executeAll(10);
+	ASSERT_EQ(0, eq.size());
+	ASSERT_FALSE(s1.isScheduled);
+}
+
+typedef struct {
+	scheduling_s s;
+	int id;
+	int period;
+	void *queue;
+	efitime_t *now;
+} ReinsertingEvent;
+
+/**
+ * Both implementations are driven by the same deterministic workload of self re-inserting events
+ * and should execute the same events in the same order, including events with equal timestamps
+ */
+template<typename Queue>
+class QueueRecorder {
+public:
+	static void reinsert(ReinsertingEvent *event) {
+		executed.push_back(event->id);
+		Queue *queue = (Queue *) event->queue;
+		queue->insertTask(&event->s, *event->now + event->period, (schfunc_t) reinsert, event);
+	}
+
+	static std::vector<int> run(int eventCount, int steps) {
+		executed.clear();
+		Queue queue;
+		efitime_t now = 0;
+		ReinsertingEvent events[EVENT_HEAP_CAPACITY];
+		srand(12345);
+		for (int i = 0; i < eventCount; i++) {
+			events[i].id = i;
+			// small periods and start times so that a lot of events share the same timestamp
+			events[i].period = 3 + rand() % 10;
+			events[i].queue = &queue;
+			events[i].now = &now;
+			queue.insertTask(&events[i].s, rand() % 20, (schfunc_t) reinsert, &events[i]);
+		}
+		for (int i = 0; i < steps; i++) {
+			now += 1 + rand() % 7;
+			queue.executeAll(now);
+			EXPECT_EQ(eventCount, queue.size());
+		}
+		return executed;
+	}
+
+	static std::vector<int> executed;
+};
+
+template<typename Queue>
+std::vector<int> QueueRecorder<Queue>::executed;
+
+TEST(EventHeap, sameOrderAsList) {
+	eventQueueDebugMode = false;
+	std::vector<int> list = QueueRecorder<EventQueue>::run(40, 300);
+	std::vector<int> heap = QueueRecorder<EventHeap>::run(40, 300);
+	eventQueueDebugMode = true;
+
+	ASSERT_TRUE(list.size() > 300);
+	ASSERT_EQ(list.size(), heap.size());
+	for (size_t i = 0; i < list.size(); i++) {
+		ASSERT_EQ(list[i], heap[i]) << "index " << i;
+	}
+}
+
+TEST(EventHeap, equalTimestampsSameOrderAsList) {
+	EventHeap heap;
+	EventQueue list;
+	scheduling_s heapEvents[6];
+	scheduling_s listEvents[6];
+	int order[] = { 2, 0, 5, 1, 4, 3 };
+
+	for (int i = 0; i < 6; i++) {
+		int index = order[i];
+		// two groups of equal timestamps
+		heap.insertTask(&heapEvents[index], 10 + 5 * (index % 2), callback, (void *) (intptr_t) index);
+		list.insertTask(&listEvents[index], 10 + 5 * (index % 2), callback, (void *) (intptr_t) index);
+	}
+
+	// list: head stays in place, otherwise newer event goes ahead of older ones with the same timestamp
+	int expected[] = { 2, 4, 0, 3, 1, 5 };
+	for (int i = 0; i < 6; i++) {
+		ASSERT_EQ((void *) (intptr_t) expected[i], list.getForUnitText(i)->param) << "list index " << i;
+		ASSERT_EQ((void *) (intptr_t) expected[i], heap.getForUnitText(i)->param) << "heap index " << i;
+	}
+}
+
+TEST(EventHeap, fullQueueSameOrderAsList) {
+	eventQueueDebugMode = false;
+	std::vector<int> list = QueueRecorder<EventQueue>::run(EVENT_HEAP_CAPACITY, 300);
+	std::vector<int> heap = QueueRecorder<EventHeap>::run(EVENT_HEAP_CAPACITY, 300);
+	eventQueueDebugMode = true;
+
+	ASSERT_EQ(list.size(), heap.size());
+	for (size_t i = 0; i < list.size(); i++) {
+		ASSERT_EQ(list[i], heap[i]) << "index " << i;
+	}
+}
+
+TEST(EventHeap, coalescing) {
+	EventHeap eq;
+	eq.setCoalescingWindow(3);
+	scheduling_s s1;
+	scheduling_s s2;
+	scheduling_s s3;
+
+	eq.insertTask(&s3, 14, callback, NULL);
+	eq.insertTask(&s2, 13, callback, NULL);
+	eq.insertTask(&s1, 10, callback, NULL);
+
+	callbackCounter = 0;
+	ASSERT_EQ(2, eq.executeAll(10));
+	ASSERT_EQ(2, callbackCounter);
+	ASSERT_EQ(14, eq.getNextEventTime(0));
+}
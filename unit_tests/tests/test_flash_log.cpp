@@ -0,0 +1,222 @@
+/**
+ * @file test_flash_log.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "unit_test_framework.h"
+#include "flash_simulator.h"
+
+#define TEST_FLASH_BASE 0x08000000
+#define TEST_SECTOR_SIZE 4096
+#define TEST_REGION_SIZE (2 * TEST_SECTOR_SIZE)
+#define TEST_IMAGE_SIZE 2000
+#define TEST_VERSION 10001
+#define PAGE_RECORD_SIZE (sizeof(flash_log_record_header_s) + FLASH_LOG_PAGE_SIZE)
+
+static void initLog(FlashLog *log, FlashSimulator *flash, int version = TEST_VERSION) {
+	log->init(flash, TEST_FLASH_BASE, TEST_FLASH_BASE + TEST_REGION_SIZE, TEST_REGION_SIZE, version, TEST_IMAGE_SIZE);
+}
+
+static void fillImage(uint8_t *image, int seed) {
+	for (int i = 0; i < TEST_IMAGE_SIZE; i++) {
+		image[i] = (uint8_t) (i * 7 + seed);
+	}
+}
+
+/**
+ * Fresh instance, same as a reboot
+ */
+static flash_log_result_e recoverAfterReboot(FlashSimulator *flash, uint8_t *image) {
+	FlashLog log;
+	initLog(&log, flash);
+	return log.recover(image);
+}
+
+TEST(flashLog, firstBurn) {
+	FlashSimulator flash(TEST_FLASH_BASE, TEST_SECTOR_SIZE, 2 * TEST_REGION_SIZE);
+	FlashLog log;
+	initLog(&log, &flash);
+	uint8_t image[TEST_IMAGE_SIZE];
+	ASSERT_EQ(FL_EMPTY, log.recover(image));
+	ASSERT_TRUE(log.isCompactionDue());
+
+	fillImage(image, 1);
+	ASSERT_EQ(FL_NO_SPACE, log.append(image));
+	ASSERT_EQ(FL_OK, log.compact(image));
+	ASSERT_EQ(2, flash.eraseCounter);
+	ASSERT_EQ(0, log.getActiveRegion());
+	ASSERT_FALSE(log.isCompactionDue());
+
+	uint8_t recovered[TEST_IMAGE_SIZE];
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(image, recovered, TEST_IMAGE_SIZE));
+
+	FlashLog otherVersion;
+	initLog(&otherVersion, &flash, TEST_VERSION + 1);
+	ASSERT_EQ(FL_INCOMPATIBLE_VERSION, otherVersion.recover(recovered));
+}
+
+TEST(flashLog, incrementalBurn) {
+	FlashSimulator flash(TEST_FLASH_BASE, TEST_SECTOR_SIZE, 2 * TEST_REGION_SIZE);
+	FlashLog log;
+	initLog(&log, &flash);
+	uint8_t image[TEST_IMAGE_SIZE];
+	fillImage(image, 1);
+	log.recover(image);
+	ASSERT_EQ(FL_OK, log.compact(image));
+	int bytesBefore = flash.bytesWritten;
+
+	// nothing changed - nothing written
+	ASSERT_EQ(FL_OK, log.append(image));
+	ASSERT_EQ(0, log.lastBurnPageCount);
+	ASSERT_EQ(bytesBefore, flash.bytesWritten);
+
+	image[3 * FLASH_LOG_PAGE_SIZE + 10]++;
+	ASSERT_EQ(FL_OK, log.append(image));
+	ASSERT_EQ(1, log.lastBurnPageCount);
+	ASSERT_EQ(bytesBefore + (int) (PAGE_RECORD_SIZE + sizeof(flash_log_record_header_s)), flash.bytesWritten);
+	ASSERT_EQ(2, flash.eraseCounter);
+
+	// last page is shorter than the others
+	image[TEST_IMAGE_SIZE - 1]++;
+	image[0]++;
+	ASSERT_EQ(FL_OK, log.append(image));
+	ASSERT_EQ(2, log.lastBurnPageCount);
+	ASSERT_EQ(0, flash.writeViolationCounter);
+
+	uint8_t recovered[TEST_IMAGE_SIZE];
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(image, recovered, TEST_IMAGE_SIZE));
+}
+
+TEST(flashLog, powerLossDuringBurn) {
+	FlashSimulator flash(TEST_FLASH_BASE, TEST_SECTOR_SIZE, 2 * TEST_REGION_SIZE);
+	FlashLog log;
+	initLog(&log, &flash);
+	uint8_t image[TEST_IMAGE_SIZE];
+	fillImage(image, 1);
+	log.recover(image);
+	ASSERT_EQ(FL_OK, log.compact(image));
+	uint8_t committed[TEST_IMAGE_SIZE];
+	memcpy(committed, image, TEST_IMAGE_SIZE);
+
+	// torn second page
+	image[FLASH_LOG_PAGE_SIZE]++;
+	image[5 * FLASH_LOG_PAGE_SIZE]++;
+	flash.losePowerAfter(PAGE_RECORD_SIZE + 100);
+	ASSERT_EQ(FL_WRITE_FAILED, log.append(image));
+	flash.powerUp();
+
+	uint8_t recovered[TEST_IMAGE_SIZE];
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(committed, recovered, TEST_IMAGE_SIZE));
+
+	// garbage at the end of the log, new burn has to go into the other region
+	FlashLog rebooted;
+	initLog(&rebooted, &flash);
+	ASSERT_EQ(FL_OK, rebooted.recover(recovered));
+	ASSERT_TRUE(rebooted.isCompactionDue());
+	ASSERT_EQ(FL_NO_SPACE, rebooted.append(image));
+	ASSERT_EQ(FL_OK, rebooted.compact(image));
+	ASSERT_EQ(1, rebooted.getActiveRegion());
+
+	// all pages are in place but commit record is missing
+	memcpy(committed, image, TEST_IMAGE_SIZE);
+	image[2 * FLASH_LOG_PAGE_SIZE]++;
+	image[6 * FLASH_LOG_PAGE_SIZE]++;
+	flash.losePowerAfter(2 * PAGE_RECORD_SIZE);
+	ASSERT_EQ(FL_WRITE_FAILED, rebooted.append(image));
+	flash.powerUp();
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(committed, recovered, TEST_IMAGE_SIZE));
+	ASSERT_EQ(0, flash.writeViolationCounter);
+}
+
+TEST(flashLog, compaction) {
+	FlashSimulator flash(TEST_FLASH_BASE, TEST_SECTOR_SIZE, 2 * TEST_REGION_SIZE);
+	FlashLog log;
+	initLog(&log, &flash);
+	uint8_t image[TEST_IMAGE_SIZE];
+	fillImage(image, 1);
+	log.recover(image);
+	ASSERT_EQ(FL_OK, log.compact(image));
+
+	int burnCount = 0;
+	while (!log.isCompactionDue()) {
+		image[(burnCount % 7) * FLASH_LOG_PAGE_SIZE]++;
+		ASSERT_EQ(FL_OK, log.append(image));
+		burnCount++;
+	}
+	ASSERT_EQ(15, burnCount);
+	ASSERT_EQ(2, flash.eraseCounter);
+	uint8_t committed[TEST_IMAGE_SIZE];
+	memcpy(committed, image, TEST_IMAGE_SIZE);
+	// a burn of every page would not fit anymore
+	fillImage(image, 2);
+	ASSERT_EQ(FL_NO_SPACE, log.append(image));
+
+	uint8_t recovered[TEST_IMAGE_SIZE];
+	// power loss in the middle of compaction, previous region is still there
+	flash.losePowerAfter(1000);
+	ASSERT_EQ(FL_WRITE_FAILED, log.compact(image));
+	flash.powerUp();
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(committed, recovered, TEST_IMAGE_SIZE));
+
+	ASSERT_EQ(FL_OK, log.compact(image));
+	ASSERT_EQ(1, log.getActiveRegion());
+	ASSERT_EQ(2, log.compactionCounter);
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(image, recovered, TEST_IMAGE_SIZE));
+
+	// and back into the first region, which now has a higher sequence number
+	image[100]++;
+	ASSERT_EQ(FL_OK, log.compact(image));
+	ASSERT_EQ(0, log.getActiveRegion());
+	FlashLog rebooted;
+	initLog(&rebooted, &flash);
+	ASSERT_EQ(FL_OK, rebooted.recover(recovered));
+	ASSERT_EQ(0, rebooted.getActiveRegion());
+	ASSERT_EQ(0, memcmp(image, recovered, TEST_IMAGE_SIZE));
+	ASSERT_EQ(0, flash.writeViolationCounter);
+}
+
+/**
+ * Same sequence flash_main goes through: burns with engine running never erase
+ */
+TEST(flashLog, burnWaitsForCompaction) {
+	FlashSimulator flash(TEST_FLASH_BASE, TEST_SECTOR_SIZE, 2 * TEST_REGION_SIZE);
+	FlashLog log;
+	initLog(&log, &flash);
+	uint8_t image[TEST_IMAGE_SIZE];
+	fillImage(image, 1);
+	ASSERT_EQ(FL_EMPTY, log.recover(image));
+	// no log yet, engine running
+	ASSERT_EQ(FL_NO_SPACE, log.burn(image, false));
+	ASSERT_EQ(0, flash.eraseCounter);
+	// engine stopped
+	ASSERT_EQ(FL_OK, log.burn(image, true));
+	ASSERT_EQ(1, log.compactionCounter);
+
+	int seed = 2;
+	while (true) {
+		fillImage(image, seed++);
+		flash_log_result_e result = log.burn(image, false);
+		if (result == FL_NO_SPACE) {
+			break;
+		}
+		ASSERT_EQ(FL_OK, result);
+	}
+	ASSERT_EQ(1, log.compactionCounter);
+	int eraseCounter = flash.eraseCounter;
+
+	ASSERT_EQ(FL_OK, log.burn(image, true));
+	ASSERT_EQ(2, log.compactionCounter);
+	ASSERT_TRUE(flash.eraseCounter > eraseCounter);
+	uint8_t recovered[TEST_IMAGE_SIZE];
+	ASSERT_EQ(FL_OK, recoverAfterReboot(&flash, recovered));
+	ASSERT_EQ(0, memcmp(image, recovered, TEST_IMAGE_SIZE));
+	ASSERT_EQ(0, flash.writeViolationCounter);
+}
@@ -257,3 +257,29 @@ TEST(fuel, testTpsBasedVeDefect799) {
 	// value in the middle of the map as expected
 	ASSERT_EQ(107, engine->engineState.currentRawVE);
 }
+
+TEST(fuel, cylinderMapCorrection) {
+	WITH_ENGINE_TEST_HELPER(FORD_ASPIRE_1996);
+	engineConfiguration->fuelAlgorithm = LM_SPEED_DENSITY;
+	engineConfiguration->injectionMode = IM_SEQUENTIAL;
+	engineConfiguration->specs.cylindersCount = 4;
+	boardConfiguration->measureMapOnlyInOneCylinder = false;
+
+	// not all cylinders have a value yet
+	engine->engineState.mapPerCylinder[0] = 90;
+	ASSERT_NEAR(1, getCylinderMapFuelCorrection(0 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+
+	engine->engineState.mapPerCylinder[1] = 110;
+	engine->engineState.mapPerCylinder[2] = 100;
+	engine->engineState.mapPerCylinder[3] = 100;
+	ASSERT_NEAR(0.9, getCylinderMapFuelCorrection(0 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+	ASSERT_NEAR(1.1, getCylinderMapFuelCorrection(1 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+	ASSERT_NEAR(1, getCylinderMapFuelCorrection(2 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+
+	// bad window is clamped
+	engine->engineState.mapPerCylinder[3] = 10;
+	ASSERT_NEAR(0.7, getCylinderMapFuelCorrection(3 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+
+	engineConfiguration->injectionMode = IM_BATCH;
+	ASSERT_NEAR(1, getCylinderMapFuelCorrection(0 PASS_ENGINE_PARAMETER_SUFFIX), EPS4D);
+}
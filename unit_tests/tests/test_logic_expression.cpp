@@ -101,6 +101,12 @@ static void testExpression2(float selfValue, const char *line, float expected, E
 	EXPAND_Engine;
 
 	ASSERT_EQ(expected, c.getValue2(selfValue, element PASS_ENGINE_PARAMETER_SUFFIX)) << line;
+
+	fsio_instruction_s code[TEST_POOL_SIZE];
+	FsioCodePool codePool(code, TEST_POOL_SIZE);
+	FsioProgram program;
+	ASSERT_TRUE(program.compile(element, &codePool PASS_ENGINE_PARAMETER_SUFFIX)) << line;
+	ASSERT_EQ(expected, program.getValue(selfValue PASS_ENGINE_PARAMETER_SUFFIX)) << "compiled " << line;
 }
 
 static void testExpression2(float selfValue, const char *line, float expected) {
@@ -234,3 +240,127 @@ TEST(misc, testLogicExpressions) {
 	testExpression("fan NOT coolant 90 > AND fan coolant 85 > AND OR", 1);
 
 }
+
+TEST(misc, testFsioCompiler) {
+	WITH_ENGINE_TEST_HELPER(FORD_INLINE_6_1995);
+	LEElement thepool[TEST_POOL_SIZE];
+	LEElementPool pool(thepool, TEST_POOL_SIZE);
+	fsio_instruction_s code[TEST_POOL_SIZE];
+	FsioCodePool codePool(code, TEST_POOL_SIZE);
+	FsioProgram program;
+	mockRpm = 900;
+
+	// constants are folded
+	ASSERT_TRUE(program.compile(pool.parseExpression("2 3 + 4 * 1 -"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(1, program.getSize());
+	ASSERT_EQ(0U, program.requiredInputs);
+	ASSERT_EQ(19, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	ASSERT_TRUE(program.compile(pool.parseExpression("rpm 2 3 + *"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(3, program.getSize());
+	ASSERT_EQ(4500, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// not all operands are constants
+	ASSERT_TRUE(program.compile(pool.parseExpression("1 rpm 2 + +"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(5, program.getSize());
+	ASSERT_EQ(903, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// settings could change at runtime
+	engineConfiguration->bc.fsio_setting[0] = 7;
+	ASSERT_TRUE(program.compile(pool.parseExpression("1 fsio_setting"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(2, program.getSize());
+	ASSERT_EQ(7, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+	engineConfiguration->bc.fsio_setting[0] = 8;
+	ASSERT_EQ(8, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// compiler records which inputs are needed
+	ASSERT_TRUE(program.compile(pool.parseExpression("rpm rpm + rpm cranking_rpm > +"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ((fsio_input_mask_t) (FSIO_INPUT_BIT(LE_METHOD_RPM) | FSIO_INPUT_BIT(LE_METHOD_CRANKING_RPM)), program.requiredInputs);
+	ASSERT_EQ(1801, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// these are left for LECalculator to report
+	ASSERT_FALSE(program.compile(pool.parseExpression("1 and"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_FALSE(program.isCompiled());
+	ASSERT_TRUE(program.source != NULL);
+	ASSERT_FALSE(program.compile(pool.parseExpression("1 2"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_FALSE(program.compile(NULL, &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	// unknown action would be outside of the snapshot
+	LEElement unknown;
+	unknown.init((le_action_e) (LE_METHOD_FSIO_DIGITAL_INPUT + 1));
+	ASSERT_FALSE(program.compile(&unknown, &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// pool overflow
+	fsio_instruction_s smallCode[2];
+	FsioCodePool smallPool(smallCode, 2);
+	ASSERT_FALSE(program.compile(pool.parseExpression("rpm 1 +"), &smallPool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(0, smallPool.getSize());
+	ASSERT_TRUE(program.compile(pool.parseExpression("1 2 +"), &smallPool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(1, smallPool.getSize());
+}
+
+TEST(misc, testFsioInputSnapshot) {
+	WITH_ENGINE_TEST_HELPER(FORD_INLINE_6_1995);
+	LEElement thepool[TEST_POOL_SIZE];
+	LEElementPool pool(thepool, TEST_POOL_SIZE);
+	fsio_instruction_s code[TEST_POOL_SIZE];
+	FsioCodePool codePool(code, TEST_POOL_SIZE);
+	FsioProgram starter;
+	FsioProgram fan;
+	ASSERT_TRUE(starter.compile(pool.parseExpression(STARTER_BLOCK), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_TRUE(fan.compile(pool.parseExpression("rpm 0 > fan not and"), &codePool PASS_ENGINE_PARAMETER_SUFFIX));
+	mockRpm = 900;
+	mockCrankingRpm = 200;
+	mockFan = 0;
+
+	FsioInputSnapshot snapshot;
+	snapshot.update(starter.requiredInputs PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(2U, snapshot.readCounter);
+	ASSERT_EQ(0, starter.getValue(0, &snapshot PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// rpm is already there, only fan is read
+	snapshot.update(fan.requiredInputs PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(3U, snapshot.readCounter);
+
+	// all expressions in one pass see the same values
+	mockRpm = 0;
+	ASSERT_EQ(900, snapshot.get(LE_METHOD_RPM));
+	ASSERT_EQ(1, fan.getValue(0, &snapshot PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(0, fan.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX));
+
+	// next pass
+	snapshot.reset();
+	snapshot.update(fan.requiredInputs PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(5U, snapshot.readCounter);
+	ASSERT_EQ(0, fan.getValue(0, &snapshot PASS_ENGINE_PARAMETER_SUFFIX));
+}
+
+/**
+ * compiled program should give the same result as LECalculator for the same input values
+ */
+TEST(misc, testFsioCompiledSameAsCalculator) {
+	WITH_ENGINE_TEST_HELPER(FORD_INLINE_6_1995);
+	const char *expressions[] = { FAN_CONTROL_LOGIC, ALTERNATOR_LOGIC, TOO_HOT_LOGIC, STARTER_BLOCK,
+			"fan NOT coolant 90 > AND fan coolant 85 > AND OR", "rpm 2 3 + * coolant max 7 -" };
+	LECalculator c;
+
+	for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+		LEElement thepool[TEST_POOL_SIZE];
+		LEElementPool pool(thepool, TEST_POOL_SIZE);
+		LEElement *element = pool.parseExpression(expressions[e]);
+		ASSERT_TRUE(element != NULL) << expressions[e];
+		fsio_instruction_s code[TEST_POOL_SIZE];
+		FsioCodePool codePool(code, TEST_POOL_SIZE);
+		FsioProgram program;
+		ASSERT_TRUE(program.compile(element, &codePool PASS_ENGINE_PARAMETER_SUFFIX)) << expressions[e];
+
+		for (int i = 0; i < 64; i++) {
+			mockFan = i & 1;
+			mockRpm = (i & 2) ? 900 : 0;
+			mockCrankingRpm = (i & 4) ? 1000 : 200;
+			mockTimeSinceBoot = (i & 8) ? 10 : 1;
+			engine->sensors.clt = (i & 16) ? 130 : 87;
+			float expected = c.getValue2(0, element PASS_ENGINE_PARAMETER_SUFFIX);
+			ASSERT_EQ(expected, program.getValue(0 PASS_ENGINE_PARAMETER_SUFFIX)) << expressions[e] << " " << i;
+		}
+	}
+}
@@ -0,0 +1,343 @@
+/**
+ * @file test_obd2_server.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "unit_test_framework.h"
+#include "can_loopback.h"
+#include "obd2_server.h"
+
+static float testRpm;
+
+static float getTestRpm(void) {
+	return testRpm;
+}
+
+static float getTestClt(void) {
+	return 90;
+}
+
+static float getTestSpeed(void) {
+	return 300;
+}
+
+static float getTestFuelRate(void) {
+	return 1.5;
+}
+
+static const obd_pid_s testPids[] = {
+	{ 0x05, 1, 40, 1, getTestClt },
+	{ 0x0C, 2, 0, 4, getTestRpm },
+	{ 0x0D, 1, 0, 1, getTestSpeed },
+	{ 0x5E, 2, 0, 20, getTestFuelRate },
+};
+
+static int getTestDtcs(uint16_t *codes, int capacity) {
+	static const int warnings[] = { 301, 6001, 117, 2, 1234 };
+	int count = 0;
+	for (int i = 0; i < 5 && count < capacity; i++) {
+		uint16_t dtc = obdCodeToDtc(warnings[i]);
+		if (dtc != 0) {
+			codes[count++] = dtc;
+		}
+	}
+	return count;
+}
+
+#define MAX_TEST_FRAMES 16
+
+static can_frame_s responses[MAX_TEST_FRAMES];
+static int responseCount;
+
+static void onResponse(const can_frame_s *frame, void *arg) {
+	(void)arg;
+	if (responseCount < MAX_TEST_FRAMES) {
+		responses[responseCount] = *frame;
+	}
+	responseCount++;
+}
+
+class Obd2Bench {
+public:
+	Obd2Bench() : ecuDriver(&ecu), testerDriver(&tester) {
+		ecuDriver.connect(&testerDriver);
+		server.init(&ecu, testPids, sizeof(testPids) / sizeof(testPids[0]));
+		server.addRxHandlers(&ecu);
+		ecu.applyFilters();
+		tester.addRxHandler(OBD_ECU_RESPONSE, CAN_STD_ID_MASK, false, onResponse, NULL);
+		tester.applyFilters();
+		responseCount = 0;
+		nowMs = 1000;
+		server.update(nowMs);
+	}
+
+	void sendRequest(const uint8_t *data, int size) {
+		can_frame_s frame;
+		initCanFrame(&frame, OBD_FUNCTIONAL_REQUEST);
+		frame.data8[0] = size;
+		memcpy(frame.data8 + 1, data, size);
+		tester.transmit(&frame);
+		exchange();
+	}
+
+	void sendFlowControl(int flag, int blockSize, int stMin) {
+		can_frame_s frame;
+		initCanFrame(&frame, OBD_PHYSICAL_REQUEST);
+		frame.data8[0] = (ISOTP_FLOW_CONTROL << 4) | flag;
+		frame.data8[1] = blockSize;
+		frame.data8[2] = stMin;
+		tester.transmit(&frame);
+		exchange();
+	}
+
+	void advance(int ms) {
+		nowMs += ms;
+		server.update(nowMs);
+		exchange();
+	}
+
+	/**
+	 * Moves frames both ways until the wire is quiet
+	 */
+	void exchange() {
+		for (int i = 0; i < 10; i++) {
+			tester.pumpTx();
+			ecu.pumpTx();
+			int count = testerDriver.completeTransmission() + ecuDriver.completeTransmission();
+			count += ecu.processRx() + tester.processRx();
+			if (count == 0) {
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Reassembles single or segmented response out of received frames
+	 * @return payload size
+	 */
+	int getPayload(uint8_t *payload) {
+		int type = responses[0].data8[0] >> 4;
+		if (type == ISOTP_SINGLE_FRAME) {
+			int size = responses[0].data8[0] & 0xF;
+			memcpy(payload, responses[0].data8 + 1, size);
+			return size;
+		}
+		EXPECT_EQ(ISOTP_FIRST_FRAME, type);
+		int size = ((responses[0].data8[0] & 0xF) << 8) | responses[0].data8[1];
+		memcpy(payload, responses[0].data8 + 2, 6);
+		int offset = 6;
+		for (int i = 1; offset < size && i < responseCount; i++) {
+			EXPECT_EQ((ISOTP_CONSECUTIVE_FRAME << 4) | (i & 0xF), responses[i].data8[0]);
+			int length = minI(7, size - offset);
+			memcpy(payload + offset, responses[i].data8 + 1, length);
+			offset += length;
+		}
+		EXPECT_EQ(size, offset) << "incomplete response";
+		return size;
+	}
+
+	CanBus ecu;
+	CanBus tester;
+	LoopbackCanDriver ecuDriver;
+	LoopbackCanDriver testerDriver;
+	Obd2Server server;
+	efitimems_t nowMs;
+};
+
+TEST(obd2, singlePid) {
+	Obd2Bench bench;
+	testRpm = 2000;
+	const uint8_t request[] = { OBD_MODE_CURRENT_DATA, 0x0C };
+	bench.sendRequest(request, sizeof(request));
+
+	ASSERT_EQ(1, responseCount);
+	ASSERT_EQ((uint32_t) OBD_ECU_RESPONSE, responses[0].id);
+	const uint8_t expected[] = { 4, 0x41, 0x0C, 0x1F, 0x40 };
+	ASSERT_EQ(0, memcmp(expected, responses[0].data8, sizeof(expected)));
+	ASSERT_EQ(1, bench.server.requestCounter);
+
+	// speed is clamped into one byte
+	const uint8_t speedRequest[] = { OBD_MODE_CURRENT_DATA, 0x0D };
+	bench.sendRequest(speedRequest, sizeof(speedRequest));
+	ASSERT_EQ(2, responseCount);
+	ASSERT_EQ(255, responses[1].data8[3]);
+
+	// nobody answers a PID we do not have
+	const uint8_t unsupported[] = { OBD_MODE_CURRENT_DATA, 0x11 };
+	bench.sendRequest(unsupported, sizeof(unsupported));
+	ASSERT_EQ(2, responseCount);
+	ASSERT_EQ(1, bench.server.unsupportedCounter);
+}
+
+TEST(obd2, batchedPids) {
+	Obd2Bench bench;
+	testRpm = 800;
+	const uint8_t request[] = { OBD_MODE_CURRENT_DATA, 0x0C, 0x05, 0x11, 0x5E };
+	bench.sendRequest(request, sizeof(request));
+
+	ASSERT_EQ(1, responseCount) << "first frame, then waiting for flow control";
+	ASSERT_EQ(0x10, responses[0].data8[0]);
+	ASSERT_EQ(9, responses[0].data8[1]);
+	ASSERT_EQ(ISOTP_WAIT_FLOW_CONTROL, bench.server.isoTp.getState());
+
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0);
+	ASSERT_EQ(2, responseCount);
+	ASSERT_EQ(ISOTP_IDLE, bench.server.isoTp.getState());
+
+	uint8_t payload[ISOTP_MAX_SIZE];
+	ASSERT_EQ(9, bench.getPayload(payload));
+	// 0x11 is not supported and is skipped
+	const uint8_t expected[] = { 0x41, 0x0C, 0x0C, 0x80, 0x05, 130, 0x5E, 0, 30 };
+	ASSERT_EQ(0, memcmp(expected, payload, sizeof(expected)));
+}
+
+TEST(obd2, supportedPids) {
+	Obd2Bench bench;
+	const uint8_t request[] = { OBD_MODE_CURRENT_DATA, 0x00 };
+	bench.sendRequest(request, sizeof(request));
+	ASSERT_EQ(1, responseCount);
+	// 0x05, 0x0C, 0x0D and "next range has something"
+	const uint8_t expected[] = { 6, 0x41, 0x00, 0x08, 0x18, 0x00, 0x01 };
+	ASSERT_EQ(0, memcmp(expected, responses[0].data8, sizeof(expected)));
+
+	const uint8_t request40[] = { OBD_MODE_CURRENT_DATA, 0x40 };
+	bench.sendRequest(request40, sizeof(request40));
+	ASSERT_EQ(2, responseCount);
+	// 0x5E is bit 31 - (0x5E - 0x41)
+	const uint8_t expected40[] = { 6, 0x41, 0x40, 0x00, 0x00, 0x00, 0x04 };
+	ASSERT_EQ(0, memcmp(expected40, responses[1].data8, sizeof(expected40)));
+
+	// nothing in 0x61-0x80
+	const uint8_t request60[] = { OBD_MODE_CURRENT_DATA, 0x60 };
+	bench.sendRequest(request60, sizeof(request60));
+	ASSERT_EQ(2, responseCount);
+}
+
+TEST(obd2, dtcCodes) {
+	ASSERT_EQ(0x0301, obdCodeToDtc(301));
+	ASSERT_EQ(0x1234, obdCodeToDtc(1234));
+	ASSERT_EQ(0x0117, obdCodeToDtc(117));
+	ASSERT_EQ(0, obdCodeToDtc(6001));
+	ASSERT_EQ(0, obdCodeToDtc(0));
+
+	Obd2Bench bench;
+	const uint8_t request[] = { OBD_MODE_STORED_DTC };
+	bench.sendRequest(request, sizeof(request));
+	ASSERT_EQ(1, responseCount);
+	const uint8_t expectedEmpty[] = { 2, 0x43, 0 };
+	ASSERT_EQ(0, memcmp(expectedEmpty, responses[0].data8, sizeof(expectedEmpty))) << "no DTCs is still an answer";
+
+	responseCount = 0;
+	bench.server.setDtcGetter(getTestDtcs);
+
+	bench.sendRequest(request, sizeof(request));
+	ASSERT_EQ(1, responseCount);
+	const uint8_t expectedFirst[] = { 0x10, 10, 0x43, 4, 0x03, 0x01, 0x01, 0x17 };
+	ASSERT_EQ(0, memcmp(expectedFirst, responses[0].data8, sizeof(expectedFirst)));
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0);
+	uint8_t payload[ISOTP_MAX_SIZE];
+	ASSERT_EQ(10, bench.getPayload(payload));
+	const uint8_t expected[] = { 0x43, 4, 0x03, 0x01, 0x01, 0x17, 0x00, 0x02, 0x12, 0x34 };
+	ASSERT_EQ(0, memcmp(expected, payload, sizeof(expected)));
+}
+
+TEST(obd2, vehicleInfo) {
+	Obd2Bench bench;
+	bench.server.setVehicleInfo(NULL, "rusEFI 20261018", "rusEFI");
+
+	const uint8_t supported[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_SUPPORTED };
+	bench.sendRequest(supported, sizeof(supported));
+	ASSERT_EQ(1, responseCount);
+	// 0x04 and 0x0A
+	const uint8_t expectedMask[] = { 6, 0x49, 0x00, 0x10, 0x40, 0x00, 0x00 };
+	ASSERT_EQ(0, memcmp(expectedMask, responses[0].data8, sizeof(expectedMask)));
+
+	const uint8_t vin[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_VIN };
+	bench.sendRequest(vin, sizeof(vin));
+	ASSERT_EQ(1, responseCount);
+
+	responseCount = 0;
+	const uint8_t name[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_ECU_NAME };
+	bench.sendRequest(name, sizeof(name));
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0);
+	ASSERT_EQ(4, responseCount);
+	uint8_t payload[ISOTP_MAX_SIZE];
+	ASSERT_EQ(3 + OBD_ECU_NAME_SIZE, bench.getPayload(payload));
+	ASSERT_EQ(0x49, payload[0]);
+	ASSERT_EQ(OBD_INFO_ECU_NAME, payload[1]);
+	ASSERT_EQ(1, payload[2]);
+	ASSERT_EQ(0, memcmp("rusEFI", payload + 3, 6));
+	ASSERT_EQ(0, payload[3 + OBD_ECU_NAME_SIZE - 1]) << "padded with zeros";
+}
+
+TEST(obd2, flowControlPacing) {
+	Obd2Bench bench;
+	bench.server.setVehicleInfo(NULL, "rusEFI 20261018", "rusEFI");
+	const uint8_t name[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_ECU_NAME };
+	bench.sendRequest(name, sizeof(name));
+	ASSERT_EQ(1, responseCount);
+
+	// two frames per block, 5ms between frames
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 2, 5);
+	ASSERT_EQ(2, responseCount) << "first consecutive frame goes right away";
+	ASSERT_EQ(5, bench.server.getNextDelayMs(bench.nowMs));
+	bench.advance(4);
+	ASSERT_EQ(2, responseCount);
+	bench.advance(1);
+	ASSERT_EQ(3, responseCount);
+	ASSERT_EQ(ISOTP_WAIT_FLOW_CONTROL, bench.server.isoTp.getState()) << "end of block";
+	bench.advance(100);
+	ASSERT_EQ(3, responseCount);
+
+	// sub-millisecond STmin
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0xF5);
+	ASSERT_EQ(4, responseCount);
+	ASSERT_EQ(ISOTP_IDLE, bench.server.isoTp.getState());
+	uint8_t payload[ISOTP_MAX_SIZE];
+	ASSERT_EQ(3 + OBD_ECU_NAME_SIZE, bench.getPayload(payload));
+}
+
+TEST(obd2, flowControlReservedSeparation) {
+	Obd2Bench bench;
+	bench.server.setVehicleInfo(NULL, "rusEFI 20261018", "rusEFI");
+	const uint8_t name[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_ECU_NAME };
+	bench.sendRequest(name, sizeof(name));
+
+	// reserved STmin means the longest separation
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0x80);
+	ASSERT_EQ(2, responseCount);
+	ASSERT_EQ(0x7F, bench.server.getNextDelayMs(bench.nowMs));
+	bench.advance(0x7F - 1);
+	ASSERT_EQ(2, responseCount);
+	bench.advance(1);
+	ASSERT_EQ(3, responseCount);
+}
+
+TEST(obd2, flowControlTimeout) {
+	Obd2Bench bench;
+	bench.server.setVehicleInfo(NULL, "rusEFI 20261018", "rusEFI");
+	const uint8_t name[] = { OBD_MODE_VEHICLE_INFO, OBD_INFO_ECU_NAME };
+	bench.sendRequest(name, sizeof(name));
+	ASSERT_EQ(ISOTP_WAIT_FLOW_CONTROL, bench.server.isoTp.getState());
+
+	bench.advance(ISOTP_FLOW_CONTROL_TIMEOUT_MS - 1);
+	// tester asks for more time
+	bench.sendFlowControl(ISOTP_FLOW_WAIT, 0, 0);
+	bench.advance(ISOTP_FLOW_CONTROL_TIMEOUT_MS - 1);
+	ASSERT_EQ(ISOTP_WAIT_FLOW_CONTROL, bench.server.isoTp.getState());
+	bench.advance(1);
+	ASSERT_EQ(ISOTP_IDLE, bench.server.isoTp.getState());
+	ASSERT_EQ(1, bench.server.isoTp.timeoutCounter);
+
+	// late flow control is ignored
+	bench.sendFlowControl(ISOTP_FLOW_CONTINUE, 0, 0);
+	ASSERT_EQ(1, responseCount);
+
+	bench.sendRequest(name, sizeof(name));
+	bench.sendFlowControl(ISOTP_FLOW_OVERFLOW, 0, 0);
+	ASSERT_EQ(ISOTP_IDLE, bench.server.isoTp.getState());
+	ASSERT_EQ(1, bench.server.isoTp.abortCounter);
+	ASSERT_EQ(2, responseCount);
+}
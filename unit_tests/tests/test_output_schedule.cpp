@@ -0,0 +1,147 @@
+/**
+ * @file test_output_schedule.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "engine_math.h"
+#include "engine_test_helper.h"
+
+TEST(fuel, outputScheduleBuffer) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	setupSimpleTestEngineWithMafAndTT_ONE_trigger(&eth);
+
+	eth.fireTriggerEventsWithDuration(20);
+	eth.fireTriggerEventsWithDuration(20);
+	eth.assertRpm(3000, "RPM");
+	engine->engineState.timingAdvance = 10;
+	engine->engineState.dwellAngle = 30;
+
+	OutputScheduleBuffer *buffer = &engine->outputSchedule;
+	FuelSchedule *fs = &engine->injectionEvents;
+	ASSERT_FALSE(buffer->getActive()->isInjectionReady);
+
+	// without a ready buffer angles are calculated right away
+	fs->addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_TRUE(fs->isReady);
+	event_trigger_position_s legacy[4];
+	for (int i = 0; i < 4; i++) {
+		legacy[i] = fs->elements[i].injectionStart;
+	}
+
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(1U, buffer->injectionUpdateCounter);
+	ASSERT_EQ(1U, buffer->ignitionUpdateCounter);
+	// new version is only used after engine cycle boundary
+	ASSERT_FALSE(buffer->getActive()->isInjectionReady);
+	buffer->onEngineCycleStart();
+	ASSERT_EQ(1U, buffer->switchCounter);
+	const output_schedule_s *active = buffer->getActive();
+	ASSERT_TRUE(active->isInjectionReady);
+	ASSERT_TRUE(active->isIgnitionReady);
+	for (int i = 0; i < 4; i++) {
+		ASSERT_EQ(legacy[i].eventIndex, active->injectionStart[i].eventIndex) << "index " << i;
+		ASSERT_NEAR(legacy[i].angleOffset, active->injectionStart[i].angleOffset, EPS4D) << "offset " << i;
+	}
+
+	// nothing has changed - nothing to recalculate and nothing to switch to
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	buffer->onEngineCycleStart();
+	ASSERT_EQ(1U, buffer->injectionUpdateCounter);
+	ASSERT_EQ(1U, buffer->ignitionUpdateCounter);
+	ASSERT_EQ(1U, buffer->switchCounter);
+
+	// interpolation noise is below the tolerance
+	engine->engineState.timingAdvance = 10 + OUTPUT_SCHEDULE_IGNITION_TOLERANCE / 2;
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(1U, buffer->ignitionUpdateCounter);
+
+	// dwell change only touches ignition
+	engine->engineState.dwellAngle = 40;
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(1U, buffer->injectionUpdateCounter);
+	ASSERT_EQ(2U, buffer->ignitionUpdateCounter);
+	buffer->onEngineCycleStart();
+	ASSERT_EQ(2U, buffer->switchCounter);
+
+	// injection change only touches injection, but until next switch events still use the active version
+	engine->injectionDuration += 3;
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(2U, buffer->injectionUpdateCounter);
+	ASSERT_EQ(2U, buffer->ignitionUpdateCounter);
+	fs->addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_NEAR(legacy[0].angleOffset, fs->elements[0].injectionStart.angleOffset, EPS4D);
+
+	// pending version cannot be overwritten
+	engine->injectionDuration += 3;
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(2U, buffer->injectionUpdateCounter);
+
+	buffer->onEngineCycleStart();
+	fs->addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(buffer->getActive()->injectionStart[0].eventIndex, fs->elements[0].injectionStart.eventIndex);
+	ASSERT_NEAR(buffer->getActive()->injectionStart[0].angleOffset, fs->elements[0].injectionStart.angleOffset, EPS4D);
+	ASSERT_TRUE(fabs(legacy[0].angleOffset - fs->elements[0].injectionStart.angleOffset) > 1);
+
+	// pending version computed before invalidation is discarded
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	buffer->invalidate();
+	buffer->onEngineCycleStart();
+	ASSERT_EQ(3U, buffer->switchCounter);
+	ASSERT_FALSE(buffer->getActive()->isInjectionReady);
+}
+
+static void runEngineCycle(EngineTestHelper *eth) {
+	for (int i = 0; i < 2; i++) {
+		eth->fireRise(20);
+		eth->executeActions();
+		eth->fireFall(20);
+		eth->executeActions();
+	}
+}
+
+TEST(fuel, outputScheduleThroughTriggerCallback) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	setupSimpleTestEngineWithMafAndTT_ONE_trigger(&eth);
+
+	eth.fireTriggerEventsWithDuration(20);
+	eth.fireTriggerEventsWithDuration(20);
+	eth.assertRpm(3000, "RPM");
+	eth.clearQueue();
+
+	OutputScheduleBuffer *buffer = &engine->outputSchedule;
+	FuelSchedule *fs = &engine->injectionEvents;
+	// this is what periodicFastCallback() does with EFI_OUTPUT_SCHEDULE_BUFFER
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(0U, buffer->switchCounter);
+
+	// trigger callback switches to the new version on trigger index zero
+	runEngineCycle(&eth);
+	ASSERT_EQ(1U, buffer->switchCounter);
+	const output_schedule_s *active = buffer->getActive();
+	ASSERT_TRUE(active->isInjectionReady);
+	// injector callbacks have re-created fuel events from the active version
+	for (int i = 0; i < 4; i++) {
+		ASSERT_EQ(active->injectionStart[i].eventIndex, fs->elements[i].injectionStart.eventIndex) << "index " << i;
+		ASSERT_NEAR(active->injectionStart[i].angleOffset, fs->elements[i].injectionStart.angleOffset, EPS4D) << "offset " << i;
+	}
+	event_trigger_position_s before = fs->elements[0].injectionStart;
+
+	// new injection phase is not used by the trigger callback until there is a new version
+	engine->engineState.injectionOffset += 90;
+	runEngineCycle(&eth);
+	ASSERT_EQ(before.eventIndex, fs->elements[0].injectionStart.eventIndex);
+	ASSERT_NEAR(before.angleOffset, fs->elements[0].injectionStart.angleOffset, EPS4D);
+
+	buffer->update(PASS_ENGINE_PARAMETER_SIGNATURE);
+	runEngineCycle(&eth);
+	ASSERT_EQ(2U, buffer->switchCounter);
+	active = buffer->getActive();
+	for (int i = 0; i < 4; i++) {
+		ASSERT_EQ(active->injectionStart[i].eventIndex, fs->elements[i].injectionStart.eventIndex) << "index " << i;
+		ASSERT_NEAR(active->injectionStart[i].angleOffset, fs->elements[i].injectionStart.angleOffset, EPS4D) << "offset " << i;
+	}
+	ASSERT_FALSE(before.eventIndex == fs->elements[0].injectionStart.eventIndex
+			&& fabs(before.angleOffset - fs->elements[0].injectionStart.angleOffset) < EPS4D);
+}
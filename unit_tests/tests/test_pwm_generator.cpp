@@ -8,6 +8,7 @@
 #include "global.h"
 #include "unit_test_framework.h"
 #include "pwm_generator_logic.h"
+#include "pwm_generator.h"
 
 #define LOW_VALUE 0
 #define HIGH_VALUE 1
@@ -166,3 +167,102 @@ TEST(misc, testPwmGenerator) {
 
 
 
+
+class MockHardwarePwm : public HardwarePwm {
+public:
+	void setDuty(float duty) override {
+		this->duty = duty;
+	}
+	void setFrequency(float frequency) override {
+		this->frequency = frequency;
+	}
+	void stop() override {
+		stopCounter++;
+	}
+	float duty = -1;
+	float frequency = -1;
+	int stopCounter = 0;
+};
+
+/**
+ * pin which has a spare timer channel, NULL if it does not
+ */
+static HardwarePwm *mockTimerChannel = NULL;
+
+HardwarePwm *tryInitHardwarePwm(const char *msg, brain_pin_e brainPin, float frequency, float dutyCycle) {
+	UNUSED(msg);
+	UNUSED(brainPin);
+	UNUSED(frequency);
+	UNUSED(dutyCycle);
+	return mockTimerChannel;
+}
+
+TEST(misc, testHardwarePwm) {
+	MockHardwarePwm hardPwm;
+	TestExecutor executor;
+	SimplePwm pwm("test PWM1");
+	pwm.hardPwm = &hardPwm;
+
+	pwm.setFrequency(300);
+	ASSERT_NEAR(300, hardPwm.frequency, EPS4D);
+
+	pwm.setSimplePwmDutyCycle(0.25);
+	ASSERT_NEAR(0.25, hardPwm.duty, EPS4D);
+	// out of range duty cycle is clamped before it reaches the timer
+	pwm.setSimplePwmDutyCycle(1.5);
+	ASSERT_NEAR(1, hardPwm.duty, EPS4D);
+
+	pwm.setFrequency(NAN);
+	ASSERT_TRUE(cisnan(hardPwm.frequency));
+	ASSERT_EQ(0, executor.size()) << "nothing should be scheduled";
+}
+
+TEST(misc, testHardwarePwmRestart) {
+	timeNowUs = 0;
+	MockHardwarePwm hardPwm;
+	TestExecutor executor;
+	OutputPin pin;
+	SimplePwm pwm("test PWM1");
+
+	// started with timer channel, restarted on a pin without one
+	pwm.hardPwm = &hardPwm;
+	startSimplePwmHard(&pwm, "unit_test", &executor, GPIO_UNASSIGNED, &pin, 1000, 0.25, (pwm_gen_callback*) testApplyPinState);
+	ASSERT_EQ(1, hardPwm.stopCounter);
+	ASSERT_TRUE(pwm.hardPwm == NULL);
+	ASSERT_EQ(1, executor.size()) << "software PWM";
+	// duty cycle goes to software PWM and not to the stale timer
+	pwm.setSimplePwmDutyCycle(0.5);
+	ASSERT_NEAR(-1, hardPwm.duty, EPS4D);
+
+	// nothing to release second time
+	releaseHardwarePwm(&pwm);
+	ASSERT_EQ(1, hardPwm.stopCounter);
+
+	// restarted with timer channel: software loop ends
+	pwm.hardPwm = &hardPwm;
+	timeNowUs = executor.getForUnitTest(0)->momentX;
+	executor.executeAll(timeNowUs);
+	ASSERT_EQ(0, executor.size());
+}
+
+TEST(misc, testStartSimplePwmHard) {
+	timeNowUs = 0;
+	MockHardwarePwm hardPwm;
+	TestExecutor executor;
+	OutputPin pin;
+	SimplePwm pwm("test PWM1");
+
+	mockTimerChannel = &hardPwm;
+	startSimplePwmHard(&pwm, "unit_test", &executor, GPIOA_0, &pin, 300, 0.25, (pwm_gen_callback*) applyPinState);
+	ASSERT_TRUE(pwm.hardPwm == &hardPwm);
+	ASSERT_NEAR(300, hardPwm.frequency, EPS4D);
+	ASSERT_NEAR(0.25, hardPwm.duty, EPS4D);
+	ASSERT_EQ(0, executor.size()) << "nothing should be scheduled";
+
+	// custom callback has to stay in software even if there is a timer channel
+	SimplePwm custom("test PWM2");
+	startSimplePwmHard(&custom, "unit_test", &executor, GPIOA_0, &pin, 300, 0.25, (pwm_gen_callback*) testApplyPinState);
+	ASSERT_TRUE(custom.hardPwm == NULL);
+	ASSERT_EQ(1, executor.size()) << "software PWM";
+	mockTimerChannel = NULL;
+}
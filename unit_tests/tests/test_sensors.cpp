@@ -9,6 +9,7 @@
 #include "thermistors.h"
 #include "allsensors.h"
 #include "engine_test_helper.h"
+#include "map_averaging.h"
 
 static ThermistorConf tc;
 
@@ -26,6 +27,34 @@ TEST(sensors, mapDecoding) {
 	ASSERT_FLOAT_EQ(58.4, decodePressure(1, &s PASS_ENGINE_PARAMETER_SUFFIX));
 }
 
+TEST(sensors, mapAverager) {
+	MapAverager averager;
+	float initial = averager.getCylinderAdc(0);
+	ASSERT_TRUE(cisnan(initial));
+	// end without start is ignored
+	ASSERT_EQ(0, averager.endWindow(0));
+
+	averager.addSample(1000);
+	averager.startWindow(0);
+	averager.addSample(100);
+	averager.addSample(200);
+	// windows of two cylinders overlap
+	averager.startWindow(1);
+	averager.addSample(300);
+	ASSERT_EQ(3, averager.endWindow(0));
+	ASSERT_NEAR(200, averager.getCylinderAdc(0), EPS4D);
+	averager.addSample(500);
+	ASSERT_EQ(2, averager.endWindow(1));
+	ASSERT_NEAR(400, averager.getCylinderAdc(1), EPS4D);
+
+	// empty window keeps previous result
+	averager.startWindow(0);
+	ASSERT_EQ(0, averager.endWindow(0));
+	ASSERT_NEAR(200, averager.getCylinderAdc(0), EPS4D);
+	map_running_sum_s sum = averager.getRunningSum();
+	ASSERT_EQ(5U, sum.count);
+}
+
 TEST(sensors, tps) {
 	print("************************************************** testTps\r\n");
 
@@ -83,3 +112,32 @@ TEST(sensors, thermistors) {
 		ASSERT_NEAR(0.0, tm.s_h_c, EPS4D);
 	}
 }
+
+TEST(sensors, thermistorTable) {
+	ThermistorMath tm;
+	float notBuilt = tm.curve.getValue(2.5);
+	ASSERT_TRUE(cisnan(notBuilt));
+
+	setThermistorConfiguration(&tc, -20, 18000, 23.8889, 2100, 120.0, 100.0);
+	tc.config.bias_resistor = 2700;
+	tm.setConfig(&tc.config);
+	ASSERT_TRUE(tm.curve.isBuilt());
+
+	float voltage = 5.0f * 2100 / (2100 + 2700);
+	ASSERT_NEAR(23.8889, tm.getTemperatureByVoltage(voltage), EPS3D);
+	ASSERT_NEAR(23.8889, tm.curve.getValue(voltage), 0.05);
+
+	float worstVoltage;
+	float error = getThermistorTableError(&tm, &worstVoltage);
+	ASSERT_LT(error, 0.25);
+	ASSERT_GT(error, 0);
+	ASSERT_NEAR(error, absF(tm.curve.getValue(worstVoltage) - tm.getTemperatureByVoltage(worstVoltage)), EPS4D);
+
+	// outside of the table, open circuit
+	ASSERT_FALSE(isValidCoolantTemperature(tm.curve.getValue(6)));
+
+	// Dodge sensor, steeper at the hot end
+	setThermistorConfiguration(&tc, -40, 336660, 30, 7550, 120, 390);
+	tm.setConfig(&tc.config);
+	ASSERT_LT(getThermistorTableError(&tm, &worstVoltage), 0.5);
+}
@@ -14,6 +14,8 @@
 #include "event_queue.h"
 #include "pwm_generator_logic.h"
 #include "unit_test_framework.h"
+#include "scheduler_histograms.h"
+#include "single_timer_executor.h"
 
 // this instance is used by some unit tests here which reference it directly
 static EventQueue eq;
@@ -165,3 +167,141 @@ TEST(misc, testSignalExecutor) {
 	ASSERT_EQ(2, callbackCounter);
 	testSignalExecutor2();
 }
+
+TEST(misc, testSignalExecutorCoalescing) {
+	eq.clear();
+	eq.setCoalescingWindow(3);
+	scheduling_s s1;
+	scheduling_s s2;
+	scheduling_s s3;
+
+	eq.insertTask(&s1, 10, callback, NULL);
+	eq.insertTask(&s2, 13, callback, NULL);
+	eq.insertTask(&s3, 14, callback, NULL);
+
+	callbackCounter = 0;
+	// s2 is due within the window so it is executed together with s1
+	ASSERT_EQ(2, eq.executeAll(10));
+	ASSERT_EQ(2, callbackCounter);
+	ASSERT_EQ(1, eq.size());
+	ASSERT_EQ(14, eq.getNextEventTime(0));
+
+	eq.setCoalescingWindow(0);
+	ASSERT_EQ(0, eq.executeAll(13));
+	ASSERT_EQ(1, eq.executeAll(14));
+}
+
+TEST(misc, testBatchTimerReset) {
+	// new head due well after the trigger handler is over waits for endBatch()
+	ASSERT_FALSE(isImmediateTimerResetNeeded(1000 + 200, 1000, 50));
+	ASSERT_FALSE(isImmediateTimerResetNeeded(1000 + 50, 1000, 50));
+	// new head which could become due while the handler is still running re-arms the timer right away
+	ASSERT_TRUE(isImmediateTimerResetNeeded(1000 + 49, 1000, 50));
+	ASSERT_TRUE(isImmediateTimerResetNeeded(1000, 1000, 50));
+	// already late
+	ASSERT_TRUE(isImmediateTimerResetNeeded(990, 1000, 50));
+}
+
+TEST(misc, testEndOfBatchExecute) {
+	scheduling_s head;
+	head.momentX = 1000;
+	ASSERT_FALSE(isEndOfBatchExecuteNeeded(false, NULL, 1000));
+	ASSERT_TRUE(isEndOfBatchExecuteNeeded(true, NULL, 1000));
+	// timer is armed for the head and nothing is due yet
+	ASSERT_FALSE(isEndOfBatchExecuteNeeded(false, &head, 999));
+	// head has become due while the batch was running, no reason to wait for the timer interrupt
+	ASSERT_TRUE(isEndOfBatchExecuteNeeded(false, &head, 1000));
+	ASSERT_TRUE(isEndOfBatchExecuteNeeded(false, &head, 1200));
+}
+
+static void otherCallback(void *a) {
+	UNUSED(a);
+}
+
+TEST(misc, schedulerHistograms) {
+	scheduler_histograms_s histograms;
+	memset(&histograms, 0, sizeof(histograms));
+	registerSchedulerCallbackName(&histograms, callback, "callback");
+
+	recordSchedulerCallback(&histograms, callback, 5, 2);
+	recordSchedulerCallback(&histograms, otherCallback, 3, 1);
+
+	callback_histograms_s *slot = &histograms.slots[0];
+	ASSERT_TRUE(slot->callback == callback);
+	ASSERT_TRUE(histograms.slots[1].callback == otherCallback);
+	ASSERT_EQ(1U, slot->lateness.total_count);
+	ASSERT_EQ(5U, slot->lateness.max);
+	ASSERT_EQ(1U, slot->duration.total_count);
+	ASSERT_EQ(2U, slot->duration.max);
+}
+
+static void unnamedCallback0(void *) {
+}
+
+static void unnamedCallback1(void *) {
+}
+
+TEST(misc, schedulerHistogramsReset) {
+	scheduler_histograms_s histograms;
+	memset(&histograms, 0, sizeof(histograms));
+
+	recordSchedulerCallback(&histograms, unnamedCallback0, 1, 1);
+	registerSchedulerCallbackName(&histograms, callback, "callback");
+	recordSchedulerCallback(&histograms, unnamedCallback1, 1, 1);
+	for (int i = 0; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		// the rest of the slots are taken by callback which is not a known function, address is only used as a key
+		recordSchedulerCallback(&histograms, (schfunc_t) (uintptr_t) (0x100 + i), 1, 1);
+	}
+	ASSERT_EQ(3U, histograms.untrackedCounter);
+
+	resetSchedulerHistograms(&histograms);
+	ASSERT_EQ(0U, histograms.untrackedCounter);
+	// named slot is kept and moved to the front, unnamed slots are released
+	ASSERT_TRUE(histograms.slots[0].callback == callback);
+	ASSERT_EQ(0U, histograms.slots[0].lateness.total_count);
+	for (int i = 1; i < SCHEDULER_HISTOGRAM_SLOTS; i++) {
+		ASSERT_TRUE(histograms.slots[i].callback == NULL) << "slot " << i;
+	}
+
+	recordSchedulerCallback(&histograms, unnamedCallback1, US2NT(7), 1);
+	ASSERT_TRUE(histograms.slots[1].callback == unnamedCallback1);
+
+	uint16_t lateness[SCHEDULER_HISTOGRAM_SLOTS];
+	uint16_t duration[SCHEDULER_HISTOGRAM_SLOTS];
+	getSchedulerHistogramsSummary(&histograms, lateness, duration);
+	ASSERT_EQ(0, lateness[0]);
+	ASSERT_EQ(7, lateness[1]);
+}
+
+/**
+ * TunerStudio gauges are labeled by registration order so named slots should not depend on which
+ * callbacks happened to be invoked first
+ */
+TEST(misc, schedulerHistogramsRegistrationOrder) {
+	scheduler_histograms_s histograms;
+	memset(&histograms, 0, sizeof(histograms));
+
+	recordSchedulerCallback(&histograms, unnamedCallback0, 1, 1);
+	recordSchedulerCallback(&histograms, otherCallback, 2, 1);
+	recordSchedulerCallback(&histograms, unnamedCallback1, 3, 1);
+	registerSchedulerCallbackName(&histograms, unnamedCallback1, "first");
+	registerSchedulerCallbackName(&histograms, callback, "second");
+	registerSchedulerCallbackName(&histograms, otherCallback, "third");
+
+	ASSERT_TRUE(histograms.slots[0].callback == unnamedCallback1);
+	ASSERT_EQ(3U, histograms.slots[0].lateness.max);
+	ASSERT_TRUE(histograms.slots[1].callback == callback);
+	ASSERT_EQ(0U, histograms.slots[1].lateness.total_count);
+	ASSERT_TRUE(histograms.slots[2].callback == otherCallback);
+	ASSERT_EQ(2U, histograms.slots[2].lateness.max);
+	// unnamed slot keeps its counters
+	ASSERT_TRUE(histograms.slots[3].callback == unnamedCallback0);
+	ASSERT_EQ(1U, histograms.slots[3].lateness.total_count);
+	ASSERT_TRUE(histograms.slots[4].callback == NULL);
+
+	resetSchedulerHistograms(&histograms);
+	ASSERT_STREQ("first", histograms.slots[0].name);
+	ASSERT_STREQ("second", histograms.slots[1].name);
+	ASSERT_STREQ("third", histograms.slots[2].name);
+	ASSERT_TRUE(histograms.slots[3].callback == NULL);
+}
@@ -41,7 +41,7 @@ TEST(engine, testStartOfCrankingPrimingPulse) {
 	ASSERT_EQ( 0,  GET_RPM()) << "RPM=0";
 
 	// this -70 value comes from CLT error handling code
-	ASSERT_NEAR( 70,  engine->sensors.clt, EPS4D) << "CLT#1";
+	ASSERT_NEAR( 70,  engine->sensors.clt, EPS2D) << "CLT#1";
 
 	// we need below freezing temperature to get prime fuel
 	// todo: less cruel CLT value assignment which would survive 'updateSlowSensors'
@@ -0,0 +1,100 @@
+/*
+ * @file test_tooth_logger.cpp
+ *
+ * @date Oct 18, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "engine_test_helper.h"
+#include "tooth_logger.h"
+
+static const composite_logger_s *getEntries(const ToothLoggerBuffer &buffer) {
+	return reinterpret_cast<const composite_logger_s *>(buffer.Buffer);
+}
+
+static void fillHalf(int count DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	for (int i = 0; i < count; i++) {
+		LogTriggerTooth(i % 2 == 0 ? SHAFT_PRIMARY_RISING : SHAFT_PRIMARY_FALLING, US2NT(1000 + i) PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+}
+
+TEST(toothLogger, compositeBothEdgesAndCam) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	EnableToothLogger();
+
+	LogTriggerTooth(SHAFT_PRIMARY_RISING, US2NT(100) PASS_ENGINE_PARAMETER_SUFFIX);
+	LogTriggerTooth(SHAFT_PRIMARY_FALLING, US2NT(200) PASS_ENGINE_PARAMETER_SUFFIX);
+	LogTriggerTooth(SHAFT_SECONDARY_RISING, US2NT(300) PASS_ENGINE_PARAMETER_SUFFIX);
+	LogCamTooth(true, US2NT(400) PASS_ENGINE_PARAMETER_SUFFIX);
+	LogTriggerTooth(SHAFT_SECONDARY_FALLING, US2NT(500) PASS_ENGINE_PARAMETER_SUFFIX);
+	LogCamTooth(false, US2NT(600) PASS_ENGINE_PARAMETER_SUFFIX);
+	// not shown by TS
+	LogTriggerTooth(SHAFT_3RD_RISING, US2NT(700) PASS_ENGINE_PARAMETER_SUFFIX);
+
+	// nothing for TS until the half is full
+	ToothLoggerBuffer empty = GetToothLoggerBuffer();
+	ASSERT_EQ(0U, empty.Length);
+	ASSERT_EQ(-1, empty.Half);
+
+	fillHalf(COMPOSITE_LOGGER_SIZE - 6 PASS_ENGINE_PARAMETER_SUFFIX);
+	ToothLoggerBuffer buffer = GetToothLoggerBuffer();
+	ASSERT_EQ(COMPOSITE_LOGGER_SIZE * sizeof(composite_logger_s), buffer.Length);
+	ASSERT_EQ(0, buffer.Half);
+
+	const composite_logger_s *entries = getEntries(buffer);
+	uint8_t expectedFlags[] = {
+			COMPOSITE_PRIMARY_LEVEL | COMPOSITE_TRIGGER,
+			COMPOSITE_TRIGGER,
+			COMPOSITE_SECONDARY_LEVEL,
+			COMPOSITE_SECONDARY_LEVEL | COMPOSITE_CAM_LEVEL | COMPOSITE_CAM,
+			COMPOSITE_CAM_LEVEL,
+			COMPOSITE_CAM };
+	for (int i = 0; i < 6; i++) {
+		ASSERT_EQ(expectedFlags[i], entries[i].flags) << i;
+		// TS wants big endian, packed field cannot be bound to a reference
+		uint32_t timestamp = entries[i].timestamp;
+		uint32_t expectedUs = 100 * (i + 1);
+		ASSERT_EQ(SWAP_UINT32(expectedUs), timestamp) << i;
+	}
+
+	ASSERT_EQ(1U, GetToothLoggerStats().BufferCount);
+	ASSERT_EQ(0U, GetToothLoggerStats().DroppedCount);
+	ReleaseToothLoggerBuffer(buffer);
+	ASSERT_EQ(0U, GetToothLoggerBuffer().Length);
+	DisableToothLogger();
+}
+
+TEST(toothLogger, releaseOnlyWhatWasSent) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	EnableToothLogger();
+
+	fillHalf(COMPOSITE_LOGGER_SIZE - 1 PASS_ENGINE_PARAMETER_SUFFIX);
+	ToothLoggerBuffer empty = GetToothLoggerBuffer();
+	ASSERT_EQ(0U, empty.Length);
+	// trigger interrupt fills the half between TS 'get' and 'release'
+	fillHalf(1 PASS_ENGINE_PARAMETER_SUFFIX);
+	ReleaseToothLoggerBuffer(empty);
+
+	// half which was not sent is still there
+	ToothLoggerBuffer first = GetToothLoggerBuffer();
+	ASSERT_EQ(0, first.Half);
+	ASSERT_EQ(COMPOSITE_LOGGER_SIZE * sizeof(composite_logger_s), first.Length);
+
+	// second half fills up while TS is sending the first one, then entries are dropped
+	fillHalf(COMPOSITE_LOGGER_SIZE + 1 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(1U, GetToothLoggerStats().DroppedCount);
+	ASSERT_EQ(0, GetToothLoggerBuffer().Half);
+
+	// releasing first half hands over the second one right away
+	ReleaseToothLoggerBuffer(first);
+	ToothLoggerBuffer second = GetToothLoggerBuffer();
+	ASSERT_EQ(1, second.Half);
+	// stale release does not touch second half
+	ReleaseToothLoggerBuffer(first);
+	ASSERT_EQ(1, GetToothLoggerBuffer().Half);
+
+	ReleaseToothLoggerBuffer(second);
+	ASSERT_EQ(-1, GetToothLoggerBuffer().Half);
+	ASSERT_EQ(2U, GetToothLoggerStats().BufferCount);
+	DisableToothLogger();
+}
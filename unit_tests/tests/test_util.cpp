@@ -21,6 +21,14 @@
 #include "lcd_menu_tree.h"
 #include "crc.h"
 #include "fl_stack.h"
+#include "spsc_queue.h"
+#include "delta_frame_encoder.h"
+#include "binary_log.h"
+#include "message_ring.h"
+#include "log_producer_rings.h"
+#include "deferred_log.h"
+#include "engine_sniffer_record.h"
+#include "adc_filter.h"
 #include "io_pins.h"
 #include "counter64.h"
 #include "efi_gpio.h"
@@ -65,6 +73,69 @@ TEST(util, Overflow64Counter) {
 	ASSERT_EQ(4294967296, o.update(0));
 }
 
+/**
+ * Hardware counter is the lower half of 'trueTime'. Reader and writer are each split into steps
+ * with random simulated interrupts in between, those interrupts advance time and read it.
+ */
+class TimeBaseStress {
+public:
+	efitime_t trueTime = 0;
+	Overflow64Counter counter;
+	uint32_t seed = 12345;
+	int checks = 0;
+	int errors = 0;
+
+	uint32_t random() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	void read(int depth) {
+		State64 snapshot = counter.getSnapshot();
+		interrupts(depth + 1);
+		efitime_t expected = trueTime;
+		efitime_t result = Overflow64Counter::toTime64(&snapshot, (uint32_t) trueTime);
+		checks++;
+		if (result != expected) {
+			errors++;
+		}
+	}
+
+	/**
+	 * ISR context: time goes on, reads are atomic from the point of view of the interrupted context
+	 */
+	void interrupts(int depth) {
+		int count = random() % 3;
+		for (int i = 0; i < count; i++) {
+			// large steps so that we get plenty of overflows, writer still has to catch up in time
+			trueTime += random() % 0x4000000;
+			if (depth < 3 && random() % 2 == 0) {
+				read(depth);
+			}
+		}
+	}
+
+	void write() {
+		uint32_t value = (uint32_t) trueTime;
+		interrupts(0);
+		counter.update(value);
+	}
+};
+
+TEST(util, Overflow64CounterStress) {
+	TimeBaseStress stress;
+	for (int i = 0; i < 1000000; i++) {
+		if (stress.random() % 8 == 0) {
+			stress.write();
+		} else {
+			stress.read(0);
+		}
+	}
+	ASSERT_TRUE(stress.trueTime > 100 * 0x100000000LL) << "not enough overflows";
+	ASSERT_TRUE(stress.checks > 1000000);
+	ASSERT_EQ(0, stress.errors);
+}
+
 TEST(util, cyclicBufferContains) {
 	cyclic_buffer<int> sb;
 	sb.add(10);
@@ -101,6 +172,646 @@ TEST(util, cyclicBuffer) {
 
 }
 
+TEST(util, spscQueue) {
+	SpscQueue<int, 4> queue;
+	int value;
+	ASSERT_FALSE(queue.pop(&value));
+
+	ASSERT_TRUE(queue.push(1));
+	ASSERT_TRUE(queue.push(2));
+	ASSERT_EQ(2, queue.getBacklog());
+	ASSERT_TRUE(queue.pop(&value));
+	ASSERT_EQ(1, value);
+
+	ASSERT_TRUE(queue.push(3));
+	ASSERT_TRUE(queue.push(4));
+	ASSERT_TRUE(queue.push(5));
+	ASSERT_EQ(4, queue.maxBacklog);
+	// full - value is dropped
+	ASSERT_FALSE(queue.push(6));
+	ASSERT_EQ(1U, queue.overrunCounter);
+
+	// order is preserved across wrap-around
+	for (int expected = 2; expected <= 5; expected++) {
+		ASSERT_TRUE(queue.pop(&value));
+		ASSERT_EQ(expected, value);
+	}
+	ASSERT_FALSE(queue.pop(&value));
+	ASSERT_EQ(0, queue.getBacklog());
+
+	queue.resetCounters();
+	ASSERT_EQ(0U, queue.overrunCounter);
+	ASSERT_EQ(0, queue.maxBacklog);
+}
+
+typedef struct {
+	int rpm;
+	float afr;
+	uint8_t flags[5];
+} test_output_channels_s;
+
+TEST(util, deltaFrameEncoder) {
+	typedef DeltaFrameEncoder<sizeof(test_output_channels_s)> encoder_t;
+	ASSERT_EQ(4, encoder_t::WORD_COUNT);
+	ASSERT_EQ(1, encoder_t::BITMAP_SIZE);
+
+	encoder_t encoder;
+	uint8_t frame[encoder_t::MAX_FRAME_SIZE];
+	test_output_channels_s state;
+	memset(&state, 0, sizeof(state));
+	test_output_channels_s received;
+	memset(&received, 0xFF, sizeof(received));
+	uint8_t expectedSequence = 0;
+
+	state.rpm = 3000;
+	state.afr = 14.7;
+	state.flags[4] = 1;
+	// first frame has everything
+	int size = encoder.encode(&state, frame);
+	ASSERT_EQ(encoder_t::MAX_FRAME_SIZE, size);
+	ASSERT_EQ(DELTA_FRAME_KEY, frame[1]);
+	ASSERT_TRUE(encoder_t::decode(frame, size, &received, &expectedSequence));
+	ASSERT_EQ(0, memcmp(&state, &received, sizeof(state)));
+
+	// nothing has changed
+	size = encoder.encode(&state, frame);
+	ASSERT_EQ(DELTA_FRAME_HEADER_SIZE + 1, size);
+	ASSERT_EQ(0, frame[2]);
+	ASSERT_TRUE(encoder_t::decode(frame, size, &received, &expectedSequence));
+
+	// only the changed word is sent
+	state.afr = 12;
+	size = encoder.encode(&state, frame);
+	ASSERT_EQ(DELTA_FRAME_HEADER_SIZE + 1 + 4, size);
+	ASSERT_EQ(0, frame[1]);
+	ASSERT_EQ(2, frame[2]);
+	ASSERT_TRUE(encoder_t::decode(frame, size, &received, &expectedSequence));
+	ASSERT_EQ(0, memcmp(&state, &received, sizeof(state)));
+
+	// lost frame is detected, receiver waits for key frame
+	state.rpm = 3100;
+	encoder.encode(&state, frame);
+	state.flags[4] = 0;
+	size = encoder.encode(&state, frame);
+	ASSERT_FALSE(encoder_t::decode(frame, size, &received, &expectedSequence));
+	encoder.reset();
+	size = encoder.encode(&state, frame);
+	ASSERT_TRUE(encoder_t::decode(frame, size, &received, &expectedSequence));
+	ASSERT_EQ(0, memcmp(&state, &received, sizeof(state)));
+	ASSERT_EQ(2U, encoder.keyFrameCounter);
+	ASSERT_EQ(6U, encoder.frameCounter);
+
+	for (int i = 0; i <= DELTA_FRAME_KEY_INTERVAL; i++) {
+		encoder.encode(&state, frame);
+	}
+	ASSERT_EQ(DELTA_FRAME_KEY, frame[1]);
+}
+
+TEST(util, messageRing) {
+	MessageRing<64> ring;
+	char output[128];
+
+	ASSERT_EQ(0, ring.read(output, sizeof(output)));
+	ASSERT_TRUE(ring.write("hello,", 6));
+	ASSERT_TRUE(ring.write("world,", 6));
+	ASSERT_EQ(16, ring.getBacklog());
+	ASSERT_EQ(12, ring.read(output, sizeof(output)));
+	ASSERT_EQ(0, memcmp("hello,world,", output, 12));
+	ASSERT_EQ(0, ring.getBacklog());
+
+	// only whole messages are taken
+	ASSERT_TRUE(ring.write("12345", 5));
+	ASSERT_TRUE(ring.write("abc", 3));
+	ASSERT_EQ(5, ring.read(output, 7));
+	ASSERT_EQ(3, ring.read(output, 7));
+	ASSERT_EQ(0, memcmp("abc", output, 3));
+
+	// full ring drops and counts
+	char message[20];
+	memset(message, 'x', sizeof(message));
+	int written = 0;
+	for (int i = 0; i < 10; i++) {
+		if (ring.write(message, sizeof(message))) {
+			written++;
+		}
+	}
+	ASSERT_EQ(64 / 22, written);
+	ASSERT_EQ((uint32_t) (10 - written), ring.droppedCounter);
+	ASSERT_EQ((uint32_t) ((10 - written) * 20), ring.droppedBytes);
+
+	// messages wrap around the end of the buffer
+	for (int i = 0; i < 50; i++) {
+		ASSERT_EQ(written * 20, ring.read(output, sizeof(output)));
+		message[0] = 'a' + i % 26;
+		for (int w = 0; w < written; w++) {
+			ASSERT_TRUE(ring.write(message, sizeof(message)));
+		}
+		ASSERT_EQ(written * 20, ring.read(output, sizeof(output)));
+		ASSERT_EQ('a' + i % 26, output[0]);
+		ASSERT_EQ('x', output[19]);
+		for (int w = 0; w < written; w++) {
+			ASSERT_TRUE(ring.write(message, sizeof(message)));
+		}
+	}
+	ASSERT_EQ((uint32_t) (written * 50 * 2 + written + 4), ring.messageCounter);
+}
+
+/**
+ * same sizes as stm32f4 logging central
+ */
+#define TEST_LOG_OUTPUT_SIZE (6500 - 5)
+typedef LogProducerRings<1024, 6, TEST_LOG_OUTPUT_SIZE> test_log_rings_t;
+
+TEST(util, logProducerRingsLargeMessage) {
+	static test_log_rings_t rings;
+	static char output[TEST_LOG_OUTPUT_SIZE];
+
+	// engine sniffer chart, see WAVE_LOGGING_SIZE
+	static char chart[5000];
+	memset(chart, 'w', sizeof(chart));
+	ASSERT_TRUE(test_log_rings_t::isLarge(sizeof(chart)));
+	ASSERT_FALSE(test_log_rings_t::isLarge(200));
+
+	ASSERT_TRUE(rings.write(2, "msg,small,", 10));
+	ASSERT_TRUE(rings.write(1, chart, sizeof(chart)));
+	ASSERT_EQ(10 + (int) sizeof(chart), rings.read(output, sizeof(output)));
+	ASSERT_EQ(0, memcmp(chart, output, sizeof(chart)));
+	ASSERT_EQ(0, memcmp("msg,small,", output + sizeof(chart), 10));
+	ASSERT_EQ(0, rings.read(output, sizeof(output)));
+
+	// second chart does not fit until the first one is read
+	ASSERT_TRUE(rings.write(0, chart, sizeof(chart)));
+	ASSERT_FALSE(rings.write(0, chart, sizeof(chart)));
+	ASSERT_EQ(1U, rings.largeDroppedCounter);
+	ASSERT_EQ((int) sizeof(chart), rings.read(output, sizeof(output)));
+	ASSERT_TRUE(rings.write(0, chart, sizeof(chart)));
+	ASSERT_EQ(3U, rings.largeMessageCounter);
+	// goes into the other buffer
+	ASSERT_EQ((int) sizeof(chart), rings.read(output, sizeof(output)));
+	ASSERT_EQ(0, rings.read(output, sizeof(output)));
+}
+
+TEST(util, deferredLog) {
+	char output[256];
+	// whatever was logged by earlier tests
+	formatDeferredMessages(output, sizeof(output));
+	while (formatDeferredMessages(output, sizeof(output)) > 0) {
+	}
+	uint32_t messageCounter = getDeferredMessageCounter();
+
+	deferredMsg("gap=%.2f index=%d error=%s %d%%", 1.5f, 3, "Yes", 100);
+	deferredMsg("no arguments");
+	deferredMsg("%5d|%-3s|%x", 42, "a", 255);
+	ASSERT_EQ(messageCounter + 3, getDeferredMessageCounter());
+
+	int size = formatDeferredMessages(output, sizeof(output));
+	ASSERT_STREQ("msg,gap=1.50 index=3 error=Yes 100%,msg,no arguments,msg,   42|a  |ff,", output);
+	ASSERT_EQ((int) strlen(output), size);
+
+	// message which does not fit stays for next time
+	deferredMsg("first");
+	deferredMsg("second");
+	ASSERT_EQ(10, formatDeferredMessages(output, 15));
+	ASSERT_STREQ("msg,first,", output);
+	ASSERT_EQ(11, formatDeferredMessages(output, 15));
+	ASSERT_STREQ("msg,second,", output);
+	ASSERT_EQ(0, formatDeferredMessages(output, 15));
+
+	// nobody reads - dropped and counted
+	uint32_t dropped = getDeferredDroppedCounter();
+	for (int i = 0; i < 1000; i++) {
+		deferredMsg("value %d %d %d", i, i, i);
+	}
+	ASSERT_TRUE(getDeferredDroppedCounter() > dropped);
+	while (formatDeferredMessages(output, sizeof(output)) > 0) {
+	}
+}
+
+static void assertEngineSnifferRoundTrip(const char *msg, int expectedEdge, int expectedValue, const char *expectedText) {
+	engine_sniffer_record_s record;
+	encodeEngineSnifferValue(&record, msg);
+	ASSERT_EQ(expectedEdge, record.edge) << msg;
+	ASSERT_EQ(expectedValue, record.value) << msg;
+
+	char buffer[ENGINE_SNIFFER_VALUE_SIZE];
+	char *end = printEngineSnifferValue(buffer, &record);
+	ASSERT_STREQ(expectedText, buffer) << msg;
+	ASSERT_EQ(strlen(expectedText), (size_t)(end - buffer)) << msg;
+}
+
+TEST(util, engineSnifferRecord) {
+	assertEngineSnifferRoundTrip("u_12", 'u', 12, "u_12");
+	assertEngineSnifferRoundTrip("d_0", 'd', 0, "d_0");
+	assertEngineSnifferRoundTrip("u", 'u', ENGINE_SNIFFER_NO_VALUE, "u");
+	assertEngineSnifferRoundTrip("1500", 0, 1500, "1500");
+	assertEngineSnifferRoundTrip("", 0, ENGINE_SNIFFER_NO_VALUE, "");
+	// too large for 16 bits
+	assertEngineSnifferRoundTrip("123456", 0, ENGINE_SNIFFER_NO_VALUE - 1, "65534");
+
+	const char * volatile names[ENGINE_SNIFFER_CHANNEL_COUNT] = {};
+	const char *c1 = "c1";
+	const char *t1 = "t1";
+	ASSERT_EQ(0, getEngineSnifferChannel(names, c1));
+	ASSERT_EQ(1, getEngineSnifferChannel(names, t1));
+	ASSERT_EQ(0, getEngineSnifferChannel(names, c1));
+	for (int i = 2; i < ENGINE_SNIFFER_CHANNEL_COUNT; i++) {
+		names[i] = "other";
+	}
+	ASSERT_EQ(-1, getEngineSnifferChannel(names, "i1"));
+}
+
+TEST(util, engineSnifferChartSwitch) {
+	volatile uint32_t slot = ENGINE_SNIFFER_SLOT(0, 0);
+	uint32_t reserved;
+
+	ASSERT_TRUE(reserveEngineSnifferRecord(&slot, 2, &reserved));
+	ASSERT_EQ(0, ENGINE_SNIFFER_SLOT_CHART(reserved));
+	ASSERT_EQ(0U, ENGINE_SNIFFER_SLOT_INDEX(reserved));
+	ASSERT_TRUE(reserveEngineSnifferRecord(&slot, 2, &reserved));
+	ASSERT_EQ(1U, ENGINE_SNIFFER_SLOT_INDEX(reserved));
+	// chart is full, writer does not get a record and nothing is counted
+	ASSERT_FALSE(reserveEngineSnifferRecord(&slot, 2, &reserved));
+	ASSERT_EQ(2U, ENGINE_SNIFFER_SLOT_INDEX(slot));
+
+	// switch tells how many records were handed out from previous chart, next writer gets new chart
+	uint32_t previous = switchEngineSnifferChart(&slot, 2);
+	ASSERT_EQ(0, ENGINE_SNIFFER_SLOT_CHART(previous));
+	ASSERT_EQ(2U, ENGINE_SNIFFER_SLOT_INDEX(previous));
+	ASSERT_TRUE(reserveEngineSnifferRecord(&slot, 2, &reserved));
+	ASSERT_EQ(2, ENGINE_SNIFFER_SLOT_CHART(reserved));
+	ASSERT_EQ(0U, ENGINE_SNIFFER_SLOT_INDEX(reserved));
+
+	previous = switchEngineSnifferChart(&slot, 1);
+	ASSERT_EQ(2, ENGINE_SNIFFER_SLOT_CHART(previous));
+	ASSERT_EQ(1U, ENGINE_SNIFFER_SLOT_INDEX(previous));
+}
+
+TEST(util, adcFilter) {
+	AdcFilterBank bank;
+	bank.setChannelCount(3);
+	// channel 0 is plain average, channel 1 IIR, channel 2 averages two blocks per step
+	bank.configure(1, 0.5, 1);
+	bank.configure(2, 1, 2);
+
+	uint16_t block1[] = { 100, 1000, 10,
+			300, 1000, 30 };
+	bank.processBlock(block1, 2);
+	ASSERT_EQ(1U, bank.getVersion());
+	ASSERT_NEAR(200, bank.getValue(0), EPS4D);
+	// first value initializes IIR state
+	ASSERT_NEAR(1000, bank.getValue(1), EPS4D);
+	// not decimated yet
+	ASSERT_NEAR(0, bank.getValue(2), EPS4D);
+
+	uint16_t block2[] = { 500, 2000, 50,
+			500, 2000, 70 };
+	bank.processBlock(block2, 2);
+	ASSERT_EQ(2U, bank.getVersion());
+	ASSERT_NEAR(500, bank.getValue(0), EPS4D);
+	ASSERT_NEAR(1500, bank.getValue(1), EPS4D);
+	ASSERT_NEAR(40, bank.getValue(2), EPS4D);
+
+	float snapshot[3];
+	ASSERT_EQ(2U, bank.getSnapshot(snapshot));
+	ASSERT_NEAR(500, snapshot[0], EPS4D);
+	ASSERT_NEAR(1500, snapshot[1], EPS4D);
+	ASSERT_NEAR(40, snapshot[2], EPS4D);
+
+	// alpha change keeps state
+	bank.setAlpha(1, 0.25);
+	uint16_t block3[] = { 0, 3500, 0 };
+	bank.processBlock(block3, 1);
+	ASSERT_NEAR(2000, bank.getValue(1), EPS4D);
+	// decimated channel keeps published value in between
+	ASSERT_NEAR(40, bank.getValue(2), EPS4D);
+}
+
+#define CIRCULAR_CHANNELS 5
+#define CIRCULAR_DEPTH 8
+
+/**
+ * Same sequence slow ADC sees in circular mode: half-buffer callbacks one after another
+ */
+TEST(util, adcFilterCircularHalfBuffers) {
+	ASSERT_EQ(1, getAdcFilterDecimation(60000, 50000));
+	ASSERT_EQ(ADC_FILTER_MAX_DECIMATION, getAdcFilterDecimation(0, 50000));
+	// 5 channels, 4 rows per half, 480 cycles each at 21MHz
+	int halfBufferUs = 1000000LL * 492 * CIRCULAR_CHANNELS * (CIRCULAR_DEPTH / 2) / 21000000;
+	int decimation = getAdcFilterDecimation(halfBufferUs, 50000);
+	ASSERT_EQ(106, decimation);
+
+	AdcFilterBank bank;
+	bank.setChannelCount(CIRCULAR_CHANNELS);
+	for (int i = 0; i < CIRCULAR_CHANNELS; i++) {
+		bank.configure(i, 1, decimation);
+	}
+	uint16_t samples[CIRCULAR_DEPTH * CIRCULAR_CHANNELS];
+	int halfSize = CIRCULAR_DEPTH / 2 * CIRCULAR_CHANNELS;
+	for (int half = 0; half < 3 * decimation; half++) {
+		uint16_t *buffer = samples + (half % 2) * halfSize;
+		// DMA keeps writing while the other half is being filtered
+		for (int row = 0; row < CIRCULAR_DEPTH / 2; row++) {
+			for (int i = 0; i < CIRCULAR_CHANNELS; i++) {
+				buffer[row * CIRCULAR_CHANNELS + i] = 100 * i + (half % 2) * 10 + row;
+			}
+		}
+		bank.processBlock(buffer, CIRCULAR_DEPTH / 2);
+		ASSERT_EQ((uint32_t) ((half + 1) / decimation), bank.getVersion());
+	}
+	for (int i = 0; i < CIRCULAR_CHANNELS; i++) {
+		// rows 0..3 average 1.5, odd halves add 10
+		ASSERT_NEAR(100 * i + 1.5 + 5, bank.getValue(i), EPS4D);
+	}
+}
+
+static int readBinaryLog(BinaryLogRing *ring, uint8_t *output) {
+	int total = 0;
+	while (ring->getBacklog() > 0) {
+		int size = ring->getContiguousSize();
+		memcpy(output + total, ring->getReadPointer(), size);
+		ring->consume(size);
+		total += size;
+	}
+	return total;
+}
+
+TEST(util, binaryLog) {
+	uint8_t buffer[BINARY_LOG_SECTOR_SIZE];
+	BinaryLogRing ring(buffer, sizeof(buffer));
+	BinaryLogEncoder encoder(&ring);
+	uint8_t output[2 * BINARY_LOG_SECTOR_SIZE];
+
+	// no file yet, encoder still has to start with schema
+	encoder.beginRecord();
+	encoder.addFloat("time", "", 1.5);
+	encoder.addInt("rpm", "RPM", 900);
+	ASSERT_TRUE(encoder.endRecord());
+	ASSERT_EQ(1U, encoder.schemaCounter);
+	int schemaSize = BINARY_LOG_SCHEMA_HEADER_SIZE + (1 + 5 + 1) + (1 + 4 + 4);
+	ASSERT_EQ(schemaSize + 9, readBinaryLog(&ring, output));
+	ASSERT_EQ(BINARY_LOG_SCHEMA_TAG, output[0]);
+	ASSERT_EQ(0, memcmp(BINARY_LOG_MAGIC, output + 1, 4));
+	ASSERT_EQ(2, output[6]);
+	ASSERT_EQ(LOG_FIELD_FLOAT, output[8]);
+	ASSERT_STREQ("time", (const char *) output + 9);
+	ASSERT_EQ(LOG_FIELD_INT, output[15]);
+	ASSERT_STREQ("rpm", (const char *) output + 16);
+	ASSERT_STREQ("RPM", (const char *) output + 20);
+	ASSERT_EQ(BINARY_LOG_RECORD_TAG, output[schemaSize]);
+	float f;
+	memcpy(&f, output + schemaSize + 1, 4);
+	ASSERT_FLOAT_EQ(1.5, f);
+	int32_t i;
+	memcpy(&i, output + schemaSize + 5, 4);
+	ASSERT_EQ(900, i);
+
+	// same fields - record only, and it wraps around the end of the ring
+	for (int r = 0; r < 100; r++) {
+		encoder.beginRecord();
+		encoder.addFloat("time", "", r);
+		encoder.addInt("rpm", "RPM", r * 10);
+		ASSERT_TRUE(encoder.endRecord());
+		ASSERT_EQ(9, readBinaryLog(&ring, output));
+		memcpy(&i, output + 5, 4);
+		ASSERT_EQ(r * 10, i);
+	}
+	ASSERT_EQ(1U, encoder.schemaCounter);
+
+	// one more field - new schema
+	encoder.beginRecord();
+	encoder.addFloat("time", "", 1);
+	encoder.addInt("rpm", "RPM", 2);
+	encoder.addFloat("CLT", "C", 3);
+	ASSERT_TRUE(encoder.endRecord());
+	ASSERT_EQ(2U, encoder.schemaCounter);
+	int schema3Size = schemaSize + 1 + 4 + 2;
+	ASSERT_EQ(schema3Size + 13, readBinaryLog(&ring, output));
+	ASSERT_EQ(BINARY_LOG_SCHEMA_TAG, output[0]);
+	ASSERT_EQ(3, output[6]);
+
+	// new file - schema is repeated
+	ring.startFile();
+	encoder.beginRecord();
+	encoder.addFloat("time", "", 1);
+	encoder.addInt("rpm", "RPM", 2);
+	encoder.addFloat("CLT", "C", 3);
+	ASSERT_TRUE(encoder.endRecord());
+	ASSERT_EQ(3U, encoder.schemaCounter);
+
+	// nobody reads - ring overrun, nothing partial is written
+	int overruns = 0;
+	for (int r = 0; r < 100; r++) {
+		encoder.beginRecord();
+		encoder.addFloat("time", "", r);
+		encoder.addInt("rpm", "RPM", r);
+		encoder.addFloat("CLT", "C", r);
+		if (!encoder.endRecord()) {
+			overruns++;
+		}
+	}
+	ASSERT_TRUE(overruns > 0);
+	ASSERT_EQ((uint32_t) overruns, ring.overrunCounter);
+	ASSERT_EQ(0, (ring.getBacklog() - schema3Size) % 13);
+	ring.discard();
+	ASSERT_EQ(0, ring.getBacklog());
+}
+
+static void addBinaryLogRecord(BinaryLogEncoder *encoder, int value) {
+	encoder->beginRecord();
+	encoder->addFloat("time", "", value);
+	encoder->addInt("rpm", "RPM", value);
+	ASSERT_TRUE(encoder->endRecord());
+}
+
+TEST(util, binaryLogNewFile) {
+	uint8_t buffer[BINARY_LOG_SECTOR_SIZE];
+	BinaryLogRing ring(buffer, sizeof(buffer));
+	BinaryLogEncoder encoder(&ring);
+	uint8_t output[BINARY_LOG_SECTOR_SIZE];
+
+	addBinaryLogRecord(&encoder, 1);
+	addBinaryLogRecord(&encoder, 2);
+	ring.startFile();
+	// producer has not noticed the new file yet
+	ASSERT_FALSE(ring.skipPreviousFile());
+	ASSERT_EQ(0, ring.getBacklog());
+	// record which was already on its way when the file was switched
+	uint8_t stale[9] = { BINARY_LOG_RECORD_TAG };
+	ASSERT_TRUE(ring.write(stale, sizeof(stale)));
+	addBinaryLogRecord(&encoder, 3);
+	ASSERT_TRUE(ring.skipPreviousFile());
+	int schemaSize = BINARY_LOG_SCHEMA_HEADER_SIZE + 1 + 5 + 1 + 1 + 4 + 4;
+	ASSERT_EQ(schemaSize + 9, readBinaryLog(&ring, output));
+	// new file starts with schema
+	ASSERT_EQ(BINARY_LOG_SCHEMA_TAG, output[0]);
+	ASSERT_EQ(BINARY_LOG_RECORD_TAG, output[schemaSize]);
+
+	// already skipped, new records of the same file are kept
+	addBinaryLogRecord(&encoder, 4);
+	ASSERT_TRUE(ring.skipPreviousFile());
+	ASSERT_EQ(9, readBinaryLog(&ring, output));
+}
+
+/**
+ * Counts bytes instead of writing them, every write has to end at sector boundary unless
+ * it is a flush
+ */
+class TestBinaryLogFile : public BinaryLogFile {
+public:
+	TestBinaryLogFile(uint32_t size) {
+		this->size = size;
+		writeCounter = 0;
+		capacity = 1 << 30;
+	}
+	int write(const void *data, int length) {
+		(void)data;
+		int written = minI(length, (int) (capacity - size));
+		size += written;
+		writeCounter++;
+		return written;
+	}
+	uint32_t size;
+	uint32_t capacity;
+	int writeCounter;
+};
+
+TEST(util, binaryLogSectorAlignedWriter) {
+	uint8_t buffer[8192];
+	BinaryLogRing ring(buffer, sizeof(buffer));
+	BinaryLogEncoder encoder(&ring);
+	// records are 9 bytes so ring offset is never sector aligned, and we append to existing
+	// file which ends in the middle of a sector
+	TestBinaryLogFile file(100);
+	ring.startFile();
+	for (int session = 0; session < 3; session++) {
+		for (int r = 0; r < 10000; r++) {
+			addBinaryLogRecord(&encoder, r);
+			uint32_t fileOffset = file.size;
+			int written = ring.writeTo(&file, fileOffset, false, 1024);
+			ASSERT_EQ((int) (file.size - fileOffset), written);
+			if (file.size != fileOffset) {
+				ASSERT_EQ(0U, file.size % BINARY_LOG_SECTOR_SIZE);
+			}
+			ASSERT_TRUE(ring.getBacklog() < BINARY_LOG_SECTOR_SIZE);
+		}
+		ASSERT_EQ(0U, ring.overrunCounter);
+		ASSERT_EQ(0U, file.size % BINARY_LOG_SECTOR_SIZE);
+		// final flush leaves partial sector, next session appends to the same file
+		int backlog = ring.getBacklog();
+		ASSERT_EQ(backlog, ring.writeTo(&file, file.size, true, 1024));
+		ASSERT_EQ(0, ring.getBacklog());
+		ring.startFile();
+	}
+}
+
+TEST(util, binaryLogWriterChunksAndErrors) {
+	uint8_t buffer[8192];
+	BinaryLogRing ring(buffer, sizeof(buffer));
+	uint8_t block[1000] = { BINARY_LOG_RECORD_TAG };
+	TestBinaryLogFile file(0);
+
+	// nothing goes into the file before producer starts it
+	ASSERT_TRUE(ring.write(block, sizeof(block)));
+	ring.startFile();
+	ASSERT_EQ(0, ring.writeTo(&file, file.size, true, 256));
+	ASSERT_EQ(0, file.writeCounter);
+	ring.markFileStart(ring.fileCounter);
+	ASSERT_TRUE(ring.write(block, sizeof(block)));
+
+	// 1000 bytes: one sector in two chunks of 256, the rest waits
+	ASSERT_EQ(512, ring.writeTo(&file, file.size, false, 256));
+	ASSERT_EQ(2, file.writeCounter);
+	ASSERT_EQ(488, ring.getBacklog());
+
+	// disk full: write stops at the first short write, whatever was not written is lost
+	ASSERT_TRUE(ring.write(block, sizeof(block)));
+	file.capacity = file.size + 300;
+	ASSERT_EQ(300, ring.writeTo(&file, file.size, false, 256));
+	ASSERT_EQ(4, file.writeCounter);
+	ASSERT_EQ(1488 - 512, ring.getBacklog());
+}
+
+#define COMPARED_LOG_FIELDS 40
+
+static const char *comparedFieldNames[COMPARED_LOG_FIELDS];
+
+/**
+ * decoded binary record should print the same as text log line did
+ */
+TEST(util, binaryLogSameAsText) {
+	char names[COMPARED_LOG_FIELDS][8];
+	for (int f = 0; f < COMPARED_LOG_FIELDS; f++) {
+		sprintf(names[f], "f%d", f);
+		comparedFieldNames[f] = names[f];
+	}
+	uint8_t ringBuffer[8192];
+	BinaryLogRing ring(ringBuffer, sizeof(ringBuffer));
+	BinaryLogEncoder encoder(&ring);
+
+	for (int l = 0; l < 100; l++) {
+		char text[1000];
+		int length = 0;
+		encoder.beginRecord();
+		for (int f = 0; f < COMPARED_LOG_FIELDS; f++) {
+			float value = l * 0.37 - f * 11.3;
+			length += snprintf(text + length, sizeof(text) - length, "%.2f\t", value);
+			encoder.addFloat(comparedFieldNames[f], "v", value);
+		}
+		ASSERT_TRUE(encoder.endRecord());
+		if (l == 0) {
+			// schema goes first, that one is covered by util.binaryLog
+			ring.discard();
+			continue;
+		}
+
+		ASSERT_EQ(1 + 4 * COMPARED_LOG_FIELDS, ring.getBacklog());
+		uint8_t record[1 + 4 * COMPARED_LOG_FIELDS];
+		int recordSize = 0;
+		// record could wrap around the end of the ring
+		while (ring.getBacklog() > 0) {
+			int size = ring.getContiguousSize();
+			memcpy(record + recordSize, ring.getReadPointer(), size);
+			recordSize += size;
+			ring.consume(size);
+		}
+		ASSERT_EQ(BINARY_LOG_RECORD_TAG, record[0]);
+		char decoded[1000];
+		int decodedLength = 0;
+		for (int f = 0; f < COMPARED_LOG_FIELDS; f++) {
+			float value;
+			memcpy(&value, record + 1 + 4 * f, sizeof(value));
+			decodedLength += snprintf(decoded + decodedLength, sizeof(decoded) - decodedLength, "%.2f\t", value);
+		}
+		ASSERT_STREQ(text, decoded);
+	}
+	ASSERT_EQ(1U, encoder.schemaCounter);
+	ASSERT_EQ(0U, ring.overrunCounter);
+}
+
+TEST(util, compactHistogram) {
+	ASSERT_EQ(0, compactHistogramGetIndex(0));
+	ASSERT_EQ(1, compactHistogramGetIndex(1));
+	ASSERT_EQ(2, compactHistogramGetIndex(3));
+	ASSERT_EQ(3, compactHistogramGetIndex(4));
+	ASSERT_EQ(COMPACT_HISTOGRAM_SIZE - 1, compactHistogramGetIndex(0xFFFFFFFF));
+
+	compact_histogram_s h;
+	resetCompactHistogram(&h);
+	ASSERT_EQ(0U, compactHsGetPercentile(&h, 0.5));
+
+	for (int i = 0; i < 90; i++) {
+		compactHsAdd(&h, 5);
+	}
+	for (int i = 0; i < 10; i++) {
+		compactHsAdd(&h, 100);
+	}
+	ASSERT_EQ(100U, h.total_count);
+	ASSERT_EQ(100U, h.max);
+	// 5 is in [4, 8) bucket
+	ASSERT_EQ(7U, compactHsGetPercentile(&h, 0.5));
+	ASSERT_EQ(100U, compactHsGetPercentile(&h, 0.95));
+}
+
 TEST(util, histogram) {
 	print("******************************************* testHistogram\r\n");
 
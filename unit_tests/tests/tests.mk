@@ -22,8 +22,14 @@ TESTS_SRC_CPP = \
 	tests/test_logic_expression.cpp \
 	tests/test_speed_density.cpp \
 	tests/test_signal_executor.cpp \
+	tests/test_event_heap.cpp \
+	tests/test_output_schedule.cpp \
 	tests/test_cpp_memory_layout.cpp \
 	tests/test_sensors.cpp \
 	tests/test_pid_auto.cpp \
 	tests/test_accel_enrichment.cpp \
-	tests/test_gpiochip.cpp
+	tests/test_gpiochip.cpp \
+	tests/test_flash_log.cpp \
+	tests/test_can_bus.cpp \
+	tests/test_obd2_server.cpp \
+	tests/test_tooth_logger.cpp